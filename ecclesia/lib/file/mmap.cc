@@ -36,30 +36,40 @@ namespace ecclesia {
 absl::StatusOr<MappedMemory> MappedMemory::Create(const std::string &path,
                                                   size_t offset, size_t size,
                                                   Type type) {
-  // Parameters for the open() and mmap() calls.
-  int open_flags, mmap_prot, mmap_flags;
+  // Open the file for reading.
+  const int fd =
+      open(path.c_str(), type == Type::kReadOnly ? O_RDONLY : O_RDWR);
+  if (fd == -1) {
+    return absl::InternalError(
+        absl::StrFormat("unable to open the file: %s", path));
+  }
+  absl::Cleanup fd_closer = [fd]() { close(fd); };
+  absl::StatusOr<MappedMemory> mapping = CreateFromFd(fd, offset, size, type);
+  if (!mapping.ok()) {
+    return absl::InternalError(
+        absl::StrFormat("unable to mmap the file: %s", path));
+  }
+  return mapping;
+}
+
+absl::StatusOr<MappedMemory> MappedMemory::CreateFromFd(int fd, size_t offset,
+                                                        size_t size,
+                                                        Type type) {
+  // Parameters for the mmap() call.
+  int mmap_prot, mmap_flags;
   bool writable;
   switch (type) {
     case Type::kReadOnly:
-      open_flags = O_RDONLY;
       mmap_prot = PROT_READ;
       mmap_flags = MAP_PRIVATE;
       writable = false;
       break;
     case Type::kReadWrite:
-      open_flags = O_RDWR;
       mmap_prot = PROT_READ | PROT_WRITE;
       mmap_flags = MAP_SHARED;
       writable = true;
       break;
   }
-  // Open the file for reading.
-  const int fd = open(path.c_str(), open_flags);
-  if (fd == -1) {
-    return absl::InternalError(
-        absl::StrFormat("unable to open the file: %s", path));
-  }
-  absl::Cleanup fd_closer = [fd]() { close(fd); };
 
   // Determine the offset and length to use for the memory mapping, rounding
   // to an appropriate page size.
@@ -70,7 +80,7 @@ absl::StatusOr<MappedMemory> MappedMemory::Create(const std::string &path,
   void *addr = mmap(nullptr, true_size, mmap_prot, mmap_flags, fd, true_offset);
   if (addr == MAP_FAILED) {
     return absl::InternalError(
-        absl::StrFormat("unable to mmap the file: %s", path));
+        absl::StrFormat("unable to mmap file descriptor %d", fd));
   }
   // We have a good mapping. Note that we no longer need to keep the fd open.
   return MappedMemory({addr, true_size, user_offset, size, writable});
@@ -54,6 +54,11 @@ class MappedMemory {
   static absl::StatusOr<MappedMemory> Create(const std::string &path,
                                              size_t offset, size_t size,
                                              Type type);
+  // Same as above, but maps the file already open as 'fd'. The file must be
+  // open for reading, and for writing too for a read-write mapping. The caller
+  // keeps ownership of 'fd', which can be closed once the mapping is created.
+  static absl::StatusOr<MappedMemory> CreateFromFd(int fd, size_t offset,
+                                                   size_t size, Type type);
 
   // This object cannot be shared so copying is not allowed. It can be moved
   // with ownership of the underlying mapping moving along with the file.
@@ -16,6 +16,9 @@
 
 #include "ecclesia/lib/file/mmap.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <cstdint>
 #include <optional>
 #include <string>
@@ -95,6 +98,20 @@ TEST_F(MappedMemoryTest, ReadOnlyWorksWithOffset) {
   EXPECT_EQ(mmap.MemoryAsStringView(), "56789\n");
 }
 
+TEST_F(MappedMemoryTest, ReadOnlyWorksFromFd) {
+  fs_.CreateFile("/fd.txt", "0123456789\n");
+  int fd = open(fs_.GetTruePath("/fd.txt").c_str(), O_RDONLY);
+  ASSERT_GE(fd, 0);
+  auto maybe_mmap =
+      MappedMemory::CreateFromFd(fd, 5, 6, MappedMemory::Type::kReadOnly);
+  // The mapping remains valid after the file is closed.
+  close(fd);
+  ASSERT_THAT(maybe_mmap, IsOk());
+
+  MappedMemory mmap = std::move(*maybe_mmap);
+  EXPECT_EQ(mmap.MemoryAsStringView(), "56789\n");
+}
+
 TEST_F(MappedMemoryTest, ReadWriteWorksOnSimpleFile) {
   fs_.CreateFile("/e.txt", "0123456789\n");
   auto maybe_mmap = MappedMemory::Create(fs_.GetTruePath("/e.txt"), 0, 11,
@@ -0,0 +1,460 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ecclesia/lib/redfish/compact_node_topology.h"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "ecclesia/lib/codec/endian.h"
+#include "ecclesia/lib/file/mmap.h"
+#include "ecclesia/lib/redfish/node_topology.h"
+#include "ecclesia/lib/redfish/topology_diff.h"
+#include "ecclesia/lib/redfish/types.h"
+
+namespace ecclesia {
+
+namespace {
+
+// Assigns ids to strings in lexicographic order, so that indexes sorted by
+// string id are also sorted by string.
+class StringTable {
+ public:
+  void Add(absl::string_view value) { ids_.try_emplace(value, 0); }
+
+  // Assigns the ids. No strings can be added afterwards.
+  void Finalize() {
+    strings_.reserve(ids_.size());
+    for (const auto &[value, unused] : ids_) strings_.push_back(value);
+    std::sort(strings_.begin(), strings_.end());
+    for (uint32_t id = 0; id < strings_.size(); ++id) {
+      ids_[strings_[id]] = id;
+    }
+  }
+
+  uint32_t Id(absl::string_view value) const { return ids_.at(value); }
+  const std::vector<absl::string_view> &strings() const { return strings_; }
+
+ private:
+  absl::flat_hash_map<absl::string_view, uint32_t> ids_;
+  std::vector<absl::string_view> strings_;
+};
+
+// Appends the rows of a compressed sparse row list to 'offsets' and 'values'.
+void AppendRow(const std::vector<uint32_t> &row, std::vector<uint32_t> &offsets,
+               std::vector<uint32_t> &values) {
+  values.insert(values.end(), row.begin(), row.end());
+  offsets.push_back(values.size());
+}
+
+}  // namespace
+
+CompactNodeTopology CompactNodeTopology::Create(const NodeTopology &topology) {
+  StringTable strings;
+  absl::flat_hash_map<const Node *, NodeId> node_ids;
+  for (const auto &node : topology.nodes) {
+    node_ids.try_emplace(node.get(), node_ids.size());
+    strings.Add(node->name);
+    strings.Add(node->model);
+    strings.Add(node->local_devpath);
+    for (const std::string &uri : node->associated_uris) strings.Add(uri);
+  }
+  for (const auto &[devpath, node] : topology.devpath_to_node_map) {
+    if (node_ids.contains(node)) strings.Add(devpath);
+  }
+  for (const auto &[uri, unused] : topology.uri_to_associated_node_map) {
+    strings.Add(uri);
+  }
+  strings.Finalize();
+
+  // Returns the ids of the Nodes in 'nodes' which are part of the topology.
+  auto get_node_ids = [&](const std::vector<Node *> &nodes) {
+    std::vector<uint32_t> ids;
+    ids.reserve(nodes.size());
+    for (const Node *node : nodes) {
+      if (auto it = node_ids.find(node); it != node_ids.end()) {
+        ids.push_back(it->second);
+      }
+    }
+    return ids;
+  };
+  auto get_adjacent_ids =
+      [&](const absl::flat_hash_map<Node *, std::vector<Node *>> &map,
+          Node *node) {
+        auto it = map.find(node);
+        return it == map.end() ? std::vector<uint32_t>()
+                               : get_node_ids(it->second);
+      };
+
+  std::vector<uint32_t> nodes;
+  std::vector<uint32_t> parent_offsets = {0}, parents;
+  std::vector<uint32_t> child_offsets = {0}, children;
+  std::vector<uint32_t> uri_offsets = {0}, uris;
+  nodes.reserve(topology.nodes.size() * kNodeFields);
+  for (const auto &node : topology.nodes) {
+    nodes.push_back(strings.Id(node->name));
+    nodes.push_back(strings.Id(node->model));
+    nodes.push_back(strings.Id(node->local_devpath));
+    nodes.push_back(node->type);
+    nodes.push_back(node->replaceable ? 1 : 0);
+    AppendRow(get_adjacent_ids(topology.node_to_parents, node.get()),
+              parent_offsets, parents);
+    AppendRow(get_adjacent_ids(topology.node_to_children, node.get()),
+              child_offsets, children);
+    std::vector<uint32_t> uri_ids;
+    for (const std::string &uri : node->associated_uris) {
+      uri_ids.push_back(strings.Id(uri));
+    }
+    AppendRow(uri_ids, uri_offsets, uris);
+  }
+
+  std::vector<std::pair<uint32_t, uint32_t>> devpath_entries;
+  for (const auto &[devpath, node] : topology.devpath_to_node_map) {
+    if (auto it = node_ids.find(node); it != node_ids.end()) {
+      devpath_entries.push_back({strings.Id(devpath), it->second});
+    }
+  }
+  std::sort(devpath_entries.begin(), devpath_entries.end());
+  std::vector<uint32_t> devpath_index;
+  for (const auto &[devpath, node] : devpath_entries) {
+    devpath_index.push_back(devpath);
+    devpath_index.push_back(node);
+  }
+
+  std::vector<std::pair<uint32_t, const std::vector<Node *> *>> uri_entries;
+  for (const auto &[uri, uri_nodes] : topology.uri_to_associated_node_map) {
+    uri_entries.push_back({strings.Id(uri), &uri_nodes});
+  }
+  std::sort(uri_entries.begin(), uri_entries.end());
+  std::vector<uint32_t> uri_index;
+  std::vector<uint32_t> uri_node_offsets = {0}, uri_nodes;
+  for (const auto &[uri, uri_entry_nodes] : uri_entries) {
+    uri_index.push_back(uri);
+    AppendRow(get_node_ids(*uri_entry_nodes), uri_node_offsets, uri_nodes);
+  }
+
+  std::vector<uint32_t> string_offsets = {0};
+  std::string string_data;
+  for (absl::string_view value : strings.strings()) {
+    string_data.append(value.data(), value.size());
+    string_offsets.push_back(string_data.size());
+  }
+  string_data.resize((string_data.size() + 3) & ~size_t{3}, '\0');
+
+  Header header;
+  header.num_nodes = topology.nodes.size();
+  header.num_strings = strings.strings().size();
+  header.string_bytes = string_data.size();
+  header.num_parents = parents.size();
+  header.num_children = children.size();
+  header.num_uris = uris.size();
+  header.num_devpath_entries = devpath_entries.size();
+  header.num_uri_entries = uri_entries.size();
+  header.num_uri_nodes = uri_nodes.size();
+
+  std::vector<uint32_t> words = {kMagic,
+                                 kVersion,
+                                 header.num_nodes,
+                                 header.num_strings,
+                                 header.string_bytes,
+                                 header.num_parents,
+                                 header.num_children,
+                                 header.num_uris,
+                                 header.num_devpath_entries,
+                                 header.num_uri_entries,
+                                 header.num_uri_nodes};
+  for (const std::vector<uint32_t> *section :
+       {&string_offsets, &nodes, &parent_offsets, &parents, &child_offsets,
+        &children, &uri_offsets, &uris, &devpath_index, &uri_index,
+        &uri_node_offsets, &uri_nodes}) {
+    words.insert(words.end(), section->begin(), section->end());
+  }
+
+  auto buffer = std::make_shared<std::string>(
+      words.size() * sizeof(uint32_t) + string_data.size(), '\0');
+  for (size_t i = 0; i < words.size(); ++i) {
+    LittleEndian::Store32(words[i], buffer->data() + i * sizeof(uint32_t));
+  }
+  buffer->replace(words.size() * sizeof(uint32_t), string_data.size(),
+                  string_data);
+  absl::string_view view = *buffer;
+  return CompactNodeTopology(view, header, std::move(buffer));
+}
+
+absl::StatusOr<CompactNodeTopology> CompactNodeTopology::Parse(
+    std::string buffer) {
+  auto storage = std::make_shared<const std::string>(std::move(buffer));
+  absl::string_view view = *storage;
+  return ParseBuffer(view, std::move(storage));
+}
+
+absl::StatusOr<CompactNodeTopology> CompactNodeTopology::ParseUnowned(
+    absl::string_view buffer) {
+  return ParseBuffer(buffer, nullptr);
+}
+
+absl::StatusOr<CompactNodeTopology> CompactNodeTopology::ParseShared(
+    absl::string_view buffer, std::shared_ptr<const void> storage) {
+  return ParseBuffer(buffer, std::move(storage));
+}
+
+absl::StatusOr<CompactNodeTopology> CompactNodeTopology::LoadFromFile(
+    const std::string &path, size_t offset) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) {
+    return absl::NotFoundError(absl::StrCat("unable to stat ", path));
+  }
+  if (offset > static_cast<size_t>(st.st_size)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("offset ", offset, " is past the end of ", path));
+  }
+  absl::StatusOr<MappedMemory> mapping = MappedMemory::Create(
+      path, offset, st.st_size - offset, MappedMemory::Type::kReadOnly);
+  if (!mapping.ok()) return mapping.status();
+  auto storage = std::make_shared<const MappedMemory>(*std::move(mapping));
+  absl::string_view view = storage->MemoryAsStringView();
+  return ParseBuffer(view, std::move(storage));
+}
+
+CompactNodeTopology::Layout CompactNodeTopology::ComputeLayout(
+    const Header &header) {
+  Layout layout;
+  size_t offset = kHeaderWords;
+  auto section = [&offset](size_t size) {
+    size_t start = offset;
+    offset += size;
+    return start;
+  };
+  layout.string_offsets = section(size_t{header.num_strings} + 1);
+  layout.nodes = section(size_t{header.num_nodes} * kNodeFields);
+  layout.parent_offsets = section(size_t{header.num_nodes} + 1);
+  layout.parents = section(header.num_parents);
+  layout.child_offsets = section(size_t{header.num_nodes} + 1);
+  layout.children = section(header.num_children);
+  layout.uri_offsets = section(size_t{header.num_nodes} + 1);
+  layout.uris = section(header.num_uris);
+  layout.devpath_index = section(size_t{header.num_devpath_entries} * 2);
+  layout.uri_index = section(header.num_uri_entries);
+  layout.uri_node_offsets = section(size_t{header.num_uri_entries} + 1);
+  layout.uri_nodes = section(header.num_uri_nodes);
+  layout.string_data = offset * sizeof(uint32_t);
+  layout.size = layout.string_data + header.string_bytes;
+  return layout;
+}
+
+absl::StatusOr<CompactNodeTopology> CompactNodeTopology::ParseBuffer(
+    absl::string_view buffer, std::shared_ptr<const void> storage) {
+  if (buffer.size() < kHeaderWords * sizeof(uint32_t)) {
+    return absl::InvalidArgumentError("topology buffer is truncated");
+  }
+  auto word = [&buffer](size_t index) {
+    return LittleEndian::Load32(buffer.data() + index * sizeof(uint32_t));
+  };
+  if (word(0) != kMagic) {
+    return absl::InvalidArgumentError("not a topology buffer");
+  }
+  if (word(1) != kVersion) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("unsupported topology buffer version ", word(1)));
+  }
+  Header header;
+  header.num_nodes = word(2);
+  header.num_strings = word(3);
+  header.string_bytes = word(4);
+  header.num_parents = word(5);
+  header.num_children = word(6);
+  header.num_uris = word(7);
+  header.num_devpath_entries = word(8);
+  header.num_uri_entries = word(9);
+  header.num_uri_nodes = word(10);
+  if (ComputeLayout(header).size != buffer.size()) {
+    return absl::InvalidArgumentError(
+        "topology buffer size does not match its header");
+  }
+  CompactNodeTopology topology(buffer, header, std::move(storage));
+  if (absl::Status status = topology.Validate(); !status.ok()) return status;
+  return topology;
+}
+
+CompactNodeTopology::CompactNodeTopology(absl::string_view buffer,
+                                         const Header &header,
+                                         std::shared_ptr<const void> storage)
+    : buffer_(buffer),
+      header_(header),
+      layout_(ComputeLayout(header)),
+      storage_(std::move(storage)) {}
+
+absl::Status CompactNodeTopology::Validate() const {
+  // Returns true if the offsets at 'offsets' are increasing from 0 to 'size'.
+  auto valid_offsets = [this](size_t offsets, size_t rows, size_t size) {
+    if (Word(offsets) != 0 || Word(offsets + rows) != size) return false;
+    for (size_t i = 0; i < rows; ++i) {
+      if (Word(offsets + i) > Word(offsets + i + 1)) return false;
+    }
+    return true;
+  };
+  // Returns true if the 'count' ids at 'ids', 'stride' words apart, are less
+  // than 'limit'.
+  auto valid_ids = [this](size_t ids, size_t count, size_t stride,
+                          size_t limit) {
+    for (size_t i = 0; i < count; ++i) {
+      if (Word(ids + i * stride) >= limit) return false;
+    }
+    return true;
+  };
+
+  const Header &h = header_;
+  const Layout &l = layout_;
+  // The string data is padded, so the strings may end before it does.
+  if (Word(l.string_offsets + h.num_strings) > h.string_bytes ||
+      !valid_offsets(l.string_offsets, h.num_strings,
+                     Word(l.string_offsets + h.num_strings)) ||
+      !valid_offsets(l.parent_offsets, h.num_nodes, h.num_parents) ||
+      !valid_offsets(l.child_offsets, h.num_nodes, h.num_children) ||
+      !valid_offsets(l.uri_offsets, h.num_nodes, h.num_uris) ||
+      !valid_offsets(l.uri_node_offsets, h.num_uri_entries, h.num_uri_nodes)) {
+    return absl::InvalidArgumentError("invalid offsets in topology buffer");
+  }
+  for (size_t field : {kNodeName, kNodeModel, kNodeLocalDevpath}) {
+    if (!valid_ids(l.nodes + field, h.num_nodes, kNodeFields, h.num_strings)) {
+      return absl::InvalidArgumentError("invalid string in topology buffer");
+    }
+  }
+  if (!valid_ids(l.nodes + kNodeType, h.num_nodes, kNodeFields,
+                 NodeType::kCable + 1) ||
+      !valid_ids(l.nodes + kNodeReplaceable, h.num_nodes, kNodeFields, 2)) {
+    return absl::InvalidArgumentError("invalid node in topology buffer");
+  }
+  if (!valid_ids(l.parents, h.num_parents, 1, h.num_nodes) ||
+      !valid_ids(l.children, h.num_children, 1, h.num_nodes) ||
+      !valid_ids(l.uri_nodes, h.num_uri_nodes, 1, h.num_nodes) ||
+      !valid_ids(l.devpath_index + 1, h.num_devpath_entries, 2, h.num_nodes)) {
+    return absl::InvalidArgumentError("invalid node id in topology buffer");
+  }
+  if (!valid_ids(l.uris, h.num_uris, 1, h.num_strings) ||
+      !valid_ids(l.devpath_index, h.num_devpath_entries, 2, h.num_strings) ||
+      !valid_ids(l.uri_index, h.num_uri_entries, 1, h.num_strings)) {
+    return absl::InvalidArgumentError("invalid string in topology buffer");
+  }
+  // Lookups rely on the indexes being sorted.
+  for (size_t i = 1; i < h.num_devpath_entries; ++i) {
+    if (Word(l.devpath_index + 2 * (i - 1)) >= Word(l.devpath_index + 2 * i)) {
+      return absl::InvalidArgumentError("unsorted devpath index");
+    }
+  }
+  for (size_t i = 1; i < h.num_uri_entries; ++i) {
+    if (Word(l.uri_index + i - 1) >= Word(l.uri_index + i)) {
+      return absl::InvalidArgumentError("unsorted URI index");
+    }
+  }
+  for (size_t i = 1; i < h.num_strings; ++i) {
+    if (GetString(i - 1) >= GetString(i)) {
+      return absl::InvalidArgumentError("unsorted string table");
+    }
+  }
+  return absl::OkStatus();
+}
+
+std::optional<size_t> CompactNodeTopology::FindString(
+    size_t index, size_t size, size_t stride, absl::string_view value) const {
+  size_t low = 0, high = size;
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    absl::string_view mid_value = GetString(Word(index + mid * stride));
+    if (mid_value == value) return mid;
+    if (mid_value < value) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<CompactNodeTopology::NodeId>
+CompactNodeTopology::FindNodeByDevpath(absl::string_view devpath) const {
+  std::optional<size_t> entry = FindString(
+      layout_.devpath_index, header_.num_devpath_entries, 2, devpath);
+  if (!entry.has_value()) return std::nullopt;
+  return Word(layout_.devpath_index + 2 * *entry + 1);
+}
+
+CompactNodeTopology::IdList CompactNodeTopology::FindNodesByUri(
+    absl::string_view uri) const {
+  std::optional<size_t> entry =
+      FindString(layout_.uri_index, header_.num_uri_entries, 1, uri);
+  if (!entry.has_value()) return IdList();
+  return GetRow(layout_.uri_node_offsets, layout_.uri_nodes, *entry);
+}
+
+NodeTopology CompactNodeTopology::ToNodeTopology() const {
+  NodeTopology topology;
+  topology.nodes.reserve(num_nodes());
+  for (NodeId id = 0; id < num_nodes(); ++id) {
+    auto node = std::make_unique<Node>();
+    node->name = std::string(name(id));
+    node->model = std::string(model(id));
+    node->local_devpath = std::string(local_devpath(id));
+    node->type = type(id);
+    node->replaceable = replaceable(id);
+    for (size_t i = 0; i < num_associated_uris(id); ++i) {
+      node->associated_uris.push_back(std::string(associated_uri(id, i)));
+    }
+    topology.nodes.push_back(std::move(node));
+  }
+  auto get_nodes = [&topology](IdList ids) {
+    std::vector<Node *> nodes;
+    nodes.reserve(ids.size());
+    for (NodeId id : ids) nodes.push_back(topology.nodes[id].get());
+    return nodes;
+  };
+  for (NodeId id = 0; id < num_nodes(); ++id) {
+    Node *node = topology.nodes[id].get();
+    if (IdList ids = parents(id); !ids.empty()) {
+      topology.node_to_parents[node] = get_nodes(ids);
+    }
+    if (IdList ids = children(id); !ids.empty()) {
+      topology.node_to_children[node] = get_nodes(ids);
+    }
+  }
+  for (size_t i = 0; i < header_.num_devpath_entries; ++i) {
+    topology.devpath_to_node_map[GetString(
+        Word(layout_.devpath_index + 2 * i))] =
+        topology.nodes[Word(layout_.devpath_index + 2 * i + 1)].get();
+  }
+  for (size_t i = 0; i < header_.num_uri_entries; ++i) {
+    topology.uri_to_associated_node_map[GetString(
+        Word(layout_.uri_index + i))] =
+        get_nodes(GetRow(layout_.uri_node_offsets, layout_.uri_nodes, i));
+  }
+  ComputeStructuralHashes(&topology);
+  return topology;
+}
+
+}  // namespace ecclesia
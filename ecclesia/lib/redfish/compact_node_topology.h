@@ -0,0 +1,238 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ECCLESIA_LIB_REDFISH_COMPACT_NODE_TOPOLOGY_H_
+#define ECCLESIA_LIB_REDFISH_COMPACT_NODE_TOPOLOGY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "ecclesia/lib/codec/endian.h"
+#include "ecclesia/lib/redfish/node_topology.h"
+#include "ecclesia/lib/redfish/types.h"
+
+namespace ecclesia {
+
+// CompactNodeTopology is an immutable form of NodeTopology held in a single
+// flat buffer. Nodes are identified by their index, strings are interned, and
+// the parents, children and associated URIs of the Nodes are stored as
+// compressed sparse rows. Devpaths and URIs are looked up by binary search over
+// sorted indexes.
+//
+// The buffer is also the serialized form of the topology: it holds
+// little-endian integers with no pointers, so it can be written to a file and
+// loaded again by memory mapping the file without any parsing. Loading
+// validates the buffer in a single pass.
+//
+// Copies share the buffer. This class is thread-safe.
+class CompactNodeTopology {
+ public:
+  using NodeId = uint32_t;
+
+  // A list of Node ids stored in the buffer.
+  class IdList {
+   public:
+    class Iterator {
+     public:
+      explicit Iterator(const char *data) : data_(data) {}
+      NodeId operator*() const { return LittleEndian::Load32(data_); }
+      Iterator &operator++() {
+        data_ += sizeof(NodeId);
+        return *this;
+      }
+      bool operator==(const Iterator &other) const {
+        return data_ == other.data_;
+      }
+      bool operator!=(const Iterator &other) const {
+        return data_ != other.data_;
+      }
+
+     private:
+      const char *data_;
+    };
+
+    IdList() = default;
+    IdList(const char *data, size_t size) : data_(data), size_(size) {}
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    NodeId operator[](size_t index) const {
+      return LittleEndian::Load32(data_ + index * sizeof(NodeId));
+    }
+    Iterator begin() const { return Iterator(data_); }
+    Iterator end() const { return Iterator(data_ + size_ * sizeof(NodeId)); }
+
+   private:
+    const char *data_ = nullptr;
+    size_t size_ = 0;
+  };
+
+  // Creates the compact form of 'topology'.
+  static CompactNodeTopology Create(const NodeTopology &topology);
+
+  // Creates a topology from a buffer returned by serialized().
+  static absl::StatusOr<CompactNodeTopology> Parse(std::string buffer);
+  // Same as above but without copying 'buffer', which must outlive the
+  // topology and its copies.
+  static absl::StatusOr<CompactNodeTopology> ParseUnowned(
+      absl::string_view buffer);
+  // Same as above but keeps 'storage', which holds 'buffer', alive as long as
+  // the topology or any of its copies.
+  static absl::StatusOr<CompactNodeTopology> ParseShared(
+      absl::string_view buffer, std::shared_ptr<const void> storage);
+  // Memory maps the file at 'path', which holds a buffer returned by
+  // serialized() from 'offset' to its end.
+  static absl::StatusOr<CompactNodeTopology> LoadFromFile(
+      const std::string &path, size_t offset = 0);
+
+  // Returns the serialized form of the topology.
+  absl::string_view serialized() const { return buffer_; }
+
+  // Returns the number of Nodes. Node ids range from 0 to num_nodes() - 1, in
+  // the order of NodeTopology::nodes.
+  size_t num_nodes() const { return header_.num_nodes; }
+
+  absl::string_view name(NodeId node) const {
+    return GetString(GetNodeField(node, kNodeName));
+  }
+  absl::string_view model(NodeId node) const {
+    return GetString(GetNodeField(node, kNodeModel));
+  }
+  absl::string_view local_devpath(NodeId node) const {
+    return GetString(GetNodeField(node, kNodeLocalDevpath));
+  }
+  NodeType type(NodeId node) const {
+    return static_cast<NodeType>(GetNodeField(node, kNodeType));
+  }
+  bool replaceable(NodeId node) const {
+    return GetNodeField(node, kNodeReplaceable) != 0;
+  }
+  IdList parents(NodeId node) const {
+    return GetRow(layout_.parent_offsets, layout_.parents, node);
+  }
+  IdList children(NodeId node) const {
+    return GetRow(layout_.child_offsets, layout_.children, node);
+  }
+  size_t num_associated_uris(NodeId node) const {
+    return GetRow(layout_.uri_offsets, layout_.uris, node).size();
+  }
+  absl::string_view associated_uri(NodeId node, size_t index) const {
+    return GetString(GetRow(layout_.uri_offsets, layout_.uris, node)[index]);
+  }
+
+  // Returns the Node with the local devpath 'devpath', as found through
+  // NodeTopology::devpath_to_node_map.
+  std::optional<NodeId> FindNodeByDevpath(absl::string_view devpath) const;
+  // Returns the Nodes associated with 'uri', as found through
+  // NodeTopology::uri_to_associated_node_map.
+  IdList FindNodesByUri(absl::string_view uri) const;
+
+  // Creates a NodeTopology from this topology, with its structural hashes.
+  NodeTopology ToNodeTopology() const;
+
+ private:
+  // Counts heading the buffer.
+  struct Header {
+    uint32_t num_nodes = 0;
+    uint32_t num_strings = 0;
+    uint32_t string_bytes = 0;
+    uint32_t num_parents = 0;
+    uint32_t num_children = 0;
+    uint32_t num_uris = 0;
+    uint32_t num_devpath_entries = 0;
+    uint32_t num_uri_entries = 0;
+    uint32_t num_uri_nodes = 0;
+  };
+  // Word offsets of the sections of the buffer, computed from the header.
+  struct Layout {
+    size_t string_offsets;
+    size_t nodes;
+    size_t parent_offsets;
+    size_t parents;
+    size_t child_offsets;
+    size_t children;
+    size_t uri_offsets;
+    size_t uris;
+    size_t devpath_index;
+    size_t uri_index;
+    size_t uri_node_offsets;
+    size_t uri_nodes;
+    // Byte offset of the string data and size of the buffer.
+    size_t string_data;
+    size_t size;
+  };
+  // Fields of a Node entry.
+  enum NodeField {
+    kNodeName,
+    kNodeModel,
+    kNodeLocalDevpath,
+    kNodeType,
+    kNodeReplaceable,
+    kNodeFields,
+  };
+
+  static constexpr uint32_t kMagic = 0x544e4345;  // "ECNT"
+  static constexpr uint32_t kVersion = 1;
+  static constexpr size_t kHeaderWords = 11;
+
+  static Layout ComputeLayout(const Header &header);
+  static absl::StatusOr<CompactNodeTopology> ParseBuffer(
+      absl::string_view buffer, std::shared_ptr<const void> storage);
+
+  CompactNodeTopology(absl::string_view buffer, const Header &header,
+                      std::shared_ptr<const void> storage);
+
+  // Returns an error if the buffer is not consistent with its header.
+  absl::Status Validate() const;
+
+  uint32_t Word(size_t index) const {
+    return LittleEndian::Load32(buffer_.data() + index * sizeof(uint32_t));
+  }
+  uint32_t GetNodeField(NodeId node, NodeField field) const {
+    return Word(layout_.nodes + node * kNodeFields + field);
+  }
+  absl::string_view GetString(uint32_t id) const {
+    uint32_t begin = Word(layout_.string_offsets + id);
+    uint32_t end = Word(layout_.string_offsets + id + 1);
+    return buffer_.substr(layout_.string_data + begin, end - begin);
+  }
+  IdList GetRow(size_t offsets, size_t values, size_t row) const {
+    uint32_t begin = Word(offsets + row);
+    uint32_t end = Word(offsets + row + 1);
+    return IdList(buffer_.data() + (values + begin) * sizeof(uint32_t),
+                  end - begin);
+  }
+  // Returns the position of the string 'value' in the sorted list of string
+  // ids at 'index' with 'size' entries each 'stride' words apart.
+  std::optional<size_t> FindString(size_t index, size_t size, size_t stride,
+                                   absl::string_view value) const;
+
+  absl::string_view buffer_;
+  Header header_;
+  Layout layout_;
+  // Keeps the buffer alive.
+  std::shared_ptr<const void> storage_;
+};
+
+}  // namespace ecclesia
+
+#endif  // ECCLESIA_LIB_REDFISH_COMPACT_NODE_TOPOLOGY_H_
@@ -0,0 +1,216 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ecclesia/lib/redfish/compact_node_topology.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "ecclesia/lib/file/test_filesystem.h"
+#include "ecclesia/lib/redfish/devpath.h"
+#include "ecclesia/lib/redfish/node_topology.h"
+#include "ecclesia/lib/redfish/types.h"
+#include "ecclesia/lib/testing/status.h"
+
+namespace ecclesia {
+namespace {
+
+using ::testing::AnyOf;
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Optional;
+
+// Adds a Node to 'topology' attached to 'parent', if any.
+Node *AddNode(NodeTopology &topology, absl::string_view devpath,
+              absl::string_view uri, NodeType type, bool replaceable,
+              Node *parent) {
+  auto node = std::make_unique<Node>();
+  node->name = std::string(devpath.substr(devpath.rfind('/') + 1));
+  node->model = "model";
+  node->local_devpath = std::string(devpath);
+  node->type = type;
+  node->replaceable = replaceable;
+  node->associated_uris.push_back(std::string(uri));
+  topology.devpath_to_node_map[devpath] = node.get();
+  topology.uri_to_associated_node_map[uri].push_back(node.get());
+  if (parent != nullptr) {
+    topology.node_to_parents[node.get()].push_back(parent);
+    topology.node_to_children[parent].push_back(node.get());
+  }
+  Node *ptr = node.get();
+  topology.nodes.push_back(std::move(node));
+  return ptr;
+}
+
+// Creates a board with a connector holding a device, and a second device
+// associated with the URI of the board.
+NodeTopology CreateTopology() {
+  NodeTopology topology;
+  Node *board = AddNode(topology, "/phys", "/redfish/v1/Chassis/chassis",
+                        NodeType::kBoard, true, nullptr);
+  Node *connector = AddNode(topology, "/phys:connector:SLOT0",
+                            "/redfish/v1/Chassis/chassis/Slot0",
+                            NodeType::kConnector, false, board);
+  AddNode(topology, "/phys/SLOT0", "/redfish/v1/Chassis/chassis/Slot0/Device",
+          NodeType::kDevice, false, connector);
+  AddNode(topology, "/phys:device:cpld", "/redfish/v1/Chassis/chassis",
+          NodeType::kDevice, false, board);
+  return topology;
+}
+
+std::vector<std::string> GetDevpaths(const CompactNodeTopology &topology,
+                                     CompactNodeTopology::IdList ids) {
+  std::vector<std::string> devpaths;
+  for (CompactNodeTopology::NodeId id : ids) {
+    devpaths.push_back(std::string(topology.local_devpath(id)));
+  }
+  return devpaths;
+}
+
+TEST(CompactNodeTopology, PreservesNodes) {
+  CompactNodeTopology topology = CompactNodeTopology::Create(CreateTopology());
+
+  ASSERT_EQ(topology.num_nodes(), 4);
+  EXPECT_EQ(topology.name(1), "phys:connector:SLOT0");
+  EXPECT_EQ(topology.model(1), "model");
+  EXPECT_EQ(topology.local_devpath(1), "/phys:connector:SLOT0");
+  EXPECT_EQ(topology.type(1), NodeType::kConnector);
+  EXPECT_FALSE(topology.replaceable(1));
+  EXPECT_TRUE(topology.replaceable(0));
+  ASSERT_EQ(topology.num_associated_uris(1), 1);
+  EXPECT_EQ(topology.associated_uri(1, 0), "/redfish/v1/Chassis/chassis/Slot0");
+  EXPECT_THAT(GetDevpaths(topology, topology.children(0)),
+              ElementsAre("/phys:connector:SLOT0", "/phys:device:cpld"));
+  EXPECT_THAT(GetDevpaths(topology, topology.parents(2)),
+              ElementsAre("/phys:connector:SLOT0"));
+  EXPECT_THAT(GetDevpaths(topology, topology.parents(0)), IsEmpty());
+}
+
+TEST(CompactNodeTopology, FindsNodes) {
+  CompactNodeTopology topology = CompactNodeTopology::Create(CreateTopology());
+
+  EXPECT_THAT(topology.FindNodeByDevpath("/phys/SLOT0"), Optional(2));
+  EXPECT_EQ(topology.FindNodeByDevpath("/phys/SLOT1"), std::nullopt);
+  EXPECT_THAT(
+      GetDevpaths(topology,
+                  topology.FindNodesByUri("/redfish/v1/Chassis/chassis")),
+      ElementsAre("/phys", "/phys:device:cpld"));
+  EXPECT_TRUE(topology.FindNodesByUri("/redfish/v1/Systems").empty());
+}
+
+TEST(CompactNodeTopology, ConvertsToNodeTopology) {
+  NodeTopology topology =
+      CompactNodeTopology::Create(CreateTopology()).ToNodeTopology();
+
+  ASSERT_EQ(topology.nodes.size(), 4);
+  Node *board = topology.nodes[0].get();
+  EXPECT_EQ(board->local_devpath, "/phys");
+  EXPECT_EQ(topology.devpath_to_node_map.at("/phys/SLOT0"),
+            topology.nodes[2].get());
+  EXPECT_THAT(topology.uri_to_associated_node_map.at(
+                  "/redfish/v1/Chassis/chassis"),
+              ElementsAre(board, topology.nodes[3].get()));
+  EXPECT_THAT(topology.node_to_children.at(board),
+              ElementsAre(topology.nodes[1].get(), topology.nodes[3].get()));
+  EXPECT_THAT(topology.node_to_parents.at(topology.nodes[2].get()),
+              ElementsAre(topology.nodes[1].get()));
+  EXPECT_FALSE(topology.node_to_parents.contains(board));
+}
+
+TEST(CompactNodeTopology, ParsesSerializedTopology) {
+  CompactNodeTopology created = CompactNodeTopology::Create(CreateTopology());
+  absl::StatusOr<CompactNodeTopology> parsed =
+      CompactNodeTopology::Parse(std::string(created.serialized()));
+  ASSERT_THAT(parsed, IsOk());
+
+  EXPECT_EQ(parsed->serialized(), created.serialized());
+  EXPECT_THAT(parsed->FindNodeByDevpath("/phys:device:cpld"), Optional(3));
+  EXPECT_THAT(CompactNodeTopology::ParseUnowned(created.serialized()), IsOk());
+}
+
+TEST(CompactNodeTopology, ParsesEmptyTopology) {
+  CompactNodeTopology created = CompactNodeTopology::Create(NodeTopology());
+  absl::StatusOr<CompactNodeTopology> parsed =
+      CompactNodeTopology::ParseUnowned(created.serialized());
+  ASSERT_THAT(parsed, IsOk());
+  EXPECT_EQ(parsed->num_nodes(), 0);
+  EXPECT_EQ(parsed->FindNodeByDevpath("/phys"), std::nullopt);
+}
+
+TEST(CompactNodeTopology, RejectsInvalidBuffers) {
+  std::string buffer(
+      CompactNodeTopology::Create(CreateTopology()).serialized());
+
+  EXPECT_THAT(CompactNodeTopology::Parse(""), IsStatusInvalidArgument());
+  EXPECT_THAT(CompactNodeTopology::Parse(buffer.substr(0, buffer.size() - 4)),
+              IsStatusInvalidArgument());
+  std::string bad_magic = buffer;
+  bad_magic[0] = 'X';
+  EXPECT_THAT(CompactNodeTopology::Parse(bad_magic), IsStatusInvalidArgument());
+  // Corrupting any word is either harmless or detected, but never accepted
+  // with out of range offsets or ids.
+  for (size_t byte = 44; byte < buffer.size(); byte += 4) {
+    std::string corrupt = buffer;
+    corrupt[byte] = '\xff';
+    corrupt[byte + 1] = '\xff';
+    EXPECT_THAT(CompactNodeTopology::ParseUnowned(corrupt).status().code(),
+                AnyOf(absl::StatusCode::kOk,
+                      absl::StatusCode::kInvalidArgument));
+  }
+}
+
+TEST(CompactNodeTopology, LoadsFromFile) {
+  TestFilesystem fs(GetTestTempdirPath());
+  fs.CreateFile("/topology",
+                CompactNodeTopology::Create(CreateTopology()).serialized());
+
+  absl::StatusOr<CompactNodeTopology> topology =
+      CompactNodeTopology::LoadFromFile(fs.GetTruePath("/topology"));
+  ASSERT_THAT(topology, IsOk());
+  EXPECT_THAT(topology->FindNodeByDevpath("/phys:connector:SLOT0"),
+              Optional(1));
+  EXPECT_THAT(
+      CompactNodeTopology::LoadFromFile(fs.GetTruePath("/missing")).status(),
+      IsStatusNotFound());
+}
+
+TEST(CompactNodeTopology, SupportsDevpathLookups) {
+  CompactNodeTopology topology = CompactNodeTopology::Create(CreateTopology());
+
+  EXPECT_THAT(GetDevpathForUri(topology, "/redfish/v1/Chassis/chassis/Slot0"),
+              Optional(std::string("/phys:connector:SLOT0")));
+  EXPECT_EQ(GetDevpathForUri(topology, "/redfish/v1/Systems"), std::nullopt);
+  EXPECT_THAT(GetFirstUriForDevpath(topology, "/phys/SLOT0"),
+              IsOkAndHolds("/redfish/v1/Chassis/chassis/Slot0/Device"));
+  EXPECT_THAT(GetFirstUriForDevpath(topology, "/phys/SLOT1"),
+              IsStatusNotFound());
+  EXPECT_THAT(
+      GetReplaceableDevpathForDevpathAndNodeTopology("/phys/SLOT0", topology),
+      IsOkAndHolds("/phys"));
+  EXPECT_THAT(
+      GetReplaceableDevpathForDevpathAndNodeTopology("/phys/SLOT1", topology),
+      IsStatusNotFound());
+}
+
+}  // namespace
+}  // namespace ecclesia
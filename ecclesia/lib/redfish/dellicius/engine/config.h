@@ -16,9 +16,11 @@
 
 #ifndef ECCLESIA_LIB_REDFISH_DELLICIUS_ENGINE_CONFIG_H_
 #define ECCLESIA_LIB_REDFISH_DELLICIUS_ENGINE_CONFIG_H_
+#include <cstddef>
 #include <vector>
 
 #include "ecclesia/lib/file/cc_embed_interface.h"
+#include "ecclesia/lib/redfish/topology.h"
 
 namespace ecclesia {
 
@@ -37,6 +39,9 @@ struct QueryEngineConfiguration {
     bool enable_transport_metrics = false;
   };
   Flags flags;
+  // Maximum number of Redfish resources fetched concurrently while building
+  // the Node Topology for the devpath extension.
+  size_t max_concurrent_topology_fetches = kDefaultMaxConcurrentTopologyFetches;
   // available and not passed to QueryEngine through engine configuration.
   std::vector<EmbeddedFile> query_files;
   std::vector<EmbeddedFile> query_rules;
@@ -17,22 +17,31 @@
 #ifndef ECCLESIA_LIB_REDFISH_DELLICIUS_ENGINE_INTERNAL_INTERFACE_H_
 #define ECCLESIA_LIB_REDFISH_DELLICIUS_ENGINE_INTERNAL_INTERFACE_H_
 
+#include <cstddef>
 #include <memory>
+#include <optional>
+#include <string>
 #include <utility>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "ecclesia/lib/redfish/dellicius/query/query.pb.h"
 #include "ecclesia/lib/redfish/dellicius/query/query_result.pb.h"
 #include "ecclesia/lib/redfish/interface.h"
 #include "ecclesia/lib/redfish/node_topology.h"
 #include "ecclesia/lib/status/macros.h"
 #include "ecclesia/lib/time/clock.h"
+#include "google/protobuf/arena.h"
 
 namespace ecclesia {
 
+class QueryProfiler;
+
 // Maps RedPath prefix to the Expand value.
 using RedPathRedfishQueryParams =
     absl::flat_hash_map<std::string /* RedPath */, GetParams>;
@@ -43,6 +52,16 @@ using RedPathRedfishQueryParams =
 // around a query operation.
 struct QueryTracker {
   RedPathRedfishQueryParams redpaths_queried;
+  // Number of Redfish nodes resolved for each executed RedPath, summed over
+  // all context nodes the RedPath executed relative to. For a collection
+  // RedPath like '/Chassis[*]' this is the number of members iterated.
+  absl::flat_hash_map<std::string /* RedPath */, size_t> redpath_node_counts;
+  // When set, the execution of each RedPath step is profiled. Not owned.
+  QueryProfiler *profiler = nullptr;
+  // Once the deadline passes, the query stops issuing Redfish requests and
+  // returns the datasets gathered so far. Subqueries left unfinished have
+  // their status set to DEADLINE_EXCEEDED.
+  absl::Time deadline = absl::InfiniteFuture();
 };
 
 // Provides an interface for normalizing a redfish response into SubqueryDataSet
@@ -67,8 +86,17 @@ class Normalizer {
   absl::StatusOr<SubqueryDataSet> Normalize(
       const RedfishObject &redfish_object,
       const DelliciusQuery::Subquery &query) {
-    if (impl_chain_.empty()) return absl::NotFoundError("No normalizers added");
     SubqueryDataSet data_set;
+    ECCLESIA_RETURN_IF_ERROR(Normalize(redfish_object, query, data_set));
+    return data_set;
+  }
+
+  // Normalizes into the given 'data_set' in place. This lets callers build
+  // datasets directly in messages owned by the query result or its arena.
+  absl::Status Normalize(const RedfishObject &redfish_object,
+                         const DelliciusQuery::Subquery &query,
+                         SubqueryDataSet &data_set) {
+    if (impl_chain_.empty()) return absl::NotFoundError("No normalizers added");
     for (const auto &impl : impl_chain_) {
       ECCLESIA_RETURN_IF_ERROR(
           impl->Normalize(redfish_object, query, data_set));
@@ -77,7 +105,7 @@ class Normalizer {
     if (data_set.properties().empty() && !data_set.has_devpath()) {
       return absl::NotFoundError("Resulting dataset is empty");
     }
-    return data_set;
+    return absl::OkStatus();
   }
 
   void AddNormilizer(std::unique_ptr<ImplInterface> impl) {
@@ -97,6 +125,24 @@ class Normalizer {
   std::vector<std::unique_ptr<ImplInterface>> impl_chain_;
 };
 
+// Describes a SubqueryDataSet streamed during query execution.
+// Datasets of a subquery linked to a root subquery are produced relative to a
+// dataset of that root subquery, which is identified by 'parent_subquery_id'
+// and 'parent_dataset_id'. A parent dataset is always streamed before any of
+// its child datasets.
+struct SubqueryDataSetInfo {
+  absl::string_view subquery_id;
+  // Identifier of the dataset, unique within a single query execution.
+  size_t dataset_id = 0;
+  // Not set for datasets of root subqueries.
+  absl::string_view parent_subquery_id;
+  std::optional<size_t> parent_dataset_id;
+};
+
+// Invoked for each normalized SubqueryDataSet as soon as it is produced.
+using SubqueryDataSetCallback = absl::FunctionRef<void(
+    const SubqueryDataSetInfo &info, SubqueryDataSet data_set)>;
+
 // Provides an interface for executing a Dellicius Query plan.
 class QueryPlannerInterface {
  public:
@@ -107,6 +153,21 @@ class QueryPlannerInterface {
   virtual DelliciusQueryResult Run(const RedfishVariant &variant,
                                    const Clock &clock,
                                    QueryTracker *tracker) = 0;
+
+  // Executes query plan using RedfishVariant as root and streams each
+  // normalized dataset to 'callback' instead of accumulating it in the result.
+  // The returned result carries the query status and subquery statuses but no
+  // datasets.
+  virtual DelliciusQueryResult Run(const RedfishVariant &variant,
+                                   const Clock &clock, QueryTracker *tracker,
+                                   SubqueryDataSetCallback callback) = 0;
+
+  // Executes query plan using RedfishVariant as root and builds the result on
+  // the given 'arena'. Normalized datasets are written directly into
+  // arena-owned messages. The returned result is owned by 'arena'.
+  virtual DelliciusQueryResult *Run(const RedfishVariant &variant,
+                                    const Clock &clock, QueryTracker *tracker,
+                                    google::protobuf::Arena &arena) = 0;
 };
 
 }  // namespace ecclesia
@@ -103,7 +103,6 @@ absl::Status NormalizerImplDefault::Normalize(
       UpdateSubqueryFromFieldOptions("devpath", data_set_local, subquery_local);
 
   for (const auto &property_requirement : subquery_local.properties()) {
-    SubqueryDataSet::Property property_out;
     absl::string_view property_name = property_requirement.property();
 
     // A property requirement can specify nested nodes like
@@ -118,6 +117,9 @@ absl::Status NormalizerImplDefault::Normalize(
       continue;
     }
 
+    // Populate the property in place so that it is allocated on the same
+    // arena as the dataset, if any.
+    SubqueryDataSet::Property &property_out = *data_set_local.add_properties();
     using RedfishProperty = DelliciusQuery::Subquery::RedfishProperty;
     switch (property_requirement.type()) {
       case RedfishProperty::STRING: {
@@ -164,6 +166,7 @@ absl::Status NormalizerImplDefault::Normalize(
       }
     }
     if (!property_out.value_case()) {
+      data_set_local.mutable_properties()->RemoveLast();
       continue;
     }
 
@@ -182,6 +185,7 @@ absl::Status NormalizerImplDefault::Normalize(
       } else if (name == oem_location) {
         data_set_local.set_devpath(property_out.string_value());
       }
+      data_set_local.mutable_properties()->RemoveLast();
       continue;
     }
 
@@ -194,7 +198,6 @@ absl::Status NormalizerImplDefault::Normalize(
       absl::StrReplaceAll({{"\\.", "."}}, &prop_name);
       property_out.set_name(prop_name);
     }
-    *data_set_local.add_properties() = std::move(property_out);
   }
   return absl::OkStatus();
 }
@@ -209,7 +212,7 @@ absl::Status NormalizerImplAddDevpath::Normalize(
 
   // Derive devpath from Node Topology (URI to local devpath map).
   std::optional<std::string> devpath =
-      GetDevpathForObjectAndNodeTopology(redfish_object, topology_);
+      GetDevpathForObjectAndNodeTopology(redfish_object, index_);
   if (devpath.has_value()) {
     data_set.set_devpath(*devpath);
   }
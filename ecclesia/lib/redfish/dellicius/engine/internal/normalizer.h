@@ -26,6 +26,7 @@
 #include "ecclesia/lib/redfish/dellicius/query/query.pb.h"
 #include "ecclesia/lib/redfish/dellicius/query/query_result.pb.h"
 #include "ecclesia/lib/redfish/dellicius/utils/id_assigner.h"
+#include "ecclesia/lib/redfish/devpath.h"
 #include "ecclesia/lib/redfish/interface.h"
 #include "ecclesia/lib/redfish/node_topology.h"
 
@@ -44,7 +45,7 @@ class NormalizerImplDefault final : public Normalizer::ImplInterface {
 class NormalizerImplAddDevpath final : public Normalizer::ImplInterface {
  public:
   NormalizerImplAddDevpath(NodeTopology node_topology)
-      : topology_(std::move(node_topology)) {}
+      : topology_(std::move(node_topology)), index_(topology_) {}
 
  protected:
   absl::Status Normalize(const RedfishObject &redfish_object,
@@ -57,6 +58,8 @@ class NormalizerImplAddDevpath final : public Normalizer::ImplInterface {
 
  private:
   NodeTopology topology_;
+  // Devpath lookups over 'topology_', built once per topology.
+  DevpathIndex index_;
 };
 
 // Adds machine level barepath to subquery output.
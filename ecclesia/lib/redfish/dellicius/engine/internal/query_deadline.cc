@@ -0,0 +1,102 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ecclesia/lib/redfish/dellicius/engine/internal/query_deadline.h"
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "ecclesia/lib/redfish/transport/interface.h"
+#include "ecclesia/lib/status/macros.h"
+#include "ecclesia/lib/time/clock.h"
+
+namespace ecclesia {
+
+namespace {
+
+// Innermost deadline in scope on the current thread.
+thread_local QueryDeadlineScope *active_deadline_scope = nullptr;
+
+}  // namespace
+
+QueryDeadlineScope::QueryDeadlineScope(const Clock &clock, absl::Time deadline)
+    : clock_(clock), deadline_(deadline) {
+  if (deadline_ == absl::InfiniteFuture()) return;
+  active_ = true;
+  previous_scope_ = active_deadline_scope;
+  if (previous_scope_ != nullptr) {
+    deadline_ = std::min(deadline_, previous_scope_->deadline_);
+  }
+  active_deadline_scope = this;
+}
+
+QueryDeadlineScope::~QueryDeadlineScope() {
+  if (active_) active_deadline_scope = previous_scope_;
+}
+
+absl::Status QueryDeadlineScope::Check() {
+  if (active_deadline_scope == nullptr) return absl::OkStatus();
+  const QueryDeadlineScope &scope = *active_deadline_scope;
+  absl::Time now = scope.clock_.Now();
+  if (now < scope.deadline_) return absl::OkStatus();
+  return absl::DeadlineExceededError(
+      absl::StrCat("Query deadline exceeded by ",
+                   absl::FormatDuration(now - scope.deadline_)));
+}
+
+absl::StatusOr<RedfishTransport::Result> DeadlineRedfishTransport::Get(
+    absl::string_view path) {
+  ECCLESIA_RETURN_IF_ERROR(QueryDeadlineScope::Check());
+  return base_transport_->Get(path);
+}
+
+absl::StatusOr<RedfishTransport::Result> DeadlineRedfishTransport::Post(
+    absl::string_view path, absl::string_view data) {
+  ECCLESIA_RETURN_IF_ERROR(QueryDeadlineScope::Check());
+  return base_transport_->Post(path, data);
+}
+
+absl::StatusOr<RedfishTransport::Result> DeadlineRedfishTransport::Patch(
+    absl::string_view path, absl::string_view data) {
+  ECCLESIA_RETURN_IF_ERROR(QueryDeadlineScope::Check());
+  return base_transport_->Patch(path, data);
+}
+
+absl::StatusOr<RedfishTransport::Result> DeadlineRedfishTransport::Delete(
+    absl::string_view path, absl::string_view data) {
+  ECCLESIA_RETURN_IF_ERROR(QueryDeadlineScope::Check());
+  return base_transport_->Delete(path, data);
+}
+
+std::function<void()> DeadlineRedfishTransport::BindToCallingThread(
+    std::function<void()> task) {
+  task = base_transport_->BindToCallingThread(std::move(task));
+  if (active_deadline_scope == nullptr) return task;
+  return [scope = active_deadline_scope, task = std::move(task)]() {
+    QueryDeadlineScope *previous_scope =
+        std::exchange(active_deadline_scope, scope);
+    task();
+    active_deadline_scope = previous_scope;
+  };
+}
+
+}  // namespace ecclesia
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ECCLESIA_LIB_REDFISH_DELLICIUS_ENGINE_INTERNAL_QUERY_DEADLINE_H_
+#define ECCLESIA_LIB_REDFISH_DELLICIUS_ENGINE_INTERNAL_QUERY_DEADLINE_H_
+
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "ecclesia/lib/redfish/transport/interface.h"
+#include "ecclesia/lib/time/clock.h"
+
+namespace ecclesia {
+
+// Bounds the query execution on the calling thread by a deadline for as long
+// as it is in scope. The query planner checks the deadline before each Redfish
+// request and skips the remaining work once it has passed.
+//
+// Nested scopes never extend the deadline of an enclosing scope. An infinite
+// deadline makes the scope a no-op.
+class QueryDeadlineScope {
+ public:
+  QueryDeadlineScope(const Clock &clock, absl::Time deadline);
+  ~QueryDeadlineScope();
+
+  QueryDeadlineScope(const QueryDeadlineScope &) = delete;
+  QueryDeadlineScope &operator=(const QueryDeadlineScope &) = delete;
+
+  // Returns DeadlineExceededError if the deadline in scope on the calling
+  // thread has passed, and OkStatus otherwise.
+  static absl::Status Check();
+
+ private:
+  const Clock &clock_;
+  absl::Time deadline_;
+  bool active_ = false;
+  QueryDeadlineScope *previous_scope_ = nullptr;
+};
+
+// Decorates RedfishTransport to fail requests issued after the query deadline
+// in scope on the calling thread has passed, without sending them. This bounds
+// requests the planner does not issue directly, such as those sent while
+// iterating an expanded collection or fetching its pages in the background.
+// Requests already in flight are bounded by the timeout of the underlying
+// transport.
+class DeadlineRedfishTransport : public RedfishTransport {
+ public:
+  explicit DeadlineRedfishTransport(std::unique_ptr<RedfishTransport> base)
+      : base_transport_(std::move(base)) {}
+
+  absl::string_view GetRootUri() override {
+    return base_transport_->GetRootUri();
+  }
+  absl::StatusOr<Result> Get(absl::string_view path) override;
+  absl::StatusOr<Result> Post(absl::string_view path,
+                              absl::string_view data) override;
+  absl::StatusOr<Result> Patch(absl::string_view path,
+                               absl::string_view data) override;
+  absl::StatusOr<Result> Delete(absl::string_view path,
+                                absl::string_view data) override;
+  // Bounds the requests of 'task' by the deadline in scope on the calling
+  // thread.
+  std::function<void()> BindToCallingThread(
+      std::function<void()> task) override;
+
+ private:
+  std::unique_ptr<RedfishTransport> base_transport_;
+};
+
+}  // namespace ecclesia
+
+#endif  // ECCLESIA_LIB_REDFISH_DELLICIUS_ENGINE_INTERNAL_QUERY_DEADLINE_H_
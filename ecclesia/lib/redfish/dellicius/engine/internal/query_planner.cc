@@ -16,6 +16,7 @@
 
 #include "ecclesia/lib/redfish/dellicius/engine/internal/query_planner.h"
 
+#include <array>
 #include <cstddef>
 #include <iterator>
 #include <memory>
@@ -28,8 +29,10 @@
 #include "google/rpc/code.pb.h"
 #include "google/rpc/status.pb.h"
 #include "absl/container/btree_map.h"
+#include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -37,15 +40,23 @@
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/str_replace.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "ecclesia/lib/redfish/dellicius/engine/compiled_query.pb.h"
 #include "ecclesia/lib/redfish/dellicius/engine/internal/interface.h"
+#include "ecclesia/lib/redfish/dellicius/engine/internal/query_deadline.h"
+#include "ecclesia/lib/redfish/dellicius/engine/internal/query_profiler.h"
 #include "ecclesia/lib/redfish/dellicius/query/query.pb.h"
 #include "ecclesia/lib/redfish/dellicius/query/query_result.pb.h"
 #include "ecclesia/lib/redfish/dellicius/utils/path_util.h"
 #include "ecclesia/lib/redfish/interface.h"
 #include "ecclesia/lib/status/macros.h"
+#include "ecclesia/lib/time/clock.h"
+#include "google/protobuf/arena.h"
+#include "google/protobuf/map.h"
 #include "re2/re2.h"
 
 namespace ecclesia {
@@ -63,6 +74,14 @@ constexpr LazyRE2 kLocationStepRegex = {
 // All RedPath expressions execute relative to service root identified by '/'.
 constexpr absl::string_view kServiceRootNode = "/";
 
+// Properties selected in every $select query parameter: identifiers, the
+// members of collections and the properties normalizers read to derive
+// devpaths and stable ids.
+constexpr std::array<absl::string_view, 11> kSelectRequiredProperties = {
+    "@odata.id", "@odata.type", "Id", "Name", "Members", "Members@odata.count",
+    "Members@odata.nextLink", "Links", "Location", "PhysicalLocation",
+    "RelatedItem"};
+
 // Known predicate expressions.
 constexpr absl::string_view kPredicateSelectAll = "*";
 constexpr absl::string_view kPredicateSelectLastIndex = "last()";
@@ -74,11 +93,11 @@ constexpr absl::string_view kLogicalOperatorOr = "or";
 constexpr std::array<const char *, 6> kRelationsOperators = {
     "<", ">", "!=", ">=", "<=", "="};
 
-using RedPathStep = std::pair<std::string, std::string>;
 using RedPathIterator =
     std::vector<std::pair<std::string, std::string>>::const_iterator;
 
-// Creates RedPathStep objects from the given RedPath string.
+}  // namespace
+
 absl::StatusOr<std::vector<RedPathStep>> RedPathToSteps(
     absl::string_view redpath) {
   std::vector<RedPathStep> steps;
@@ -104,6 +123,8 @@ absl::StatusOr<std::vector<RedPathStep>> RedPathToSteps(
   return steps;
 }
 
+namespace {
+
 // Returns true if child RedPath is in expand path of parent RedPath.
 bool IsInExpandPath(absl::string_view child_redpath,
                     absl::string_view parent_redpath,
@@ -376,6 +397,132 @@ bool ApplyPredicateRule(const RedfishObject &redfish_object, size_t node_index,
   return is_filter_success;
 }
 
+}  // namespace
+
+std::optional<std::string> PredicateToFilterExpression(
+    absl::string_view predicate) {
+  std::vector<std::string> terms;
+  absl::string_view logical_operation;
+  bool expect_operand = true;
+  for (absl::string_view expr :
+       SplitExprByDelimiterWithEscape(predicate, " ", '\\')) {
+    if (expr == kLogicalOperatorAnd || expr == kLogicalOperatorOr) {
+      if (expect_operand ||
+          (!logical_operation.empty() && logical_operation != expr)) {
+        return std::nullopt;
+      }
+      logical_operation = expr;
+      terms.push_back(std::string(expr));
+      expect_operand = true;
+      continue;
+    }
+    std::string node_name, op, test_value;
+    if (!expect_operand ||
+        !RE2::FullMatch(expr, *kPredicateRegexRelationalOperator, &node_name,
+                        &op, &test_value) ||
+        node_name.find_first_of("#@\\") != std::string::npos) {
+      return std::nullopt;
+    }
+    expect_operand = false;
+
+    absl::string_view filter_op;
+    if (op == "=") filter_op = "eq";
+    if (op == "!=") filter_op = "ne";
+    if (op == ">") filter_op = "gt";
+    if (op == ">=") filter_op = "ge";
+    if (op == "<") filter_op = "lt";
+    if (op == "<=") filter_op = "le";
+
+    double number;
+    if (absl::SimpleAtod(test_value, &number)) return std::nullopt;
+    std::string filter_value;
+    if (test_value == kBinaryOperandTrue || test_value == kBinaryOperandFalse ||
+        test_value == "null") {
+      filter_value = test_value;
+    } else if (op == "=" || op == "!=") {
+      absl::StrReplaceAll({{"\\", ""}}, &test_value);
+      filter_value = absl::StrCat(
+          "'", absl::StrReplaceAll(test_value, {{"'", "''"}}), "'");
+    } else {
+      return std::nullopt;
+    }
+    terms.push_back(absl::StrCat(absl::StrReplaceAll(node_name, {{".", "/"}}),
+                                 " ", filter_op, " ", filter_value));
+  }
+  if (expect_operand) return std::nullopt;
+  return absl::StrJoin(terms, " ");
+}
+
+namespace {
+
+// Dataset of a parent subquery that a child subquery dataset is linked to.
+struct ParentDataSet {
+  absl::string_view subquery_id;
+  size_t dataset_id = 0;
+};
+
+// Assigns identifiers to normalized datasets and either hands them to a
+// SubqueryDataSetCallback as soon as they are produced or builds them in place
+// in a DelliciusQueryResult.
+class DataSetEmitter {
+ public:
+  explicit DataSetEmitter(SubqueryDataSetCallback callback)
+      : callback_(callback) {}
+
+  // Datasets of root subqueries are added to 'result'. Datasets of child
+  // subqueries are added to the dataset of the parent subquery.
+  explicit DataSetEmitter(DelliciusQueryResult &result) : result_(&result) {}
+
+  // Populates a dataset using 'populate' and emits it if populated
+  // successfully. Returns the identifier assigned to the dataset.
+  absl::StatusOr<size_t> Emit(
+      absl::string_view subquery_id,
+      const std::optional<ParentDataSet> &parent_dataset,
+      absl::FunctionRef<absl::Status(SubqueryDataSet &)> populate) {
+    if (result_ == nullptr) {
+      SubqueryDataSet data_set;
+      ECCLESIA_RETURN_IF_ERROR(populate(data_set));
+      SubqueryDataSetInfo info{.subquery_id = subquery_id,
+                               .dataset_id = next_dataset_id_++};
+      if (parent_dataset.has_value()) {
+        info.parent_subquery_id = parent_dataset->subquery_id;
+        info.parent_dataset_id = parent_dataset->dataset_id;
+      }
+      (*callback_)(info, std::move(data_set));
+      return info.dataset_id;
+    }
+
+    SubqueryOutput *subquery_output = nullptr;
+    if (!parent_dataset.has_value()) {
+      subquery_output =
+          &(*result_->mutable_subquery_output_by_id())[std::string(
+              subquery_id)];
+    } else if (auto iter = id_to_dataset_.find(parent_dataset->dataset_id);
+               iter != id_to_dataset_.end()) {
+      subquery_output = &(*iter->second->mutable_child_subquery_output_by_id())
+          [std::string(subquery_id)];
+    } else {
+      return absl::InternalError("Cannot find parent subquery dataset");
+    }
+    // Build the dataset in place so that it is allocated on the arena of the
+    // result, if any.
+    SubqueryDataSet *data_set = subquery_output->add_data_sets();
+    if (absl::Status status = populate(*data_set); !status.ok()) {
+      subquery_output->mutable_data_sets()->RemoveLast();
+      return status;
+    }
+    size_t dataset_id = next_dataset_id_++;
+    id_to_dataset_[dataset_id] = data_set;
+    return dataset_id;
+  }
+
+ private:
+  std::optional<SubqueryDataSetCallback> callback_;
+  DelliciusQueryResult *result_ = nullptr;
+  absl::flat_hash_map<size_t, SubqueryDataSet *> id_to_dataset_;
+  size_t next_dataset_id_ = 0;
+};
+
 // Provides a subquery level abstraction to traverse RedPath step expressions
 // and apply predicate expression rules to refine a given node-set.
 class SubqueryHandle final {
@@ -388,12 +535,13 @@ class SubqueryHandle final {
         redpath_steps_(std::move(redpath_steps)) {}
 
   // Parses given 'redfish_object' for properties requested in the subquery
-  // and prepares dataset to be appended in 'result'.
-  // When subqueries are linked, the normalized dataset is added to the given
-  // 'parent_subquery_dataset' instead of the 'result'
-  absl::StatusOr<SubqueryDataSet *> Normalize(
-      const RedfishObject &redfish_object, DelliciusQueryResult &result,
-      SubqueryDataSet *parent_subquery_dataset);
+  // and emits the normalized dataset through 'emitter'.
+  // When subqueries are linked, the normalized dataset is linked to the given
+  // 'parent_dataset'.
+  // Returns the identifier of the emitted dataset.
+  absl::StatusOr<size_t> Normalize(
+      const RedfishObject &redfish_object, DataSetEmitter &emitter,
+      const std::optional<ParentDataSet> &parent_dataset);
 
   void AddChildSubqueryHandle(SubqueryHandle *child_subquery_handle) {
     child_subquery_handles_.push_back(child_subquery_handle);
@@ -408,10 +556,6 @@ class SubqueryHandle final {
 
   bool HasChildSubqueries() const { return !child_subquery_handles_.empty(); }
 
-  void SetParentSubqueryDataSet(SubqueryDataSet *parent_subquery_data_set) {
-    parent_subquery_data_set_ = parent_subquery_data_set;
-  }
-
   RedPathIterator GetRedPathIterator() { return redpath_steps_.begin(); }
 
   bool IsEndOfRedPath(const RedPathIterator &iter) {
@@ -421,7 +565,9 @@ class SubqueryHandle final {
 
   std::string RedPathToString() const { return subquery_.redpath(); }
 
-  std::string GetSubqueryId() const { return subquery_.subquery_id(); }
+  const std::string &GetSubqueryId() const { return subquery_.subquery_id(); }
+
+  const DelliciusQuery::Subquery &GetSubquery() const { return subquery_; }
 
  private:
   DelliciusQuery::Subquery subquery_;
@@ -431,8 +577,6 @@ class SubqueryHandle final {
   // Eg. /Chassis[*]/Sensors[1] - {(Chassis, *), (Sensors, 1)}
   std::vector<std::pair<std::string, std::string>> redpath_steps_;
   std::vector<SubqueryHandle *> child_subquery_handles_;
-  // Dataset of parent subquery to link the current subquery output with.
-  SubqueryDataSet *parent_subquery_data_set_ = nullptr;
 };
 
 struct RedPathContext {
@@ -440,7 +584,7 @@ struct RedPathContext {
   SubqueryHandle *subquery_handle;
   // Dataset of the root RedPath to which the current RedPath dataset is
   // linked.
-  SubqueryDataSet *root_redpath_dataset = nullptr;
+  std::optional<ParentDataSet> root_redpath_dataset;
   // Iterator configured to iterate over RedPath steps - NodeName and
   // Predicate pair
   RedPathIterator redpath_steps_iterator;
@@ -475,7 +619,22 @@ class QueryPlanner final : public QueryPlannerInterface {
   DelliciusQueryResult Run(const RedfishVariant &variant, const Clock &clock,
                            QueryTracker *tracker) override;
 
+  DelliciusQueryResult Run(const RedfishVariant &variant, const Clock &clock,
+                           QueryTracker *tracker,
+                           SubqueryDataSetCallback callback) override;
+
+  DelliciusQueryResult *Run(const RedfishVariant &variant, const Clock &clock,
+                            QueryTracker *tracker,
+                            google::protobuf::Arena &arena) override;
+
  private:
+  // Executes the query plan relative to 'variant'. Normalized datasets are
+  // handed to 'emitter' and query and subquery statuses are set in 'result'.
+  // The deadline in 'tracker', if any, is measured against 'clock'.
+  void RunWithEmitter(const RedfishVariant &variant, const Clock &clock,
+                      QueryTracker *tracker, DataSetEmitter &emitter,
+                      DelliciusQueryResult &result);
+
   const std::string plan_id_;
   // Collection of all SubqueryHandle instances including both root and child
   // handles.
@@ -491,13 +650,27 @@ class SubqueryHandleFactory {
  public:
   static absl::StatusOr<SubqueryHandleCollection> CreateSubqueryHandles(
       const DelliciusQuery &query, Normalizer *normalizer) {
-    return std::move(SubqueryHandleFactory(query, normalizer))
+    return std::move(SubqueryHandleFactory(query, normalizer, nullptr))
+        .GetSubqueryHandles();
+  }
+
+  // Creates SubqueryHandles using RedPath steps split at build time.
+  static absl::StatusOr<SubqueryHandleCollection> CreateSubqueryHandles(
+      const CompiledQuery &compiled_query, Normalizer *normalizer) {
+    return std::move(SubqueryHandleFactory(compiled_query.query(), normalizer,
+                                           &compiled_query.subquery_redpaths()))
         .GetSubqueryHandles();
   }
 
  private:
-  SubqueryHandleFactory(const DelliciusQuery &query, Normalizer *normalizer)
-      : query_(query), normalizer_(normalizer) {
+  using CompiledRedPaths =
+      google::protobuf::Map<std::string, CompiledQuery::CompiledRedPath>;
+
+  SubqueryHandleFactory(const DelliciusQuery &query, Normalizer *normalizer,
+                        const CompiledRedPaths *compiled_redpaths)
+      : query_(query),
+        normalizer_(normalizer),
+        compiled_redpaths_(compiled_redpaths) {
     for (const auto &subquery : query.subquery()) {
       id_to_subquery_[subquery.subquery_id()] = subquery;
     }
@@ -519,11 +692,18 @@ class SubqueryHandleFactory {
       absl::flat_hash_set<std::string> &subquery_id_chain,
       SubqueryHandle *child_subquery_handle);
 
+  // Returns the RedPath steps of 'subquery', splitting its RedPath unless the
+  // steps were split at build time.
+  absl::StatusOr<std::vector<RedPathStep>> GetRedPathSteps(
+      const DelliciusQuery::Subquery &subquery) const;
+
   const DelliciusQuery &query_;
   absl::flat_hash_map<std::string, std::unique_ptr<SubqueryHandle>>
       id_to_subquery_handle_;
   absl::flat_hash_map<std::string, DelliciusQuery::Subquery> id_to_subquery_;
   Normalizer *normalizer_;
+  // RedPath steps of each subquery split at build time, if available.
+  const CompiledRedPaths *compiled_redpaths_;
 };
 
 // Executes the next predicate expression in each RedPath and returns those
@@ -537,6 +717,9 @@ std::vector<RedPathContext> ExecutePredicateFromEachSubquery(
     if (!redpath_ctx.subquery_handle) {
       continue;
     }
+    if (!redpath_ctx.redpath_steps_iterator->second.empty()) {
+      QueryProfiler::RecordPredicateEvaluation();
+    }
     if (!ApplyPredicateRule(redfish_object, node_index, node_set_size,
                             redpath_ctx.redpath_steps_iterator)) {
       continue;
@@ -554,7 +737,7 @@ std::vector<RedPathContext> ExecutePredicateFromEachSubquery(
 std::vector<RedPathContext> PopulateResultOrContinueQuery(
     const RedfishObject &redfish_object,
     const std::vector<RedPathContext> &redpath_ctx_multiple,
-    DelliciusQueryResult &result) {
+    DataSetEmitter &emitter) {
   std::vector<RedPathContext> redpath_ctx_unresolved;
   if (redpath_ctx_multiple.empty()) return redpath_ctx_unresolved;
   for (const auto &redpath_ctx : redpath_ctx_multiple) {
@@ -566,16 +749,16 @@ std::vector<RedPathContext> PopulateResultOrContinueQuery(
     // result for requested properties.
     if (is_end_of_redpath && !subquery_handle->HasChildSubqueries()) {
       subquery_handle
-          ->Normalize(redfish_object, result, redpath_ctx.root_redpath_dataset)
+          ->Normalize(redfish_object, emitter, redpath_ctx.root_redpath_dataset)
           .IgnoreError();
       continue;
     }
     // If we have reached the end of RedPath expression but there are child
     // subqueries linked.
     if (is_end_of_redpath) {
-      absl::StatusOr<SubqueryDataSet *> last_normalized_dataset;
+      absl::StatusOr<size_t> last_normalized_dataset;
       if (last_normalized_dataset = subquery_handle->Normalize(
-              redfish_object, result, redpath_ctx.root_redpath_dataset);
+              redfish_object, emitter, redpath_ctx.root_redpath_dataset);
           !last_normalized_dataset.ok()) {
         continue;
       }
@@ -585,7 +768,9 @@ std::vector<RedPathContext> PopulateResultOrContinueQuery(
            subquery_handle->GetChildSubqueryHandles()) {
         if (!child_subquery_handle) continue;
         redpath_ctx_unresolved.push_back(
-            {child_subquery_handle, *last_normalized_dataset,
+            {child_subquery_handle,
+             ParentDataSet{subquery_handle->GetSubqueryId(),
+                           *last_normalized_dataset},
              child_subquery_handle->GetRedPathIterator()});
       }
       continue;
@@ -609,6 +794,100 @@ std::vector<RedPathContext> FilterRedPathWithNoPredicate(
   return redpath_ctx_no_predicate;
 }
 
+// Returns true if 'status' of a request carrying $filter shows the service
+// rejected the filter, rather than failing to serve the resource itself.
+bool IsFilterRejected(const absl::Status &status) {
+  return status.code() == absl::StatusCode::kInvalidArgument ||
+         status.code() == absl::StatusCode::kUnimplemented;
+}
+
+// Returns the $filter expression equivalent to the next predicate of every
+// RedPath in 'redpath_ctx_multiple', or nullopt if the RedPaths do not share a
+// predicate that has an equivalent.
+std::optional<std::string> GetFilterForRedPaths(
+    const std::vector<RedPathContext> &redpath_ctx_multiple) {
+  if (redpath_ctx_multiple.empty()) return std::nullopt;
+  absl::string_view predicate =
+      redpath_ctx_multiple.front().redpath_steps_iterator->second;
+  for (const RedPathContext &redpath_ctx : redpath_ctx_multiple) {
+    if (redpath_ctx.redpath_steps_iterator->second != predicate) {
+      return std::nullopt;
+    }
+  }
+  return PredicateToFilterExpression(predicate);
+}
+
+// Adds the top level node of 'property' to 'properties', without any array
+// index since $select names whole properties.
+// Eg. 'Thresholds.UpperCritical.Reading' - 'Thresholds'
+//     'Actions[0].Target' - 'Actions'
+void AddTopLevelNodeName(absl::string_view property,
+                         absl::btree_set<std::string> &properties) {
+  std::vector<std::string> node_names = SplitNodeNameForNestedNodes(property);
+  if (node_names.empty()) return;
+  if (std::optional<std::pair<std::string, int>> array_node =
+          SplitNodeNameIfArrayType(node_names.front());
+      array_node.has_value()) {
+    properties.insert(std::move(array_node->first));
+    return;
+  }
+  properties.insert(std::move(node_names.front()));
+}
+
+// Adds the properties tested by 'predicate' to 'properties'.
+void AddPredicateProperties(absl::string_view predicate,
+                            absl::btree_set<std::string> &properties) {
+  for (absl::string_view expr :
+       SplitExprByDelimiterWithEscape(predicate, " ", '\\')) {
+    size_t index;
+    if (expr == kLogicalOperatorAnd || expr == kLogicalOperatorOr ||
+        expr == kPredicateSelectAll || expr == kPredicateSelectLastIndex ||
+        absl::SimpleAtoi(expr, &index)) {
+      continue;
+    }
+    std::string node_name, op, test_value;
+    if (RE2::FullMatch(expr, *kPredicateRegexRelationalOperator, &node_name,
+                       &op, &test_value)) {
+      AddTopLevelNodeName(node_name, properties);
+    } else if (absl::StartsWith(expr, "!")) {
+      AddTopLevelNodeName(expr.substr(1), properties);
+    } else {
+      AddTopLevelNodeName(expr, properties);
+    }
+  }
+}
+
+// Returns the properties the query reads from the Redfish resources fetched
+// for the next step of each RedPath in 'redpath_ctx_multiple': properties
+// tested by predicates, node names of following steps, properties normalized
+// by subqueries ending at the step and node names of their child subqueries.
+// Returns nullopt if a child subquery executes relative to the resource itself.
+std::optional<std::vector<std::string>> GetSelectForRedPaths(
+    const std::vector<RedPathContext> &redpath_ctx_multiple) {
+  absl::btree_set<std::string> properties(kSelectRequiredProperties.begin(),
+                                          kSelectRequiredProperties.end());
+  for (const RedPathContext &redpath_ctx : redpath_ctx_multiple) {
+    SubqueryHandle *subquery_handle = redpath_ctx.subquery_handle;
+    if (subquery_handle == nullptr) continue;
+    AddPredicateProperties(redpath_ctx.redpath_steps_iterator->second,
+                           properties);
+    if (!subquery_handle->IsEndOfRedPath(redpath_ctx.redpath_steps_iterator)) {
+      properties.insert(std::next(redpath_ctx.redpath_steps_iterator)->first);
+      continue;
+    }
+    for (const DelliciusQuery::Subquery::RedfishProperty &property :
+         subquery_handle->GetSubquery().properties()) {
+      AddTopLevelNodeName(property.property(), properties);
+    }
+    for (SubqueryHandle *child : subquery_handle->GetChildSubqueryHandles()) {
+      const std::string &child_node_name = child->GetRedPathIterator()->first;
+      if (child_node_name.empty()) return std::nullopt;
+      properties.insert(child_node_name);
+    }
+  }
+  return std::vector<std::string>(properties.begin(), properties.end());
+}
+
 using NodeNameToRedPathContexts =
     absl::flat_hash_map<std::string, std::vector<RedPathContext>>;
 
@@ -635,7 +914,7 @@ NodeNameToRedPathContexts DeduplicateNodeNamesAcrossSubqueries(
 ContextNode ExecutePredicateExpression(const int node_index,
                                        const size_t node_count,
                                        ContextNode context_node,
-                                       DelliciusQueryResult &result) {
+                                       DataSetEmitter &emitter) {
   // At this step only those RedPath contexts will be returned whose filter
   // criteria is met by the RedfishObject.
   std::vector<RedPathContext> redpath_ctx_filtered =
@@ -644,7 +923,7 @@ ContextNode ExecutePredicateExpression(const int node_index,
                                        node_count);
   if (redpath_ctx_filtered.empty()) return context_node;
   redpath_ctx_filtered = PopulateResultOrContinueQuery(
-      *context_node.redfish_object, redpath_ctx_filtered, result);
+      *context_node.redfish_object, redpath_ctx_filtered, emitter);
   // Prepare the RedfishObject to serve as ContextNode for remaining
   // unresolved RedPath expressions.
   context_node.redpath_ctx_multiple = std::move(redpath_ctx_filtered);
@@ -690,7 +969,7 @@ void PopulateSubqueryErrorStatus(
 void ExecuteRedPathStepFromEachSubquery(
     const RedPathRedfishQueryParams &redpath_to_query_params,
     ContextNode &context_node, DelliciusQueryResult &result,
-    QueryTracker *tracker) {
+    DataSetEmitter &emitter, QueryTracker *tracker) {
   // Return if the Context Node does not contain a valid RedfishObject.
   if (!context_node.redfish_object) {
     return;
@@ -713,6 +992,7 @@ void ExecuteRedPathStepFromEachSubquery(
   // Set of Nodes that are obtained by executing RedPath expressions relative
   // to Redfish Object encapsulated in given 'context_node'.
   std::vector<ContextNode> context_nodes;
+  QueryProfiler *profiler = tracker ? tracker->profiler : nullptr;
 
   // We will query each NodeName in node_name_to_redpath_contexts map created
   // above and apply predicate expressions from each RedPath to filter the
@@ -721,21 +1001,62 @@ void ExecuteRedPathStepFromEachSubquery(
        node_name_to_redpath_contexts) {
     std::string redpath_to_execute =
         absl::StrCat(context_node.last_executed_redpath, "/", node_name);
+    // Skip the remaining steps of each subquery once the deadline passes.
+    if (absl::Status deadline = QueryDeadlineScope::Check(); !deadline.ok()) {
+      PopulateSubqueryErrorStatus(deadline, redpath_ctx_multiple, result,
+                                  node_name,
+                                  context_node.last_executed_redpath);
+      continue;
+    }
+    QueryProfiler::StepScope step_scope(profiler, redpath_to_execute);
 
     // Get QueryRule configured for the RedPath expression we are about to
     // execute.
     auto get_params_for_redpath =
         GetQueryParamsForRedPath(redpath_to_query_params, redpath_to_execute);
 
+    // Let services supporting $filter evaluate the predicate shared by the
+    // RedPaths. The predicate is still evaluated on each member returned, so
+    // services that ignore the filter produce the same result.
+    if (std::optional<std::string> filter =
+            GetFilterForRedPaths(redpath_ctx_multiple);
+        filter.has_value()) {
+      get_params_for_redpath.filter.emplace(*std::move(filter));
+    }
+
+    // Let services supporting $select return only the properties the query
+    // reads. Expanded resources are left whole as $select would apply to the
+    // expanded members too.
+    std::optional<std::vector<std::string>> select =
+        GetSelectForRedPaths(redpath_ctx_multiple);
+    if (select.has_value() && !get_params_for_redpath.expand.has_value()) {
+      get_params_for_redpath.select.emplace(*select);
+    }
+
     // Dispatch Redfish Request for the Redfish Resource associated with the
     // NodeName expression.
-    RedfishVariant node_set_as_variant =
-        context_node.redfish_object->Get(node_name, get_params_for_redpath);
+    RedfishVariant node_set_as_variant = step_scope.Request([&]() {
+      return context_node.redfish_object->Get(node_name,
+                                              get_params_for_redpath);
+    });
+    // Fall back to evaluating the predicate on every member if the service
+    // rejects the filter.
+    if (get_params_for_redpath.filter.has_value() &&
+        IsFilterRejected(node_set_as_variant.status())) {
+      get_params_for_redpath.filter.reset();
+      node_set_as_variant = step_scope.Request([&]() {
+        return context_node.redfish_object->Get(node_name,
+                                                get_params_for_redpath);
+      });
+    }
 
     // Add the last executed RedPath to the record.
     if (tracker) {
       tracker->redpaths_queried.insert(
           {redpath_to_execute, get_params_for_redpath});
+      if (node_set_as_variant.status().ok()) {
+        ++tracker->redpath_node_counts[redpath_to_execute];
+      }
     }
 
     // If NodeName does not resolve to a valid Redfish Resource, skip it!
@@ -761,7 +1082,7 @@ void ExecuteRedPathStepFromEachSubquery(
       if (!node_as_object) continue;
       std::vector<RedPathContext> redpath_ctx_filtered =
           PopulateResultOrContinueQuery(*node_as_object,
-                                        redpath_ctx_no_predicate, result);
+                                        redpath_ctx_no_predicate, emitter);
       ContextNode new_context_node{
           .redfish_object = std::move(node_as_object),
           .redpath_ctx_multiple = std::move(redpath_ctx_filtered),
@@ -783,10 +1104,12 @@ void ExecuteRedPathStepFromEachSubquery(
         redpath_to_query_params,
         absl::StrCat(redpath_to_execute, "[", kPredicateSelectAll, "]"));
 
+    if (select.has_value() && !redpath_params.expand.has_value()) {
+      redpath_params.select.emplace(*std::move(select));
+    }
     std::unique_ptr<RedfishIterable> node_as_iterable =
         node_set_as_variant.AsIterable(
-            RedfishVariant::IterableMode::kAllowExpand,
-            redpath_params.freshness);
+            RedfishVariant::IterableMode::kAllowExpand, redpath_params);
 
     if (node_as_iterable == nullptr) {
       // We now know that the Redfish node is not a collection/array.
@@ -799,7 +1122,7 @@ void ExecuteRedPathStepFromEachSubquery(
           {.redfish_object = std::move(node_as_object),
            .redpath_ctx_multiple = redpath_ctx_multiple,
            .last_executed_redpath = redpath_to_execute},
-          result);
+          emitter);
       context_nodes.push_back(std::move(new_context_node));
       continue;
     }
@@ -808,15 +1131,23 @@ void ExecuteRedPathStepFromEachSubquery(
     // going to execute '[*]' predicate expression as we iterate over each
     // member in collection to test predicate filters.
     absl::StrAppend(&redpath_to_execute, "[", kPredicateSelectAll, "]");
+    node_count = node_as_iterable->Size();
     if (tracker) {
       tracker->redpaths_queried.insert({redpath_to_execute, redpath_params});
+      tracker->redpath_node_counts[redpath_to_execute] += node_count;
     }
-    node_count = node_as_iterable->Size();
 
     for (int node_index = 0; node_index < node_count; ++node_index) {
+      // Members not visited before the deadline are left out of the result.
+      if (absl::Status deadline = QueryDeadlineScope::Check(); !deadline.ok()) {
+        PopulateSubqueryErrorStatus(deadline, redpath_ctx_multiple, result,
+                                    node_name, redpath_to_execute);
+        break;
+      }
       // If we are dealing with RedfishCollection, get collection member as
       // RedfishObject.
-      RedfishVariant indexed_node = (*node_as_iterable)[node_index];
+      RedfishVariant indexed_node =
+          step_scope.Request([&]() { return (*node_as_iterable)[node_index]; });
       if (!indexed_node.status().ok()) {
         PopulateSubqueryErrorStatus(indexed_node.status(), redpath_ctx_multiple,
                                     result, node_name, redpath_to_execute);
@@ -834,7 +1165,7 @@ void ExecuteRedPathStepFromEachSubquery(
           {.redfish_object = std::move(indexed_node_as_object),
            .redpath_ctx_multiple = redpath_ctx_multiple,
            .last_executed_redpath = redpath_to_execute},
-          result);
+          emitter);
       context_nodes.push_back(std::move(new_context_node));
     }
   }
@@ -844,47 +1175,68 @@ void ExecuteRedPathStepFromEachSubquery(
   // expression from every RedPath context mapped to the context node.
   for (auto &new_context_node : context_nodes) {
     ExecuteRedPathStepFromEachSubquery(redpath_to_query_params,
-                                       new_context_node, result, tracker);
+                                       new_context_node, result, emitter,
+                                       tracker);
   }
 }
 
-absl::StatusOr<SubqueryDataSet *> SubqueryHandle::Normalize(
-    const RedfishObject &redfish_object, DelliciusQueryResult &result,
-    SubqueryDataSet *parent_subquery_dataset) {
-  ECCLESIA_ASSIGN_OR_RETURN(SubqueryDataSet subquery_dataset,
-                            normalizer_->Normalize(redfish_object, subquery_));
-
-  // Insert normalized data in the parent Subquery dataset if provided.
-  // Otherwise, add the dataset in the query result.
-  SubqueryOutput *subquery_output = nullptr;
-  if (!parent_subquery_dataset) {
-    subquery_output =
-        &(*result.mutable_subquery_output_by_id())[subquery_.subquery_id()];
-  } else {
-    subquery_output = &(
-        *parent_subquery_dataset
-             ->mutable_child_subquery_output_by_id())[subquery_.subquery_id()];
-  }
-  auto *dataset = subquery_output->mutable_data_sets()->Add();
-  if (dataset != nullptr) {
-    *dataset = std::move(subquery_dataset);
-  }
-  return dataset;
+absl::StatusOr<size_t> SubqueryHandle::Normalize(
+    const RedfishObject &redfish_object, DataSetEmitter &emitter,
+    const std::optional<ParentDataSet> &parent_dataset) {
+  return emitter.Emit(subquery_.subquery_id(), parent_dataset,
+                      [&](SubqueryDataSet &data_set) {
+                        return normalizer_->Normalize(redfish_object,
+                                                      subquery_, data_set);
+                      });
 }
 
 DelliciusQueryResult QueryPlanner::Run(const RedfishVariant &variant,
                                        const Clock &clock,
                                        QueryTracker *tracker) {
   DelliciusQueryResult result;
+  DataSetEmitter emitter(result);
+  RunWithEmitter(variant, clock, tracker, emitter, result);
+  return result;
+}
 
+DelliciusQueryResult QueryPlanner::Run(const RedfishVariant &variant,
+                                       const Clock &clock,
+                                       QueryTracker *tracker,
+                                       SubqueryDataSetCallback callback) {
+  DelliciusQueryResult result;
+  DataSetEmitter emitter(callback);
+  RunWithEmitter(variant, clock, tracker, emitter, result);
+  return result;
+}
+
+DelliciusQueryResult *QueryPlanner::Run(const RedfishVariant &variant,
+                                        const Clock &clock,
+                                        QueryTracker *tracker,
+                                        google::protobuf::Arena &arena) {
+  auto *result =
+      google::protobuf::Arena::CreateMessage<DelliciusQueryResult>(&arena);
+  DataSetEmitter emitter(*result);
+  RunWithEmitter(variant, clock, tracker, emitter, *result);
+  return result;
+}
+
+void QueryPlanner::RunWithEmitter(const RedfishVariant &variant,
+                                  const Clock &clock, QueryTracker *tracker,
+                                  DataSetEmitter &emitter,
+                                  DelliciusQueryResult &result) {
+  QueryDeadlineScope deadline_scope(
+      clock, tracker ? tracker->deadline : absl::InfiniteFuture());
     result.set_query_id(plan_id_);
     std::unique_ptr<RedfishObject> redfish_object = variant.AsObject();
     if (!redfish_object) {
-    result.mutable_status()->set_code(::google::rpc::Code::FAILED_PRECONDITION);
+    result.mutable_status()->set_code(
+        variant.status().code() == absl::StatusCode::kDeadlineExceeded
+            ? ::google::rpc::Code::DEADLINE_EXCEEDED
+            : ::google::rpc::Code::FAILED_PRECONDITION);
     result.mutable_status()->set_message(
         absl::StrCat("Cannot query service root for query with id: ", plan_id_,
                      ". Check host configuration."));
-    return result;
+    return;
     }
 
   // We will create ContextNode for the RedfishObject relative to which all
@@ -904,12 +1256,12 @@ DelliciusQueryResult QueryPlanner::Run(const RedfishVariant &variant,
     // subquery.
     RedPathIterator path_iter = subquery_handle->GetRedPathIterator();
     std::vector<RedPathContext> redpath_ctx_multiple = {
-        {subquery_handle.get(), nullptr, path_iter}};
+        {subquery_handle.get(), std::nullopt, path_iter}};
     // A special case where properties need to be queried from service root
     // itself.
     if (path_iter->first.empty()) {
       redpath_ctx_multiple = PopulateResultOrContinueQuery(
-          *context_node.redfish_object, redpath_ctx_multiple, result);
+          *context_node.redfish_object, redpath_ctx_multiple, emitter);
     }
     // Update ContextNode with RedPath contexts created for the subquery.
     context_node.redpath_ctx_multiple.insert(
@@ -918,12 +1270,11 @@ DelliciusQueryResult QueryPlanner::Run(const RedfishVariant &variant,
   }
 
   // Return if there are no RedPath contexts to execute.
-  if (context_node.redpath_ctx_multiple.empty()) return result;
+  if (context_node.redpath_ctx_multiple.empty()) return;
 
   // Recursively execute each RedPath step across subqueries.
   ExecuteRedPathStepFromEachSubquery(redpath_to_query_params_, context_node,
-                                     result, tracker);
-  return result;
+                                     result, emitter, tracker);
 }
 
 absl::Status SubqueryHandleFactory::BuildSubqueryHandleChain(
@@ -954,7 +1305,7 @@ absl::Status SubqueryHandleFactory::BuildSubqueryHandleChain(
   }
   // Create a new SubqueryHandle.
   absl::StatusOr<std::vector<RedPathStep>> steps =
-      RedPathToSteps(subquery.redpath());
+      GetRedPathSteps(subquery);
   if (!steps.ok()) {
     LOG(ERROR) << "Cannot create SubqueryHandle for " << subquery_id;
     return steps.status();
@@ -986,6 +1337,24 @@ absl::Status SubqueryHandleFactory::BuildSubqueryHandleChain(
   return absl::OkStatus();
 }
 
+absl::StatusOr<std::vector<RedPathStep>>
+SubqueryHandleFactory::GetRedPathSteps(
+    const DelliciusQuery::Subquery &subquery) const {
+  if (compiled_redpaths_ == nullptr) return RedPathToSteps(subquery.redpath());
+  auto iter = compiled_redpaths_->find(subquery.subquery_id());
+  if (iter == compiled_redpaths_->end()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Compiled query has no RedPath steps for subquery %s",
+        subquery.subquery_id()));
+  }
+  std::vector<RedPathStep> steps;
+  steps.reserve(iter->second.steps_size());
+  for (const CompiledQuery::RedPathStep &step : iter->second.steps()) {
+    steps.push_back({step.node_name(), step.predicate()});
+  }
+  return steps;
+}
+
 absl::StatusOr<SubqueryHandleCollection>
 SubqueryHandleFactory::GetSubqueryHandles() {
   for (const auto &subquery : query_.subquery()) {
@@ -1022,4 +1391,17 @@ absl::StatusOr<std::unique_ptr<QueryPlannerInterface>> BuildDefaultQueryPlanner(
                                         std::move(redpath_to_query_params));
 }
 
+absl::StatusOr<std::unique_ptr<QueryPlannerInterface>> BuildDefaultQueryPlanner(
+    const CompiledQuery &compiled_query,
+    RedPathRedfishQueryParams redpath_to_query_params, Normalizer *normalizer) {
+  absl::StatusOr<SubqueryHandleCollection> subquery_handle_collection =
+      SubqueryHandleFactory::CreateSubqueryHandles(compiled_query, normalizer);
+  if (!subquery_handle_collection.ok()) {
+    return subquery_handle_collection.status();
+  }
+  return std::make_unique<QueryPlanner>(compiled_query.query(),
+                                        *std::move(subquery_handle_collection),
+                                        std::move(redpath_to_query_params));
+}
+
 }  // namespace ecclesia
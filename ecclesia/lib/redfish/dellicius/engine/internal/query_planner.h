@@ -18,17 +18,50 @@
 #define ECCLESIA_LIB_REDFISH_DELLICIUS_ENGINE_INTERNAL_QUERY_PLANNER_H_
 
 #include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "ecclesia/lib/redfish/dellicius/engine/compiled_query.pb.h"
 #include "ecclesia/lib/redfish/dellicius/engine/internal/interface.h"
 #include "ecclesia/lib/redfish/dellicius/query/query.pb.h"
 
 namespace ecclesia {
 
+// Location step in a RedPath expression - (NodeName, Predicate).
+using RedPathStep = std::pair<std::string, std::string>;
+
+// Splits the given RedPath into location steps.
+// Eg. /Chassis[*]/Sensors[1] - {(Chassis, *), (Sensors, 1)}
+absl::StatusOr<std::vector<RedPathStep>> RedPathToSteps(
+    absl::string_view redpath);
+
+// Translates a predicate built from relational expressions into an equivalent
+// $filter expression, eg. 'ReadingType=Temperature' into
+// "ReadingType eq 'Temperature'". Returns nullopt when there is no equivalent:
+// - Index and node name predicates.
+// - Predicates mixing 'and' with 'or', since the planner applies logical
+//   operators left to right while $filter gives 'and' higher precedence.
+// - Comparisons against numbers, which also match numeric strings when
+//   evaluated by the planner.
+// - Ordering comparisons against strings.
+// String literals are quoted and escaped as OData requires.
+std::optional<std::string> PredicateToFilterExpression(
+    absl::string_view predicate);
+
 absl::StatusOr<std::unique_ptr<QueryPlannerInterface>> BuildDefaultQueryPlanner(
     const DelliciusQuery &query,
     RedPathRedfishQueryParams redpath_to_query_params, Normalizer *normalizer);
 
+// Builds the default query planner for a query compiled at build time. RedPath
+// steps are taken from 'compiled_query' instead of being parsed.
+absl::StatusOr<std::unique_ptr<QueryPlannerInterface>> BuildDefaultQueryPlanner(
+    const CompiledQuery &compiled_query,
+    RedPathRedfishQueryParams redpath_to_query_params, Normalizer *normalizer);
+
 }  // namespace ecclesia
 
 #endif  // ECCLESIA_LIB_REDFISH_DELLICIUS_ENGINE_INTERNAL_QUERY_PLANNER_H_
@@ -0,0 +1,215 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ecclesia/lib/redfish/dellicius/engine/internal/query_profiler.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <variant>
+
+#include "absl/functional/function_ref.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_profile.pb.h"
+#include "ecclesia/lib/redfish/interface.h"
+#include "ecclesia/lib/redfish/transport/interface.h"
+#include "ecclesia/lib/redfish/transport/lazy_json.h"
+#include "single_include/nlohmann/json.hpp"
+
+namespace ecclesia {
+
+namespace {
+
+// Step being profiled on the current thread. Query execution is single
+// threaded so this attributes transport activity to the step that caused it.
+thread_local QueryProfiler::StepScope *active_step_scope = nullptr;
+// Step on whose behalf the current thread runs bound work, such as a page of a
+// collection fetched in the background.
+thread_local QueryProfiler::StepScope *bound_step_scope = nullptr;
+
+// Returns the payload size of 'result' from its Content-Length header, or the
+// size of its body otherwise.
+size_t GetPayloadBytes(const RedfishTransport::Result &result) {
+  for (absl::string_view header : {"Content-Length", "content-length"}) {
+    if (auto iter = result.headers.find(header); iter != result.headers.end()) {
+      size_t content_length = 0;
+      if (absl::SimpleAtoi(iter->second, &content_length)) {
+        return content_length;
+      }
+    }
+  }
+  if (const auto *bytes = std::get_if<RedfishTransport::bytes>(&result.body)) {
+    return bytes->size();
+  }
+  if (const auto *lazy = std::get_if<LazyJson>(&result.body)) {
+    return lazy->text().size();
+  }
+  const auto &json = std::get<nlohmann::json>(result.body);
+  if (json.is_discarded()) return 0;
+  return json.dump().size();
+}
+
+}  // namespace
+
+QueryProfiler::StepScope::StepScope(QueryProfiler *profiler,
+                                    absl::string_view redpath)
+    : profiler_(profiler) {
+  if (profiler_ == nullptr) return;
+  step_index_ = profiler_->GetStepIndex(redpath);
+  previous_scope_ = active_step_scope;
+  active_step_scope = this;
+  start_time_ = profiler_->clock_->Now();
+}
+
+QueryProfiler::StepScope::~StepScope() {
+  if (profiler_ == nullptr) return;
+  active_step_scope = previous_scope_;
+  profiler_->EndStep(*this, profiler_->clock_->Now());
+}
+
+RedfishVariant QueryProfiler::StepScope::Request(
+    absl::FunctionRef<RedfishVariant()> request) {
+  if (profiler_ == nullptr) return request();
+  uint64_t issued_fetch_count = issued_fetch_count_;
+  RedfishVariant variant = request();
+  ++request_count_;
+  if (issued_fetch_count_ == issued_fetch_count) ++cache_hit_count_;
+  return variant;
+}
+
+void QueryProfiler::RecordFetch(size_t payload_bytes) {
+  StepScope *scope = active_step_scope;
+  if (scope != nullptr) {
+    ++scope->issued_fetch_count_;
+  } else {
+    scope = bound_step_scope;
+    if (scope == nullptr) return;
+  }
+  ++scope->fetch_count_;
+  scope->payload_bytes_ += payload_bytes;
+}
+
+std::function<void()> QueryProfiler::BindToActiveStep(
+    std::function<void()> task) {
+  StepScope *scope = active_step_scope;
+  if (scope != nullptr) {
+    // The work is issued on behalf of the request in progress, which is
+    // therefore not served from the cache.
+    ++scope->issued_fetch_count_;
+  } else {
+    // Work bound from bound work is attributed to the same step.
+    scope = bound_step_scope;
+    if (scope == nullptr) return task;
+  }
+  return [scope, task = std::move(task)]() {
+    StepScope *previous_scope = std::exchange(bound_step_scope, scope);
+    task();
+    bound_step_scope = previous_scope;
+  };
+}
+
+void QueryProfiler::RecordPredicateEvaluation() {
+  if (active_step_scope == nullptr) return;
+  ++active_step_scope->predicate_evaluation_count_;
+}
+
+size_t QueryProfiler::GetStepIndex(absl::string_view redpath) {
+  auto [iter, inserted] =
+      redpath_to_step_index_.try_emplace(redpath, steps_.size());
+  if (inserted) {
+    steps_.emplace_back().set_redpath(std::string(redpath));
+  }
+  return iter->second;
+}
+
+void QueryProfiler::EndStep(const StepScope &scope, absl::Time end_time) {
+  absl::Duration duration = end_time - scope.start_time_;
+  QueryProfile::StepProfile &step = steps_[scope.step_index_];
+  step.set_execution_count(step.execution_count() + 1);
+  step.set_wall_time_us(step.wall_time_us() +
+                        absl::ToInt64Microseconds(duration));
+  step.set_request_count(step.request_count() + scope.request_count_);
+  step.set_cache_hit_count(step.cache_hit_count() + scope.cache_hit_count_);
+  uint64_t fetch_count = scope.fetch_count_.load();
+  uint64_t payload_bytes = scope.payload_bytes_.load();
+  step.set_fetch_count(step.fetch_count() + fetch_count);
+  step.set_payload_bytes(step.payload_bytes() + payload_bytes);
+  step.set_predicate_evaluation_count(step.predicate_evaluation_count() +
+                                      scope.predicate_evaluation_count_);
+
+  if (events_.size() >= options_.max_trace_events) {
+    ++dropped_trace_events_;
+    return;
+  }
+  events_.push_back({.step_index = scope.step_index_,
+                     .start_time = scope.start_time_,
+                     .duration = duration,
+                     .request_count = scope.request_count_,
+                     .fetch_count = fetch_count,
+                     .payload_bytes = payload_bytes,
+                     .predicate_evaluation_count =
+                         scope.predicate_evaluation_count_});
+}
+
+QueryProfile QueryProfiler::ToProto() const {
+  QueryProfile profile;
+  for (const QueryProfile::StepProfile &step : steps_) {
+    *profile.add_steps() = step;
+  }
+  profile.set_dropped_trace_events(dropped_trace_events_);
+  return profile;
+}
+
+std::string QueryProfiler::ToChromeTraceJson() const {
+  nlohmann::json trace_events = nlohmann::json::array();
+  for (const TraceEvent &event : events_) {
+    trace_events.push_back(
+        {{"name", steps_[event.step_index].redpath()},
+         {"cat", "redpath"},
+         {"ph", "X"},
+         {"ts", absl::ToUnixMicros(event.start_time)},
+         {"dur", absl::ToInt64Microseconds(event.duration)},
+         {"pid", 0},
+         {"tid", 0},
+         {"args",
+          {{"request_count", event.request_count},
+           {"fetch_count", event.fetch_count},
+           {"payload_bytes", event.payload_bytes},
+           {"predicate_evaluation_count",
+            event.predicate_evaluation_count}}}});
+  }
+  nlohmann::json trace = {{"traceEvents", std::move(trace_events)},
+                          {"displayTimeUnit", "ms"}};
+  return trace.dump();
+}
+
+absl::StatusOr<RedfishTransport::Result> ProfilingRedfishTransport::Get(
+    absl::string_view path) {
+  absl::StatusOr<Result> result = base_transport_->Get(path);
+  // Sizing a parsed body takes serializing it, so skip it when not profiling.
+  if (active_step_scope == nullptr && bound_step_scope == nullptr) {
+    return result;
+  }
+  QueryProfiler::RecordFetch(result.ok() ? GetPayloadBytes(*result) : 0);
+  return result;
+}
+
+}  // namespace ecclesia
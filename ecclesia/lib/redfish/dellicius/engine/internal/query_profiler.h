@@ -0,0 +1,181 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ECCLESIA_LIB_REDFISH_DELLICIUS_ENGINE_INTERNAL_QUERY_PROFILER_H_
+#define ECCLESIA_LIB_REDFISH_DELLICIUS_ENGINE_INTERNAL_QUERY_PROFILER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_profile.pb.h"
+#include "ecclesia/lib/redfish/interface.h"
+#include "ecclesia/lib/redfish/transport/interface.h"
+#include "ecclesia/lib/time/clock.h"
+
+namespace ecclesia {
+
+struct QueryProfilerOptions {
+  // Upper bound on the number of step executions recorded as trace events.
+  // Bounds memory use on large queries; aggregated step metrics are always
+  // complete.
+  size_t max_trace_events = 4096;
+};
+
+// Records wall time, Redfish requests, cache hits, fetches, payload bytes and
+// predicate evaluations for each RedPath step executed by a query.
+//
+// Profiling is enabled for a query execution by setting
+// QueryTracker::profiler. Recording is a few counter updates and two clock
+// reads per step execution, which keeps it cheap enough to enable for a
+// sample of queries in production.
+//
+// Fetches and payload bytes are attributed to the step executing on the
+// calling thread, or on whose behalf the calling thread runs work bound
+// through RedfishTransport::BindToCallingThread, and are only recorded when
+// the Redfish transport is wrapped in a ProfilingRedfishTransport.
+//
+// A QueryProfiler must only be used by one query execution at a time.
+class QueryProfiler {
+ public:
+  // Records one execution of a RedPath step for as long as it is in scope.
+  // A null 'profiler' makes the scope a no-op.
+  class StepScope {
+   public:
+    StepScope(QueryProfiler *profiler, absl::string_view redpath);
+    ~StepScope();
+
+    StepScope(const StepScope &) = delete;
+    StepScope &operator=(const StepScope &) = delete;
+
+    // Issues the request for a Redfish node through 'request' and records it
+    // as a cache hit unless it fetched a payload or scheduled work fetching
+    // one on another thread.
+    RedfishVariant Request(absl::FunctionRef<RedfishVariant()> request);
+
+   private:
+    friend class QueryProfiler;
+
+    QueryProfiler *profiler_;
+    StepScope *previous_scope_ = nullptr;
+    size_t step_index_ = 0;
+    absl::Time start_time_;
+    uint64_t request_count_ = 0;
+    uint64_t cache_hit_count_ = 0;
+    // Fetches issued from the thread executing the step, including the work
+    // bound to other threads.
+    uint64_t issued_fetch_count_ = 0;
+    // Updated from the threads running work bound to the step as well.
+    std::atomic<uint64_t> fetch_count_{0};
+    std::atomic<uint64_t> payload_bytes_{0};
+    uint64_t predicate_evaluation_count_ = 0;
+  };
+
+  explicit QueryProfiler(const Clock *clock = Clock::RealClock(),
+                         QueryProfilerOptions options = {})
+      : clock_(clock), options_(options) {}
+
+  // Records a payload fetched from the Redfish service against the step
+  // executing on the calling thread, or on whose behalf it runs, if any.
+  static void RecordFetch(size_t payload_bytes);
+
+  // Returns 'task' wrapped to record its fetches against the step executing
+  // on the calling thread, if any. 'task' must finish before the step ends.
+  static std::function<void()> BindToActiveStep(std::function<void()> task);
+
+  // Records a predicate evaluation against the step executing on the calling
+  // thread, if any.
+  static void RecordPredicateEvaluation();
+
+  // Returns the aggregated per step profile.
+  QueryProfile ToProto() const;
+
+  // Returns the recorded step executions in the Chrome trace event format,
+  // which can be loaded in chrome://tracing or Perfetto.
+  std::string ToChromeTraceJson() const;
+
+ private:
+  struct TraceEvent {
+    size_t step_index;
+    absl::Time start_time;
+    absl::Duration duration;
+    uint64_t request_count;
+    uint64_t fetch_count;
+    uint64_t payload_bytes;
+    uint64_t predicate_evaluation_count;
+  };
+
+  // Returns the index of the step for 'redpath', adding one if needed.
+  size_t GetStepIndex(absl::string_view redpath);
+  // Merges a finished step execution into the profile.
+  void EndStep(const StepScope &scope, absl::Time end_time);
+
+  const Clock *clock_;
+  QueryProfilerOptions options_;
+  // Steps in the order they were first executed.
+  std::vector<QueryProfile::StepProfile> steps_;
+  absl::flat_hash_map<std::string, size_t> redpath_to_step_index_;
+  std::vector<TraceEvent> events_;
+  uint64_t dropped_trace_events_ = 0;
+};
+
+// Decorates RedfishTransport to attribute fetched payloads to the RedPath step
+// being profiled on the calling thread, or on whose behalf it runs. When no
+// step is being profiled, the overhead is two thread local loads per request.
+class ProfilingRedfishTransport : public RedfishTransport {
+ public:
+  explicit ProfilingRedfishTransport(std::unique_ptr<RedfishTransport> base)
+      : base_transport_(std::move(base)) {}
+
+  absl::string_view GetRootUri() override {
+    return base_transport_->GetRootUri();
+  }
+  absl::StatusOr<Result> Get(absl::string_view path) override;
+  absl::StatusOr<Result> Post(absl::string_view path,
+                              absl::string_view data) override {
+    return base_transport_->Post(path, data);
+  }
+  absl::StatusOr<Result> Patch(absl::string_view path,
+                               absl::string_view data) override {
+    return base_transport_->Patch(path, data);
+  }
+  absl::StatusOr<Result> Delete(absl::string_view path,
+                                absl::string_view data) override {
+    return base_transport_->Delete(path, data);
+  }
+  std::function<void()> BindToCallingThread(
+      std::function<void()> task) override {
+    return QueryProfiler::BindToActiveStep(
+        base_transport_->BindToCallingThread(std::move(task)));
+  }
+
+ private:
+  std::unique_ptr<RedfishTransport> base_transport_;
+};
+
+}  // namespace ecclesia
+
+#endif  // ECCLESIA_LIB_REDFISH_DELLICIUS_ENGINE_INTERNAL_QUERY_PROFILER_H_
@@ -0,0 +1,238 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "ecclesia/lib/redfish/dellicius/engine/query_cost_estimator.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "ecclesia/lib/file/path.h"
+#include "ecclesia/lib/file/test_filesystem.h"
+#include "ecclesia/lib/protobuf/parse.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_cost_estimate.pb.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_rules.pb.h"
+#include "ecclesia/lib/redfish/dellicius/query/query.pb.h"
+#include "ecclesia/lib/redfish/testing/fake_redfish_server.h"
+#include "ecclesia/lib/redfish/transport/interface.h"
+#include "ecclesia/lib/testing/status.h"
+
+namespace ecclesia {
+namespace {
+
+using ::testing::Eq;
+using ::testing::Gt;
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+using ::testing::Lt;
+using ::testing::SizeIs;
+
+constexpr absl::string_view kQuerySamplesLocation =
+    "lib/redfish/dellicius/query/samples";
+
+// Trace of a service with two chassis that supports $expand. The expanded
+// chassis collection carries its members inline.
+constexpr absl::string_view kTrace = R"json({
+  "/redfish/v1": {
+    "@odata.id": "/redfish/v1",
+    "Chassis": {"@odata.id": "/redfish/v1/Chassis"},
+    "ProtocolFeaturesSupported": {
+      "ExpandQuery": {
+        "ExpandAll": true,
+        "Levels": true,
+        "Links": true,
+        "NoLinks": true,
+        "MaxLevels": 6
+      }
+    }
+  },
+  "/redfish/v1/Chassis": {
+    "@odata.id": "/redfish/v1/Chassis",
+    "Members": [
+      {"@odata.id": "/redfish/v1/Chassis/1"},
+      {"@odata.id": "/redfish/v1/Chassis/2"}
+    ],
+    "Members@odata.count": 2
+  },
+  "/redfish/v1/Chassis?$expand=.($levels=1)": {
+    "@odata.id": "/redfish/v1/Chassis",
+    "Members": [
+      {"@odata.id": "/redfish/v1/Chassis/1", "Id": "1", "Name": "Tray"},
+      {"@odata.id": "/redfish/v1/Chassis/2", "Id": "2", "Name": "Sled"}
+    ],
+    "Members@odata.count": 2
+  },
+  "/redfish/v1/Chassis/1": {
+    "@odata.id": "/redfish/v1/Chassis/1", "Id": "1", "Name": "Tray"
+  },
+  "/redfish/v1/Chassis/2": {
+    "@odata.id": "/redfish/v1/Chassis/2", "Id": "2", "Name": "Sled"
+  }
+})json";
+
+std::unique_ptr<RedfishTransport> TraceTransport() {
+  absl::StatusOr<std::unique_ptr<RecordedTraceTransport>> transport =
+      RecordedTraceTransport::Create(kTrace);
+  if (!transport.ok()) return nullptr;
+  return *std::move(transport);
+}
+
+const QueryCostEstimate::StepCost *FindStep(const QueryCostEstimate &estimate,
+                                            absl::string_view redpath) {
+  for (const QueryCostEstimate::StepCost &step : estimate.steps()) {
+    if (step.redpath() == redpath) return &step;
+  }
+  return nullptr;
+}
+
+TEST(RecordedTraceTransportTest, ReplaysRecordedResponses) {
+  absl::StatusOr<std::unique_ptr<RecordedTraceTransport>> transport =
+      RecordedTraceTransport::Create(kTrace);
+  ASSERT_THAT(transport, IsOk());
+
+  absl::StatusOr<RedfishTransport::Result> result =
+      (*transport)->Get("/redfish/v1/Chassis/1");
+  ASSERT_THAT(result, IsOk());
+  EXPECT_THAT(result->code, Eq(200));
+  EXPECT_TRUE(result->headers.contains("Content-Length"));
+  // Query parameters that were not recorded are dropped.
+  EXPECT_THAT((*transport)->Get("/redfish/v1/Chassis/1?$top=1"), IsOk());
+  EXPECT_THAT((*transport)->Get("/redfish/v1/Systems").status().code(),
+              Eq(absl::StatusCode::kNotFound));
+  EXPECT_THAT((*transport)->Post("/redfish/v1/Chassis", "{}").status().code(),
+              Eq(absl::StatusCode::kUnimplemented));
+  EXPECT_THAT(RecordedTraceTransport::Create("[]").status().code(),
+              Eq(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(QueryCostEstimatorTest, ComparesCostWithAndWithoutExpand) {
+  DelliciusQuery query = ParseTextProtoOrDie(R"pb(
+    query_id: "ChassisCollector"
+    subquery {
+      subquery_id: "Chassis"
+      redpath: "/Chassis[*]"
+      properties { property: "Name" type: STRING }
+    }
+  )pb");
+  QueryRules query_rules = ParseTextProtoOrDie(R"pb(
+    query_id_to_params_rule {
+      key: "ChassisCollector"
+      value {
+        redpath_prefix_with_params {
+          redpath: "/Chassis"
+          expand_configuration { level: 1 type: NO_LINKS }
+        }
+      }
+    }
+  )pb");
+
+  absl::StatusOr<QueryCostEstimate> estimate =
+      EstimateQueryCost(query, query_rules, TraceTransport);
+  ASSERT_THAT(estimate, IsOk());
+  EXPECT_THAT(estimate->query_id(), Eq("ChassisCollector"));
+  ASSERT_THAT(estimate->plan(), SizeIs(1));
+  EXPECT_THAT(estimate->plan(0).steps(), SizeIs(1));
+  EXPECT_THAT(estimate->full_scans(), IsEmpty());
+
+  // The collection and each of its members are fetched without $expand.
+  const QueryCostEstimate::StepCost *chassis = FindStep(*estimate, "/Chassis");
+  ASSERT_NE(chassis, nullptr);
+  EXPECT_THAT(chassis->request_count(), Eq(3));
+  EXPECT_THAT(chassis->payload_bytes(), Gt(0));
+  EXPECT_THAT(estimate->request_count(), Eq(4));
+  // Members arrive inline with $expand.
+  EXPECT_THAT(chassis->expanded_request_count(), Eq(1));
+  EXPECT_THAT(estimate->expanded_request_count(),
+              Lt(estimate->request_count()));
+
+  std::string report = FormatQueryCostEstimate(*estimate);
+  EXPECT_THAT(report, HasSubstr("Chassis: Chassis[*]"));
+  EXPECT_THAT(report, HasSubstr("/Chassis"));
+}
+
+TEST(QueryCostEstimatorTest, FlagsPredicatesForcingFullScans) {
+  DelliciusQuery query = ParseTextProtoOrDie(R"pb(
+    query_id: "TrayCollector"
+    subquery {
+      subquery_id: "Tray"
+      redpath: "/Chassis[Location]"
+      properties { property: "Id" type: STRING }
+    }
+  )pb");
+
+  absl::StatusOr<QueryCostEstimate> estimate =
+      EstimateQueryCost(query, QueryRules(), TraceTransport);
+  ASSERT_THAT(estimate, IsOk());
+  ASSERT_THAT(estimate->full_scans(), SizeIs(1));
+  const QueryCostEstimate::FullScan &full_scan = estimate->full_scans(0);
+  EXPECT_THAT(full_scan.subquery_id(), Eq("Tray"));
+  EXPECT_THAT(full_scan.redpath(), Eq("/Chassis[Location]"));
+  EXPECT_THAT(full_scan.predicate(), Eq("Location"));
+  EXPECT_THAT(full_scan.member_count(), Eq(2));
+  EXPECT_THAT(FormatQueryCostEstimate(*estimate),
+              HasSubstr("Full collection scans"));
+}
+
+TEST(QueryCostEstimatorTest, SkipsPredicatesSentAsFilter) {
+  DelliciusQuery query = ParseTextProtoOrDie(R"pb(
+    query_id: "TrayCollector"
+    subquery {
+      subquery_id: "Tray"
+      redpath: "/Chassis[Name=Tray]"
+      properties { property: "Id" type: STRING }
+    }
+  )pb");
+
+  absl::StatusOr<QueryCostEstimate> estimate =
+      EstimateQueryCost(query, QueryRules(), TraceTransport);
+  ASSERT_THAT(estimate, IsOk());
+  EXPECT_THAT(estimate->full_scans(), IsEmpty());
+}
+
+TEST(QueryCostEstimatorTest, EstimatesQueryAgainstMockup) {
+  FakeRedfishServer server("indus_hmb_shim/mockup.shar");
+  DelliciusQuery query = ParseTextFileAsProtoOrDie<DelliciusQuery>(
+      GetTestDataDependencyPath(JoinFilePaths(
+          kQuerySamplesLocation, "query_in/sensor_in.textproto")));
+
+  absl::StatusOr<QueryCostEstimate> estimate = EstimateQueryCost(
+      query, QueryRules(), [&]() { return server.RedfishClientTransport(); });
+  ASSERT_THAT(estimate, IsOk());
+  ASSERT_THAT(estimate->plan(), SizeIs(1));
+  EXPECT_THAT(estimate->plan(0).subquery_id(), Eq("Sensors"));
+  EXPECT_THAT(estimate->full_scans(), IsEmpty());
+
+  const QueryCostEstimate::StepCost *root = FindStep(*estimate, "/");
+  ASSERT_NE(root, nullptr);
+  EXPECT_THAT(root->request_count(), Eq(1));
+  const QueryCostEstimate::StepCost *sensors =
+      FindStep(*estimate, "/Chassis[*]/Sensors");
+  ASSERT_NE(sensors, nullptr);
+  EXPECT_THAT(sensors->request_count(), Gt(0));
+  EXPECT_THAT(sensors->payload_bytes(), Gt(0));
+  // Without query rules both executions issue the same requests.
+  EXPECT_THAT(estimate->expanded_request_count(),
+              Eq(estimate->request_count()));
+}
+
+}  // namespace
+}  // namespace ecclesia
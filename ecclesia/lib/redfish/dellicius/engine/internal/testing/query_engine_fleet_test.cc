@@ -0,0 +1,237 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ecclesia/lib/redfish/dellicius/engine/query_engine_fleet.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "google/rpc/code.pb.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ecclesia/lib/redfish/dellicius/engine/internal/testing/test_queries_embedded.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_engine.h"
+#include "ecclesia/lib/redfish/dellicius/query/query_result.pb.h"
+#include "ecclesia/lib/redfish/testing/fake_redfish_transport.h"
+#include "ecclesia/lib/testing/status.h"
+#include "single_include/nlohmann/json.hpp"
+
+namespace ecclesia {
+namespace {
+
+using ::testing::Eq;
+using ::testing::Le;
+using ::testing::SizeIs;
+
+// Tracks the highest number of requests in flight at once.
+class ConcurrencyTracker {
+ public:
+  void Begin() {
+    int in_flight = ++in_flight_;
+    int max_in_flight = max_in_flight_.load();
+    while (in_flight > max_in_flight &&
+           !max_in_flight_.compare_exchange_weak(max_in_flight, in_flight)) {
+    }
+  }
+  void End() { --in_flight_; }
+  int max_in_flight() const { return max_in_flight_.load(); }
+
+ private:
+  std::atomic<int> in_flight_ = 0;
+  std::atomic<int> max_in_flight_ = 0;
+};
+
+// Returns a transport serving a BMC with a chassis of four sensors and a
+// manager, enough for the SensorCollector and ManagerCollector queries.
+std::unique_ptr<FakeRedfishTransport> NewBmcTransport() {
+  auto transport = std::make_unique<FakeRedfishTransport>();
+  transport->SetResource(
+      "/redfish/v1",
+      {{"@odata.id", "/redfish/v1"},
+       {"Chassis", {{"@odata.id", "/redfish/v1/Chassis"}}},
+       {"Managers", {{"@odata.id", "/redfish/v1/Managers"}}}});
+  transport->SetResource(
+      "/redfish/v1/Chassis",
+      {{"@odata.id", "/redfish/v1/Chassis"},
+       {"Members", {{{"@odata.id", "/redfish/v1/Chassis/1"}}}}});
+  transport->SetResource(
+      "/redfish/v1/Chassis/1",
+      {{"@odata.id", "/redfish/v1/Chassis/1"},
+       {"Id", "1"},
+       {"Sensors", {{"@odata.id", "/redfish/v1/Chassis/1/Sensors"}}}});
+  nlohmann::json sensors = nlohmann::json::array();
+  for (int i = 0; i < 4; ++i) {
+    std::string uri = absl::StrCat("/redfish/v1/Chassis/1/Sensors/", i);
+    transport->SetResource(uri, {{"@odata.id", uri},
+                                 {"Id", absl::StrCat(i)},
+                                 {"Name", absl::StrCat("temp", i)},
+                                 {"ReadingType", "Temperature"},
+                                 {"ReadingUnits", "Cel"},
+                                 {"Reading", 30 + i}});
+    sensors.push_back({{"@odata.id", uri}});
+  }
+  transport->SetResource("/redfish/v1/Chassis/1/Sensors",
+                         {{"@odata.id", "/redfish/v1/Chassis/1/Sensors"},
+                          {"Members", sensors}});
+  transport->SetResource(
+      "/redfish/v1/Managers",
+      {{"@odata.id", "/redfish/v1/Managers"},
+       {"Members", {{{"@odata.id", "/redfish/v1/Managers/bmc"}}}}});
+  transport->SetResource(
+      "/redfish/v1/Managers/bmc",
+      {{"@odata.id", "/redfish/v1/Managers/bmc"},
+       {"Id", "bmc"},
+       {"Actions",
+        {{"#Manager.Reset",
+          {{"ResetType@Redfish.AllowableValues", {"GracefulRestart"}}}}}}});
+  return transport;
+}
+
+// Collects the results reported for each endpoint.
+class ResultCollector {
+ public:
+  QueryEngineFleet::ResultCallback Callback() {
+    return [this](absl::string_view endpoint,
+                  std::vector<DelliciusQueryResult> results) {
+      absl::MutexLock lock(&mutex_);
+      ++callback_counts_[endpoint];
+      results_[endpoint] = std::move(results);
+    };
+  }
+
+  absl::flat_hash_map<std::string, int> callback_counts() {
+    absl::MutexLock lock(&mutex_);
+    return callback_counts_;
+  }
+  absl::flat_hash_map<std::string, std::vector<DelliciusQueryResult>>
+  results() {
+    absl::MutexLock lock(&mutex_);
+    return results_;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, int> callback_counts_
+      ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, std::vector<DelliciusQueryResult>> results_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+TEST(QueryEngineFleetTest, ExecutesQueriesAcrossManyBmcs) {
+  constexpr int kNumBmcs = 32;
+  constexpr int kNumWorkers = 4;
+  QueryEngineFleet fleet({.num_workers = kNumWorkers,
+                          .max_concurrent_queries_per_engine = 1});
+  std::vector<FakeRedfishTransport *> transports;
+  ConcurrencyTracker fleet_tracker;
+  for (int i = 0; i < kNumBmcs; ++i) {
+    std::unique_ptr<FakeRedfishTransport> transport = NewBmcTransport();
+    // Requests take long enough for queries on different BMCs to overlap.
+    transport->SetLatency(absl::Milliseconds(1));
+    transport->SetGetHooks(
+        [&fleet_tracker](absl::string_view) { fleet_tracker.Begin(); },
+        [&fleet_tracker](absl::string_view) { fleet_tracker.End(); });
+    transports.push_back(transport.get());
+    ASSERT_THAT(fleet.AddEngine(absl::StrCat("bmc", i),
+                                {.query_files = kDelliciusQueries},
+                                {.transport = std::move(transport)}),
+                IsOk());
+  }
+  ASSERT_THAT(fleet.size(), Eq(kNumBmcs));
+
+  ResultCollector collector;
+  fleet.ExecuteQuery({"SensorCollector", "ManagerCollector"},
+                     collector.Callback());
+
+  absl::flat_hash_map<std::string, int> callback_counts =
+      collector.callback_counts();
+  absl::flat_hash_map<std::string, std::vector<DelliciusQueryResult>> results =
+      collector.results();
+  ASSERT_THAT(results, SizeIs(kNumBmcs));
+  for (int i = 0; i < kNumBmcs; ++i) {
+    std::string endpoint = absl::StrCat("bmc", i);
+    EXPECT_THAT(callback_counts[endpoint], Eq(1)) << endpoint;
+    ASSERT_THAT(results[endpoint], SizeIs(2)) << endpoint;
+    EXPECT_THAT(results[endpoint][0].query_id(), Eq("SensorCollector"));
+    EXPECT_THAT(results[endpoint][1].query_id(), Eq("ManagerCollector"));
+    EXPECT_THAT(
+        results[endpoint][0].subquery_output_by_id().at("Sensors").data_sets(),
+        SizeIs(4))
+        << endpoint;
+    EXPECT_THAT(results[endpoint][1]
+                    .subquery_output_by_id()
+                    .at("GetManagersIdAndResetType")
+                    .data_sets(),
+                SizeIs(1))
+        << endpoint;
+    // Queries on a BMC never overlap.
+    EXPECT_THAT(transports[i]->GetMaxConcurrentRequests(), Le(1)) << endpoint;
+  }
+  // Requests across the fleet are bounded by the worker pool.
+  EXPECT_THAT(fleet_tracker.max_in_flight(), Le(kNumWorkers));
+}
+
+TEST(QueryEngineFleetTest, ReportsUnknownQueries) {
+  QueryEngineFleet fleet({.num_workers = 2});
+  ASSERT_THAT(fleet.AddEngine("bmc0", {.query_files = kDelliciusQueries},
+                              {.transport = NewBmcTransport()}),
+              IsOk());
+
+  ResultCollector collector;
+  fleet.ExecuteQuery({"UnknownQuery"}, collector.Callback());
+  absl::flat_hash_map<std::string, std::vector<DelliciusQueryResult>> results =
+      collector.results();
+  ASSERT_THAT(results["bmc0"], SizeIs(1));
+  EXPECT_THAT(results["bmc0"][0].query_id(), Eq("UnknownQuery"));
+  EXPECT_THAT(results["bmc0"][0].status().code(),
+              Eq(::google::rpc::Code::NOT_FOUND));
+}
+
+TEST(QueryEngineFleetTest, AddsAndRemovesEngines) {
+  QueryEngineFleet fleet;
+  ASSERT_THAT(fleet.AddEngine("bmc0", {.query_files = kDelliciusQueries},
+                              {.transport = NewBmcTransport()}),
+              IsOk());
+  EXPECT_THAT(fleet.AddEngine("bmc0", {.query_files = kDelliciusQueries},
+                              {.transport = NewBmcTransport()})
+                  .code(),
+              Eq(absl::StatusCode::kAlreadyExists));
+  EXPECT_THAT(fleet.size(), Eq(1));
+
+  ASSERT_THAT(fleet.RemoveEngine("bmc0"), IsOk());
+  EXPECT_THAT(fleet.size(), Eq(0));
+  EXPECT_THAT(fleet.RemoveEngine("bmc0").code(),
+              Eq(absl::StatusCode::kNotFound));
+
+  // Executing queries on an empty fleet reports nothing.
+  ResultCollector collector;
+  fleet.ExecuteQuery({"SensorCollector"}, collector.Callback());
+  EXPECT_THAT(collector.results(), SizeIs(0));
+}
+
+}  // namespace
+}  // namespace ecclesia
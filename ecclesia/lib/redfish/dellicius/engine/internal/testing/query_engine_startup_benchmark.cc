@@ -0,0 +1,64 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares query engine startup with queries and rules embedded as text
+// against queries compiled at build time by the compiled_redpath_queries rule.
+
+#include <memory>
+
+#include "benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "ecclesia/lib/redfish/dellicius/engine/factory.h"
+#include "ecclesia/lib/redfish/dellicius/engine/internal/testing/test_queries_embedded.h"
+#include "ecclesia/lib/redfish/dellicius/engine/internal/testing/test_query_rules_embedded.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_engine.h"
+#include "ecclesia/lib/redfish/dellicius/query/samples/sample_queries_compiled.h"
+#include "ecclesia/lib/redfish/interface.h"
+#include "ecclesia/lib/redfish/transport/cache.h"
+#include "ecclesia/lib/redfish/transport/http_redfish_intf.h"
+#include "ecclesia/lib/redfish/transport/interface.h"
+
+namespace ecclesia {
+namespace {
+
+void CreateEngine(benchmark::State &state, const QueryContext &query_context) {
+  for (auto s : state) {
+    absl::StatusOr<QueryEngine> query_engine = CreateQueryEngine(
+        query_context,
+        NewHttpInterface(std::make_unique<NullTransport>(), NullCache::Create,
+                         RedfishInterface::kTrusted),
+        BuildDefaultNormalizer());
+    CHECK(query_engine.ok()) << query_engine.status();
+    benchmark::DoNotOptimize(query_engine);
+  }
+}
+
+void BM_StartupWithTextQueries(benchmark::State &state) {
+  CreateEngine(state, {.query_files = kDelliciusQueries,
+                       .query_rules = kQueryRules});
+}
+
+void BM_StartupWithCompiledQueries(benchmark::State &state) {
+  CreateEngine(state, {.query_files = {},
+                       .compiled_query_files = kSampleQueriesCompiled});
+}
+
+BENCHMARK(BM_StartupWithTextQueries);
+BENCHMARK(BM_StartupWithCompiledQueries);
+
+}  // namespace
+}  // namespace ecclesia
@@ -21,6 +21,7 @@
 #include <utility>
 #include <vector>
 
+#include "google/rpc/code.pb.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/strings/string_view.h"
@@ -37,6 +38,7 @@
 #include "ecclesia/lib/redfish/dellicius/engine/internal/testing/test_query_rules_embedded.h"
 #include "ecclesia/lib/redfish/dellicius/engine/query_engine_fake.h"
 #include "ecclesia/lib/redfish/dellicius/query/query_result.pb.h"
+#include "ecclesia/lib/redfish/dellicius/query/samples/sample_queries_compiled.h"
 #include "ecclesia/lib/redfish/interface.h"
 #include "ecclesia/lib/redfish/testing/fake_redfish_server.h"
 #include "ecclesia/lib/redfish/transport/http.h"
@@ -378,20 +380,24 @@ TEST(QueryEngineTest, QueryEngineTransportMetrics) {
   EXPECT_EQ(transport_metrics.uri_to_metrics_map().size(), 8);
 }
 
-absl::StatusOr<QueryEngine> GetDefaultQueryEngine(
-    FakeRedfishServer &server,
-    absl::Span<const EmbeddedFile> query_files = kDelliciusQueries,
-    const Clock *clock = Clock::RealClock()) {
+std::unique_ptr<RedfishTransport> GetNetworkTransport(
+    FakeRedfishServer &server) {
   FakeRedfishServer::Config config = server.GetConfig();
   auto http_client = std::make_unique<CurlHttpClient>(
       LibCurlProxy::CreateInstance(), HttpCredential{});
   std::string network_endpoint =
       absl::StrFormat("%s:%d", config.hostname, config.port);
-  std::unique_ptr<RedfishTransport> transport =
-      HttpRedfishTransport::MakeNetwork(std::move(http_client),
-                                        network_endpoint);
+  return HttpRedfishTransport::MakeNetwork(std::move(http_client),
+                                           network_endpoint);
+}
+
+absl::StatusOr<QueryEngine> GetDefaultQueryEngine(
+    FakeRedfishServer &server,
+    absl::Span<const EmbeddedFile> query_files = kDelliciusQueries,
+    const Clock *clock = Clock::RealClock()) {
   QueryContext query_context{.query_files = query_files, .clock = clock};
-  return CreateQueryEngine(query_context, {.transport = std::move(transport)});
+  return CreateQueryEngine(query_context,
+                           {.transport = GetNetworkTransport(server)});
 }
 
 TEST(QueryEngineTest, QueryEngineWithDefaultNormalizer) {
@@ -411,6 +417,74 @@ TEST(QueryEngineTest, QueryEngineWithDefaultNormalizer) {
                      {std::move(intent_output_sensor)});
 }
 
+TEST(QueryEngineTest, QueryEngineWithExpiredDeadline) {
+  FakeRedfishServer server(kIndusMockup);
+  FakeClock clock{clock_time};
+  absl::StatusOr<QueryEngine> query_engine =
+      GetDefaultQueryEngine(server, kDelliciusQueries, &clock);
+  ASSERT_TRUE(query_engine.ok());
+
+  std::vector<DelliciusQueryResult> results =
+      query_engine->ExecuteQuery({"SensorCollector"}, clock.Now());
+  ASSERT_EQ(results.size(), 1);
+  ASSERT_FALSE(results[0].subquery_output_by_id().empty());
+  for (const auto &[id, subquery_output] :
+       results[0].subquery_output_by_id()) {
+    EXPECT_EQ(subquery_output.status().code(),
+              ::google::rpc::Code::DEADLINE_EXCEEDED);
+    EXPECT_TRUE(subquery_output.data_sets().empty());
+  }
+}
+
+TEST(QueryEngineTest, QueryEngineStreamingQueryWithExpiredDeadline) {
+  FakeRedfishServer server(kIndusMockup);
+  FakeClock clock{clock_time};
+  absl::StatusOr<QueryEngine> query_engine =
+      GetDefaultQueryEngine(server, kDelliciusQueries, &clock);
+  ASSERT_TRUE(query_engine.ok());
+
+  QueryTracker tracker{.deadline = clock.Now()};
+  int num_data_sets = 0;
+  absl::StatusOr<DelliciusQueryResult> result =
+      query_engine->ExecuteQueryStreaming(
+          "SensorCollector", tracker,
+          [&num_data_sets](const SubqueryDataSetInfo &, SubqueryDataSet) {
+            ++num_data_sets;
+          });
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(num_data_sets, 0);
+  ASSERT_FALSE(result->subquery_output_by_id().empty());
+  for (const auto &[id, subquery_output] : result->subquery_output_by_id()) {
+    EXPECT_EQ(subquery_output.status().code(),
+              ::google::rpc::Code::DEADLINE_EXCEEDED);
+  }
+}
+
+TEST(QueryEngineTest, QueryEngineDeltaQuery) {
+  FakeRedfishServer server(kIndusMockup);
+  FakeClock clock{clock_time};
+  absl::StatusOr<QueryEngine> query_engine =
+      GetDefaultQueryEngine(server, kDelliciusQueries, &clock);
+  ASSERT_TRUE(query_engine.ok());
+
+  absl::StatusOr<DelliciusQueryResultDelta> first =
+      query_engine->ExecuteQueryDelta("SensorCollector", "");
+  ASSERT_TRUE(first.ok());
+  EXPECT_FALSE(first->added().empty());
+
+  // Nothing changes on the fake server between the two executions.
+  absl::StatusOr<DelliciusQueryResultDelta> second =
+      query_engine->ExecuteQueryDelta("SensorCollector", first->version());
+  ASSERT_TRUE(second.ok());
+  EXPECT_EQ(second->base_version(), first->version());
+  EXPECT_TRUE(second->added().empty());
+  EXPECT_TRUE(second->changed().empty());
+  EXPECT_TRUE(second->removed().empty());
+
+  EXPECT_EQ(query_engine->ExecuteQueryDelta("UnknownQuery", "").status().code(),
+            absl::StatusCode::kNotFound);
+}
+
 TEST(QueryEngineTest, TestQueryEngineFactoryForParserError) {
   FakeRedfishServer server(kIndusMockup);
   EXPECT_EQ(GetDefaultQueryEngine(server, {{"Test", "{}"}}).status().code(),
@@ -423,6 +497,37 @@ TEST(QueryEngineTest, TestQueryEngineFactoryForInvalidQuery) {
             absl::StatusCode::kInternal);
 }
 
+TEST(QueryEngineTest, QueryEngineWithCompiledQueries) {
+  FakeRedfishServer server(kIndusMockup);
+  FakeClock clock{clock_time};
+  QueryContext query_context{.query_files = {},
+                             .clock = &clock,
+                             .compiled_query_files = kSampleQueriesCompiled};
+  absl::StatusOr<QueryEngine> query_engine = CreateQueryEngine(
+      query_context, {.transport = GetNetworkTransport(server)});
+  ASSERT_TRUE(query_engine.ok());
+
+  DelliciusQueryResult intent_output_sensor =
+      ParseTextFileAsProtoOrDie<DelliciusQueryResult>(
+          GetTestDataDependencyPath(JoinFilePaths(
+              kQuerySamplesLocation, "query_out/sensor_out.textproto")));
+  std::vector<DelliciusQueryResult> response_entries =
+      query_engine->ExecuteQuery({"SensorCollector"});
+  VerifyQueryResults(std::move(response_entries),
+                     {std::move(intent_output_sensor)});
+}
+
+TEST(QueryEngineTest, TestQueryEngineFactoryForCompiledQueryParserError) {
+  FakeRedfishServer server(kIndusMockup);
+  QueryContext query_context{.query_files = {},
+                             .compiled_query_files = {{"Test", "\xff"}}};
+  EXPECT_EQ(CreateQueryEngine(query_context,
+                              {.transport = GetNetworkTransport(server)})
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
 }  // namespace
 
 }  // namespace ecclesia
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares building query results on the heap against building them on a
+// protobuf Arena. Besides latency, each benchmark reports the number of heap
+// allocations per query in the "allocs" counter.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "ecclesia/lib/file/path.h"
+#include "ecclesia/lib/file/test_filesystem.h"
+#include "ecclesia/lib/protobuf/parse.h"
+#include "ecclesia/lib/redfish/dellicius/engine/factory.h"
+#include "ecclesia/lib/redfish/dellicius/engine/internal/interface.h"
+#include "ecclesia/lib/redfish/dellicius/engine/internal/query_planner.h"
+#include "ecclesia/lib/redfish/dellicius/query/query.pb.h"
+#include "ecclesia/lib/redfish/dellicius/query/query_result.pb.h"
+#include "ecclesia/lib/redfish/interface.h"
+#include "ecclesia/lib/redfish/testing/fake_redfish_server.h"
+#include "ecclesia/lib/redfish/transport/cache.h"
+#include "ecclesia/lib/redfish/transport/http_redfish_intf.h"
+#include "ecclesia/lib/redfish/transport/interface.h"
+#include "ecclesia/lib/time/clock_fake.h"
+#include "google/protobuf/arena.h"
+
+namespace {
+
+std::atomic<size_t> allocation_count{0};
+
+}  // namespace
+
+void *operator new(size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (void *ptr = std::malloc(size)) return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+namespace ecclesia {
+namespace {
+
+constexpr absl::string_view kQuerySamplesLocation =
+    "lib/redfish/dellicius/query/samples";
+
+// Redfish service, normalizer and query plan for the sensor query.
+struct SensorQueryFixture {
+  SensorQueryFixture()
+      : server("indus_hmb_shim/mockup.shar"),
+        clock(absl::FromUnixSeconds(10)),
+        normalizer(BuildDefaultNormalizer()) {
+    // Cache all responses so that the benchmark measures result construction
+    // rather than the fake server.
+    intf = NewHttpInterface(
+        server.RedfishClientTransport(),
+        [this](RedfishTransport *transport) {
+          return std::make_unique<TimeBasedCache>(transport, &clock,
+                                                  absl::InfiniteDuration());
+        },
+        RedfishInterface::kTrusted);
+    DelliciusQuery query = ParseTextFileAsProtoOrDie<DelliciusQuery>(
+        GetTestDataDependencyPath(JoinFilePaths(
+            kQuerySamplesLocation, "query_in/sensor_in.textproto")));
+    auto query_planner = BuildDefaultQueryPlanner(
+        query, RedPathRedfishQueryParams{}, normalizer.get());
+    CHECK(query_planner.ok()) << query_planner.status();
+    planner = *std::move(query_planner);
+  }
+
+  FakeRedfishServer server;
+  FakeClock clock;
+  std::unique_ptr<Normalizer> normalizer;
+  std::unique_ptr<RedfishInterface> intf;
+  std::unique_ptr<QueryPlannerInterface> planner;
+};
+
+void BM_SensorQueryHeapResult(benchmark::State &state) {
+  SensorQueryFixture fixture;
+  size_t allocations = 0;
+  for (auto s : state) {
+    RedfishVariant root = fixture.intf->GetRoot();
+    size_t start = allocation_count.load(std::memory_order_relaxed);
+    DelliciusQueryResult result =
+        fixture.planner->Run(root, fixture.clock, nullptr);
+    allocations += allocation_count.load(std::memory_order_relaxed) - start;
+    benchmark::DoNotOptimize(result);
+  }
+  state.counters["allocs"] =
+      benchmark::Counter(allocations, benchmark::Counter::kAvgIterations);
+}
+
+void BM_SensorQueryArenaResult(benchmark::State &state) {
+  SensorQueryFixture fixture;
+  size_t allocations = 0;
+  for (auto s : state) {
+    RedfishVariant root = fixture.intf->GetRoot();
+    size_t start = allocation_count.load(std::memory_order_relaxed);
+    google::protobuf::Arena arena;
+    DelliciusQueryResult *result =
+        fixture.planner->Run(root, fixture.clock, nullptr, arena);
+    allocations += allocation_count.load(std::memory_order_relaxed) - start;
+    benchmark::DoNotOptimize(result);
+  }
+  state.counters["allocs"] =
+      benchmark::Counter(allocations, benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BM_SensorQueryHeapResult);
+BENCHMARK(BM_SensorQueryArenaResult);
+
+}  // namespace
+}  // namespace ecclesia
@@ -16,16 +16,22 @@
 
 #include "ecclesia/lib/redfish/dellicius/engine/internal/query_planner.h"
 
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "google/rpc/code.pb.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "ecclesia/lib/file/path.h"
@@ -37,13 +43,17 @@
 #include "ecclesia/lib/redfish/dellicius/query/query_result.pb.h"
 #include "ecclesia/lib/redfish/interface.h"
 #include "ecclesia/lib/redfish/testing/fake_redfish_server.h"
+#include "ecclesia/lib/redfish/testing/fake_redfish_transport.h"
 #include "ecclesia/lib/redfish/topology.h"
 #include "ecclesia/lib/redfish/transport/cache.h"
 #include "ecclesia/lib/redfish/transport/http_redfish_intf.h"
+#include "ecclesia/lib/redfish/transport/interface.h"
 #include "ecclesia/lib/redfish/transport/metrical_transport.h"
 #include "ecclesia/lib/redfish/transport/transport_metrics.pb.h"
 #include "ecclesia/lib/testing/proto.h"
 #include "ecclesia/lib/time/clock_fake.h"
+#include "google/protobuf/arena.h"
+#include "single_include/nlohmann/json.hpp"
 
 namespace ecclesia {
 
@@ -53,6 +63,14 @@ using ::testing::_;
 using ::testing::Return;
 using ::testing::Eq;
 using ::testing::ByMove;
+using ::testing::AllOf;
+using ::testing::Contains;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+using ::testing::Not;
+using ::testing::SizeIs;
+using ::testing::StartsWith;
 
 constexpr absl::string_view kQuerySamplesLocation =
     "lib/redfish/dellicius/query/samples";
@@ -234,6 +252,84 @@ TEST_F(QueryPlannerTestRunner,
   TestQuery(query_in_path, query_out_path, normalizer_with_devpath.get());
 }
 
+// Returns the number of datasets in 'subquery_output_by_id' including datasets
+// of linked child subqueries.
+size_t CountDataSets(
+    const google::protobuf::Map<std::string, SubqueryOutput>
+        &subquery_output_by_id) {
+  size_t count = 0;
+  for (const auto &[id, subquery_output] : subquery_output_by_id) {
+    for (const SubqueryDataSet &data_set : subquery_output.data_sets()) {
+      count += 1 + CountDataSets(data_set.child_subquery_output_by_id());
+    }
+  }
+  return count;
+}
+
+TEST_F(QueryPlannerTestRunner, StreamsDataSetsWithParentLinkage) {
+  std::string query_in_path = GetTestDataDependencyPath(JoinFilePaths(
+      kQuerySamplesLocation, "query_in/sensor_in_links.textproto"));
+  SetTestParams("indus_hmb_shim/mockup.shar", absl::FromUnixSeconds(10));
+  auto default_normalizer = BuildDefaultNormalizer();
+  DelliciusQuery query =
+      ParseTextFileAsProtoOrDie<DelliciusQuery>(query_in_path);
+  absl::StatusOr<std::unique_ptr<QueryPlannerInterface>> qp =
+      BuildDefaultQueryPlanner(query, RedPathRedfishQueryParams{},
+                               default_normalizer.get());
+  ASSERT_TRUE(qp.ok());
+
+  // Subquery id of each dataset streamed so far, keyed by dataset id.
+  absl::flat_hash_map<size_t, std::string> streamed_datasets;
+  bool has_linked_dataset = false;
+  DelliciusQueryResult streamed_result = (*qp)->Run(
+      intf_->GetRoot(), *clock_, nullptr,
+      [&](const SubqueryDataSetInfo &info, SubqueryDataSet data_set) {
+        if (info.parent_dataset_id.has_value()) {
+          has_linked_dataset = true;
+          // Parent datasets are streamed before their children.
+          auto parent = streamed_datasets.find(*info.parent_dataset_id);
+          ASSERT_NE(parent, streamed_datasets.end());
+          EXPECT_EQ(parent->second, info.parent_subquery_id);
+        }
+        EXPECT_TRUE(
+            streamed_datasets
+                .emplace(info.dataset_id, std::string(info.subquery_id))
+                .second);
+      });
+  EXPECT_TRUE(has_linked_dataset);
+  EXPECT_EQ(streamed_result.query_id(), query.query_id());
+  EXPECT_EQ(CountDataSets(streamed_result.subquery_output_by_id()), 0);
+
+  // Batch execution produces the same datasets as the stream.
+  DelliciusQueryResult batch_result =
+      (*qp)->Run(intf_->GetRoot(), *clock_, nullptr);
+  EXPECT_EQ(CountDataSets(batch_result.subquery_output_by_id()),
+            streamed_datasets.size());
+}
+
+TEST_F(QueryPlannerTestRunner, BuildsResultOnArena) {
+  std::string query_in_path = GetTestDataDependencyPath(JoinFilePaths(
+      kQuerySamplesLocation, "query_in/sensor_in_links.textproto"));
+  SetTestParams("indus_hmb_shim/mockup.shar", absl::FromUnixSeconds(10));
+  auto default_normalizer = BuildDefaultNormalizer();
+  DelliciusQuery query =
+      ParseTextFileAsProtoOrDie<DelliciusQuery>(query_in_path);
+  absl::StatusOr<std::unique_ptr<QueryPlannerInterface>> qp =
+      BuildDefaultQueryPlanner(query, RedPathRedfishQueryParams{},
+                               default_normalizer.get());
+  ASSERT_TRUE(qp.ok());
+
+  google::protobuf::Arena arena;
+  DelliciusQueryResult *arena_result =
+      (*qp)->Run(intf_->GetRoot(), *clock_, nullptr, arena);
+  ASSERT_NE(arena_result, nullptr);
+  EXPECT_EQ(arena_result->GetArena(), &arena);
+  DelliciusQueryResult heap_result =
+      (*qp)->Run(intf_->GetRoot(), *clock_, nullptr);
+  EXPECT_THAT(*arena_result, IgnoringRepeatedFieldOrdering(
+                                 EqualsProto(heap_result)));
+}
+
 TEST_F(QueryPlannerTestRunner, TestNestedNodeNameInQueryProperty) {
   std::string query_in_path = GetTestDataDependencyPath(
       JoinFilePaths(kQuerySamplesLocation, "query_in/managers_in.textproto"));
@@ -474,6 +570,413 @@ TEST_F(QueryPlannerTestRunner, CheckSubqueryErrorsPopulatedCollectionResource) {
   }
 }
 
+// Returns a transport advancing 'clock' by one second for each request, which
+// expresses query deadlines as a number of requests.
+std::unique_ptr<FakeRedfishTransport> NewClockAdvancingTransport(
+    FakeRedfishServer &server, FakeClock &clock) {
+  auto transport =
+      std::make_unique<FakeRedfishTransport>(server.RedfishClientTransport());
+  transport->SetGetHooks(
+      [&clock](absl::string_view) { clock.AdvanceTime(absl::Seconds(1)); },
+      nullptr);
+  return transport;
+}
+
+TEST(QueryPlannerTest, ReturnsPartialResultsOnDeadline) {
+  std::string sensor_in_path = GetTestDataDependencyPath(
+      JoinFilePaths(kQuerySamplesLocation, "query_in/sensor_in.textproto"));
+  FakeClock clock(absl::FromUnixSeconds(10));
+  FakeRedfishServer server("indus_hmb_shim/mockup.shar");
+  std::unique_ptr<FakeRedfishTransport> transport =
+      NewClockAdvancingTransport(server, clock);
+  FakeRedfishTransport *transport_ptr = transport.get();
+  auto cache = std::make_unique<NullCache>(transport.get());
+  auto intf = NewHttpInterface(std::move(transport), std::move(cache),
+                               RedfishInterface::kTrusted);
+  RedfishVariant service_root = intf->GetRoot();
+  auto default_normalizer = BuildDefaultNormalizer();
+  DelliciusQuery query_sensor =
+      ParseTextFileAsProtoOrDie<DelliciusQuery>(sensor_in_path);
+  auto qps = BuildDefaultQueryPlanner(
+      query_sensor, RedPathRedfishQueryParams{}, default_normalizer.get());
+  ASSERT_TRUE(qps.ok());
+
+  // Without a deadline, the query completes.
+  size_t start_request_count = transport_ptr->GetRequestCount();
+  DelliciusQueryResult full_result =
+      (*qps)->Run(service_root, clock, nullptr);
+  size_t full_request_count =
+      transport_ptr->GetRequestCount() - start_request_count;
+  ASSERT_TRUE(full_result.subquery_output_by_id().contains("Sensors"));
+  const SubqueryOutput &full_output =
+      full_result.subquery_output_by_id().at("Sensors");
+  EXPECT_FALSE(full_output.has_status());
+  ASSERT_GT(full_output.data_sets_size(), 1);
+
+  // With a deadline, the query stops issuing requests once it passes and
+  // returns the datasets gathered so far.
+  QueryTracker tracker{.deadline =
+                           clock.Now() + absl::Seconds(full_request_count / 2)};
+  start_request_count = transport_ptr->GetRequestCount();
+  DelliciusQueryResult partial_result =
+      (*qps)->Run(service_root, clock, &tracker);
+  EXPECT_LE(transport_ptr->GetRequestCount() - start_request_count,
+            full_request_count / 2);
+  ASSERT_TRUE(partial_result.subquery_output_by_id().contains("Sensors"));
+  const SubqueryOutput &partial_output =
+      partial_result.subquery_output_by_id().at("Sensors");
+  EXPECT_THAT(partial_output.status().code(),
+              Eq(::google::rpc::Code::DEADLINE_EXCEEDED));
+  EXPECT_GT(partial_output.data_sets_size(), 0);
+  EXPECT_LT(partial_output.data_sets_size(), full_output.data_sets_size());
+}
+
+TEST(QueryPlannerTest, ExpiredDeadlineSkipsAllRequests) {
+  std::string sensor_in_path = GetTestDataDependencyPath(
+      JoinFilePaths(kQuerySamplesLocation, "query_in/sensor_in.textproto"));
+  FakeClock clock(absl::FromUnixSeconds(10));
+  FakeRedfishServer server("indus_hmb_shim/mockup.shar");
+  std::unique_ptr<FakeRedfishTransport> transport =
+      NewClockAdvancingTransport(server, clock);
+  FakeRedfishTransport *transport_ptr = transport.get();
+  auto cache = std::make_unique<NullCache>(transport.get());
+  auto intf = NewHttpInterface(std::move(transport), std::move(cache),
+                               RedfishInterface::kTrusted);
+  RedfishVariant service_root = intf->GetRoot();
+  auto default_normalizer = BuildDefaultNormalizer();
+  DelliciusQuery query_sensor =
+      ParseTextFileAsProtoOrDie<DelliciusQuery>(sensor_in_path);
+  auto qps = BuildDefaultQueryPlanner(
+      query_sensor, RedPathRedfishQueryParams{}, default_normalizer.get());
+  ASSERT_TRUE(qps.ok());
+
+  QueryTracker tracker{.deadline = clock.Now()};
+  size_t start_request_count = transport_ptr->GetRequestCount();
+  DelliciusQueryResult result = (*qps)->Run(service_root, clock, &tracker);
+  EXPECT_EQ(transport_ptr->GetRequestCount(), start_request_count);
+  ASSERT_TRUE(result.subquery_output_by_id().contains("Sensors"));
+  EXPECT_THAT(result.subquery_output_by_id().at("Sensors").status().code(),
+              Eq(::google::rpc::Code::DEADLINE_EXCEEDED));
+  EXPECT_EQ(result.subquery_output_by_id().at("Sensors").data_sets_size(), 0);
+}
+
+constexpr absl::string_view kTrayFilterPath =
+    "/redfish/v1/Chassis?$filter=Name%20eq%20%27Tray%27";
+
+// Returns a transport serving a service with three chassis, which advertises
+// $filter support when 'advertise_filter' is set. The chassis collection
+// filtered by name is left to each test.
+std::unique_ptr<FakeRedfishTransport> NewChassisTransport(
+    bool advertise_filter) {
+  auto transport = std::make_unique<FakeRedfishTransport>();
+  transport->SetResource(
+      "/redfish/v1",
+      {{"@odata.id", "/redfish/v1"},
+       {"Chassis", {{"@odata.id", "/redfish/v1/Chassis"}}},
+       {"ProtocolFeaturesSupported", {{"FilterQuery", advertise_filter}}}});
+  nlohmann::json members = nlohmann::json::array();
+  for (absl::string_view name : {"Tray", "Sled", "Fan"}) {
+    std::string uri = absl::StrCat("/redfish/v1/Chassis/", name);
+    transport->SetResource(uri, {{"@odata.id", uri},
+                                 {"Id", std::string(name)},
+                                 {"Name", std::string(name)}});
+    members.push_back({{"@odata.id", uri}});
+  }
+  transport->SetResource(
+      "/redfish/v1/Chassis",
+      {{"@odata.id", "/redfish/v1/Chassis"}, {"Members", members}});
+  return transport;
+}
+
+// Serves the chassis collection filtered to the chassis named 'Tray'.
+void ServeTrayFilter(FakeRedfishTransport &transport) {
+  transport.SetResource(
+      std::string(kTrayFilterPath),
+      {{"@odata.id", "/redfish/v1/Chassis"},
+       {"Members", {{{"@odata.id", "/redfish/v1/Chassis/Tray"}}}}});
+}
+
+// Answers every request without a resource with the HTTP status 'code'.
+void ServeHttpCode(FakeRedfishTransport &transport, int code) {
+  transport.SetDefaultGetHandler(
+      [code](absl::string_view) -> absl::StatusOr<RedfishTransport::Result> {
+        return RedfishTransport::Result{.code = code,
+                                        .body = nlohmann::json::object()};
+      });
+}
+
+// Outcome of running the query for the chassis named 'Tray'.
+struct TrayQueryRun {
+  DelliciusQueryResult result;
+  std::vector<std::string> requested_paths;
+};
+
+TrayQueryRun RunTrayQuery(std::unique_ptr<FakeRedfishTransport> transport) {
+  FakeClock clock(absl::FromUnixSeconds(10));
+  FakeRedfishTransport *transport_ptr = transport.get();
+  auto cache = std::make_unique<NullCache>(transport.get());
+  auto intf = NewHttpInterface(std::move(transport), std::move(cache),
+                               RedfishInterface::kTrusted);
+  RedfishVariant service_root = intf->GetRoot();
+  auto default_normalizer = BuildDefaultNormalizer();
+  DelliciusQuery query = ParseTextProtoOrDie(R"pb(
+    query_id: "TrayCollector"
+    subquery {
+      subquery_id: "Tray"
+      redpath: "/Chassis[Name=Tray]"
+      properties { property: "Id" type: STRING }
+    }
+  )pb");
+  auto qps = BuildDefaultQueryPlanner(query, RedPathRedfishQueryParams{},
+                                      default_normalizer.get());
+  EXPECT_TRUE(qps.ok());
+  TrayQueryRun run;
+  run.result = (*qps)->Run(service_root, clock, nullptr);
+  run.requested_paths = transport_ptr->GetRequestedPaths();
+  return run;
+}
+
+TEST(QueryPlannerTest, PushesPredicateDownAsFilter) {
+  std::unique_ptr<FakeRedfishTransport> transport =
+      NewChassisTransport(/*advertise_filter=*/true);
+  ServeTrayFilter(*transport);
+  TrayQueryRun run = RunTrayQuery(std::move(transport));
+  EXPECT_THAT(run.result.subquery_output_by_id().at("Tray").data_sets(),
+              SizeIs(1));
+  EXPECT_THAT(run.requested_paths,
+              ElementsAre("/redfish/v1", kTrayFilterPath,
+                          "/redfish/v1/Chassis/Tray"));
+}
+
+TEST(QueryPlannerTest, EvaluatesPredicateWhenFilterIsNotSupported) {
+  std::unique_ptr<FakeRedfishTransport> transport =
+      NewChassisTransport(/*advertise_filter=*/false);
+  ServeTrayFilter(*transport);
+  TrayQueryRun run = RunTrayQuery(std::move(transport));
+  EXPECT_THAT(run.result.subquery_output_by_id().at("Tray").data_sets(),
+              SizeIs(1));
+  EXPECT_THAT(run.requested_paths,
+              ElementsAre("/redfish/v1", "/redfish/v1/Chassis",
+                          "/redfish/v1/Chassis/Tray",
+                          "/redfish/v1/Chassis/Sled",
+                          "/redfish/v1/Chassis/Fan"));
+}
+
+TEST(QueryPlannerTest, EvaluatesPredicateWhenFilterIsRejected) {
+  std::unique_ptr<FakeRedfishTransport> transport =
+      NewChassisTransport(/*advertise_filter=*/true);
+  ServeHttpCode(*transport, 400);
+  TrayQueryRun run = RunTrayQuery(std::move(transport));
+  EXPECT_THAT(run.result.subquery_output_by_id().at("Tray").data_sets(),
+              SizeIs(1));
+  EXPECT_THAT(run.requested_paths,
+              ElementsAre("/redfish/v1", kTrayFilterPath,
+                          "/redfish/v1/Chassis", "/redfish/v1/Chassis/Tray",
+                          "/redfish/v1/Chassis/Sled",
+                          "/redfish/v1/Chassis/Fan"));
+}
+
+TEST(QueryPlannerTest, DoesNotRetryWithoutFilterWhenNotFound) {
+  std::unique_ptr<FakeRedfishTransport> transport =
+      NewChassisTransport(/*advertise_filter=*/true);
+  ServeHttpCode(*transport, 404);
+  TrayQueryRun run = RunTrayQuery(std::move(transport));
+  EXPECT_THAT(run.result.subquery_output_by_id(), IsEmpty());
+  EXPECT_THAT(run.requested_paths, ElementsAre("/redfish/v1", kTrayFilterPath));
+}
+
+TEST(QueryPlannerTest, EvaluatesNumericPredicateLocally) {
+  std::unique_ptr<FakeRedfishTransport> transport =
+      NewChassisTransport(/*advertise_filter=*/true);
+  FakeRedfishTransport *transport_ptr = transport.get();
+  FakeClock clock(absl::FromUnixSeconds(10));
+  auto cache = std::make_unique<NullCache>(transport.get());
+  auto intf = NewHttpInterface(std::move(transport), std::move(cache),
+                               RedfishInterface::kTrusted);
+  auto default_normalizer = BuildDefaultNormalizer();
+  // Numeric predicates also match numeric strings, which $filter would not.
+  DelliciusQuery query = ParseTextProtoOrDie(R"pb(
+    query_id: "ChassisCollector"
+    subquery {
+      subquery_id: "Chassis"
+      redpath: "/Chassis[Id>1]"
+      properties { property: "Id" type: STRING }
+    }
+  )pb");
+  auto qps = BuildDefaultQueryPlanner(query, RedPathRedfishQueryParams{},
+                                      default_normalizer.get());
+  ASSERT_TRUE(qps.ok());
+  (*qps)->Run(intf->GetRoot(), clock, nullptr);
+  EXPECT_THAT(transport_ptr->GetRequestedPaths(),
+              ElementsAre("/redfish/v1", "/redfish/v1/Chassis",
+                          "/redfish/v1/Chassis/Tray",
+                          "/redfish/v1/Chassis/Sled",
+                          "/redfish/v1/Chassis/Fan"));
+}
+
+// Returns a transport serving a service with sensors carrying large OEM
+// payloads, which advertises $select support when 'advertise_select' is set.
+// Responses are projected to the properties given in a $select query
+// parameter.
+std::unique_ptr<FakeRedfishTransport> NewSensorTransport(
+    bool advertise_select) {
+  auto transport = std::make_unique<FakeRedfishTransport>();
+  transport->SetResource(
+      "/redfish/v1",
+      {{"@odata.id", "/redfish/v1"},
+       {"Chassis", {{"@odata.id", "/redfish/v1/Chassis"}}},
+       {"ProtocolFeaturesSupported", {{"SelectQuery", advertise_select}}}});
+  transport->SetResource(
+      "/redfish/v1/Chassis",
+      {{"@odata.id", "/redfish/v1/Chassis"},
+       {"Members", {{{"@odata.id", "/redfish/v1/Chassis/1"}}}}});
+  nlohmann::json oem = {{"Blob", std::string(4096, 'x')}};
+  transport->SetResource(
+      "/redfish/v1/Chassis/1",
+      {{"@odata.id", "/redfish/v1/Chassis/1"},
+       {"Id", "1"},
+       {"Sensors", {{"@odata.id", "/redfish/v1/Chassis/1/Sensors"}}},
+       {"Oem", oem}});
+  nlohmann::json members = nlohmann::json::array();
+  for (int i = 0; i < 8; ++i) {
+    std::string uri = absl::StrCat("/redfish/v1/Chassis/1/Sensors/", i);
+    transport->SetResource(
+        uri, {{"@odata.id", uri},
+              {"Id", absl::StrCat(i)},
+              {"Name", absl::StrCat("sensor", i)},
+              {"Reading", i * 10},
+              {"ReadingType", "Temperature"},
+              {"RelatedItem", {{{"@odata.id", "/redfish/v1/Chassis/1"}}}},
+              {"Oem", oem}});
+    members.push_back({{"@odata.id", uri}});
+  }
+  transport->SetResource("/redfish/v1/Chassis/1/Sensors",
+                         {{"@odata.id", "/redfish/v1/Chassis/1/Sensors"},
+                          {"Members", members}});
+
+  FakeRedfishTransport *resources = transport.get();
+  transport->SetDefaultGetHandler(
+      [resources](
+          absl::string_view path) -> absl::StatusOr<RedfishTransport::Result> {
+        std::pair<absl::string_view, absl::string_view> uri_and_query =
+            absl::StrSplit(path, absl::MaxSplits('?', 1));
+        std::optional<nlohmann::json> body =
+            resources->GetResource(uri_and_query.first);
+        if (!body.has_value() ||
+            !absl::ConsumePrefix(&uri_and_query.second, "$select=")) {
+          return absl::NotFoundError(path);
+        }
+        nlohmann::json projected = nlohmann::json::object();
+        for (absl::string_view property :
+             absl::StrSplit(uri_and_query.second, ',')) {
+          if (auto it = body->find(property); it != body->end()) {
+            projected[std::string(property)] = *it;
+          }
+        }
+        return RedfishTransport::Result{.code = 200,
+                                        .body = std::move(projected)};
+      });
+  return transport;
+}
+
+// Outcome of running a sensor query against a NewSensorTransport service.
+struct SensorQueryRun {
+  DelliciusQueryResult result;
+  size_t payload_bytes;
+  std::vector<std::string> requested_paths;
+};
+
+constexpr absl::string_view kTemperatureSensorQuery = R"pb(
+  query_id: "SensorCollector"
+  subquery {
+    subquery_id: "Sensors"
+    redpath: "/Chassis[*]/Sensors[ReadingType=Temperature]"
+    properties { property: "Name" type: STRING }
+    properties { property: "Reading" type: INT64 }
+  }
+)pb";
+
+SensorQueryRun RunSensorQuery(
+    bool advertise_select,
+    absl::string_view query_text = kTemperatureSensorQuery) {
+  FakeClock clock(absl::FromUnixSeconds(10));
+  std::unique_ptr<FakeRedfishTransport> transport =
+      NewSensorTransport(advertise_select);
+  FakeRedfishTransport *transport_ptr = transport.get();
+  auto cache = std::make_unique<NullCache>(transport.get());
+  auto intf = NewHttpInterface(std::move(transport), std::move(cache),
+                               RedfishInterface::kTrusted);
+  auto default_normalizer = BuildDefaultNormalizer();
+  DelliciusQuery query = ParseTextProtoOrDie(std::string(query_text));
+  auto qps = BuildDefaultQueryPlanner(query, RedPathRedfishQueryParams{},
+                                      default_normalizer.get());
+  EXPECT_TRUE(qps.ok());
+  SensorQueryRun run;
+  run.result = (*qps)->Run(intf->GetRoot(), clock, nullptr);
+  run.payload_bytes = transport_ptr->GetServedBytes();
+  run.requested_paths = transport_ptr->GetRequestedPaths();
+  return run;
+}
+
+TEST(QueryPlannerTest, SelectsOnlyQueriedProperties) {
+  SensorQueryRun unprojected = RunSensorQuery(/*advertise_select=*/false);
+  SensorQueryRun projected = RunSensorQuery(/*advertise_select=*/true);
+
+  const auto &data_sets =
+      projected.result.subquery_output_by_id().at("Sensors").data_sets();
+  ASSERT_THAT(data_sets, SizeIs(8));
+  ASSERT_THAT(data_sets[1].properties(), SizeIs(2));
+  EXPECT_EQ(data_sets[1].properties(0).string_value(), "sensor1");
+  EXPECT_EQ(data_sets[1].properties(1).int64_value(), 10);
+  for (int i = 0; i < data_sets.size(); ++i) {
+    EXPECT_THAT(data_sets[i],
+                EqualsProto(unprojected.result.subquery_output_by_id()
+                                .at("Sensors")
+                                .data_sets(i)));
+  }
+
+  for (const std::string &path : unprojected.requested_paths) {
+    EXPECT_THAT(path, Not(HasSubstr("$select=")));
+  }
+  // Members are fetched with the queried properties, including those the
+  // predicate depends on.
+  EXPECT_THAT(projected.requested_paths,
+              Contains(AllOf(StartsWith("/redfish/v1/Chassis/1/Sensors/0?"
+                                        "$select=@odata.id,"),
+                             HasSubstr(",Reading,ReadingType,"))));
+  // The OEM payloads are no longer transferred.
+  EXPECT_LT(projected.payload_bytes * 10, unprojected.payload_bytes);
+}
+
+TEST(QueryPlannerTest, SelectsArrayPropertiesByName) {
+  constexpr absl::string_view kRelatedItemQuery = R"pb(
+    query_id: "SensorCollector"
+    subquery {
+      subquery_id: "Sensors"
+      redpath: "/Chassis[*]/Sensors[*]"
+      properties { property: "Name" type: STRING }
+      properties { property: "RelatedItem[0].@odata\\.id" type: STRING }
+    }
+  )pb";
+  SensorQueryRun projected =
+      RunSensorQuery(/*advertise_select=*/true, kRelatedItemQuery);
+
+  const auto &data_sets =
+      projected.result.subquery_output_by_id().at("Sensors").data_sets();
+  ASSERT_THAT(data_sets, SizeIs(8));
+  ASSERT_THAT(data_sets[0].properties(), SizeIs(2));
+  EXPECT_EQ(data_sets[0].properties(1).string_value(),
+            "/redfish/v1/Chassis/1");
+  // The array is selected by its name, without the index.
+  EXPECT_THAT(projected.requested_paths,
+              Contains(AllOf(StartsWith("/redfish/v1/Chassis/1/Sensors/0?"
+                                        "$select="),
+                             HasSubstr(",RelatedItem"))));
+  for (const std::string &path : projected.requested_paths) {
+    EXPECT_THAT(path, Not(HasSubstr("RelatedItem[")));
+  }
+}
+
 }  // namespace
 
 }  // namespace ecclesia
@@ -0,0 +1,255 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ecclesia/lib/redfish/dellicius/engine/internal/query_profiler.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "ecclesia/lib/file/path.h"
+#include "ecclesia/lib/file/test_filesystem.h"
+#include "ecclesia/lib/protobuf/parse.h"
+#include "ecclesia/lib/redfish/dellicius/engine/factory.h"
+#include "ecclesia/lib/redfish/dellicius/engine/internal/interface.h"
+#include "ecclesia/lib/redfish/dellicius/engine/internal/query_planner.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_profile.pb.h"
+#include "ecclesia/lib/redfish/dellicius/query/query.pb.h"
+#include "ecclesia/lib/redfish/interface.h"
+#include "ecclesia/lib/redfish/testing/fake_redfish_server.h"
+#include "ecclesia/lib/redfish/transport/cache.h"
+#include "ecclesia/lib/redfish/transport/http_redfish_intf.h"
+#include "ecclesia/lib/redfish/transport/interface.h"
+#include "ecclesia/lib/time/clock_fake.h"
+#include "single_include/nlohmann/json.hpp"
+
+namespace ecclesia {
+namespace {
+
+using ::testing::Eq;
+using ::testing::Gt;
+using ::testing::SizeIs;
+
+constexpr absl::string_view kQuerySamplesLocation =
+    "lib/redfish/dellicius/query/samples";
+
+const QueryProfile::StepProfile *FindStep(const QueryProfile &profile,
+                                          absl::string_view redpath) {
+  for (const QueryProfile::StepProfile &step : profile.steps()) {
+    if (step.redpath() == redpath) return &step;
+  }
+  return nullptr;
+}
+
+class QueryProfilerTest : public ::testing::Test {
+ protected:
+  QueryProfilerTest()
+      : server_("indus_hmb_shim/mockup.shar"),
+        clock_(absl::FromUnixSeconds(10)),
+        normalizer_(BuildDefaultNormalizer()) {
+    intf_ = NewHttpInterface(
+        std::make_unique<ProfilingRedfishTransport>(
+            server_.RedfishClientTransport()),
+        [this](RedfishTransport *transport) {
+          return std::make_unique<TimeBasedCache>(transport, &clock_,
+                                                  absl::InfiniteDuration());
+        },
+        RedfishInterface::kTrusted);
+    DelliciusQuery query = ParseTextFileAsProtoOrDie<DelliciusQuery>(
+        GetTestDataDependencyPath(JoinFilePaths(
+            kQuerySamplesLocation, "query_in/sensor_in.textproto")));
+    auto query_planner = BuildDefaultQueryPlanner(
+        query, RedPathRedfishQueryParams{}, normalizer_.get());
+    EXPECT_TRUE(query_planner.ok());
+    planner_ = *std::move(query_planner);
+  }
+
+  QueryProfile ProfileQuery(QueryProfiler &profiler) {
+    QueryTracker tracker{.profiler = &profiler};
+    planner_->Run(intf_->GetRoot(), clock_, &tracker);
+    return profiler.ToProto();
+  }
+
+  FakeRedfishServer server_;
+  FakeClock clock_;
+  std::unique_ptr<Normalizer> normalizer_;
+  std::unique_ptr<RedfishInterface> intf_;
+  std::unique_ptr<QueryPlannerInterface> planner_;
+};
+
+TEST_F(QueryProfilerTest, RecordsFetchesAndPredicatesPerStep) {
+  QueryProfiler profiler(&clock_);
+  QueryProfile profile = ProfileQuery(profiler);
+  ASSERT_THAT(profile.steps(), SizeIs(2));
+
+  const QueryProfile::StepProfile *chassis = FindStep(profile, "/Chassis");
+  ASSERT_NE(chassis, nullptr);
+  EXPECT_THAT(chassis->execution_count(), Eq(1));
+  // The collection and each of its members are fetched once.
+  EXPECT_THAT(chassis->request_count(), Gt(1));
+  EXPECT_THAT(chassis->fetch_count(), Eq(chassis->request_count()));
+  EXPECT_THAT(chassis->cache_hit_count(), Eq(0));
+  // The '[*]' predicate is evaluated once per member.
+  EXPECT_THAT(chassis->predicate_evaluation_count(),
+              Eq(chassis->request_count() - 1));
+
+  const QueryProfile::StepProfile *sensors =
+      FindStep(profile, "/Chassis[*]/Sensors");
+  ASSERT_NE(sensors, nullptr);
+  EXPECT_THAT(sensors->execution_count(), Eq(chassis->request_count() - 1));
+  EXPECT_THAT(sensors->fetch_count(), Gt(0));
+  EXPECT_THAT(sensors->predicate_evaluation_count(), Gt(0));
+}
+
+TEST_F(QueryProfilerTest, RecordsCacheHits) {
+  // Warm up the cache.
+  QueryProfiler warm_up_profiler(&clock_);
+  ProfileQuery(warm_up_profiler);
+
+  QueryProfiler profiler(&clock_);
+  QueryProfile profile = ProfileQuery(profiler);
+  ASSERT_THAT(profile.steps(), SizeIs(2));
+  for (const QueryProfile::StepProfile &step : profile.steps()) {
+    EXPECT_THAT(step.fetch_count(), Eq(0)) << step.redpath();
+    EXPECT_THAT(step.payload_bytes(), Eq(0)) << step.redpath();
+    EXPECT_THAT(step.cache_hit_count(), Eq(step.request_count()))
+        << step.redpath();
+  }
+}
+
+TEST_F(QueryProfilerTest, ExportsChromeTrace) {
+  QueryProfiler profiler(&clock_);
+  QueryProfile profile = ProfileQuery(profiler);
+  size_t execution_count = 0;
+  for (const QueryProfile::StepProfile &step : profile.steps()) {
+    execution_count += step.execution_count();
+  }
+
+  nlohmann::json trace = nlohmann::json::parse(profiler.ToChromeTraceJson());
+  ASSERT_TRUE(trace.contains("traceEvents"));
+  ASSERT_THAT(trace["traceEvents"], SizeIs(execution_count));
+  EXPECT_EQ(trace["traceEvents"][0]["name"], "/Chassis");
+  EXPECT_EQ(trace["traceEvents"][0]["ph"], "X");
+}
+
+TEST_F(QueryProfilerTest, BoundsTraceEvents) {
+  QueryProfiler profiler(&clock_, {.max_trace_events = 1});
+  QueryProfile profile = ProfileQuery(profiler);
+  EXPECT_THAT(profile.dropped_trace_events(), Gt(0));
+
+  nlohmann::json trace = nlohmann::json::parse(profiler.ToChromeTraceJson());
+  EXPECT_THAT(trace["traceEvents"], SizeIs(1));
+}
+
+// Transport returning an empty JSON payload with a fixed Content-Length.
+class ContentLengthTransport : public NullTransport {
+ public:
+  absl::StatusOr<Result> Get(absl::string_view path) override {
+    return Result{.code = 200,
+                  .body = nlohmann::json::object(),
+                  .headers = {{"Content-Length", "128"}}};
+  }
+};
+
+TEST(ProfilingRedfishTransportTest, AttributesPayloadBytesToActiveStep) {
+  FakeClock clock(absl::FromUnixSeconds(10));
+  QueryProfiler profiler(&clock);
+  ProfilingRedfishTransport transport(
+      std::make_unique<ContentLengthTransport>());
+  // Fetches outside a step are not recorded.
+  ASSERT_TRUE(transport.Get("/redfish/v1").ok());
+  {
+    QueryProfiler::StepScope step_scope(&profiler, "/Chassis");
+    clock.AdvanceTime(absl::Milliseconds(3));
+    ASSERT_TRUE(transport.Get("/redfish/v1/Chassis").ok());
+    ASSERT_TRUE(transport.Get("/redfish/v1/Chassis/1").ok());
+  }
+
+  QueryProfile profile = profiler.ToProto();
+  ASSERT_THAT(profile.steps(), SizeIs(1));
+  EXPECT_THAT(profile.steps(0).fetch_count(), Eq(2));
+  EXPECT_THAT(profile.steps(0).payload_bytes(), Eq(256));
+  EXPECT_THAT(profile.steps(0).wall_time_us(), Eq(3000));
+}
+
+// Transport returning a parsed JSON payload without a Content-Length.
+class JsonTransport : public NullTransport {
+ public:
+  static nlohmann::json Payload() {
+    return {{"@odata.id", "/redfish/v1/Chassis/1"}, {"Name", "chassis"}};
+  }
+
+  absl::StatusOr<Result> Get(absl::string_view path) override {
+    return Result{.code = 200, .body = Payload()};
+  }
+};
+
+TEST(ProfilingRedfishTransportTest, SizesParsedPayloads) {
+  FakeClock clock(absl::FromUnixSeconds(10));
+  QueryProfiler profiler(&clock);
+  ProfilingRedfishTransport transport(std::make_unique<JsonTransport>());
+  {
+    QueryProfiler::StepScope step_scope(&profiler, "/Chassis");
+    ASSERT_TRUE(transport.Get("/redfish/v1/Chassis/1").ok());
+  }
+
+  QueryProfile profile = profiler.ToProto();
+  ASSERT_THAT(profile.steps(), SizeIs(1));
+  EXPECT_THAT(profile.steps(0).fetch_count(), Eq(1));
+  EXPECT_THAT(profile.steps(0).payload_bytes(),
+              Eq(JsonTransport::Payload().dump().size()));
+}
+
+TEST(ProfilingRedfishTransportTest, AttributesBoundWorkToActiveStep) {
+  FakeClock clock(absl::FromUnixSeconds(10));
+  QueryProfiler profiler(&clock);
+  ProfilingRedfishTransport transport(
+      std::make_unique<ContentLengthTransport>());
+  // Work bound outside a step is not recorded.
+  std::thread(transport.BindToCallingThread([&transport]() {
+    ASSERT_TRUE(transport.Get("/redfish/v1").ok());
+  })).join();
+  {
+    QueryProfiler::StepScope step_scope(&profiler, "/Chassis");
+    // A request served without fetching is a cache hit.
+    step_scope.Request([]() { return RedfishVariant(absl::OkStatus()); });
+    // A request fetching on another thread is not.
+    step_scope.Request([&transport]() {
+      std::thread(transport.BindToCallingThread([&transport]() {
+        ASSERT_TRUE(transport.Get("/redfish/v1/Chassis/1").ok());
+      })).join();
+      return RedfishVariant(absl::OkStatus());
+    });
+  }
+
+  QueryProfile profile = profiler.ToProto();
+  ASSERT_THAT(profile.steps(), SizeIs(1));
+  EXPECT_THAT(profile.steps(0).request_count(), Eq(2));
+  EXPECT_THAT(profile.steps(0).cache_hit_count(), Eq(1));
+  EXPECT_THAT(profile.steps(0).fetch_count(), Eq(1));
+  EXPECT_THAT(profile.steps(0).payload_bytes(), Eq(128));
+}
+
+}  // namespace
+}  // namespace ecclesia
@@ -0,0 +1,244 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ecclesia/lib/redfish/dellicius/engine/query_scheduler.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "google/rpc/code.pb.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "ecclesia/lib/redfish/dellicius/engine/internal/interface.h"
+#include "ecclesia/lib/redfish/dellicius/engine/internal/passkey.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_engine.h"
+#include "ecclesia/lib/redfish/dellicius/query/query_result.pb.h"
+#include "ecclesia/lib/redfish/interface.h"
+#include "ecclesia/lib/redfish/node_topology.h"
+#include "ecclesia/lib/testing/status.h"
+#include "ecclesia/lib/time/clock_fake.h"
+
+namespace ecclesia {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::Ge;
+using ::testing::Lt;
+using ::testing::SizeIs;
+
+using QueryBatches = std::vector<std::vector<std::string>>;
+
+// Query engine recording each batch of query ids it executes. Results carry
+// only the query id. Queries named "Unknown" have no query plan.
+class RecordingQueryEngine : public QueryEngine::QueryEngineIntf {
+ public:
+  explicit RecordingQueryEngine(QueryBatches &batches) : batches_(batches) {}
+
+  std::vector<DelliciusQueryResult> ExecuteQuery(
+      QueryEngine::ServiceRootType service_root_uri,
+      absl::Span<const absl::string_view> query_ids) override {
+    batches_.emplace_back(query_ids.begin(), query_ids.end());
+    std::vector<DelliciusQueryResult> results;
+    for (absl::string_view query_id : query_ids) {
+      if (query_id == "Unknown") continue;
+      results.emplace_back().set_query_id(std::string(query_id));
+    }
+    return results;
+  }
+  std::vector<DelliciusQueryResult> ExecuteQuery(
+      QueryEngine::ServiceRootType service_root_uri,
+      absl::Span<const absl::string_view> query_ids,
+      QueryTracker &tracker) override {
+    return ExecuteQuery(service_root_uri, query_ids);
+  }
+  std::vector<DelliciusQueryResult> ExecuteQueryWithMetrics(
+      QueryEngine::ServiceRootType service_root_uri,
+      absl::Span<const absl::string_view> query_ids,
+      RedfishMetrics *transport_metrics) override {
+    return ExecuteQuery(service_root_uri, query_ids);
+  }
+  const NodeTopology &GetTopology() override { return topology_; }
+  absl::StatusOr<RedfishInterface *> GetRedfishInterface(
+      RedfishInterfacePasskey unused_passkey) override {
+    return absl::UnimplementedError("No Redfish interface");
+  }
+
+ private:
+  QueryBatches &batches_;
+  NodeTopology topology_;
+};
+
+class QuerySchedulerTest : public ::testing::Test {
+ protected:
+  QuerySchedulerTest()
+      : engine_(std::make_unique<RecordingQueryEngine>(batches_)),
+        clock_(absl::UnixEpoch() + absl::Seconds(100)) {}
+
+  QueryBatches batches_;
+  QueryEngine engine_;
+  FakeClock clock_;
+};
+
+TEST_F(QuerySchedulerTest, CoalescesSubscriptionsDueInSameTick) {
+  QueryScheduler scheduler(engine_, &clock_);
+  std::vector<std::string> received;
+  auto record = [&received](const DelliciusQueryResult &result) {
+    received.push_back(result.query_id());
+  };
+  ASSERT_THAT(scheduler.Subscribe("Sensors", absl::Seconds(10), record),
+              IsOk());
+  ASSERT_THAT(scheduler.Subscribe("Sensors", absl::Seconds(10), record),
+              IsOk());
+  ASSERT_THAT(scheduler.Subscribe("Assemblies", absl::Seconds(30), record),
+              IsOk());
+
+  // Both intervals are aligned to the epoch, so Sensors is due at 100s and
+  // every 10s after, while Assemblies is first due at 120s.
+  EXPECT_THAT(scheduler.RunDueSubscriptions(),
+              Eq(absl::UnixEpoch() + absl::Seconds(110)));
+  clock_.AdvanceTime(absl::Seconds(10));
+  EXPECT_THAT(scheduler.RunDueSubscriptions(),
+              Eq(absl::UnixEpoch() + absl::Seconds(120)));
+  clock_.AdvanceTime(absl::Seconds(10));
+  scheduler.RunDueSubscriptions();
+
+  // Each query runs once per tick regardless of the number of subscribers.
+  EXPECT_THAT(batches_,
+              ElementsAre(ElementsAre("Sensors"), ElementsAre("Sensors"),
+                          ElementsAre("Sensors", "Assemblies")));
+  EXPECT_THAT(received, SizeIs(7));
+  EXPECT_THAT(scheduler.skipped_runs(), Eq(0));
+}
+
+TEST_F(QuerySchedulerTest, NothingRunsBeforeDue) {
+  QueryScheduler scheduler(engine_, &clock_);
+  ASSERT_THAT(scheduler.Subscribe("Sensors", absl::Seconds(30),
+                                  [](const DelliciusQueryResult &) {}),
+              IsOk());
+  EXPECT_THAT(scheduler.RunDueSubscriptions(),
+              Eq(absl::UnixEpoch() + absl::Seconds(120)));
+  EXPECT_THAT(batches_, SizeIs(0));
+}
+
+TEST_F(QuerySchedulerTest, SkipsLateRuns) {
+  QueryScheduler scheduler(engine_, &clock_);
+  int run_count = 0;
+  ASSERT_THAT(scheduler.Subscribe(
+                  "Sensors", absl::Seconds(10),
+                  [&run_count](const DelliciusQueryResult &) { ++run_count; }),
+              IsOk());
+  scheduler.RunDueSubscriptions();
+
+  // The runs due at 110s, 120s and 130s are late at 135s. One run catches up
+  // and the other two are skipped.
+  clock_.AdvanceTime(absl::Seconds(35));
+  EXPECT_THAT(scheduler.RunDueSubscriptions(),
+              Eq(absl::UnixEpoch() + absl::Seconds(140)));
+  EXPECT_THAT(run_count, Eq(2));
+  EXPECT_THAT(scheduler.skipped_runs(), Eq(2));
+}
+
+TEST_F(QuerySchedulerTest, UnsubscribeStopsRuns) {
+  QueryScheduler scheduler(engine_, &clock_);
+  absl::StatusOr<QueryScheduler::SubscriptionId> id = scheduler.Subscribe(
+      "Sensors", absl::Seconds(10), [](const DelliciusQueryResult &) {});
+  ASSERT_THAT(id, IsOk());
+  ASSERT_THAT(scheduler.Unsubscribe(*id), IsOk());
+  EXPECT_THAT(scheduler.Unsubscribe(*id).code(),
+              Eq(absl::StatusCode::kNotFound));
+  EXPECT_THAT(scheduler.RunDueSubscriptions(), Eq(absl::InfiniteFuture()));
+  EXPECT_THAT(batches_, SizeIs(0));
+}
+
+TEST_F(QuerySchedulerTest, ValidatesAndRoundsIntervals) {
+  QueryScheduler scheduler(engine_, &clock_, {.tick = absl::Seconds(2)});
+  EXPECT_THAT(scheduler
+                  .Subscribe("Sensors", absl::ZeroDuration(),
+                             [](const DelliciusQueryResult &) {})
+                  .status()
+                  .code(),
+              Eq(absl::StatusCode::kInvalidArgument));
+
+  // 3s is rounded up to 4s.
+  ASSERT_THAT(scheduler.Subscribe("Sensors", absl::Seconds(3),
+                                  [](const DelliciusQueryResult &) {}),
+              IsOk());
+  EXPECT_THAT(scheduler.RunDueSubscriptions(),
+              Eq(absl::UnixEpoch() + absl::Seconds(104)));
+}
+
+TEST_F(QuerySchedulerTest, ReportsUnknownQueries) {
+  QueryScheduler scheduler(engine_, &clock_);
+  int32_t code = google::rpc::Code::OK;
+  ASSERT_THAT(scheduler.Subscribe("Unknown", absl::Seconds(10),
+                                  [&code](const DelliciusQueryResult &result) {
+                                    code = result.status().code();
+                                  }),
+              IsOk());
+  scheduler.RunDueSubscriptions();
+  EXPECT_THAT(code, Eq(google::rpc::Code::NOT_FOUND));
+}
+
+TEST_F(QuerySchedulerTest, JitterOffsetsRuns) {
+  constexpr absl::Duration kMaxJitter = absl::Seconds(5);
+  QueryScheduler scheduler(engine_, &clock_,
+                           {.max_jitter = kMaxJitter, .jitter_key = "bmc0"});
+  ASSERT_THAT(scheduler.Subscribe("Sensors", absl::Seconds(10),
+                                  [](const DelliciusQueryResult &) {}),
+              IsOk());
+  absl::Time first_run = scheduler.RunDueSubscriptions();
+  if (!batches_.empty()) {
+    // The jittered run fell on the current time.
+    first_run -= absl::Seconds(10);
+  }
+  absl::Duration offset = first_run - (absl::UnixEpoch() + absl::Seconds(100));
+  EXPECT_THAT(offset, Ge(absl::ZeroDuration()));
+  EXPECT_THAT(offset, Lt(kMaxJitter));
+  // The jitter of a key does not change from one process to the next.
+  EXPECT_THAT(offset, Eq(absl::Nanoseconds(2900472451)));
+
+  // Later runs keep the offset.
+  clock_.AdvanceTime(first_run - clock_.Now());
+  EXPECT_THAT(scheduler.RunDueSubscriptions(),
+              Eq(first_run + absl::Seconds(10)));
+}
+
+TEST_F(QuerySchedulerTest, RunsUntilStopped) {
+  QueryScheduler scheduler(engine_, &clock_);
+  int run_count = 0;
+  ASSERT_THAT(scheduler.Subscribe("Sensors", absl::Seconds(10),
+                                  [&](const DelliciusQueryResult &) {
+                                    if (++run_count == 3) scheduler.Stop();
+                                  }),
+              IsOk());
+  // The fake clock advances on each sleep, so this returns after the third
+  // run at 120s.
+  scheduler.Run();
+  EXPECT_THAT(run_count, Eq(3));
+  EXPECT_THAT(clock_.Now(), Eq(absl::UnixEpoch() + absl::Seconds(120)));
+  EXPECT_THAT(scheduler.skipped_runs(), Eq(0));
+}
+
+}  // namespace
+}  // namespace ecclesia
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ecclesia/lib/redfish/dellicius/engine/query_compiler.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "ecclesia/lib/redfish/dellicius/engine/compiled_query.pb.h"
+#include "ecclesia/lib/redfish/dellicius/engine/internal/interface.h"
+#include "ecclesia/lib/redfish/dellicius/engine/internal/query_planner.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_rules.pb.h"
+#include "ecclesia/lib/redfish/dellicius/query/query.pb.h"
+#include "ecclesia/lib/redfish/dellicius/utils/parsers.h"
+#include "ecclesia/lib/status/macros.h"
+
+namespace ecclesia {
+
+absl::StatusOr<CompiledQuery> CompileQuery(const DelliciusQuery &query,
+                                           const QueryRules &query_rules) {
+  CompiledQuery compiled_query;
+  *compiled_query.mutable_query() = query;
+  for (const DelliciusQuery::Subquery &subquery : query.subquery()) {
+    ECCLESIA_ASSIGN_OR_RETURN(std::vector<RedPathStep> steps,
+                              RedPathToSteps(subquery.redpath()));
+    CompiledQuery::CompiledRedPath &compiled_redpath =
+        (*compiled_query.mutable_subquery_redpaths())[subquery.subquery_id()];
+    for (auto &[node_name, predicate] : steps) {
+      CompiledQuery::RedPathStep *step = compiled_redpath.add_steps();
+      step->set_node_name(std::move(node_name));
+      step->set_predicate(std::move(predicate));
+    }
+  }
+  if (auto iter = query_rules.query_id_to_params_rule().find(query.query_id());
+      iter != query_rules.query_id_to_params_rule().end()) {
+    *compiled_query.mutable_query_rules() = iter->second;
+  }
+
+  // Build the query plan to validate subquery links.
+  absl::StatusOr<std::unique_ptr<QueryPlannerInterface>> query_planner =
+      BuildDefaultQueryPlanner(compiled_query,
+                               ParseQueryRules(compiled_query.query_rules()),
+                               nullptr);
+  if (!query_planner.ok()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Cannot create query plan for ", query.query_id(), ": ",
+                     query_planner.status().message()));
+  }
+  return compiled_query;
+}
+
+}  // namespace ecclesia
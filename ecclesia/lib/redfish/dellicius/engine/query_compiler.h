@@ -0,0 +1,38 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ECCLESIA_LIB_REDFISH_DELLICIUS_ENGINE_QUERY_COMPILER_H_
+#define ECCLESIA_LIB_REDFISH_DELLICIUS_ENGINE_QUERY_COMPILER_H_
+
+#include "absl/status/statusor.h"
+#include "ecclesia/lib/redfish/dellicius/engine/compiled_query.pb.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_rules.pb.h"
+#include "ecclesia/lib/redfish/dellicius/query/query.pb.h"
+
+namespace ecclesia {
+
+// Compiles 'query' into a CompiledQuery that a query engine loads without any
+// text parsing. The RedPath of each subquery is split into location steps and
+// the rules in 'query_rules' for the query id, if any, are embedded.
+//
+// The query plan is built once to validate the query, so that malformed
+// RedPaths and subquery links fail at build time rather than at startup.
+absl::StatusOr<CompiledQuery> CompileQuery(const DelliciusQuery &query,
+                                           const QueryRules &query_rules = {});
+
+}  // namespace ecclesia
+
+#endif  // ECCLESIA_LIB_REDFISH_DELLICIUS_ENGINE_QUERY_COMPILER_H_
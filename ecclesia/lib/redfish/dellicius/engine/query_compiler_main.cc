@@ -0,0 +1,99 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This is a command-line utility that compiles a RedPath query textproto into
+// a binary CompiledQuery proto.
+//
+// The utility takes the path of a single query textproto. Query rules that
+// apply to the query can be given in a QueryRules textproto with
+// --query_rules. The compiled query is written to the path given by --output.
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/log/log.h"
+#include "absl/status/statusor.h"
+#include "ecclesia/lib/redfish/dellicius/engine/compiled_query.pb.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_compiler.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_rules.pb.h"
+#include "ecclesia/lib/redfish/dellicius/query/query.pb.h"
+#include "google/protobuf/text_format.h"
+
+ABSL_FLAG(std::string, query_rules, "",
+          "Optional path to a QueryRules textproto with rules for the query.");
+ABSL_FLAG(std::string, output, "",
+          "Path where the binary CompiledQuery proto should be written.");
+
+namespace ecclesia {
+namespace {
+
+// Reads the textproto at 'path' into 'message'. Terminates on failure.
+void ReadTextProtoOrDie(const std::string &path,
+                        google::protobuf::Message &message) {
+  std::fstream in_f(path, in_f.binary | in_f.in);
+  if (!in_f.is_open()) LOG(FATAL) << "unable to open " << path;
+  std::stringstream buffer;
+  buffer << in_f.rdbuf();
+  if (!google::protobuf::TextFormat::ParseFromString(buffer.str(), &message)) {
+    LOG(FATAL) << "unable to parse " << path;
+  }
+}
+
+}  // namespace
+
+int RealMain(int argc, char *argv[]) {
+  std::vector<char *> args = absl::ParseCommandLine(argc, argv);
+
+  // Make sure all of the required flags were specified.
+  if (absl::GetFlag(FLAGS_output).empty()) {
+    LOG(FATAL) << "output was not specified";
+  }
+  if (args.size() != 2) {
+    LOG(FATAL) << "expected exactly one query file";
+  }
+
+  DelliciusQuery query;
+  ReadTextProtoOrDie(args[1], query);
+  QueryRules query_rules;
+  if (!absl::GetFlag(FLAGS_query_rules).empty()) {
+    ReadTextProtoOrDie(absl::GetFlag(FLAGS_query_rules), query_rules);
+  }
+
+  absl::StatusOr<CompiledQuery> compiled_query =
+      CompileQuery(query, query_rules);
+  if (!compiled_query.ok()) {
+    LOG(FATAL) << "unable to compile " << args[1] << ": "
+               << compiled_query.status();
+  }
+
+  std::fstream out_f(absl::GetFlag(FLAGS_output),
+                     out_f.binary | out_f.trunc | out_f.out);
+  if (!out_f.is_open()) {
+    LOG(FATAL) << "unable to open " << absl::GetFlag(FLAGS_output);
+  }
+  if (!compiled_query->SerializeToOstream(&out_f)) {
+    LOG(FATAL) << "unable to write " << absl::GetFlag(FLAGS_output);
+  }
+  return 0;
+}
+
+}  // namespace ecclesia
+
+int main(int argc, char *argv[]) { return ecclesia::RealMain(argc, argv); }
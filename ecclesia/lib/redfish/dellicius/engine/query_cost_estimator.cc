@@ -0,0 +1,334 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "ecclesia/lib/redfish/dellicius/engine/query_cost_estimator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
+#include "ecclesia/lib/redfish/dellicius/engine/factory.h"
+#include "ecclesia/lib/redfish/dellicius/engine/internal/interface.h"
+#include "ecclesia/lib/redfish/dellicius/engine/internal/query_planner.h"
+#include "ecclesia/lib/redfish/dellicius/engine/internal/query_profiler.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_cost_estimate.pb.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_profile.pb.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_rules.pb.h"
+#include "ecclesia/lib/redfish/dellicius/query/query.pb.h"
+#include "ecclesia/lib/redfish/dellicius/utils/parsers.h"
+#include "ecclesia/lib/redfish/interface.h"
+#include "ecclesia/lib/redfish/transport/cache.h"
+#include "ecclesia/lib/redfish/transport/http_redfish_intf.h"
+#include "ecclesia/lib/redfish/transport/interface.h"
+#include "ecclesia/lib/status/macros.h"
+#include "ecclesia/lib/time/clock.h"
+#include "single_include/nlohmann/json.hpp"
+
+namespace ecclesia {
+
+namespace {
+
+// Profiler step the request for the service root is attributed to.
+constexpr absl::string_view kServiceRootStep = "/";
+
+// Profile of a single execution of a query.
+struct QueryExecution {
+  QueryProfile profile;
+  absl::flat_hash_map<std::string, size_t> redpath_node_counts;
+};
+
+// Executes 'query' with 'query_params' without a cache and profiles the
+// Redfish requests issued by each RedPath step.
+absl::StatusOr<QueryExecution> ExecuteQuery(
+    const DelliciusQuery &query, RedPathRedfishQueryParams query_params,
+    absl::FunctionRef<std::unique_ptr<RedfishTransport>()> transport_factory) {
+  std::unique_ptr<Normalizer> normalizer = BuildDefaultNormalizer();
+  ECCLESIA_ASSIGN_OR_RETURN(
+      std::unique_ptr<QueryPlannerInterface> planner,
+      BuildDefaultQueryPlanner(query, std::move(query_params),
+                               normalizer.get()));
+  std::unique_ptr<RedfishTransport> transport = transport_factory();
+  if (transport == nullptr) {
+    return absl::InvalidArgumentError("No Redfish transport to query");
+  }
+  std::unique_ptr<RedfishInterface> intf = NewHttpInterface(
+      std::make_unique<ProfilingRedfishTransport>(std::move(transport)),
+      NullCache::Create, RedfishInterface::kTrusted);
+
+  const Clock *clock = Clock::RealClock();
+  QueryProfiler profiler(clock);
+  QueryTracker tracker{.profiler = &profiler};
+  RedfishVariant root = [&]() {
+    QueryProfiler::StepScope step_scope(&profiler, kServiceRootStep);
+    return step_scope.Request([&]() { return intf->GetRoot(); });
+  }();
+  ECCLESIA_RETURN_IF_ERROR(root.status());
+  planner->Run(root, *clock, &tracker);
+  return QueryExecution{
+      .profile = profiler.ToProto(),
+      .redpath_node_counts = std::move(tracker.redpath_node_counts)};
+}
+
+// Returns true if the query planner evaluates 'predicate' on every member of
+// a collection. This holds for any predicate other than '[*]', as members are
+// fetched before index and filter predicates are tested, unless the predicate
+// is sent to the service as $filter and only matching members are returned.
+bool IsFullScanPredicate(absl::string_view predicate) {
+  return !predicate.empty() && predicate != "*" &&
+         !PredicateToFilterExpression(predicate).has_value();
+}
+
+// Builds the plan tree of subqueries and records the full collection scans of
+// each subquery.
+class PlanBuilder {
+ public:
+  PlanBuilder(const DelliciusQuery &query,
+              const absl::flat_hash_map<std::string, size_t> &node_counts,
+              QueryCostEstimate &estimate)
+      : node_counts_(node_counts), estimate_(estimate) {
+    for (const DelliciusQuery::Subquery &subquery : query.subquery()) {
+      if (subquery.root_subquery_ids().empty()) {
+        roots_.push_back(&subquery);
+        continue;
+      }
+      for (const std::string &parent_id : subquery.root_subquery_ids()) {
+        parent_to_children_[parent_id].push_back(&subquery);
+      }
+    }
+  }
+
+  absl::Status Build() {
+    for (const DelliciusQuery::Subquery *subquery : roots_) {
+      ECCLESIA_RETURN_IF_ERROR(
+          AddPlanNode(*subquery, "", *estimate_.add_plan()));
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  // Populates 'node' for 'subquery' executing relative to 'executed_redpath',
+  // which is the RedPath last executed for the parent subquery as recorded by
+  // the query tracker.
+  absl::Status AddPlanNode(const DelliciusQuery::Subquery &subquery,
+                           std::string executed_redpath,
+                           QueryCostEstimate::PlanNode &node) {
+    if (!active_subquery_ids_.insert(subquery.subquery_id()).second) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Subquery ", subquery.subquery_id(),
+                       " is linked to itself"));
+    }
+    node.set_subquery_id(subquery.subquery_id());
+    node.set_redpath(subquery.redpath());
+    ECCLESIA_ASSIGN_OR_RETURN(std::vector<RedPathStep> steps,
+                              RedPathToSteps(subquery.redpath()));
+    std::string step_redpath;
+    for (const auto &[node_name, predicate] : steps) {
+      // The service root has no location step.
+      if (node_name.empty()) continue;
+      std::string step = node_name;
+      if (!predicate.empty()) absl::StrAppend(&step, "[", predicate, "]");
+      absl::StrAppend(&step_redpath, "/", step);
+      node.add_steps(std::move(step));
+
+      // The tracker records the members iterated of nodes that resolved to a
+      // collection against the RedPath suffixed with '[*]'.
+      absl::StrAppend(&executed_redpath, "/", node_name);
+      auto iter = node_counts_.find(absl::StrCat(executed_redpath, "[*]"));
+      if (iter == node_counts_.end()) continue;
+      absl::StrAppend(&executed_redpath, "[*]");
+      if (!IsFullScanPredicate(predicate)) continue;
+      QueryCostEstimate::FullScan &full_scan = *estimate_.add_full_scans();
+      full_scan.set_subquery_id(subquery.subquery_id());
+      full_scan.set_redpath(step_redpath);
+      full_scan.set_predicate(predicate);
+      full_scan.set_member_count(iter->second);
+    }
+
+    if (auto iter = parent_to_children_.find(subquery.subquery_id());
+        iter != parent_to_children_.end()) {
+      for (const DelliciusQuery::Subquery *child : iter->second) {
+        ECCLESIA_RETURN_IF_ERROR(
+            AddPlanNode(*child, executed_redpath, *node.add_children()));
+      }
+    }
+    active_subquery_ids_.erase(subquery.subquery_id());
+    return absl::OkStatus();
+  }
+
+  const absl::flat_hash_map<std::string, size_t> &node_counts_;
+  QueryCostEstimate &estimate_;
+  std::vector<const DelliciusQuery::Subquery *> roots_;
+  absl::flat_hash_map<std::string,
+                      std::vector<const DelliciusQuery::Subquery *>>
+      parent_to_children_;
+  // Subqueries on the path from a root subquery to the current one.
+  absl::flat_hash_set<std::string> active_subquery_ids_;
+};
+
+void FormatPlanNode(const QueryCostEstimate::PlanNode &node, int depth,
+                    std::string &out) {
+  std::string indent(2 * (depth + 1), ' ');
+  absl::StrAppend(&out, indent, node.subquery_id(), ": ",
+                  absl::StrJoin(node.steps(), " -> "), "\n");
+  for (const QueryCostEstimate::PlanNode &child : node.children()) {
+    FormatPlanNode(child, depth + 1, out);
+  }
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<RecordedTraceTransport>>
+RecordedTraceTransport::Create(absl::string_view trace_json) {
+  nlohmann::json trace = nlohmann::json::parse(trace_json, nullptr,
+                                               /*allow_exceptions=*/false);
+  if (trace.is_discarded() || !trace.is_object()) {
+    return absl::InvalidArgumentError(
+        "Recorded trace must be a JSON object mapping URIs to responses");
+  }
+  return std::make_unique<RecordedTraceTransport>(std::move(trace));
+}
+
+absl::StatusOr<RedfishTransport::Result> RecordedTraceTransport::Get(
+    absl::string_view path) {
+  auto iter = trace_.find(path);
+  if (iter == trace_.end()) {
+    iter = trace_.find(path.substr(0, path.find('?')));
+  }
+  if (iter == trace_.end()) {
+    return absl::NotFoundError(absl::StrCat("No response recorded for ", path));
+  }
+  return Result{.code = 200,
+                .body = *iter,
+                .headers = {{"Content-Length", absl::StrCat(
+                                                   iter->dump().size())}}};
+}
+
+absl::StatusOr<RedfishTransport::Result> RecordedTraceTransport::Post(
+    absl::string_view path, absl::string_view data) {
+  return absl::UnimplementedError("Recorded traces are read-only");
+}
+
+absl::StatusOr<RedfishTransport::Result> RecordedTraceTransport::Patch(
+    absl::string_view path, absl::string_view data) {
+  return absl::UnimplementedError("Recorded traces are read-only");
+}
+
+absl::StatusOr<RedfishTransport::Result> RecordedTraceTransport::Delete(
+    absl::string_view path, absl::string_view data) {
+  return absl::UnimplementedError("Recorded traces are read-only");
+}
+
+absl::StatusOr<QueryCostEstimate> EstimateQueryCost(
+    const DelliciusQuery &query, const QueryRules &query_rules,
+    absl::FunctionRef<std::unique_ptr<RedfishTransport>()> transport_factory) {
+  RedPathRedfishQueryParams query_params;
+  if (auto iter = query_rules.query_id_to_params_rule().find(query.query_id());
+      iter != query_rules.query_id_to_params_rule().end()) {
+    query_params = ParseQueryRules(iter->second);
+  }
+  ECCLESIA_ASSIGN_OR_RETURN(
+      QueryExecution execution,
+      ExecuteQuery(query, RedPathRedfishQueryParams{}, transport_factory));
+  ECCLESIA_ASSIGN_OR_RETURN(
+      QueryExecution expanded_execution,
+      ExecuteQuery(query, std::move(query_params), transport_factory));
+
+  QueryCostEstimate estimate;
+  estimate.set_query_id(query.query_id());
+  // Steps executed with query rules may differ from those executed without,
+  // eg. when an expanded collection makes member fetches unnecessary.
+  absl::flat_hash_map<std::string, QueryCostEstimate::StepCost *> steps;
+  auto get_step = [&](const std::string &redpath) {
+    QueryCostEstimate::StepCost *&step = steps[redpath];
+    if (step == nullptr) {
+      step = estimate.add_steps();
+      step->set_redpath(redpath);
+    }
+    return step;
+  };
+  for (const QueryProfile::StepProfile &profile :
+       execution.profile.steps()) {
+    QueryCostEstimate::StepCost *step = get_step(profile.redpath());
+    step->set_request_count(profile.fetch_count());
+    step->set_payload_bytes(profile.payload_bytes());
+    estimate.set_request_count(estimate.request_count() +
+                               profile.fetch_count());
+    estimate.set_payload_bytes(estimate.payload_bytes() +
+                               profile.payload_bytes());
+  }
+  for (const QueryProfile::StepProfile &profile :
+       expanded_execution.profile.steps()) {
+    QueryCostEstimate::StepCost *step = get_step(profile.redpath());
+    step->set_expanded_request_count(profile.fetch_count());
+    step->set_expanded_payload_bytes(profile.payload_bytes());
+    estimate.set_expanded_request_count(estimate.expanded_request_count() +
+                                        profile.fetch_count());
+    estimate.set_expanded_payload_bytes(estimate.expanded_payload_bytes() +
+                                        profile.payload_bytes());
+  }
+
+  // Full scans are reported for the execution without query rules, as rules
+  // change how members are fetched but not which members are evaluated.
+  ECCLESIA_RETURN_IF_ERROR(
+      PlanBuilder(query, execution.redpath_node_counts, estimate).Build());
+  return estimate;
+}
+
+std::string FormatQueryCostEstimate(const QueryCostEstimate &estimate) {
+  std::string out = absl::StrCat("Query: ", estimate.query_id(), "\nPlan:\n");
+  for (const QueryCostEstimate::PlanNode &node : estimate.plan()) {
+    FormatPlanNode(node, 0, out);
+  }
+  absl::StrAppendFormat(&out, "Steps:\n  %-40s %10s %12s %10s %12s\n",
+                        "RedPath", "Requests", "Bytes", "Requests*",
+                        "Bytes*");
+  for (const QueryCostEstimate::StepCost &step : estimate.steps()) {
+    absl::StrAppendFormat(&out, "  %-40s %10d %12d %10d %12d\n",
+                          step.redpath(), step.request_count(),
+                          step.payload_bytes(), step.expanded_request_count(),
+                          step.expanded_payload_bytes());
+  }
+  absl::StrAppendFormat(&out, "  %-40s %10d %12d %10d %12d\n", "Total",
+                        estimate.request_count(), estimate.payload_bytes(),
+                        estimate.expanded_request_count(),
+                        estimate.expanded_payload_bytes());
+  absl::StrAppend(&out, "  (* with query rules applied)\n");
+  if (estimate.full_scans().empty()) return out;
+  absl::StrAppend(&out, "Full collection scans:\n");
+  for (const QueryCostEstimate::FullScan &full_scan : estimate.full_scans()) {
+    absl::StrAppendFormat(&out,
+                          "  %s: %s fetches %d members to evaluate [%s]\n",
+                          full_scan.subquery_id(), full_scan.redpath(),
+                          full_scan.member_count(), full_scan.predicate());
+  }
+  return out;
+}
+
+}  // namespace ecclesia
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ECCLESIA_LIB_REDFISH_DELLICIUS_ENGINE_QUERY_COST_ESTIMATOR_H_
+#define ECCLESIA_LIB_REDFISH_DELLICIUS_ENGINE_QUERY_COST_ESTIMATOR_H_
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/functional/function_ref.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_cost_estimate.pb.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_rules.pb.h"
+#include "ecclesia/lib/redfish/dellicius/query/query.pb.h"
+#include "ecclesia/lib/redfish/transport/interface.h"
+#include "single_include/nlohmann/json.hpp"
+
+namespace ecclesia {
+
+// Replays a recorded trace of a Redfish service. The trace is a JSON object
+// mapping the URI of each recorded GET request to its JSON response, eg.
+//   {"/redfish/v1": {...}, "/redfish/v1/Chassis": {...}}
+//
+// A request whose URI was not recorded is answered with the response recorded
+// for the URI without its query parameters, so that queries using $expand can
+// still be replayed against traces recorded without it. Write operations are
+// not supported.
+class RecordedTraceTransport : public RedfishTransport {
+ public:
+  static absl::StatusOr<std::unique_ptr<RecordedTraceTransport>> Create(
+      absl::string_view trace_json);
+
+  explicit RecordedTraceTransport(nlohmann::json trace)
+      : trace_(std::move(trace)) {}
+
+  absl::string_view GetRootUri() override { return "/redfish/v1"; }
+  absl::StatusOr<Result> Get(absl::string_view path) override;
+  absl::StatusOr<Result> Post(absl::string_view path,
+                              absl::string_view data) override;
+  absl::StatusOr<Result> Patch(absl::string_view path,
+                               absl::string_view data) override;
+  absl::StatusOr<Result> Delete(absl::string_view path,
+                                absl::string_view data) override;
+
+ private:
+  const nlohmann::json trace_;
+};
+
+// Estimates the cost of 'query' by executing it without a cache against the
+// Redfish service behind the transports returned by 'transport_factory', such
+// as a Redfish mockup or a RecordedTraceTransport. The query is executed twice,
+// without and with the rules in 'query_rules' for the query id, to report the
+// requests saved by rules like $expand. Predicates that make the query planner
+// fetch every member of a collection are reported as full scans.
+absl::StatusOr<QueryCostEstimate> EstimateQueryCost(
+    const DelliciusQuery &query, const QueryRules &query_rules,
+    absl::FunctionRef<std::unique_ptr<RedfishTransport>()> transport_factory);
+
+// Formats 'estimate' as a human readable EXPLAIN report listing the query plan,
+// the cost of each step and the full collection scans.
+std::string FormatQueryCostEstimate(const QueryCostEstimate &estimate);
+
+}  // namespace ecclesia
+
+#endif  // ECCLESIA_LIB_REDFISH_DELLICIUS_ENGINE_QUERY_COST_ESTIMATOR_H_
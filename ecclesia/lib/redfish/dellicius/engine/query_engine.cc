@@ -31,22 +31,28 @@
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "ecclesia/lib/file/cc_embed_interface.h"
+#include "ecclesia/lib/redfish/dellicius/engine/compiled_query.pb.h"
 #include "ecclesia/lib/redfish/dellicius/engine/config.h"
 #include "ecclesia/lib/redfish/dellicius/engine/factory.h"
 #include "ecclesia/lib/redfish/dellicius/engine/internal/interface.h"
+#include "ecclesia/lib/redfish/dellicius/engine/internal/query_deadline.h"
 #include "ecclesia/lib/redfish/dellicius/engine/internal/query_planner.h"
+#include "ecclesia/lib/redfish/dellicius/engine/internal/query_profiler.h"
 #include "ecclesia/lib/redfish/dellicius/query/query.pb.h"
 #include "ecclesia/lib/redfish/dellicius/query/query_result.pb.h"
 #include "ecclesia/lib/redfish/dellicius/utils/parsers.h"
+#include "ecclesia/lib/redfish/dellicius/utils/query_result_delta.h"
 #include "ecclesia/lib/redfish/interface.h"
 #include "ecclesia/lib/redfish/node_topology.h"
 #include "ecclesia/lib/redfish/topology.h"
+#include "ecclesia/lib/redfish/topology_config.pb.h"
 #include "ecclesia/lib/redfish/transport/http_redfish_intf.h"
 #include "ecclesia/lib/redfish/transport/interface.h"
 #include "ecclesia/lib/redfish/transport/metrical_transport.h"
 #include "ecclesia/lib/redfish/transport/transport_metrics.pb.h"
 #include "ecclesia/lib/time/clock.h"
 #include "ecclesia/lib/time/proto.h"
+#include "google/protobuf/arena.h"
 #include "google/protobuf/text_format.h"
 
 namespace ecclesia {
@@ -84,6 +90,10 @@ class QueryEngineImpl final : public QueryEngine::QueryEngineIntf {
                            RedfishTransportCacheFactory cache_factory,
                            const Clock *clock)
       : clock_(clock) {
+    // Attributes fetches to RedPath steps when a query is profiled and fails
+    // requests issued past the query deadline.
+    transport = std::make_unique<DeadlineRedfishTransport>(
+        std::make_unique<ProfilingRedfishTransport>(std::move(transport)));
     if (config.flags.enable_transport_metrics) {
       std::unique_ptr<MetricalRedfishTransport> metrical_transport =
           std::make_unique<MetricalRedfishTransport>(std::move(transport),
@@ -100,7 +110,9 @@ class QueryEngineImpl final : public QueryEngine::QueryEngineIntf {
 
     if (config.flags.enable_devpath_extension) {
       normalizer_ = BuildDefaultNormalizerWithLocalDevpath(
-          CreateTopologyFromRedfish(redfish_interface_.get()));
+          CreateTopologyFromRedfish(redfish_interface_.get(),
+                                    REDFISH_TOPOLOGY_UNSPECIFIED,
+                                    config.max_concurrent_topology_fetches));
     } else {
       normalizer_ = BuildDefaultNormalizer();
     }
@@ -191,6 +203,41 @@ class QueryEngineImpl final : public QueryEngine::QueryEngineIntf {
       QueryTracker &tracker) override {
     return ExecuteQuery(service_root_uri, query_ids, &tracker);
   }
+  std::vector<DelliciusQueryResult *> ExecuteQuery(
+      QueryEngine::ServiceRootType service_root_uri,
+      absl::Span<const absl::string_view> query_ids,
+      google::protobuf::Arena &arena) override {
+    std::vector<DelliciusQueryResult *> response_entries;
+    for (const absl::string_view query_id : query_ids) {
+      auto it = id_to_query_plans_.find(query_id);
+      if (it == id_to_query_plans_.end()) {
+        LOG(ERROR) << "Query plan does not exist for id " << query_id;
+        continue;
+      }
+
+      absl::Time start_time = clock_->Now();
+      DelliciusQueryResult *result_single = nullptr;
+      if (service_root_uri == QueryEngine::ServiceRootType::kGoogle) {
+        result_single = it->second->Run(
+            redfish_interface_->GetRoot(GetParams{}, ServiceRootUri::kGoogle),
+            *clock_, nullptr, arena);
+      } else {
+        result_single = it->second->Run(redfish_interface_->GetRoot(),
+                                        *clock_, nullptr, arena);
+      }
+      // The query planner creates the result, so the start time is recorded
+      // separately instead of through QueryTimestamp.
+      if (auto timestamp = AbslTimeToProtoTime(start_time); timestamp.ok()) {
+        *result_single->mutable_start_timestamp() = *std::move(timestamp);
+      }
+      if (auto timestamp = AbslTimeToProtoTime(clock_->Now()); timestamp.ok()) {
+        *result_single->mutable_end_timestamp() = *std::move(timestamp);
+      }
+      response_entries.push_back(result_single);
+    }
+    return response_entries;
+  }
+
   std::vector<DelliciusQueryResult> ExecuteQueryWithMetrics(
       QueryEngine::ServiceRootType service_root_uri,
       absl::Span<const absl::string_view> query_ids,
@@ -202,6 +249,57 @@ class QueryEngineImpl final : public QueryEngine::QueryEngineIntf {
     return ExecuteQuery(service_root_uri, query_ids, nullptr);
   }
 
+  absl::StatusOr<DelliciusQueryResult> ExecuteQueryStreaming(
+      QueryEngine::ServiceRootType service_root_uri,
+      absl::string_view query_id, QueryTracker *tracker,
+      SubqueryDataSetCallback callback) {
+    auto it = id_to_query_plans_.find(query_id);
+    if (it == id_to_query_plans_.end()) {
+      return absl::NotFoundError(
+          absl::StrCat("Query plan does not exist for id ", query_id));
+    }
+
+    DelliciusQueryResult result;
+    {
+      auto query_timer = QueryTimestamp(&result, clock_);
+      if (service_root_uri == QueryEngine::ServiceRootType::kGoogle) {
+        result = it->second->Run(
+            redfish_interface_->GetRoot(GetParams{}, ServiceRootUri::kGoogle),
+            *clock_, tracker, callback);
+      } else {
+        result = it->second->Run(redfish_interface_->GetRoot(), *clock_,
+                                 tracker, callback);
+      }
+    }
+    return result;
+  }
+
+  absl::StatusOr<DelliciusQueryResult> ExecuteQueryStreaming(
+      QueryEngine::ServiceRootType service_root_uri,
+      absl::string_view query_id, SubqueryDataSetCallback callback) override {
+    return ExecuteQueryStreaming(service_root_uri, query_id, nullptr, callback);
+  }
+
+  absl::StatusOr<DelliciusQueryResult> ExecuteQueryStreaming(
+      QueryEngine::ServiceRootType service_root_uri,
+      absl::string_view query_id, QueryTracker &tracker,
+      SubqueryDataSetCallback callback) override {
+    return ExecuteQueryStreaming(service_root_uri, query_id, &tracker,
+                                 callback);
+  }
+
+  absl::StatusOr<DelliciusQueryResultDelta> ExecuteQueryDelta(
+      QueryEngine::ServiceRootType service_root_uri, absl::string_view query_id,
+      absl::string_view base_version) override {
+    if (!id_to_query_plans_.contains(query_id)) {
+      return absl::NotFoundError(
+          absl::StrCat("Query plan does not exist for id ", query_id));
+    }
+    std::vector<DelliciusQueryResult> results =
+        ExecuteQuery(service_root_uri, {query_id}, nullptr);
+    return delta_tracker_.ComputeDelta(results.front(), base_version);
+  }
+
   const NodeTopology &GetTopology() override {
     if (absl::StatusOr<const NodeTopology *> topology =
             normalizer_->GetNodeTopology();
@@ -232,6 +330,8 @@ class QueryEngineImpl final : public QueryEngine::QueryEngineIntf {
 
   // Used during query metrics collection.
   MetricalRedfishTransport *metrical_transport_ = nullptr;
+  // Fingerprints of recent query results used to compute deltas.
+  QueryResultDeltaTracker delta_tracker_;
 };
 
 }  // namespace
@@ -252,9 +352,40 @@ absl::StatusOr<QueryEngine> CreateQueryEngine(
       query_id_to_rules = ParseQueryRulesFromEmbeddedFiles(
           {query_context.query_rules.begin(), query_context.query_rules.end()});
 
-  // Parse queries from embedded proto messages
   absl::flat_hash_map<std::string, std::unique_ptr<QueryPlannerInterface>>
       id_to_query_plans;
+  // Load queries compiled at build time from embedded binary protos.
+  for (const EmbeddedFile &compiled_query_file :
+       query_context.compiled_query_files) {
+    CompiledQuery compiled_query;
+    if (!compiled_query.ParseFromArray(compiled_query_file.data.data(),
+                                       compiled_query_file.data.size())) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Cannot get compiled RedPath query from embedded file ",
+                       compiled_query_file.name));
+    }
+    const std::string &query_id = compiled_query.query().query_id();
+    if (id_to_query_plans.contains(query_id)) continue;
+    RedPathRedfishQueryParams params;
+    if (compiled_query.has_query_rules()) {
+      params = ParseQueryRules(compiled_query.query_rules());
+    } else if (auto iter = query_id_to_rules.find(query_id);
+               iter != query_id_to_rules.end()) {
+      params = iter->second;
+    }
+
+    absl::StatusOr<std::unique_ptr<QueryPlannerInterface>> query_planner =
+        BuildDefaultQueryPlanner(compiled_query, std::move(params),
+                                 normalizer.get());
+    if (!query_planner.ok()) {
+      return absl::InternalError(
+          absl::StrCat("Cannot create query plan due to error: ",
+                       query_planner.status().message()));
+    }
+    id_to_query_plans.insert({query_id, *std::move(query_planner)});
+  }
+
+  // Parse queries from embedded proto messages
   for (const EmbeddedFile &query_file : query_context.query_files) {
     DelliciusQuery query;
     if (!google::protobuf::TextFormat::ParseFromString(std::string(query_file.data),
@@ -287,16 +418,22 @@ absl::StatusOr<QueryEngine> CreateQueryEngine(
 
 absl::StatusOr<QueryEngine> CreateQueryEngine(const QueryContext &query_context,
                                               QueryEngineParams configuration) {
-  // Build Redfish interface
+  // Build Redfish interface. The transport is decorated to attribute fetches
+  // to RedPath steps when a query is profiled and to fail requests issued past
+  // the query deadline set through QueryTracker.
   std::unique_ptr<RedfishInterface> redfish_interface = NewHttpInterface(
-      std::move(configuration.transport),
+      std::make_unique<DeadlineRedfishTransport>(
+          std::make_unique<ProfilingRedfishTransport>(
+              std::move(configuration.transport))),
       std::move(configuration.cache_factory), RedfishInterface::kTrusted);
 
   RedfishInterface *redfish_interface_ptr = redfish_interface.get();
   return CreateQueryEngine(
       query_context, std::move(redfish_interface),
-      BuildLocalDevpathNormalizer(configuration.stable_id_type,
-                                  redfish_interface_ptr));
+      BuildLocalDevpathNormalizer(
+          configuration.stable_id_type, redfish_interface_ptr,
+          configuration.topology_snapshot_path,
+          configuration.max_concurrent_topology_fetches));
 }
 
 }  // namespace ecclesia
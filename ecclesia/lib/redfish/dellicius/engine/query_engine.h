@@ -17,6 +17,7 @@
 #ifndef ECCLESIA_LIB_REDFISH_DELLICIUS_ENGINE_QUERY_ENGINE_H_
 #define ECCLESIA_LIB_REDFISH_DELLICIUS_ENGINE_QUERY_ENGINE_H_
 
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <utility>
@@ -26,6 +27,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "ecclesia/lib/file/cc_embed_interface.h"
 #include "ecclesia/lib/redfish/dellicius/engine/config.h"
@@ -37,11 +39,14 @@
 #include "ecclesia/lib/redfish/interface.h"
 #include "ecclesia/lib/redfish/node_topology.h"
 #include "ecclesia/lib/redfish/topology.h"
+#include "ecclesia/lib/redfish/topology_config.pb.h"
+#include "ecclesia/lib/redfish/topology_snapshot.h"
 #include "ecclesia/lib/redfish/transport/cache.h"
 #include "ecclesia/lib/redfish/transport/http_redfish_intf.h"
 #include "ecclesia/lib/redfish/transport/interface.h"
 #include "ecclesia/lib/redfish/transport/transport_metrics.pb.h"
 #include "ecclesia/lib/time/clock.h"
+#include "google/protobuf/arena.h"
 
 namespace ecclesia {
 
@@ -97,6 +102,34 @@ class QueryEngine {
         ServiceRootType service_root_uri,
         absl::Span<const absl::string_view> query_ids,
         RedfishMetrics *transport_metrics) = 0;
+    virtual std::vector<DelliciusQueryResult *> ExecuteQuery(
+        ServiceRootType service_root_uri,
+        absl::Span<const absl::string_view> query_ids,
+        google::protobuf::Arena &arena) {
+      std::vector<DelliciusQueryResult *> results;
+      for (DelliciusQueryResult &result :
+           ExecuteQuery(service_root_uri, query_ids)) {
+        results.push_back(
+            google::protobuf::Arena::CreateMessage<DelliciusQueryResult>(&arena));
+        *results.back() = std::move(result);
+      }
+      return results;
+    }
+    virtual absl::StatusOr<DelliciusQueryResult> ExecuteQueryStreaming(
+        ServiceRootType service_root_uri, absl::string_view query_id,
+        SubqueryDataSetCallback callback) {
+      return absl::UnimplementedError("Streaming query is not supported");
+    }
+    virtual absl::StatusOr<DelliciusQueryResult> ExecuteQueryStreaming(
+        ServiceRootType service_root_uri, absl::string_view query_id,
+        QueryTracker &tracker, SubqueryDataSetCallback callback) {
+      return absl::UnimplementedError("Streaming query is not supported");
+    }
+    virtual absl::StatusOr<DelliciusQueryResultDelta> ExecuteQueryDelta(
+        ServiceRootType service_root_uri, absl::string_view query_id,
+        absl::string_view base_version) {
+      return absl::UnimplementedError("Delta query is not supported");
+    }
     virtual const NodeTopology &GetTopology() = 0;
     // QueryEngineRawInterfacePasskey is just an empty strongly-typed object
     // that one needs to provide in order to invoke the member function.
@@ -131,6 +164,24 @@ class QueryEngine {
       ServiceRootType service_root_uri = ServiceRootType::kRedfish) {
     return engine_impl_->ExecuteQuery(service_root_uri, query_ids, tracker);
   }
+  // Executes queries until |deadline| as measured by the engine clock. Once the
+  // deadline passes, no further Redfish requests are issued and each result
+  // holds the datasets gathered so far. Subqueries left unfinished have their
+  // status set to DEADLINE_EXCEEDED.
+  std::vector<DelliciusQueryResult> ExecuteQuery(
+      absl::Span<const absl::string_view> query_ids, absl::Time deadline,
+      ServiceRootType service_root_uri = ServiceRootType::kRedfish) {
+    QueryTracker tracker{.deadline = deadline};
+    return engine_impl_->ExecuteQuery(service_root_uri, query_ids, tracker);
+  }
+  // Builds query results on the caller supplied |arena| to avoid allocating
+  // each result message individually. Returned results are owned by |arena|.
+  std::vector<DelliciusQueryResult *> ExecuteQuery(
+      absl::Span<const absl::string_view> query_ids,
+      google::protobuf::Arena &arena,
+      ServiceRootType service_root_uri = ServiceRootType::kRedfish) {
+    return engine_impl_->ExecuteQuery(service_root_uri, query_ids, arena);
+  }
   // Transport metrics flag must be true for metrics to be populated.
   std::vector<DelliciusQueryResult> ExecuteQueryWithMetrics(
       absl::Span<const absl::string_view> query_ids,
@@ -139,6 +190,40 @@ class QueryEngine {
     return engine_impl_->ExecuteQueryWithMetrics(service_root_uri, query_ids,
                                                  transport_metrics);
   }
+  // Executes the query identified by |query_id| and invokes |callback| for
+  // each normalized SubqueryDataSet as soon as it is produced, so that large
+  // results need not be held in memory. The returned result carries the query
+  // status, timestamps and subquery statuses but no datasets.
+  // Returns NotFoundError if no query plan exists for |query_id|.
+  absl::StatusOr<DelliciusQueryResult> ExecuteQueryStreaming(
+      absl::string_view query_id, SubqueryDataSetCallback callback,
+      ServiceRootType service_root_uri = ServiceRootType::kRedfish) {
+    return engine_impl_->ExecuteQueryStreaming(service_root_uri, query_id,
+                                               callback);
+  }
+  // Streams the query as above while applying the deadline and profiler of
+  // |tracker| and recording the queried RedPaths in it, as ExecuteQuery does.
+  absl::StatusOr<DelliciusQueryResult> ExecuteQueryStreaming(
+      absl::string_view query_id, QueryTracker &tracker,
+      SubqueryDataSetCallback callback,
+      ServiceRootType service_root_uri = ServiceRootType::kRedfish) {
+    return engine_impl_->ExecuteQueryStreaming(service_root_uri, query_id,
+                                               tracker, callback);
+  }
+  // Executes the query identified by |query_id| and returns only the datasets
+  // added, changed or removed since the result identified by |base_version|.
+  // The returned delta carries the version token to pass as |base_version|
+  // on the next call. An empty or expired |base_version| yields every dataset
+  // as added, so callers can always start from an empty token.
+  // Returns NotFoundError if no query plan exists for |query_id|. Returns the
+  // error of the query if it failed as a whole or none of its subqueries
+  // produced data because of failures; |base_version| remains valid then.
+  absl::StatusOr<DelliciusQueryResultDelta> ExecuteQueryDelta(
+      absl::string_view query_id, absl::string_view base_version,
+      ServiceRootType service_root_uri = ServiceRootType::kRedfish) {
+    return engine_impl_->ExecuteQueryDelta(service_root_uri, query_id,
+                                           base_version);
+  }
   const NodeTopology &GetTopology() { return engine_impl_->GetTopology(); }
   absl::StatusOr<RedfishInterface *> GetRedfishInterface(
       RedfishInterfacePasskey unused_passkey) {
@@ -157,6 +242,11 @@ struct QueryContext {
   // specific RedPath prefixes in given queries.
   absl::Span<const EmbeddedFile> query_rules = {};
   const Clock *clock = Clock::RealClock();
+  // Binary CompiledQuery protos generated by the compiled_redpath_queries build
+  // rule. These are loaded without any text parsing and carry their own query
+  // rules, if any were given at build time. Queries whose id also appears in
+  // 'query_files' are taken from here.
+  absl::Span<const EmbeddedFile> compiled_query_files = {};
 };
 
 // Parameters necessary to configure the query engine.
@@ -178,17 +268,46 @@ struct QueryEngineParams {
   // Type of stable identifier to use in query result
   QueryEngineParams::RedfishStableIdType stable_id_type =
       QueryEngineParams::RedfishStableIdType::kRedfishLocation;
+  // Optional path of a topology snapshot. When set, the topology derived for
+  // stable ids is read from the snapshot if the Redfish Assemblies did not
+  // change since it was written, and written to it otherwise, which saves
+  // creating the topology at every start.
+  std::string topology_snapshot_path;
+  // Maximum number of Redfish resources fetched concurrently while creating
+  // the topology for stable ids derived from the Redfish topology.
+  size_t max_concurrent_topology_fetches = kDefaultMaxConcurrentTopologyFetches;
 };
 
+// Creates the topology for stable ids derived from the Redfish topology, using
+// the snapshot at |topology_snapshot_path| if one is given. Up to
+// |max_concurrent_fetches| resources are fetched at once.
+inline NodeTopology CreateStableIdTopology(
+    RedfishInterface *redfish_interface,
+    const std::string &topology_snapshot_path,
+    size_t max_concurrent_fetches = kDefaultMaxConcurrentTopologyFetches) {
+  if (topology_snapshot_path.empty()) {
+    return CreateTopologyFromRedfish(redfish_interface,
+                                     REDFISH_TOPOLOGY_UNSPECIFIED,
+                                     max_concurrent_fetches);
+  }
+  return CreateTopologyFromRedfishWithSnapshot(
+      redfish_interface, topology_snapshot_path, REDFISH_TOPOLOGY_UNSPECIFIED,
+      max_concurrent_fetches);
+}
+
 inline std::unique_ptr<Normalizer> BuildLocalDevpathNormalizer(
     QueryEngineParams::RedfishStableIdType stable_id_type,
-    RedfishInterface *redfish_interface) {
+    RedfishInterface *redfish_interface,
+    const std::string &topology_snapshot_path = "",
+    size_t max_concurrent_topology_fetches =
+        kDefaultMaxConcurrentTopologyFetches) {
   switch (stable_id_type) {
     case QueryEngineParams::RedfishStableIdType::kRedfishLocation:
       return BuildDefaultNormalizer();
     case QueryEngineParams::RedfishStableIdType::kRedfishLocationDerived:
       return BuildDefaultNormalizerWithLocalDevpath(
-          CreateTopologyFromRedfish(redfish_interface));
+          CreateStableIdTopology(redfish_interface, topology_snapshot_path,
+                                 max_concurrent_topology_fetches));
   }
 }
 
@@ -198,7 +317,10 @@ std::unique_ptr<Normalizer> BuildMachineDevpathNormalizer(
     QueryEngineParams::RedfishStableIdType stable_id_type,
     std::unique_ptr<LocalIdMapT> local_id_map,
     const IdAssignerFactory<LocalIdMapT> &id_assigner_factory,
-    RedfishInterface *redfish_interface) {
+    RedfishInterface *redfish_interface,
+    const std::string &topology_snapshot_path = "",
+    size_t max_concurrent_topology_fetches =
+        kDefaultMaxConcurrentTopologyFetches) {
   switch (stable_id_type) {
     case QueryEngineParams::RedfishStableIdType::kRedfishLocation:
       return BuildDefaultNormalizerWithMachineDevpath<LocalIdMapT>(
@@ -206,7 +328,8 @@ std::unique_ptr<Normalizer> BuildMachineDevpathNormalizer(
     case QueryEngineParams::RedfishStableIdType::kRedfishLocationDerived:
       return BuildDefaultNormalizerWithMachineDevpath<LocalIdMapT>(
           server_tag, std::move(local_id_map), id_assigner_factory,
-          CreateTopologyFromRedfish(redfish_interface));
+          CreateStableIdTopology(redfish_interface, topology_snapshot_path,
+                                 max_concurrent_topology_fetches));
   }
 }
 
@@ -238,7 +361,9 @@ absl::StatusOr<QueryEngine> CreateQueryEngine(
     return absl::InternalError("Can't create redfish interface");
   std::unique_ptr<Normalizer> normalizer = BuildMachineDevpathNormalizer(
       engine_params.entity_tag, engine_params.stable_id_type,
-      std::move(local_id_map), id_assigner_factory, redfish_interface.get());
+      std::move(local_id_map), id_assigner_factory, redfish_interface.get(),
+      engine_params.topology_snapshot_path,
+      engine_params.max_concurrent_topology_fetches);
 
   return CreateQueryEngine(query_context, std::move(redfish_interface),
                            std::move(normalizer));
@@ -0,0 +1,208 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ecclesia/lib/redfish/dellicius/engine/query_engine_fleet.h"
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "google/rpc/code.pb.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_engine.h"
+#include "ecclesia/lib/redfish/dellicius/query/query_result.pb.h"
+#include "ecclesia/lib/status/macros.h"
+
+namespace ecclesia {
+
+// Results of a batch on a single engine.
+struct QueryEngineFleet::EngineResults {
+  std::vector<DelliciusQueryResult> results;
+  size_t remaining_queries = 0;
+};
+
+// Queries requested by a single ExecuteQuery call across the fleet.
+struct QueryEngineFleet::Batch {
+  bool Done() const { return remaining_engines == 0; }
+
+  absl::Span<const absl::string_view> query_ids;
+  absl::Time deadline;
+  const ResultCallback &callback;
+  std::vector<EngineResults> engine_results;
+  size_t remaining_engines = 0;
+};
+
+struct QueryEngineFleet::Engine {
+  Engine(absl::string_view endpoint, QueryEngine engine)
+      : endpoint(endpoint), engine(std::move(engine)) {}
+
+  bool Idle() const { return pending.empty() && running == 0; }
+
+  const std::string endpoint;
+  QueryEngine engine;
+  // The members below are guarded by the mutex of the fleet.
+  std::deque<Task> pending;
+  int running = 0;
+  // Whether the engine is in the ready queue of the fleet.
+  bool ready = false;
+};
+
+QueryEngineFleet::QueryEngineFleet(QueryEngineFleetOptions options)
+    : options_(options), thread_pool_(options.num_workers) {}
+
+QueryEngineFleet::~QueryEngineFleet() {
+  absl::MutexLock lock(&mutex_);
+  mutex_.Await(absl::Condition(this, &QueryEngineFleet::Idle));
+}
+
+absl::Status QueryEngineFleet::AddEngine(absl::string_view endpoint,
+                                         QueryEngine engine) {
+  absl::MutexLock lock(&mutex_);
+  if (engines_.contains(endpoint)) {
+    return absl::AlreadyExistsError(
+        absl::StrCat("Query engine already exists for ", endpoint));
+  }
+  engines_.emplace(endpoint,
+                   std::make_shared<Engine>(endpoint, std::move(engine)));
+  return absl::OkStatus();
+}
+
+absl::Status QueryEngineFleet::AddEngine(absl::string_view endpoint,
+                                         const QueryContext &query_context,
+                                         QueryEngineParams engine_params) {
+  ECCLESIA_ASSIGN_OR_RETURN(
+      QueryEngine engine,
+      CreateQueryEngine(query_context, std::move(engine_params)));
+  return AddEngine(endpoint, std::move(engine));
+}
+
+absl::Status QueryEngineFleet::RemoveEngine(absl::string_view endpoint) {
+  absl::MutexLock lock(&mutex_);
+  auto iter = engines_.find(endpoint);
+  if (iter == engines_.end()) {
+    return absl::NotFoundError(
+        absl::StrCat("No query engine exists for ", endpoint));
+  }
+  std::shared_ptr<Engine> engine = iter->second;
+  mutex_.Await(absl::Condition(engine.get(), &Engine::Idle));
+  engines_.erase(endpoint);
+  return absl::OkStatus();
+}
+
+size_t QueryEngineFleet::size() const {
+  absl::MutexLock lock(&mutex_);
+  return engines_.size();
+}
+
+void QueryEngineFleet::ExecuteQuery(
+    absl::Span<const absl::string_view> query_ids,
+    const ResultCallback &callback, absl::Time deadline) {
+  Batch batch{.query_ids = query_ids, .deadline = deadline,
+              .callback = callback};
+  absl::MutexLock lock(&mutex_);
+  if (query_ids.empty() || engines_.empty()) return;
+  batch.engine_results.resize(engines_.size());
+  batch.remaining_engines = engines_.size();
+  size_t engine_index = 0;
+  for (auto &[endpoint, engine] : engines_) {
+    EngineResults &engine_results = batch.engine_results[engine_index++];
+    engine_results.results.resize(query_ids.size());
+    engine_results.remaining_queries = query_ids.size();
+    for (size_t query_index = 0; query_index < query_ids.size();
+         ++query_index) {
+      engine->pending.push_back({.batch = &batch,
+                                 .engine_results = &engine_results,
+                                 .query_index = query_index});
+    }
+    if (!engine->ready &&
+        engine->running < options_.max_concurrent_queries_per_engine) {
+      engine->ready = true;
+      ready_engines_.push_back(engine);
+    }
+  }
+  DispatchLocked();
+  mutex_.Await(absl::Condition(&batch, &Batch::Done));
+}
+
+void QueryEngineFleet::DispatchLocked() {
+  while (running_tasks_ < options_.num_workers && !ready_engines_.empty()) {
+    std::shared_ptr<Engine> engine = std::move(ready_engines_.front());
+    ready_engines_.pop_front();
+    Task task = engine->pending.front();
+    engine->pending.pop_front();
+    ++engine->running;
+    ++running_tasks_;
+    // Requeue the engine behind the others so that engines take turns.
+    engine->ready =
+        !engine->pending.empty() &&
+        engine->running < options_.max_concurrent_queries_per_engine;
+    if (engine->ready) ready_engines_.push_back(engine);
+    thread_pool_.Schedule([this, engine, task]() { RunTask(engine, task); });
+  }
+}
+
+void QueryEngineFleet::RunTask(const std::shared_ptr<Engine> &engine,
+                               Task task) {
+  absl::string_view query_id = task.batch->query_ids[task.query_index];
+  std::vector<DelliciusQueryResult> results =
+      engine->engine.ExecuteQuery({query_id}, task.batch->deadline);
+  DelliciusQueryResult result;
+  if (results.empty()) {
+    result.set_query_id(std::string(query_id));
+    result.mutable_status()->set_code(::google::rpc::Code::NOT_FOUND);
+    result.mutable_status()->set_message(
+        absl::StrCat("Query plan does not exist for id ", query_id));
+  } else {
+    result = std::move(results.front());
+  }
+
+  std::vector<DelliciusQueryResult> engine_results;
+  bool engine_done = false;
+  {
+    absl::MutexLock lock(&mutex_);
+    task.engine_results->results[task.query_index] = std::move(result);
+    if (--task.engine_results->remaining_queries == 0) {
+      engine_done = true;
+      engine_results = std::move(task.engine_results->results);
+    }
+  }
+  // The batch outlives the callback since it is only done once every engine
+  // has been reported.
+  if (engine_done) {
+    task.batch->callback(engine->endpoint, std::move(engine_results));
+  }
+
+  absl::MutexLock lock(&mutex_);
+  if (engine_done) --task.batch->remaining_engines;
+  --engine->running;
+  --running_tasks_;
+  if (!engine->ready && !engine->pending.empty() &&
+      engine->running < options_.max_concurrent_queries_per_engine) {
+    engine->ready = true;
+    ready_engines_.push_back(engine);
+  }
+  DispatchLocked();
+}
+
+}  // namespace ecclesia
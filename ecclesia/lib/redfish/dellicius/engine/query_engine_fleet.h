@@ -0,0 +1,143 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ECCLESIA_LIB_REDFISH_DELLICIUS_ENGINE_QUERY_ENGINE_FLEET_H_
+#define ECCLESIA_LIB_REDFISH_DELLICIUS_ENGINE_QUERY_ENGINE_FLEET_H_
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_engine.h"
+#include "ecclesia/lib/redfish/dellicius/query/query_result.pb.h"
+#include "ecclesia/lib/thread/thread_pool.h"
+
+namespace ecclesia {
+
+struct QueryEngineFleetOptions {
+  // Number of worker threads shared by all engines in the fleet.
+  int num_workers = 8;
+  // Upper bound on the number of queries executing at once on a single
+  // engine. Values above 1 require the transport and cache of each engine to
+  // be thread safe.
+  int max_concurrent_queries_per_engine = 1;
+};
+
+// Owns the QueryEngine of each BMC in a fleet, keyed by endpoint, and executes
+// queries across them on a shared, bounded pool of worker threads.
+//
+// Each query on each engine is scheduled as a separate unit of work. Engines
+// with pending work are served round robin, so an engine with many or slow
+// queries does not hold back the others, and no engine runs more than
+// |max_concurrent_queries_per_engine| queries at once.
+//
+// Usage:
+//   QueryEngineFleet fleet({.num_workers = 16});
+//   fleet.AddEngine("bmc0", query_context, {.transport = ...});
+//   fleet.ExecuteQuery({"SensorCollector"},
+//                      [](absl::string_view endpoint,
+//                         std::vector<DelliciusQueryResult> results) {...});
+//
+// This class is thread-safe.
+class QueryEngineFleet {
+ public:
+  // Receives the results of all queries executed on the engine of |endpoint|,
+  // in the order the queries were requested, as soon as they complete.
+  // May be invoked concurrently from worker threads.
+  using ResultCallback = std::function<void(
+      absl::string_view endpoint, std::vector<DelliciusQueryResult> results)>;
+
+  explicit QueryEngineFleet(QueryEngineFleetOptions options = {});
+
+  QueryEngineFleet(const QueryEngineFleet &) = delete;
+  QueryEngineFleet &operator=(const QueryEngineFleet &) = delete;
+
+  // Waits for any executing queries to complete.
+  ~QueryEngineFleet();
+
+  // Adds |engine| to the fleet as the engine of |endpoint|.
+  // Returns AlreadyExistsError if the fleet has an engine for |endpoint|.
+  absl::Status AddEngine(absl::string_view endpoint, QueryEngine engine);
+
+  // Builds an engine through CreateQueryEngine and adds it to the fleet as the
+  // engine of |endpoint|.
+  absl::Status AddEngine(absl::string_view endpoint,
+                         const QueryContext &query_context,
+                         QueryEngineParams engine_params);
+
+  // Removes the engine of |endpoint| once the queries scheduled on it have
+  // completed. Returns NotFoundError if the fleet has no such engine.
+  absl::Status RemoveEngine(absl::string_view endpoint);
+
+  // Returns the number of engines in the fleet.
+  size_t size() const;
+
+  // Executes |query_ids| on every engine in the fleet and invokes |callback|
+  // with the results of each engine as they complete. Queries still executing
+  // at |deadline| return partial results as described in
+  // QueryEngine::ExecuteQuery. Blocks until |callback| has been invoked for
+  // every engine.
+  void ExecuteQuery(absl::Span<const absl::string_view> query_ids,
+                    const ResultCallback &callback,
+                    absl::Time deadline = absl::InfiniteFuture());
+
+ private:
+  struct Batch;
+  struct Engine;
+  struct EngineResults;
+
+  // A single query to execute on an engine as part of a batch.
+  struct Task {
+    Batch *batch;
+    EngineResults *engine_results;
+    size_t query_index;
+  };
+
+  bool Idle() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) {
+    return running_tasks_ == 0;
+  }
+
+  // Schedules pending tasks on the worker pool while workers are available.
+  void DispatchLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Executes 'task' on 'engine' and records its result.
+  void RunTask(const std::shared_ptr<Engine> &engine, Task task);
+
+  const QueryEngineFleetOptions options_;
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, std::shared_ptr<Engine>> engines_
+      ABSL_GUARDED_BY(mutex_);
+  // Engines with pending tasks and spare concurrency, served round robin.
+  std::deque<std::shared_ptr<Engine>> ready_engines_ ABSL_GUARDED_BY(mutex_);
+  // Number of tasks scheduled on the worker pool.
+  int running_tasks_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Declared last so that workers are joined before the state they use is
+  // destroyed.
+  ThreadPool thread_pool_;
+};
+
+}  // namespace ecclesia
+
+#endif  // ECCLESIA_LIB_REDFISH_DELLICIUS_ENGINE_QUERY_ENGINE_FLEET_H_
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+// This is a command-line utility that explains the cost of a RedPath query
+// without a live Redfish service.
+//
+// The utility takes the path of a single query textproto and the path of a
+// recorded Redfish trace given by --trace, which is a JSON object mapping
+// request URIs to responses. Query rules that apply to the query can be given
+// in a QueryRules textproto with --query_rules. The query plan, the Redfish
+// requests and payload bytes of each step with and without the query rules, and
+// the predicates that force full collection scans are printed to stdout.
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/log/log.h"
+#include "absl/status/statusor.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_cost_estimate.pb.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_cost_estimator.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_rules.pb.h"
+#include "ecclesia/lib/redfish/dellicius/query/query.pb.h"
+#include "ecclesia/lib/redfish/transport/interface.h"
+#include "google/protobuf/text_format.h"
+
+ABSL_FLAG(std::string, query_rules, "",
+          "Optional path to a QueryRules textproto with rules for the query.");
+ABSL_FLAG(std::string, trace, "",
+          "Path to a recorded Redfish trace to execute the query against.");
+
+namespace ecclesia {
+namespace {
+
+// Returns the contents of the file at 'path'. Terminates on failure.
+std::string ReadFileOrDie(const std::string &path) {
+  std::fstream in_f(path, in_f.binary | in_f.in);
+  if (!in_f.is_open()) LOG(FATAL) << "unable to open " << path;
+  std::stringstream buffer;
+  buffer << in_f.rdbuf();
+  return buffer.str();
+}
+
+// Reads the textproto at 'path' into 'message'. Terminates on failure.
+void ReadTextProtoOrDie(const std::string &path,
+                        google::protobuf::Message &message) {
+  if (!google::protobuf::TextFormat::ParseFromString(ReadFileOrDie(path),
+                                                     &message)) {
+    LOG(FATAL) << "unable to parse " << path;
+  }
+}
+
+}  // namespace
+
+int RealMain(int argc, char *argv[]) {
+  std::vector<char *> args = absl::ParseCommandLine(argc, argv);
+
+  // Make sure all of the required flags were specified.
+  if (absl::GetFlag(FLAGS_trace).empty()) {
+    LOG(FATAL) << "trace was not specified";
+  }
+  if (args.size() != 2) {
+    LOG(FATAL) << "expected exactly one query file";
+  }
+
+  DelliciusQuery query;
+  ReadTextProtoOrDie(args[1], query);
+  QueryRules query_rules;
+  if (!absl::GetFlag(FLAGS_query_rules).empty()) {
+    ReadTextProtoOrDie(absl::GetFlag(FLAGS_query_rules), query_rules);
+  }
+  std::string trace = ReadFileOrDie(absl::GetFlag(FLAGS_trace));
+
+  absl::StatusOr<QueryCostEstimate> estimate = EstimateQueryCost(
+      query, query_rules, [&]() -> std::unique_ptr<RedfishTransport> {
+        absl::StatusOr<std::unique_ptr<RecordedTraceTransport>> transport =
+            RecordedTraceTransport::Create(trace);
+        if (!transport.ok()) {
+          LOG(FATAL) << "unable to load trace: " << transport.status();
+        }
+        return *std::move(transport);
+      });
+  if (!estimate.ok()) {
+    LOG(FATAL) << "unable to explain " << args[1] << ": " << estimate.status();
+  }
+  std::cout << FormatQueryCostEstimate(*estimate);
+  return 0;
+}
+
+}  // namespace ecclesia
+
+int main(int argc, char *argv[]) { return ecclesia::RealMain(argc, argv); }
@@ -0,0 +1,197 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ecclesia/lib/redfish/dellicius/engine/query_scheduler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "google/rpc/code.pb.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_engine.h"
+#include "ecclesia/lib/redfish/dellicius/query/query_result.pb.h"
+#include "ecclesia/lib/time/clock.h"
+
+namespace ecclesia {
+
+namespace {
+
+absl::Duration GetJitter(const QuerySchedulerOptions &options) {
+  if (options.max_jitter <= absl::ZeroDuration()) return absl::ZeroDuration();
+  auto max_jitter_ns =
+      static_cast<uint64_t>(absl::ToInt64Nanoseconds(options.max_jitter));
+  // Derive the jitter with FNV-1a so a key keeps the same jitter across
+  // restarts; absl::Hash is seeded per process.
+  uint64_t hash = 0xcbf29ce484222325;
+  for (char c : options.jitter_key) {
+    hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3;
+  }
+  return absl::Nanoseconds(static_cast<int64_t>(hash % max_jitter_ns));
+}
+
+// Rounds |interval| up to a positive multiple of |tick|.
+absl::Duration RoundUpToTick(absl::Duration interval, absl::Duration tick) {
+  absl::Duration remainder;
+  int64_t ticks = absl::IDivDuration(interval, tick, &remainder);
+  if (remainder > absl::ZeroDuration()) ++ticks;
+  return tick * std::max<int64_t>(ticks, 1);
+}
+
+}  // namespace
+
+QueryScheduler::QueryScheduler(QueryEngine &engine, Clock *clock,
+                               QuerySchedulerOptions options)
+    : engine_(engine),
+      clock_(clock),
+      tick_(options.tick > absl::ZeroDuration() ? options.tick
+                                                : absl::Seconds(1)),
+      jitter_(GetJitter(options)) {}
+
+absl::Time QueryScheduler::AlignUp(absl::Time time,
+                                   absl::Duration interval) const {
+  absl::Duration remainder;
+  absl::IDivDuration(time - (absl::UnixEpoch() + jitter_), interval,
+                     &remainder);
+  if (remainder < absl::ZeroDuration()) remainder += interval;
+  if (remainder == absl::ZeroDuration()) return time;
+  return time + (interval - remainder);
+}
+
+absl::StatusOr<QueryScheduler::SubscriptionId> QueryScheduler::Subscribe(
+    absl::string_view query_id, absl::Duration interval,
+    ResultCallback callback) {
+  if (interval <= absl::ZeroDuration()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Invalid interval for query ", query_id, ": ",
+                     absl::FormatDuration(interval)));
+  }
+  interval = RoundUpToTick(interval, tick_);
+  absl::MutexLock lock(&mutex_);
+  SubscriptionId id = next_id_++;
+  subscriptions_[id] = {.query_id = std::string(query_id),
+                        .interval = interval,
+                        .callback = std::move(callback),
+                        .next_run = AlignUp(clock_->Now(), interval)};
+  return id;
+}
+
+absl::Status QueryScheduler::Unsubscribe(SubscriptionId id) {
+  absl::MutexLock lock(&mutex_);
+  if (subscriptions_.erase(id) == 0) {
+    return absl::NotFoundError(absl::StrCat("Unknown subscription ", id));
+  }
+  return absl::OkStatus();
+}
+
+absl::Time QueryScheduler::RunDueSubscriptions() {
+  absl::Time now = clock_->Now();
+  // Distinct queries due now, in subscription order.
+  std::vector<std::string> query_ids;
+  std::vector<std::pair<std::string, ResultCallback>> due_callbacks;
+  {
+    absl::MutexLock lock(&mutex_);
+    for (auto &[id, subscription] : subscriptions_) {
+      if (subscription.next_run > now) continue;
+      if (std::find(query_ids.begin(), query_ids.end(),
+                    subscription.query_id) == query_ids.end()) {
+        query_ids.push_back(subscription.query_id);
+      }
+      due_callbacks.push_back({subscription.query_id, subscription.callback});
+
+      subscription.next_run += subscription.interval;
+      if (subscription.next_run > now) continue;
+      // The run is late by more than an interval. Skip the missed runs and
+      // resume at the next aligned time.
+      absl::Time next_run = AlignUp(now, subscription.interval);
+      if (next_run == now) next_run += subscription.interval;
+      absl::Duration remainder;
+      skipped_runs_ += absl::IDivDuration(next_run - subscription.next_run,
+                                          subscription.interval, &remainder);
+      subscription.next_run = next_run;
+    }
+  }
+
+  if (!query_ids.empty()) {
+    std::vector<absl::string_view> query_id_views(query_ids.begin(),
+                                                  query_ids.end());
+    std::vector<DelliciusQueryResult> results =
+        engine_.ExecuteQuery(query_id_views);
+    absl::flat_hash_map<std::string, const DelliciusQueryResult *>
+        id_to_result;
+    for (const DelliciusQueryResult &result : results) {
+      id_to_result[result.query_id()] = &result;
+    }
+    for (const auto &[query_id, callback] : due_callbacks) {
+      if (auto iter = id_to_result.find(query_id);
+          iter != id_to_result.end()) {
+        callback(*iter->second);
+        continue;
+      }
+      DelliciusQueryResult not_found;
+      not_found.set_query_id(query_id);
+      not_found.mutable_status()->set_code(::google::rpc::Code::NOT_FOUND);
+      not_found.mutable_status()->set_message(
+          absl::StrCat("Query plan does not exist for id ", query_id));
+      callback(not_found);
+    }
+  }
+
+  absl::MutexLock lock(&mutex_);
+  absl::Time next_run = absl::InfiniteFuture();
+  for (const auto &[id, subscription] : subscriptions_) {
+    next_run = std::min(next_run, subscription.next_run);
+  }
+  return next_run;
+}
+
+void QueryScheduler::Run() {
+  while (true) {
+    {
+      absl::MutexLock lock(&mutex_);
+      if (stopped_) return;
+    }
+    absl::Time next_run = RunDueSubscriptions();
+    {
+      // Callbacks may have stopped the scheduler.
+      absl::MutexLock lock(&mutex_);
+      if (stopped_) return;
+    }
+    // Wake up at least once per tick to observe Stop and new subscriptions.
+    absl::Duration wait = std::min(next_run - clock_->Now(), tick_);
+    if (wait > absl::ZeroDuration()) clock_->Sleep(wait);
+  }
+}
+
+void QueryScheduler::Stop() {
+  absl::MutexLock lock(&mutex_);
+  stopped_ = true;
+}
+
+uint64_t QueryScheduler::skipped_runs() const {
+  absl::MutexLock lock(&mutex_);
+  return skipped_runs_;
+}
+
+}  // namespace ecclesia
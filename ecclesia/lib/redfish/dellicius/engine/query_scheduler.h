@@ -0,0 +1,130 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ECCLESIA_LIB_REDFISH_DELLICIUS_ENGINE_QUERY_SCHEDULER_H_
+#define ECCLESIA_LIB_REDFISH_DELLICIUS_ENGINE_QUERY_SCHEDULER_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/btree_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_engine.h"
+#include "ecclesia/lib/redfish/dellicius/query/query_result.pb.h"
+#include "ecclesia/lib/time/clock.h"
+
+namespace ecclesia {
+
+struct QuerySchedulerOptions {
+  // Granularity of the schedule. Subscription intervals are rounded up to a
+  // multiple of the tick.
+  absl::Duration tick = absl::Seconds(1);
+  // Ticks are offset from the Unix epoch by a jitter in [0, max_jitter)
+  // derived from |jitter_key|. Giving each BMC its own key spreads the load
+  // of schedulers that would otherwise poll every BMC at the same instant.
+  absl::Duration max_jitter = absl::ZeroDuration();
+  std::string jitter_key;
+};
+
+// Executes queries periodically on a QueryEngine on behalf of subscribers.
+//
+// Each subscription runs at multiples of its interval, aligned to the same
+// epoch, so subscriptions with related intervals fall due together. All
+// subscriptions due in the same tick are coalesced into a single
+// QueryEngine::ExecuteQuery batch, which runs each distinct query once and
+// hands its result to every subscriber of that query.
+//
+// When a run is late by more than an interval, the missed runs are skipped
+// rather than executed back to back, so a slow BMC does not build a backlog.
+//
+// Time is read from the given Clock, so tests can drive the schedule with a
+// FakeClock through RunDueSubscriptions.
+//
+// This class is thread-safe.
+class QueryScheduler {
+ public:
+  using SubscriptionId = int64_t;
+  // Receives each result of the subscribed query. Invoked on the thread
+  // running the scheduler.
+  using ResultCallback = std::function<void(const DelliciusQueryResult &)>;
+
+  // |engine| and |clock| must outlive the scheduler.
+  explicit QueryScheduler(QueryEngine &engine,
+                          Clock *clock = Clock::RealClock(),
+                          QuerySchedulerOptions options = {});
+
+  QueryScheduler(const QueryScheduler &) = delete;
+  QueryScheduler &operator=(const QueryScheduler &) = delete;
+
+  // Executes |query_id| every |interval| and passes each result to
+  // |callback|. The first run happens at the next multiple of |interval|.
+  // Returns InvalidArgumentError if |interval| is not positive.
+  absl::StatusOr<SubscriptionId> Subscribe(absl::string_view query_id,
+                                           absl::Duration interval,
+                                           ResultCallback callback);
+
+  // Cancels a subscription. A run already in progress may still invoke its
+  // callback once. Returns NotFoundError for an unknown |id|.
+  absl::Status Unsubscribe(SubscriptionId id);
+
+  // Executes the subscriptions due at the current time as one batch and
+  // returns the time at which the next subscription falls due, or
+  // absl::InfiniteFuture() if there are no subscriptions.
+  absl::Time RunDueSubscriptions();
+
+  // Runs due subscriptions until Stop is called, sleeping on the clock in
+  // between. Stop takes effect within one tick.
+  // Once stopped, Run returns immediately.
+  void Run();
+  void Stop();
+
+  // Returns the number of runs skipped because they were late.
+  uint64_t skipped_runs() const;
+
+ private:
+  struct Subscription {
+    std::string query_id;
+    absl::Duration interval;
+    ResultCallback callback;
+    absl::Time next_run;
+  };
+
+  // Returns the first time at or after |time| that is a multiple of
+  // |interval| from the jittered epoch.
+  absl::Time AlignUp(absl::Time time, absl::Duration interval) const;
+
+  QueryEngine &engine_;
+  Clock *clock_;
+  const absl::Duration tick_;
+  // Offset of all scheduled runs from the Unix epoch.
+  const absl::Duration jitter_;
+  mutable absl::Mutex mutex_;
+  SubscriptionId next_id_ ABSL_GUARDED_BY(mutex_) = 0;
+  absl::btree_map<SubscriptionId, Subscription> subscriptions_
+      ABSL_GUARDED_BY(mutex_);
+  uint64_t skipped_runs_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool stopped_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+}  // namespace ecclesia
+
+#endif  // ECCLESIA_LIB_REDFISH_DELLICIUS_ENGINE_QUERY_SCHEDULER_H_
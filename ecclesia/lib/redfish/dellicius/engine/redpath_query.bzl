@@ -45,3 +45,63 @@ def redpath_queries(name, srcs, cc_namespace, var_name, visibility = None):
         var_name = var_name,
         visibility = visibility,
     )
+
+def compiled_redpath_queries(
+        name,
+        srcs,
+        cc_namespace,
+        var_name,
+        query_rules = None,
+        visibility = None,
+        compiler_label = "//ecclesia/lib/redfish/dellicius/engine:query_compiler_main"):
+    """Given a set of RedPath queries, compile them into query plans and create data library to access them.
+
+    Each query is compiled into a binary CompiledQuery proto with the RedPath of
+    every subquery split into location steps and the applicable query rules
+    embedded. Query engines load these through QueryContext.compiled_query_files
+    without parsing any text. Malformed queries fail the build.
+
+    Args:
+        name: Name of the resulting library.
+        srcs: A list of source RedPath textproto queries to compile into the library.
+        cc_namespace: C++ namespace for underlying data to be accessible
+        var_name: C++ variable name for underlying data to use
+        query_rules: Optional QueryRules textproto with rules for the queries.
+        visibility: Built rule visibility for the final data.
+        compiler_label: a query compiler bazel label.
+    """
+    rules_srcs = []
+    rules_flag = ""
+    if query_rules:
+        rules_srcs = [query_rules]
+        rules_flag = "--query_rules=$(location %s) " % query_rules
+
+    # Compile each file in the srcs into a binary CompiledQuery proto
+    compiled_outs = []
+    for src in srcs:
+        if not src.endswith(".textproto") and not src.endswith(".textpb"):
+            fail("Textproto files must end in '.textproto' or '.textpb'. Violating src file: %s" % (src))
+        no_suffix_src = src.rsplit(".", 1)[0]
+        src_rule_name = "%s__%s" % (name, no_suffix_src)
+        out = src_rule_name + ".pb"
+        compiled_outs.append(out)
+        native.genrule(
+            name = src_rule_name,
+            srcs = [src] + rules_srcs,
+            outs = [out],
+            tools = [compiler_label],
+            cmd = "$(location %s) %s--output=$@ $(location %s)" % (
+                compiler_label,
+                rules_flag,
+                src,
+            ),
+        )
+
+    # Bundle all of the output files into
+    cc_data_library(
+        name = name,
+        data = compiled_outs,
+        cc_namespace = cc_namespace,
+        var_name = var_name,
+        visibility = visibility,
+    )
@@ -30,8 +30,12 @@
 
 #include <stdlib.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
 #include <memory>
 #include <ostream>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -48,11 +52,18 @@
 #include "absl/flags/flag.h"
 #include "absl/log/globals.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_cost_estimate.pb.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_cost_estimator.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_rules.pb.h"
+#include "ecclesia/lib/redfish/dellicius/query/query.pb.h"
 #include "ecclesia/lib/redfish/dellicius/utils/query_validator.h"
+#include "ecclesia/lib/redfish/transport/interface.h"
+#include "google/protobuf/text_format.h"
 
 using ::devtools::api::Finding;
 using ::devtools::api::source::PresubmitRequest;
@@ -63,6 +74,18 @@ using ::devtools::api::source::presubmit_build_target::ReadRequest;
 using ::devtools::api::source::presubmit_build_target::WriteResponse;
 using Status = ::devtools::api::source::piper::Presubmit::Status;
 
+// Flags that enable cost estimation of redpath queries against a recorded
+// trace of a Redfish service. See query_cost_estimator.h for the format.
+ABSL_FLAG(std::string, cost_trace, "",
+          "Optional path to a recorded Redfish trace to estimate the cost of "
+          "each redpath query against.");
+ABSL_FLAG(std::string, cost_query_rules, "",
+          "Optional path to a QueryRules textproto applied when estimating "
+          "query cost.");
+ABSL_FLAG(uint64_t, max_request_count, 0,
+          "Redfish requests a query may issue against --cost_trace before a "
+          "warning is raised. Zero disables the check.");
+
 namespace ecclesia {
 
 constexpr absl::string_view kDisableValidatorTag =
@@ -83,6 +106,85 @@ static std::vector<std::string> GetPathsToCheck(const PresubmitRequest& req) {
   return paths;
 }
 
+static bool ReadFile(absl::string_view path, std::string& contents) {
+  std::ifstream file{std::string(path)};
+  if (!file.is_open()) return false;
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  contents = buffer.str();
+  return true;
+}
+
+// Estimates the cost of each query in 'paths' against the trace given by
+// --cost_trace and returns a Finding for each query exceeding
+// --max_request_count and for each predicate forcing a full collection scan.
+static std::vector<Finding> EstimateQueryCosts(
+    absl::Span<const std::string> paths) {
+  std::vector<Finding> findings;
+  std::string trace;
+  if (absl::GetFlag(FLAGS_cost_trace).empty()) return findings;
+  if (!ReadFile(absl::GetFlag(FLAGS_cost_trace), trace)) {
+    LOG(ERROR) << "Cannot read trace " << absl::GetFlag(FLAGS_cost_trace);
+    return findings;
+  }
+  QueryRules query_rules;
+  std::string query_rules_text;
+  if (!absl::GetFlag(FLAGS_cost_query_rules).empty() &&
+      (!ReadFile(absl::GetFlag(FLAGS_cost_query_rules), query_rules_text) ||
+       !google::protobuf::TextFormat::ParseFromString(query_rules_text,
+                                                      &query_rules))) {
+    LOG(ERROR) << "Cannot parse query rules "
+               << absl::GetFlag(FLAGS_cost_query_rules);
+  }
+  auto trace_transport = [&]() -> std::unique_ptr<RedfishTransport> {
+    absl::StatusOr<std::unique_ptr<RecordedTraceTransport>> transport =
+        RecordedTraceTransport::Create(trace);
+    if (!transport.ok()) return nullptr;
+    return *std::move(transport);
+  };
+  const uint64_t max_request_count = absl::GetFlag(FLAGS_max_request_count);
+  for (absl::string_view path : paths) {
+    std::string query_text;
+    DelliciusQuery query;
+    if (!ReadFile(path, query_text) ||
+        !google::protobuf::TextFormat::ParseFromString(query_text, &query)) {
+      continue;
+    }
+    absl::StatusOr<QueryCostEstimate> estimate =
+        EstimateQueryCost(query, query_rules, trace_transport);
+    if (!estimate.ok()) {
+      LOG(ERROR) << "Cannot estimate cost of " << path << ": "
+                 << estimate.status();
+      continue;
+    }
+    VLOG(1) << FormatQueryCostEstimate(*estimate);
+    uint64_t request_count = estimate->request_count();
+    if (estimate->expanded_request_count() > 0) {
+      request_count = std::min(request_count,
+                               estimate->expanded_request_count());
+    }
+    if (max_request_count > 0 && request_count > max_request_count) {
+      Finding& finding = findings.emplace_back();
+      finding.mutable_location()->set_path(std::string(path));
+      finding.set_message(absl::StrCat(
+          "Costly Query Warning: query ", query.query_id(), " issues ",
+          request_count, " Redfish requests, more than the limit of ",
+          max_request_count));
+    }
+    for (const QueryCostEstimate::FullScan& full_scan :
+         estimate->full_scans()) {
+      Finding& finding = findings.emplace_back();
+      finding.mutable_location()->set_path(std::string(path));
+      finding.set_message(absl::StrCat(
+          "Full Collection Scan Warning: subquery ", full_scan.subquery_id(),
+          " fetches ", full_scan.member_count(), " members of ",
+          full_scan.redpath(), " to evaluate predicate [",
+          full_scan.predicate(), "]"));
+    }
+  }
+  return findings;
+}
+
 static void RunPresubmitGuardRails(absl::Span<const std::string> paths,
                                    PresubmitResponse& resp) {
   RedPathQueryValidator validator;
@@ -94,11 +196,12 @@ static void RunPresubmitGuardRails(absl::Span<const std::string> paths,
     }
   }
   const bool errors_occurred = !validator.GetErrors().empty();
+  std::vector<Finding> cost_findings = EstimateQueryCosts(paths);
   resp.set_succeeded(true);
   // Add warnings to response. Add each warning as a Finding member in the
   // PresubmitResponse. Downgrade the failure status to warning if there
   // are no errors.
-  if (!validator.GetWarnings().empty()) {
+  if (!validator.GetWarnings().empty() || !cost_findings.empty()) {
     resp.set_succeeded(false);
     for (const RedPathQueryValidator::Warning& warning :
          validator.GetWarnings()) {
@@ -109,6 +212,9 @@ static void RunPresubmitGuardRails(absl::Span<const std::string> paths,
           " Warning: ", warning.message));
       *resp.add_finding() = std::move(finding);
     }
+    for (Finding& finding : cost_findings) {
+      *resp.add_finding() = std::move(finding);
+    }
     if (!errors_occurred) {
       resp.set_failure_message(absl::StrCat(
           "Warnings raised for one or more redpath queries. These can be "
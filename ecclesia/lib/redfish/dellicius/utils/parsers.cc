@@ -26,6 +26,38 @@ namespace ecclesia {
 
 using ExpandConfiguration = RedPathPrefixWithQueryParams::ExpandConfiguration;
 
+RedPathRedfishQueryParams ParseQueryRules(
+    const QueryRules::RedPathPrefixSetWithQueryParams
+        &prefix_set_with_query_params) {
+  RedPathRedfishQueryParams redpath_prefix_to_params;
+  // Iterate over each pair of RedPath prefix and Redfish query parameter
+  // configuration and build the prefix to param mapping in memory.
+  for (const auto &redpath_prefix_with_query_params :
+       prefix_set_with_query_params.redpath_prefix_with_params()) {
+    RedfishQueryParamExpand::ExpandType expand_type;
+    ExpandConfiguration::ExpandType expand_type_in_rule =
+        redpath_prefix_with_query_params.expand_configuration().type();
+    if (expand_type_in_rule == ExpandConfiguration::BOTH) {
+      expand_type = RedfishQueryParamExpand::kBoth;
+    } else if (expand_type_in_rule == ExpandConfiguration::NO_LINKS) {
+      expand_type = RedfishQueryParamExpand::kNotLinks;
+    } else if (expand_type_in_rule == ExpandConfiguration::ONLY_LINKS) {
+      expand_type = RedfishQueryParamExpand::kLinks;
+    } else {
+      break;
+    }
+    GetParams params{.expand = RedfishQueryParamExpand(
+                         {.type = expand_type,
+                          .levels = redpath_prefix_with_query_params
+                                        .expand_configuration()
+                                        .level()})};
+
+    redpath_prefix_to_params[redpath_prefix_with_query_params.redpath()] =
+        params;
+  }
+  return redpath_prefix_to_params;
+}
+
 absl::flat_hash_map<std::string, RedPathRedfishQueryParams>
 ParseQueryRulesFromEmbeddedFiles(
     const std::vector<EmbeddedFile> &embedded_query_rules) {
@@ -41,33 +73,8 @@ ParseQueryRulesFromEmbeddedFiles(
     // Extract RedPath prefix to query params map for each query id.
     for (const auto &[query_id, prefix_set_with_query_params] :
          query_rules.query_id_to_params_rule()) {
-      RedPathRedfishQueryParams redpath_prefix_to_params;
-      // Iterate over each pair of RedPath prefix and Redfish query parameter
-      // configuration and build the prefix to param mapping in memory.
-      for (const auto &redpath_prefix_with_query_params :
-           prefix_set_with_query_params.redpath_prefix_with_params()) {
-        RedfishQueryParamExpand::ExpandType expand_type;
-        ExpandConfiguration::ExpandType expand_type_in_rule =
-            redpath_prefix_with_query_params.expand_configuration().type();
-        if (expand_type_in_rule == ExpandConfiguration::BOTH) {
-          expand_type = RedfishQueryParamExpand::kBoth;
-        } else if (expand_type_in_rule == ExpandConfiguration::NO_LINKS) {
-          expand_type = RedfishQueryParamExpand::kNotLinks;
-        } else if (expand_type_in_rule == ExpandConfiguration::ONLY_LINKS) {
-          expand_type = RedfishQueryParamExpand::kLinks;
-        } else {
-          break;
-        }
-        GetParams params{.expand = RedfishQueryParamExpand(
-                             {.type = expand_type,
-                              .levels = redpath_prefix_with_query_params
-                                            .expand_configuration()
-                                            .level()})};
-
-        redpath_prefix_to_params[redpath_prefix_with_query_params.redpath()] =
-            params;
-      }
-      parsed_query_rules[query_id] = redpath_prefix_to_params;
+      parsed_query_rules[query_id] =
+          ParseQueryRules(prefix_set_with_query_params);
     }
   }
   return parsed_query_rules;
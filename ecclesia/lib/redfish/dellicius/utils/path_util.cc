@@ -43,6 +43,8 @@ namespace {
 constexpr LazyRE2 kValidPropertyPathSegment = {
     "^([a-zA-Z#@][0-9a-zA-Z#@.]+)(?:\\[([0-9]+)\\]|)$"};
 
+}  // namespace
+
 std::optional<std::pair<std::string, int>> SplitNodeNameIfArrayType(
     absl::string_view node_name) {
   std::string string_index;
@@ -60,8 +62,6 @@ std::optional<std::pair<std::string, int>> SplitNodeNameIfArrayType(
   return std::pair<std::string, int>(node_name_stripped, index);
 }
 
-}  // namespace
-
 std::vector<absl::string_view> SplitExprByDelimiterWithEscape(
     absl::string_view expression, absl::string_view delimiter,
     char escape_character) {
@@ -17,6 +17,10 @@
 #ifndef ECCLESIA_LIB_REDFISH_DELLICIUS_UTILS_PATH_UTIL_H_
 #define ECCLESIA_LIB_REDFISH_DELLICIUS_UTILS_PATH_UTIL_H_
 
+#include <optional>
+#include <string>
+#include <utility>
+
 #include "absl/strings/string_view.h"
 #include "ecclesia/lib/redfish/interface.h"
 
@@ -37,6 +41,12 @@ std::vector<absl::string_view> SplitExprByDelimiterWithEscape(
 std::vector<std::string> SplitNodeNameForNestedNodes(
     absl::string_view expression);
 
+// Splits a node name indexing into an array into the array name and index.
+// Returns nullopt if the node name does not index into an array.
+// Example: "Sensors[2]" -> {"Sensors", 2}
+std::optional<std::pair<std::string, int>> SplitNodeNameIfArrayType(
+    absl::string_view node_name);
+
 // Helper function to resolve node_name for nested nodes if any and return json
 // object to be evaluated for required property.
 absl::StatusOr<nlohmann::json> ResolveNodeNameToJsonObj(
@@ -0,0 +1,207 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ecclesia/lib/redfish/dellicius/utils/query_result_delta.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/hash/hash.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ecclesia/lib/redfish/dellicius/query/query_result.pb.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
+
+namespace ecclesia {
+
+namespace {
+
+// Returns the stable id of 'data_set', or an empty string if it has none.
+std::string GetStableId(const SubqueryDataSet &data_set) {
+  if (data_set.has_devpath()) return data_set.devpath();
+  if (data_set.decorators().has_machine_devpath()) {
+    return data_set.decorators().machine_devpath();
+  }
+  if (data_set.has_redfish_location()) {
+    return absl::StrCat(data_set.redfish_location().service_label(), ":",
+                        data_set.redfish_location().part_location_context());
+  }
+  return "";
+}
+
+// Hashes the deterministic serialization of 'data_set'. Map fields such as
+// child subquery outputs serialize in a fixed order, so equal datasets have
+// equal hashes.
+uint64_t HashDataSet(const SubqueryDataSet &data_set) {
+  std::string serialized;
+  {
+    google::protobuf::io::StringOutputStream string_stream(&serialized);
+    google::protobuf::io::CodedOutputStream coded_stream(&string_stream);
+    coded_stream.SetSerializationDeterministic(true);
+    data_set.SerializeToCodedStream(&coded_stream);
+  }
+  return absl::HashOf(serialized);
+}
+
+absl::Status ToAbslStatus(const google::rpc::Status &status) {
+  return absl::Status(static_cast<absl::StatusCode>(status.code()),
+                      status.message());
+}
+
+}  // namespace
+
+QueryResultDeltaTracker::QueryResultDeltaTracker(size_t max_versions_per_query)
+    : max_versions_per_query_(std::max<size_t>(max_versions_per_query, 1)),
+      version_prefix_(absl::StrCat(absl::ToUnixNanos(absl::Now()))) {}
+
+absl::StatusOr<DelliciusQueryResultDelta>
+QueryResultDeltaTracker::ComputeDelta(const DelliciusQueryResult &result,
+                                      absl::string_view base_version) {
+  if (result.has_status()) {
+    if (absl::Status status = ToAbslStatus(result.status()); !status.ok()) {
+      return status;
+    }
+  }
+
+  DelliciusQueryResultDelta delta;
+  delta.set_query_id(result.query_id());
+  *delta.mutable_start_timestamp() = result.start_timestamp();
+  *delta.mutable_end_timestamp() = result.end_timestamp();
+  if (result.has_status()) *delta.mutable_status() = result.status();
+
+  // Visit subqueries in a fixed order so that changes are reported in the
+  // same order across results.
+  std::vector<absl::string_view> subquery_ids;
+  subquery_ids.reserve(result.subquery_output_by_id_size());
+  for (const auto &[subquery_id, subquery_output] :
+       result.subquery_output_by_id()) {
+    subquery_ids.push_back(subquery_id);
+    if (subquery_output.has_status()) {
+      (*delta.mutable_subquery_status_by_id())[subquery_id] =
+          subquery_output.status();
+    }
+  }
+  std::sort(subquery_ids.begin(), subquery_ids.end());
+
+  // A run without datasets because of failures is not a result to diff.
+  absl::flat_hash_set<std::string> failed_subquery_ids;
+  absl::Status failure;
+  bool has_data_sets = false;
+  for (absl::string_view subquery_id : subquery_ids) {
+    const SubqueryOutput &subquery_output =
+        result.subquery_output_by_id().at(std::string(subquery_id));
+    has_data_sets = has_data_sets || subquery_output.data_sets_size() > 0;
+    if (!subquery_output.has_status()) continue;
+    if (absl::Status status = ToAbslStatus(subquery_output.status());
+        !status.ok()) {
+      failed_subquery_ids.insert(std::string(subquery_id));
+      failure.Update(status);
+    }
+  }
+  if (!has_data_sets && !failure.ok()) return failure;
+
+  // Fingerprint the result. Datasets without a stable id, or sharing one,
+  // are told apart by their order of appearance.
+  ResultFingerprint fingerprint;
+  std::vector<std::pair<std::string, const SubqueryDataSet *>> keyed_datasets;
+  for (absl::string_view subquery_id : subquery_ids) {
+    absl::flat_hash_map<std::string, size_t> stable_id_count;
+    for (const SubqueryDataSet &data_set :
+         result.subquery_output_by_id().at(std::string(subquery_id))
+             .data_sets()) {
+      std::string stable_id = GetStableId(data_set);
+      size_t occurrence = stable_id_count[stable_id]++;
+      std::string key = absl::StrCat(subquery_id, "/", stable_id);
+      if (stable_id.empty() || occurrence > 0) {
+        absl::StrAppend(&key, "#", occurrence);
+      }
+      fingerprint.datasets[key] = {.hash = HashDataSet(data_set),
+                                   .subquery_id = std::string(subquery_id)};
+      keyed_datasets.push_back({std::move(key), &data_set});
+    }
+  }
+
+  absl::MutexLock lock(&mutex_);
+  fingerprint.version = absl::StrCat(version_prefix_, "-", next_version_++);
+  delta.set_version(fingerprint.version);
+  std::deque<ResultFingerprint> &fingerprints =
+      query_id_to_fingerprints_[result.query_id()];
+
+  const ResultFingerprint *base = nullptr;
+  if (!base_version.empty()) {
+    for (const ResultFingerprint &previous : fingerprints) {
+      if (previous.version == base_version) {
+        base = &previous;
+        break;
+      }
+    }
+  }
+
+  if (base != nullptr) delta.set_base_version(base->version);
+  for (auto &[key, data_set] : keyed_datasets) {
+    const DataSetFingerprint &current = fingerprint.datasets.at(key);
+    DelliciusQueryResultDelta::DataSetChange *change = nullptr;
+    if (base == nullptr) {
+      change = delta.add_added();
+    } else if (auto iter = base->datasets.find(key);
+               iter == base->datasets.end()) {
+      change = delta.add_added();
+    } else if (iter->second.hash != current.hash) {
+      change = delta.add_changed();
+    } else {
+      continue;
+    }
+    change->set_key(key);
+    change->set_subquery_id(current.subquery_id);
+    *change->mutable_data_set() = *data_set;
+  }
+  if (base != nullptr) {
+    std::vector<absl::string_view> removed;
+    for (const auto &[key, base_data_set] : base->datasets) {
+      if (fingerprint.datasets.contains(key)) continue;
+      // Keep the datasets of failed subqueries for the next delta to compare
+      // against.
+      if (failed_subquery_ids.contains(base_data_set.subquery_id)) {
+        fingerprint.datasets[key] = base_data_set;
+        continue;
+      }
+      removed.push_back(key);
+    }
+    std::sort(removed.begin(), removed.end());
+    for (absl::string_view key : removed) {
+      delta.add_removed(std::string(key));
+    }
+  }
+
+  fingerprints.push_back(std::move(fingerprint));
+  if (fingerprints.size() > max_versions_per_query_) fingerprints.pop_front();
+  return delta;
+}
+
+}  // namespace ecclesia
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ECCLESIA_LIB_REDFISH_DELLICIUS_UTILS_QUERY_RESULT_DELTA_H_
+#define ECCLESIA_LIB_REDFISH_DELLICIUS_UTILS_QUERY_RESULT_DELTA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "ecclesia/lib/redfish/dellicius/query/query_result.pb.h"
+
+namespace ecclesia {
+
+// Keeps a fingerprint of recent results of each query to report the changes
+// between successive results as a DelliciusQueryResultDelta.
+//
+// A fingerprint holds a hash per root subquery dataset, keyed by the subquery
+// id and stable id of the dataset, so memory use scales with the number of
+// datasets rather than their size. The last |max_versions_per_query| versions
+// are retained per query, which allows a few consumers of the same query to
+// progress independently.
+//
+// This class is thread-safe.
+class QueryResultDeltaTracker {
+ public:
+  explicit QueryResultDeltaTracker(size_t max_versions_per_query = 4);
+
+  // Records 'result' as the latest version of its query and returns the
+  // changes relative to 'base_version'. If 'base_version' is empty or no
+  // longer retained, every dataset in 'result' is reported as added.
+  //
+  // Datasets of subqueries that failed are not reported as removed, as their
+  // absence says nothing about the system. If the query failed as a whole, or
+  // every subquery failed without producing a dataset, the error is returned
+  // instead and 'result' is not recorded.
+  absl::StatusOr<DelliciusQueryResultDelta> ComputeDelta(
+      const DelliciusQueryResult &result, absl::string_view base_version);
+
+ private:
+  // Hash of a root subquery dataset along with the id of the subquery.
+  struct DataSetFingerprint {
+    uint64_t hash;
+    std::string subquery_id;
+  };
+  struct ResultFingerprint {
+    std::string version;
+    // Maps dataset key to the fingerprint of the dataset.
+    absl::flat_hash_map<std::string, DataSetFingerprint> datasets;
+  };
+
+  const size_t max_versions_per_query_;
+  // Distinguishes version tokens issued by different tracker instances.
+  const std::string version_prefix_;
+  absl::Mutex mutex_;
+  uint64_t next_version_ ABSL_GUARDED_BY(mutex_) = 0;
+  absl::flat_hash_map<std::string, std::deque<ResultFingerprint>>
+      query_id_to_fingerprints_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace ecclesia
+
+#endif  // ECCLESIA_LIB_REDFISH_DELLICIUS_UTILS_QUERY_RESULT_DELTA_H_
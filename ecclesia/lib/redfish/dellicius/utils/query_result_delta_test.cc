@@ -0,0 +1,222 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ecclesia/lib/redfish/dellicius/utils/query_result_delta.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "ecclesia/lib/protobuf/parse.h"
+#include "ecclesia/lib/redfish/dellicius/query/query_result.pb.h"
+#include "ecclesia/lib/status/test_macros.h"
+#include "ecclesia/lib/testing/proto.h"
+#include "ecclesia/lib/testing/status.h"
+
+namespace ecclesia {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::SizeIs;
+
+constexpr char kSensorResult[] = R"pb(
+  query_id: "SensorCollector"
+  subquery_output_by_id {
+    key: "Sensors"
+    value {
+      data_sets {
+        devpath: "/phys/PSU0"
+        properties { name: "Reading" int64_value: 10 }
+      }
+      data_sets {
+        devpath: "/phys/PSU1"
+        properties { name: "Reading" int64_value: 20 }
+      }
+    }
+  }
+)pb";
+
+TEST(QueryResultDeltaTrackerTest, ReportsEverythingWithoutBaseVersion) {
+  QueryResultDeltaTracker tracker;
+  ECCLESIA_ASSIGN_OR_FAIL(
+      DelliciusQueryResultDelta delta,
+      tracker.ComputeDelta(ParseTextProtoOrDie(kSensorResult),
+                           /*base_version=*/""));
+  EXPECT_EQ(delta.query_id(), "SensorCollector");
+  EXPECT_TRUE(delta.base_version().empty());
+  EXPECT_FALSE(delta.version().empty());
+  EXPECT_THAT(delta.added(), SizeIs(2));
+  EXPECT_THAT(delta.changed(), IsEmpty());
+  EXPECT_THAT(delta.removed(), IsEmpty());
+}
+
+TEST(QueryResultDeltaTrackerTest, ReportsNothingForUnchangedResult) {
+  QueryResultDeltaTracker tracker;
+  DelliciusQueryResult result = ParseTextProtoOrDie(kSensorResult);
+  ECCLESIA_ASSIGN_OR_FAIL(DelliciusQueryResultDelta first,
+                          tracker.ComputeDelta(result, ""));
+  ECCLESIA_ASSIGN_OR_FAIL(DelliciusQueryResultDelta second,
+                          tracker.ComputeDelta(result, first.version()));
+  EXPECT_EQ(second.base_version(), first.version());
+  EXPECT_NE(second.version(), first.version());
+  EXPECT_THAT(second.added(), IsEmpty());
+  EXPECT_THAT(second.changed(), IsEmpty());
+  EXPECT_THAT(second.removed(), IsEmpty());
+}
+
+TEST(QueryResultDeltaTrackerTest, ReportsAddedChangedAndRemovedDataSets) {
+  QueryResultDeltaTracker tracker;
+  ECCLESIA_ASSIGN_OR_FAIL(
+      DelliciusQueryResultDelta first,
+      tracker.ComputeDelta(ParseTextProtoOrDie(kSensorResult), ""));
+
+  DelliciusQueryResult result = ParseTextProtoOrDie(R"pb(
+    query_id: "SensorCollector"
+    subquery_output_by_id {
+      key: "Sensors"
+      value {
+        data_sets {
+          devpath: "/phys/PSU0"
+          properties { name: "Reading" int64_value: 11 }
+        }
+        data_sets {
+          devpath: "/phys/PSU2"
+          properties { name: "Reading" int64_value: 30 }
+        }
+      }
+    }
+  )pb");
+  ECCLESIA_ASSIGN_OR_FAIL(DelliciusQueryResultDelta second,
+                          tracker.ComputeDelta(result, first.version()));
+  EXPECT_THAT(second.added(), ElementsAre(EqualsProto(R"pb(
+                key: "Sensors//phys/PSU2"
+                subquery_id: "Sensors"
+                data_set {
+                  devpath: "/phys/PSU2"
+                  properties { name: "Reading" int64_value: 30 }
+                }
+              )pb")));
+  EXPECT_THAT(second.changed(), ElementsAre(EqualsProto(R"pb(
+                key: "Sensors//phys/PSU0"
+                subquery_id: "Sensors"
+                data_set {
+                  devpath: "/phys/PSU0"
+                  properties { name: "Reading" int64_value: 11 }
+                }
+              )pb")));
+  EXPECT_THAT(second.removed(), ElementsAre("Sensors//phys/PSU1"));
+}
+
+TEST(QueryResultDeltaTrackerTest, ExpiresOldVersions) {
+  QueryResultDeltaTracker tracker(/*max_versions_per_query=*/1);
+  DelliciusQueryResult result = ParseTextProtoOrDie(kSensorResult);
+  ECCLESIA_ASSIGN_OR_FAIL(DelliciusQueryResultDelta first,
+                          tracker.ComputeDelta(result, ""));
+  EXPECT_THAT(tracker.ComputeDelta(result, ""), IsOk());
+  ECCLESIA_ASSIGN_OR_FAIL(DelliciusQueryResultDelta third,
+                          tracker.ComputeDelta(result, first.version()));
+  EXPECT_TRUE(third.base_version().empty());
+  EXPECT_THAT(third.added(), SizeIs(2));
+}
+
+TEST(QueryResultDeltaTrackerTest, KeysDataSetsWithoutStableIdByPosition) {
+  QueryResultDeltaTracker tracker;
+  ECCLESIA_ASSIGN_OR_FAIL(
+      DelliciusQueryResultDelta delta,
+      tracker.ComputeDelta(ParseTextProtoOrDie(R"pb(
+                             query_id: "ServiceRoot"
+                             subquery_output_by_id {
+                               key: "RedfishVersion"
+                               value {
+                                 data_sets {
+                                   properties {
+                                     name: "Version"
+                                     string_value: "1.6.0"
+                                   }
+                                 }
+                               }
+                             }
+                           )pb"),
+                           ""));
+  ASSERT_THAT(delta.added(), SizeIs(1));
+  EXPECT_EQ(delta.added(0).key(), "RedfishVersion/#0");
+}
+
+TEST(QueryResultDeltaTrackerTest, ReturnsErrorOfFailedQuery) {
+  QueryResultDeltaTracker tracker;
+  ECCLESIA_ASSIGN_OR_FAIL(
+      DelliciusQueryResultDelta first,
+      tracker.ComputeDelta(ParseTextProtoOrDie(kSensorResult), ""));
+
+  EXPECT_THAT(tracker.ComputeDelta(ParseTextProtoOrDie(R"pb(
+                                     query_id: "SensorCollector"
+                                     status {
+                                       code: 9
+                                       message: "Cannot query service root"
+                                     }
+                                   )pb"),
+                                   first.version()),
+              IsStatusFailedPrecondition());
+  // A run whose every subquery failed is not reported as removals either.
+  EXPECT_THAT(tracker.ComputeDelta(ParseTextProtoOrDie(R"pb(
+                                     query_id: "SensorCollector"
+                                     subquery_output_by_id {
+                                       key: "Sensors"
+                                       value { status { code: 4 } }
+                                     }
+                                   )pb"),
+                                   first.version()),
+              IsStatusDeadlineExceeded());
+
+  // The base version is still usable after failed runs.
+  ECCLESIA_ASSIGN_OR_FAIL(
+      DelliciusQueryResultDelta second,
+      tracker.ComputeDelta(ParseTextProtoOrDie(kSensorResult),
+                           first.version()));
+  EXPECT_EQ(second.base_version(), first.version());
+  EXPECT_THAT(second.added(), IsEmpty());
+  EXPECT_THAT(second.removed(), IsEmpty());
+}
+
+TEST(QueryResultDeltaTrackerTest, KeepsDataSetsOfFailedSubqueries) {
+  QueryResultDeltaTracker tracker;
+  DelliciusQueryResult result = ParseTextProtoOrDie(kSensorResult);
+  (*result.mutable_subquery_output_by_id())["Processors"] = ParseTextProtoOrDie(
+      R"pb(data_sets { devpath: "/phys/CPU0" })pb");
+  ECCLESIA_ASSIGN_OR_FAIL(DelliciusQueryResultDelta first,
+                          tracker.ComputeDelta(result, ""));
+
+  DelliciusQueryResult partial_result = ParseTextProtoOrDie(kSensorResult);
+  (*partial_result.mutable_subquery_output_by_id())["Processors"] =
+      ParseTextProtoOrDie(R"pb(status { code: 13 })pb");
+  ECCLESIA_ASSIGN_OR_FAIL(
+      DelliciusQueryResultDelta second,
+      tracker.ComputeDelta(partial_result, first.version()));
+  EXPECT_THAT(second.removed(), IsEmpty());
+  EXPECT_THAT(second.subquery_status_by_id(), SizeIs(1));
+
+  // Datasets missing after a successful run are removed from the version of
+  // the partial run.
+  DelliciusQueryResult sensor_result = ParseTextProtoOrDie(kSensorResult);
+  (*sensor_result.mutable_subquery_output_by_id())["Processors"];
+  ECCLESIA_ASSIGN_OR_FAIL(
+      DelliciusQueryResultDelta third,
+      tracker.ComputeDelta(sensor_result, second.version()));
+  EXPECT_THAT(third.removed(), ElementsAre("Processors//phys/CPU0"));
+}
+
+}  // namespace
+}  // namespace ecclesia
@@ -0,0 +1,187 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ecclesia/lib/redfish/dellicius/utils/query_rules_synthesizer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/btree_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "ecclesia/lib/redfish/dellicius/engine/internal/interface.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_rules.pb.h"
+#include "ecclesia/lib/redfish/interface.h"
+#include "ecclesia/lib/status/macros.h"
+
+namespace ecclesia {
+
+namespace {
+
+using ExpandConfiguration = RedPathPrefixWithQueryParams::ExpandConfiguration;
+
+// Returns true if |child| is a RedPath strictly below |parent|.
+bool IsDescendant(absl::string_view child, absl::string_view parent) {
+  if (child.size() <= parent.size() || !absl::StartsWith(child, parent)) {
+    return false;
+  }
+  char next = child[parent.size()];
+  return next == '/' || next == '[';
+}
+
+// Returns the number of $expand levels needed for a response fetched at
+// |parent| to embed |child|. Node names and predicates each count as a level,
+// consistent with how the query planner resolves expanded RedPaths.
+size_t ExpandLevelsBetween(absl::string_view child, absl::string_view parent) {
+  size_t levels = 0;
+  absl::string_view diff = child.substr(parent.size());
+  for (absl::string_view step : absl::StrSplit(diff, '/', absl::SkipEmpty())) {
+    size_t predicate_start = step.find('[');
+    if (predicate_start != 0) ++levels;
+    if (predicate_start != absl::string_view::npos) ++levels;
+  }
+  return levels;
+}
+
+// Returns the $expand type to use given the service capabilities.
+absl::StatusOr<ExpandConfiguration::ExpandType> GetExpandType(
+    const RedfishSupportedFeatures &features) {
+  if (features.expand.no_links) return ExpandConfiguration::NO_LINKS;
+  if (features.expand.expand_all) return ExpandConfiguration::BOTH;
+  return absl::FailedPreconditionError(
+      "Redfish service does not support a usable $expand type");
+}
+
+}  // namespace
+
+std::string QueryRuleSynthesisReport::ToString() const {
+  return absl::StrFormat("Estimated Redfish requests: %d without rules, %d "
+                         "with rules",
+                         requests_without_rules, requests_with_rules);
+}
+
+absl::StatusOr<SynthesizedQueryRules> SynthesizeQueryRules(
+    const QueryTracker &tracker, const RedfishSupportedFeatures &features,
+    const QueryRuleSynthesisOptions &options) {
+  ECCLESIA_ASSIGN_OR_RETURN(ExpandConfiguration::ExpandType expand_type,
+                            GetExpandType(features));
+  if (!features.expand.levels || features.expand.max_levels <= 0) {
+    return absl::FailedPreconditionError(
+        "Redfish service does not support $levels in $expand");
+  }
+  const size_t max_levels = static_cast<size_t>(features.expand.max_levels);
+
+  // Order RedPaths such that each prefix is visited before its descendants.
+  absl::btree_map<std::string, size_t> redpath_to_node_count;
+  for (const auto &[redpath, params] : tracker.redpaths_queried) {
+    auto iter = tracker.redpath_node_counts.find(redpath);
+    redpath_to_node_count[redpath] =
+        iter == tracker.redpath_node_counts.end() ? 0 : iter->second;
+  }
+
+  SynthesizedQueryRules synthesized;
+  for (const auto &[redpath, node_count] : redpath_to_node_count) {
+    synthesized.report.requests_without_rules += node_count;
+  }
+
+  absl::flat_hash_set<absl::string_view> covered;
+  size_t covered_requests = 0;
+  for (const auto &[redpath, node_count] : redpath_to_node_count) {
+    // Query parameters are looked up for RedPaths ending in a node name.
+    // Predicate RedPaths are covered by expanding the collection itself.
+    if (node_count == 0 || absl::EndsWith(redpath, "]") ||
+        covered.contains(redpath)) {
+      continue;
+    }
+
+    // Bucket traced descendants by the $expand level needed to embed them.
+    std::vector<std::vector<std::pair<absl::string_view, size_t>>>
+        descendants_by_level(max_levels + 1);
+    for (auto iter = redpath_to_node_count.upper_bound(redpath);
+         iter != redpath_to_node_count.end() &&
+         absl::StartsWith(iter->first, redpath);
+         ++iter) {
+      if (!IsDescendant(iter->first, redpath) || covered.contains(iter->first))
+        continue;
+      size_t levels = ExpandLevelsBetween(iter->first, redpath);
+      if (levels <= max_levels) {
+        descendants_by_level[levels].push_back({iter->first, iter->second});
+      }
+    }
+
+    // Pick the deepest level that embeds something new without exceeding the
+    // payload budget for a single response.
+    size_t chosen_level = 0;
+    size_t embedded_nodes = 0;
+    for (size_t level = 1; level <= max_levels; ++level) {
+      if (descendants_by_level[level].empty()) continue;
+      size_t nodes_at_level = 0;
+      for (const auto &[descendant, count] : descendants_by_level[level]) {
+        nodes_at_level += count;
+      }
+      // Estimate per-response size by spreading embedded nodes evenly across
+      // each time this RedPath was fetched.
+      size_t nodes_per_response =
+          1 + (embedded_nodes + nodes_at_level + node_count - 1) / node_count;
+      if (nodes_per_response * options.estimated_resource_bytes >
+          options.max_payload_bytes) {
+        break;
+      }
+      embedded_nodes += nodes_at_level;
+      chosen_level = level;
+    }
+    if (chosen_level == 0) continue;
+
+    for (size_t level = 1; level <= chosen_level; ++level) {
+      for (const auto &[descendant, count] : descendants_by_level[level]) {
+        covered.insert(descendant);
+        covered_requests += count;
+      }
+    }
+    RedPathPrefixWithQueryParams *rule =
+        synthesized.rules.add_redpath_prefix_with_params();
+    rule->set_redpath(redpath);
+    rule->mutable_expand_configuration()->set_level(chosen_level);
+    rule->mutable_expand_configuration()->set_type(expand_type);
+  }
+
+  synthesized.report.requests_with_rules =
+      synthesized.report.requests_without_rules -
+      std::min(covered_requests, synthesized.report.requests_without_rules);
+  return synthesized;
+}
+
+absl::StatusOr<QueryRules> SynthesizeQueryRulesForQuery(
+    absl::string_view query_id, const QueryTracker &tracker,
+    const RedfishSupportedFeatures &features,
+    const QueryRuleSynthesisOptions &options) {
+  ECCLESIA_ASSIGN_OR_RETURN(SynthesizedQueryRules synthesized,
+                            SynthesizeQueryRules(tracker, features, options));
+  QueryRules query_rules;
+  (*query_rules.mutable_query_id_to_params_rule())[std::string(query_id)] =
+      std::move(synthesized.rules);
+  return query_rules;
+}
+
+}  // namespace ecclesia
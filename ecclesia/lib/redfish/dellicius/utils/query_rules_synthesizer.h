@@ -0,0 +1,82 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ECCLESIA_LIB_REDFISH_DELLICIUS_UTILS_QUERY_RULES_SYNTHESIZER_H_
+#define ECCLESIA_LIB_REDFISH_DELLICIUS_UTILS_QUERY_RULES_SYNTHESIZER_H_
+
+#include <cstddef>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "ecclesia/lib/redfish/dellicius/engine/internal/interface.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_rules.pb.h"
+#include "ecclesia/lib/redfish/interface.h"
+
+namespace ecclesia {
+
+// Bounds applied when synthesizing $expand rules from a query trace.
+struct QueryRuleSynthesisOptions {
+  // Upper bound on the estimated size of any single expanded response.
+  size_t max_payload_bytes = 1024 * 1024;
+  // Estimated serialized size of one Redfish resource. Used to estimate the
+  // size of an expanded response from the number of nodes it embeds.
+  size_t estimated_resource_bytes = 4 * 1024;
+};
+
+// Summarizes the expected effect of a synthesized rule set.
+struct QueryRuleSynthesisReport {
+  // Estimated number of Redfish requests issued by the traced query without
+  // any $expand rules.
+  size_t requests_without_rules = 0;
+  // Estimated number of Redfish requests issued with the synthesized rules.
+  size_t requests_with_rules = 0;
+
+  std::string ToString() const;
+};
+
+struct SynthesizedQueryRules {
+  QueryRules::RedPathPrefixSetWithQueryParams rules;
+  QueryRuleSynthesisReport report;
+};
+
+// Synthesizes $expand rules for the RedPath prefixes recorded in |tracker|.
+//
+// Each RedPath that resolves a Redfish resource is considered for an $expand
+// rule in lexicographic order, so that a RedPath is considered before any of
+// its descendants. The deepest $expand level supported by the
+// service is chosen such that the estimated response stays within
+// |options.max_payload_bytes|, and RedPaths embedded by an expanded ancestor
+// are not expanded again. The result minimizes round trips greedily; it is
+// exact for traces where sibling collections are of similar size.
+//
+// The tracker must come from running the query without any rules, so that
+// |QueryTracker::redpath_node_counts| reflects one request per node.
+// Returns FailedPreconditionError if the service does not support $expand.
+absl::StatusOr<SynthesizedQueryRules> SynthesizeQueryRules(
+    const QueryTracker &tracker, const RedfishSupportedFeatures &features,
+    const QueryRuleSynthesisOptions &options = {});
+
+// Convenience wrapper producing a QueryRules message for |query_id| that can
+// be written out as a query rule file.
+absl::StatusOr<QueryRules> SynthesizeQueryRulesForQuery(
+    absl::string_view query_id, const QueryTracker &tracker,
+    const RedfishSupportedFeatures &features,
+    const QueryRuleSynthesisOptions &options = {});
+
+}  // namespace ecclesia
+
+#endif  // ECCLESIA_LIB_REDFISH_DELLICIUS_UTILS_QUERY_RULES_SYNTHESIZER_H_
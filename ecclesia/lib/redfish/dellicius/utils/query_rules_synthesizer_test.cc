@@ -0,0 +1,128 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ecclesia/lib/redfish/dellicius/utils/query_rules_synthesizer.h"
+
+#include <cstddef>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "ecclesia/lib/redfish/dellicius/engine/internal/interface.h"
+#include "ecclesia/lib/redfish/dellicius/engine/query_rules.pb.h"
+#include "ecclesia/lib/redfish/interface.h"
+#include "ecclesia/lib/testing/proto.h"
+#include "ecclesia/lib/testing/status.h"
+
+namespace ecclesia {
+namespace {
+
+void AddTrace(QueryTracker &tracker, const std::string &redpath,
+              size_t node_count) {
+  tracker.redpaths_queried[redpath] = GetParams{};
+  tracker.redpath_node_counts[redpath] = node_count;
+}
+
+// Trace of a sensor query over 2 chassis with 10 sensors each.
+QueryTracker SensorQueryTrace() {
+  QueryTracker tracker;
+  AddTrace(tracker, "/Chassis", 1);
+  AddTrace(tracker, "/Chassis[*]", 2);
+  AddTrace(tracker, "/Chassis[*]/Sensors", 2);
+  AddTrace(tracker, "/Chassis[*]/Sensors[*]", 20);
+  return tracker;
+}
+
+RedfishSupportedFeatures ExpandFeatures(int max_levels) {
+  RedfishSupportedFeatures features;
+  features.expand.expand_all = true;
+  features.expand.no_links = true;
+  features.expand.levels = true;
+  features.expand.max_levels = max_levels;
+  return features;
+}
+
+TEST(QueryRulesSynthesizerTest, ExpandsCollectionsWithinLevelLimit) {
+  absl::StatusOr<SynthesizedQueryRules> synthesized =
+      SynthesizeQueryRules(SensorQueryTrace(), ExpandFeatures(1));
+  ASSERT_THAT(synthesized, IsOk());
+  EXPECT_THAT(synthesized->rules, IgnoringRepeatedFieldOrdering(EqualsProto(
+                                      R"pb(
+                                        redpath_prefix_with_params {
+                                          redpath: "/Chassis"
+                                          expand_configuration {
+                                            level: 1
+                                            type: NO_LINKS
+                                          }
+                                        }
+                                        redpath_prefix_with_params {
+                                          redpath: "/Chassis[*]/Sensors"
+                                          expand_configuration {
+                                            level: 1
+                                            type: NO_LINKS
+                                          }
+                                        }
+                                      )pb")));
+  EXPECT_EQ(synthesized->report.requests_without_rules, 25);
+  EXPECT_EQ(synthesized->report.requests_with_rules, 3);
+}
+
+TEST(QueryRulesSynthesizerTest, UsesDeepestLevelOnRootPrefix) {
+  absl::StatusOr<SynthesizedQueryRules> synthesized =
+      SynthesizeQueryRules(SensorQueryTrace(), ExpandFeatures(6));
+  ASSERT_THAT(synthesized, IsOk());
+  EXPECT_THAT(synthesized->rules, EqualsProto(R"pb(
+                redpath_prefix_with_params {
+                  redpath: "/Chassis"
+                  expand_configuration { level: 3 type: NO_LINKS }
+                }
+              )pb"));
+  EXPECT_EQ(synthesized->report.requests_with_rules, 1);
+}
+
+TEST(QueryRulesSynthesizerTest, RespectsPayloadLimit) {
+  // Allow at most 5 resources in a single response.
+  QueryRuleSynthesisOptions options{.max_payload_bytes = 5 * 1024,
+                                    .estimated_resource_bytes = 1024};
+  absl::StatusOr<SynthesizedQueryRules> synthesized =
+      SynthesizeQueryRules(SensorQueryTrace(), ExpandFeatures(6), options);
+  ASSERT_THAT(synthesized, IsOk());
+  // Expanding '/Chassis' by 2 levels embeds 2 chassis and 2 sensor
+  // collections. Sensor collections of 10 members cannot be expanded.
+  EXPECT_THAT(synthesized->rules, EqualsProto(R"pb(
+                redpath_prefix_with_params {
+                  redpath: "/Chassis"
+                  expand_configuration { level: 2 type: NO_LINKS }
+                }
+              )pb"));
+  EXPECT_EQ(synthesized->report.requests_with_rules, 21);
+}
+
+TEST(QueryRulesSynthesizerTest, FailsWithoutExpandSupport) {
+  EXPECT_THAT(SynthesizeQueryRules(SensorQueryTrace(), {}),
+              IsStatusFailedPrecondition());
+}
+
+TEST(QueryRulesSynthesizerTest, ProducesRulesForQuery) {
+  absl::StatusOr<QueryRules> rules = SynthesizeQueryRulesForQuery(
+      "SensorCollector", SensorQueryTrace(), ExpandFeatures(6));
+  ASSERT_THAT(rules, IsOk());
+  EXPECT_TRUE(rules->query_id_to_params_rule().contains("SensorCollector"));
+}
+
+}  // namespace
+}  // namespace ecclesia
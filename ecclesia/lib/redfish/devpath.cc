@@ -16,6 +16,7 @@
 
 #include "ecclesia/lib/redfish/devpath.h"
 
+#include <cstddef>
 #include <optional>
 #include <queue>
 #include <string>
@@ -23,11 +24,14 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_replace.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
+#include "ecclesia/lib/redfish/compact_node_topology.h"
 #include "ecclesia/lib/redfish/interface.h"
 #include "ecclesia/lib/redfish/node_topology.h"
 #include "ecclesia/lib/redfish/property_definitions.h"
@@ -37,6 +41,103 @@
 
 namespace ecclesia {
 
+namespace {
+
+// Calls 'func' with each non-empty segment of 'uri' until it returns false.
+template <typename Func>
+void ForEachUriSegment(absl::string_view uri, Func func) {
+  size_t pos = 0;
+  while (pos < uri.size()) {
+    size_t end = uri.find('/', pos);
+    if (end == absl::string_view::npos) end = uri.size();
+    if (end > pos && !func(uri.substr(pos, end - pos))) return;
+    pos = end + 1;
+  }
+}
+
+}  // namespace
+
+DevpathIndex::DevpathIndex(const NodeTopology &topology) : trie_(1) {
+  for (const auto &[uri, nodes] : topology.uri_to_associated_node_map) {
+    if (nodes.empty()) continue;
+    // As in GetDevpathForUri, the first Node represents the URI.
+    absl::string_view devpath = nodes.front()->local_devpath;
+    uri_to_devpath_.emplace(uri, devpath);
+    size_t trie_node = 0;
+    ForEachUriSegment(uri, [&](absl::string_view segment) {
+      auto [iter, inserted] =
+          trie_[trie_node].children.try_emplace(segment, trie_.size());
+      trie_node = iter->second;
+      if (inserted) trie_.emplace_back();
+      return true;
+    });
+    if (trie_node != 0) trie_[trie_node].devpath = devpath;
+  }
+
+  // Find the nearest replaceable Node breadth-first through the parents, as
+  // in GetReplaceableDevpathForDevpathAndNodeTopology.
+  for (const auto &[devpath, node] : topology.devpath_to_node_map) {
+    if (node == nullptr) continue;
+    const Node *replaceable = nullptr;
+    absl::flat_hash_set<const Node *> visited = {node};
+    std::queue<const Node *> node_queue;
+    node_queue.push(node);
+    while (!node_queue.empty()) {
+      const Node *current = node_queue.front();
+      node_queue.pop();
+      if (current->replaceable) {
+        replaceable = current;
+        break;
+      }
+      auto parent_iter =
+          topology.node_to_parents.find(const_cast<Node *>(current));
+      if (parent_iter == topology.node_to_parents.end()) continue;
+      for (const Node *parent : parent_iter->second) {
+        if (visited.insert(parent).second) node_queue.push(parent);
+      }
+    }
+    devpath_to_replaceable_.emplace(devpath, replaceable);
+  }
+}
+
+std::optional<absl::string_view> DevpathIndex::FindDevpathForUri(
+    absl::string_view uri) const {
+  auto iter = uri_to_devpath_.find(uri);
+  if (iter == uri_to_devpath_.end()) return std::nullopt;
+  return iter->second;
+}
+
+std::optional<absl::string_view> DevpathIndex::FindDevpathForUriPrefix(
+    absl::string_view uri, size_t min_segments) const {
+  std::optional<absl::string_view> devpath;
+  size_t trie_node = 0;
+  size_t segments = 0;
+  ForEachUriSegment(uri, [&](absl::string_view segment) {
+    auto iter = trie_[trie_node].children.find(segment);
+    if (iter == trie_[trie_node].children.end()) return false;
+    trie_node = iter->second;
+    if (++segments >= min_segments && trie_[trie_node].devpath.has_value()) {
+      devpath = trie_[trie_node].devpath;
+    }
+    return true;
+  });
+  return devpath;
+}
+
+absl::StatusOr<absl::string_view> DevpathIndex::FindReplaceableDevpath(
+    absl::string_view devpath) const {
+  auto iter = devpath_to_replaceable_.find(devpath);
+  if (iter == devpath_to_replaceable_.end()) {
+    return absl::NotFoundError(
+        absl::StrCat("NodeTopology not found through devpath: ", devpath));
+  }
+  if (iter->second == nullptr) {
+    return absl::NotFoundError(
+        absl::StrCat("No parent is replaceable: ", devpath));
+  }
+  return iter->second->local_devpath;
+}
+
 std::optional<std::string> GetDevpathForUri(const NodeTopology &topology,
                                             absl::string_view uri) {
   auto it = topology.uri_to_associated_node_map.find(uri);
@@ -58,27 +159,66 @@ absl::StatusOr<std::string> GetFirstUriForDevpath(const NodeTopology &topology,
   return it->second->associated_uris[0];
 }
 
-std::optional<std::string> GetDevpathForObjectAndNodeTopology(
-    const RedfishObject &obj, const NodeTopology &topology) {
-  if (std::optional<ResourceTypeAndVersion> type_and_version =
-          GetResourceTypeAndVersionForObject(obj);
-      type_and_version.has_value()) {
-    if (type_and_version->resource_type == ResourceManager::Name) {
-      return GetManagerDevpathFromNodeTopology(obj, topology);
-    }
-    if (type_and_version->resource_type == ResourceSensor::Name) {
-      return GetSensorDevpathFromNodeTopology(obj, topology);
-    }
+std::optional<std::string> GetDevpathForUri(
+    const CompactNodeTopology &topology, absl::string_view uri) {
+  CompactNodeTopology::IdList nodes = topology.FindNodesByUri(uri);
+  if (nodes.empty()) return std::nullopt;
+  return std::string(topology.local_devpath(nodes[0]));
+}
+
+absl::StatusOr<std::string> GetFirstUriForDevpath(
+    const CompactNodeTopology &topology, absl::string_view devpath) {
+  std::optional<CompactNodeTopology::NodeId> node =
+      topology.FindNodeByDevpath(devpath);
+  if (!node.has_value() || topology.num_associated_uris(*node) == 0) {
+    return absl::NotFoundError(
+        absl::StrCat("Unable to find a uri for devpath ", devpath));
   }
-  std::optional<std::string> maybe_uri = obj.GetUriString();
-  if (!maybe_uri.has_value()) {
-    return std::nullopt;
+  return std::string(topology.associated_uri(*node, 0));
+}
+
+std::optional<std::string> GetDevpathForUri(const DevpathIndex &index,
+                                            absl::string_view uri) {
+  std::optional<absl::string_view> devpath = index.FindDevpathForUri(uri);
+  if (!devpath.has_value()) return std::nullopt;
+  return std::string(*devpath);
+}
+
+namespace {
+
+// Returns the devpath of the Chassis containing the resource at 'uri'.
+template <typename TopologyT>
+std::optional<std::string> GetContainingChassisDevpath(
+    const TopologyT &topology, absl::string_view uri) {
+  std::vector<absl::string_view> uri_parts = absl::StrSplit(uri, '/');
+  // The URI should be of the format
+  // /redfish/v1/Chassis/<chassis-id>/{Thermals#|Sensors|Power#}/...
+  // So we can resize the parts down to /redfish/v1/Chassis/<chassis-id> which
+  // is equivalent to five parts: "", "redfish", "v1", "Chassis",
+  // "<chassis-id>"
+  if (uri_parts.size() > 5 && uri_parts[1] == kRfPropertyRedfish &&
+      uri_parts[2] == kRfPropertyV1 && uri_parts[3] == kRfPropertyChassis) {
+    uri_parts.resize(5);
+    return GetDevpathForUri(topology, absl::StrJoin(uri_parts, "/"));
   }
-  return GetDevpathForUri(topology, *maybe_uri);
+  return std::nullopt;
 }
 
-std::optional<std::string> GetSensorDevpathFromNodeTopology(
-    const RedfishObject &obj, const NodeTopology &topology) {
+// Same as above but without splitting 'uri': the devpath of the closest
+// containing resource at or below the Chassis is found in the URI trie.
+std::optional<std::string> GetContainingChassisDevpath(
+    const DevpathIndex &index, absl::string_view uri) {
+  static constexpr absl::string_view kChassisPrefix = "/redfish/v1/Chassis/";
+  if (!absl::StartsWith(uri, kChassisPrefix)) return std::nullopt;
+  std::optional<absl::string_view> devpath =
+      index.FindDevpathForUriPrefix(uri, /*min_segments=*/4);
+  if (!devpath.has_value()) return std::nullopt;
+  return std::string(*devpath);
+}
+
+template <typename TopologyT>
+std::optional<std::string> GetSensorDevpathFromNodeTopologyImpl(
+    const RedfishObject &obj, const TopologyT &topology) {
   nlohmann::json json_obj = obj.GetContentAsJson();
   if (json_obj.contains(kRfPropertyRelatedItem)) {
     nlohmann::json related_item_json = json_obj[kRfPropertyRelatedItem];
@@ -103,32 +243,15 @@ std::optional<std::string> GetSensorDevpathFromNodeTopology(
 
     // If sensor itself and Related Item don't have devpaths, check the prefix
     // Chassis URI
-    std::vector<absl::string_view> uri_parts = absl::StrSplit(*sensor_uri, '/');
-    // The URI should be of the format
-    // /redfish/v1/Chassis/<chassis-id>/{Thermals#|Sensors|Power#}/...
-    // So we can resize the parts down to /redfish/v1/Chassis/<chassis-id> which
-    // is equivalent to five parts: "", "redfish", "v1", "Chassis",
-    // "<chassis-id>"
-    if (uri_parts.size() > 5 && uri_parts[1] == kRfPropertyRedfish &&
-        uri_parts[2] == kRfPropertyV1 && uri_parts[3] == kRfPropertyChassis) {
-      uri_parts.resize(5);
-      auto devpath = GetDevpathForUri(topology, absl::StrJoin(uri_parts, "/"));
-      if (devpath.has_value()) {
-        return *devpath;
-      }
-    }
+    return GetContainingChassisDevpath(topology, *sensor_uri);
   }
   return std::nullopt;
 }
 
-std::optional<std::string> GetSensorDevpathFromNodeTopology(
-    RedfishObject *obj, const NodeTopology &topology) {
-  return GetSensorDevpathFromNodeTopology(*obj, topology);
-}
-
-std::optional<std::string> GetSlotDevpathFromNodeTopology(
+template <typename TopologyT>
+std::optional<std::string> GetSlotDevpathFromNodeTopologyImpl(
     const RedfishObject &obj, absl::string_view parent_uri,
-    const NodeTopology &topology) {
+    const TopologyT &topology) {
   // Append the parent URL to each SLOT Service label.
   std::vector<absl::string_view> uri_parts = absl::StrSplit(parent_uri, '/');
   // The URI should be of the format
@@ -165,14 +288,9 @@ std::optional<std::string> GetSlotDevpathFromNodeTopology(
   return std::nullopt;
 }
 
-std::optional<std::string> GetDevpathFromSlotDevpath(
-    absl::string_view slot_devpath) {
-  if (!absl::StrContains(slot_devpath, ":connector:")) return std::nullopt;
-  return absl::StrReplaceAll(slot_devpath, {{":connector:", "/"}});
-}
-
-std::optional<std::string> GetManagerDevpathFromNodeTopology(
-    const RedfishObject &obj, const NodeTopology &topology) {
+template <typename TopologyT>
+std::optional<std::string> GetManagerDevpathFromNodeTopologyImpl(
+    const RedfishObject &obj, const TopologyT &topology) {
   auto manager_in_chassis =
       obj[kRfPropertyLinks][kRfPropertyManagerInChassis].AsObject();
   if (manager_in_chassis != nullptr) {
@@ -200,6 +318,102 @@ std::optional<std::string> GetManagerDevpathFromNodeTopology(
   return std::nullopt;
 }
 
+template <typename TopologyT>
+std::optional<std::string> GetDevpathForObjectAndNodeTopologyImpl(
+    const RedfishObject &obj, const TopologyT &topology) {
+  if (std::optional<ResourceTypeAndVersion> type_and_version =
+          GetResourceTypeAndVersionForObject(obj);
+      type_and_version.has_value()) {
+    if (type_and_version->resource_type == ResourceManager::Name) {
+      return GetManagerDevpathFromNodeTopologyImpl(obj, topology);
+    }
+    if (type_and_version->resource_type == ResourceSensor::Name) {
+      return GetSensorDevpathFromNodeTopologyImpl(obj, topology);
+    }
+  }
+  std::optional<std::string> maybe_uri = obj.GetUriString();
+  if (!maybe_uri.has_value()) {
+    return std::nullopt;
+  }
+  return GetDevpathForUri(topology, *maybe_uri);
+}
+
+}  // namespace
+
+std::optional<std::string> GetDevpathForObjectAndNodeTopology(
+    const RedfishObject &obj, const NodeTopology &topology) {
+  return GetDevpathForObjectAndNodeTopologyImpl(obj, topology);
+}
+
+std::optional<std::string> GetDevpathForObjectAndNodeTopology(
+    const RedfishObject &obj, const CompactNodeTopology &topology) {
+  return GetDevpathForObjectAndNodeTopologyImpl(obj, topology);
+}
+
+std::optional<std::string> GetDevpathForObjectAndNodeTopology(
+    const RedfishObject &obj, const DevpathIndex &index) {
+  return GetDevpathForObjectAndNodeTopologyImpl(obj, index);
+}
+
+std::optional<std::string> GetSensorDevpathFromNodeTopology(
+    const RedfishObject &obj, const NodeTopology &topology) {
+  return GetSensorDevpathFromNodeTopologyImpl(obj, topology);
+}
+
+std::optional<std::string> GetSensorDevpathFromNodeTopology(
+    const RedfishObject &obj, const CompactNodeTopology &topology) {
+  return GetSensorDevpathFromNodeTopologyImpl(obj, topology);
+}
+
+std::optional<std::string> GetSensorDevpathFromNodeTopology(
+    const RedfishObject &obj, const DevpathIndex &index) {
+  return GetSensorDevpathFromNodeTopologyImpl(obj, index);
+}
+
+std::optional<std::string> GetSensorDevpathFromNodeTopology(
+    RedfishObject *obj, const NodeTopology &topology) {
+  return GetSensorDevpathFromNodeTopology(*obj, topology);
+}
+
+std::optional<std::string> GetSlotDevpathFromNodeTopology(
+    const RedfishObject &obj, absl::string_view parent_uri,
+    const NodeTopology &topology) {
+  return GetSlotDevpathFromNodeTopologyImpl(obj, parent_uri, topology);
+}
+
+std::optional<std::string> GetSlotDevpathFromNodeTopology(
+    const RedfishObject &obj, absl::string_view parent_uri,
+    const CompactNodeTopology &topology) {
+  return GetSlotDevpathFromNodeTopologyImpl(obj, parent_uri, topology);
+}
+
+std::optional<std::string> GetSlotDevpathFromNodeTopology(
+    const RedfishObject &obj, absl::string_view parent_uri,
+    const DevpathIndex &index) {
+  return GetSlotDevpathFromNodeTopologyImpl(obj, parent_uri, index);
+}
+
+std::optional<std::string> GetDevpathFromSlotDevpath(
+    absl::string_view slot_devpath) {
+  if (!absl::StrContains(slot_devpath, ":connector:")) return std::nullopt;
+  return absl::StrReplaceAll(slot_devpath, {{":connector:", "/"}});
+}
+
+std::optional<std::string> GetManagerDevpathFromNodeTopology(
+    const RedfishObject &obj, const NodeTopology &topology) {
+  return GetManagerDevpathFromNodeTopologyImpl(obj, topology);
+}
+
+std::optional<std::string> GetManagerDevpathFromNodeTopology(
+    const RedfishObject &obj, const CompactNodeTopology &topology) {
+  return GetManagerDevpathFromNodeTopologyImpl(obj, topology);
+}
+
+std::optional<std::string> GetManagerDevpathFromNodeTopology(
+    const RedfishObject &obj, const DevpathIndex &index) {
+  return GetManagerDevpathFromNodeTopologyImpl(obj, index);
+}
+
 absl::StatusOr<absl::string_view>
 GetReplaceableDevpathForDevpathAndNodeTopology(absl::string_view devpath,
                                                const NodeTopology &topology) {
@@ -227,4 +441,35 @@ GetReplaceableDevpathForDevpathAndNodeTopology(absl::string_view devpath,
   return node_queue.front()->local_devpath;
 }
 
+absl::StatusOr<absl::string_view>
+GetReplaceableDevpathForDevpathAndNodeTopology(
+    absl::string_view devpath, const CompactNodeTopology &topology) {
+  std::optional<CompactNodeTopology::NodeId> node =
+      topology.FindNodeByDevpath(devpath);
+  if (!node.has_value()) {
+    return absl::NotFoundError(
+        absl::StrCat("NodeTopology not found through devpath: ", devpath));
+  }
+  std::queue<CompactNodeTopology::NodeId> node_queue;
+  node_queue.push(*node);
+  while (!node_queue.empty() && !topology.replaceable(node_queue.front())) {
+    for (CompactNodeTopology::NodeId parent :
+         topology.parents(node_queue.front())) {
+      node_queue.push(parent);
+    }
+    node_queue.pop();
+  }
+  if (node_queue.empty()) {
+    return absl::NotFoundError(
+        absl::StrCat("No parent is replaceable: ", devpath));
+  }
+  return topology.local_devpath(node_queue.front());
+}
+
+absl::StatusOr<absl::string_view>
+GetReplaceableDevpathForDevpathAndNodeTopology(absl::string_view devpath,
+                                               const DevpathIndex &index) {
+  return index.FindReplaceableDevpath(devpath);
+}
+
 }  // namespace ecclesia
@@ -17,30 +17,87 @@
 #ifndef ECCLESIA_LIB_REDFISH_DEVPATH_H_
 #define ECCLESIA_LIB_REDFISH_DEVPATH_H_
 
+#include <cstddef>
 #include <optional>
 #include <string>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "ecclesia/lib/redfish/compact_node_topology.h"
 #include "ecclesia/lib/redfish/interface.h"
 #include "ecclesia/lib/redfish/node_topology.h"
 
 namespace ecclesia {
 
+// DevpathIndex answers devpath lookups against a NodeTopology from tables built
+// once, rather than by searching the topology on every lookup. URIs are
+// indexed exactly and in a trie of their path segments for longest-prefix
+// matches, and each devpath is mapped to its nearest replaceable ancestor.
+// Lookups do not allocate.
+//
+// The index refers to the Nodes of the topology, which must outlive it and
+// must not be modified while it is in use.
+class DevpathIndex {
+ public:
+  explicit DevpathIndex(const NodeTopology &topology);
+
+  // Returns the devpath of the first Node associated with 'uri'.
+  std::optional<absl::string_view> FindDevpathForUri(
+      absl::string_view uri) const;
+
+  // Returns the devpath of the first Node associated with the longest URI
+  // that is a prefix of 'uri' on a segment boundary and has at least
+  // 'min_segments' segments. "/redfish/v1/Chassis/chassis" has four segments.
+  std::optional<absl::string_view> FindDevpathForUriPrefix(
+      absl::string_view uri, size_t min_segments = 1) const;
+
+  // Returns the devpath of the Node with 'devpath' if it is replaceable, or
+  // else of its nearest replaceable ancestor.
+  absl::StatusOr<absl::string_view> FindReplaceableDevpath(
+      absl::string_view devpath) const;
+
+ private:
+  // A node of the URI trie. Node 0 is the root.
+  struct TrieNode {
+    absl::flat_hash_map<std::string, size_t> children;
+    // Devpath of the URI ending at this node, if it is associated with a Node.
+    std::optional<absl::string_view> devpath;
+  };
+
+  absl::flat_hash_map<std::string, absl::string_view> uri_to_devpath_;
+  std::vector<TrieNode> trie_;
+  // Maps each devpath to its nearest replaceable Node, or to nullptr if there
+  // is none.
+  absl::flat_hash_map<std::string, const Node *> devpath_to_replaceable_;
+};
+
 // Function to find devpath for an arbitrary URI by searching through
 // NodeTopology
 std::optional<std::string> GetDevpathForUri(const NodeTopology &topology,
                                             absl::string_view uri);
+std::optional<std::string> GetDevpathForUri(
+    const CompactNodeTopology &topology, absl::string_view uri);
+std::optional<std::string> GetDevpathForUri(const DevpathIndex &index,
+                                            absl::string_view uri);
 
 // Function to find a main uri which is the RedfishObj's uri that creates the
 // target devpath by searching through NodeTopology
 absl::StatusOr<std::string> GetFirstUriForDevpath(const NodeTopology &topology,
                                                   absl::string_view devpath);
+absl::StatusOr<std::string> GetFirstUriForDevpath(
+    const CompactNodeTopology &topology, absl::string_view devpath);
 
 // Attempts to get a devpath for a Redfish object, handling special cases like
 // Manager and Sensor resources that rely on different properties to resolve a
 // devpath.
 std::optional<std::string> GetDevpathForObjectAndNodeTopology(
     const RedfishObject &obj, const NodeTopology &topology);
+std::optional<std::string> GetDevpathForObjectAndNodeTopology(
+    const RedfishObject &obj, const CompactNodeTopology &topology);
+std::optional<std::string> GetDevpathForObjectAndNodeTopology(
+    const RedfishObject &obj, const DevpathIndex &index);
 
 // Function to find devpath for Sensor resources (Sensor/Power/Thermal) based on
 // RelatedItems
@@ -53,18 +110,36 @@ std::optional<std::string> GetDevpathForObjectAndNodeTopology(
 //
 // The RedfishObject passed to this function must be under a subURI of a Chassis
 // in order to produce a valid depvath i.e. /redfish/v1/Chassis/<chassis-id>/...
+//
+// With a DevpathIndex, the final fallback is the closest resource containing
+// the Sensor object which has a devpath, which is the Chassis unless a resource
+// in between has a devpath of its own.
 std::optional<std::string> GetSensorDevpathFromNodeTopology(
     const RedfishObject &obj, const NodeTopology &topology);
+std::optional<std::string> GetSensorDevpathFromNodeTopology(
+    const RedfishObject &obj, const CompactNodeTopology &topology);
+std::optional<std::string> GetSensorDevpathFromNodeTopology(
+    const RedfishObject &obj, const DevpathIndex &index);
 
 std::optional<std::string> GetSensorDevpathFromNodeTopology(
     RedfishObject *obj, const NodeTopology &topology);
 
 std::optional<std::string> GetManagerDevpathFromNodeTopology(
     const RedfishObject &obj, const NodeTopology &topology);
+std::optional<std::string> GetManagerDevpathFromNodeTopology(
+    const RedfishObject &obj, const CompactNodeTopology &topology);
+std::optional<std::string> GetManagerDevpathFromNodeTopology(
+    const RedfishObject &obj, const DevpathIndex &index);
 
 std::optional<std::string> GetSlotDevpathFromNodeTopology(
     const RedfishObject &obj, absl::string_view parent_uri,
     const NodeTopology &topology);
+std::optional<std::string> GetSlotDevpathFromNodeTopology(
+    const RedfishObject &obj, absl::string_view parent_uri,
+    const CompactNodeTopology &topology);
+std::optional<std::string> GetSlotDevpathFromNodeTopology(
+    const RedfishObject &obj, absl::string_view parent_uri,
+    const DevpathIndex &index);
 
 std::optional<std::string> GetDevpathFromSlotDevpath(
     absl::string_view slot_devpath);
@@ -75,6 +150,12 @@ std::optional<std::string> GetDevpathFromSlotDevpath(
 absl::StatusOr<absl::string_view>
 GetReplaceableDevpathForDevpathAndNodeTopology(absl::string_view devpath,
                                                const NodeTopology &topology);
+absl::StatusOr<absl::string_view>
+GetReplaceableDevpathForDevpathAndNodeTopology(
+    absl::string_view devpath, const CompactNodeTopology &topology);
+absl::StatusOr<absl::string_view>
+GetReplaceableDevpathForDevpathAndNodeTopology(absl::string_view devpath,
+                                               const DevpathIndex &index);
 
 }  // namespace ecclesia
 
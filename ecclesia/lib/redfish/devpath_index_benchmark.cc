@@ -0,0 +1,138 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares devpath lookups over a NodeTopology against the same lookups over
+// a DevpathIndex of it. Each iteration performs kNumLookups lookups cycling
+// through the resources of the indus mockup.
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "ecclesia/lib/redfish/devpath.h"
+#include "ecclesia/lib/redfish/interface.h"
+#include "ecclesia/lib/redfish/node_topology.h"
+#include "ecclesia/lib/redfish/testing/fake_redfish_server.h"
+#include "ecclesia/lib/redfish/testing/json_mockup.h"
+#include "ecclesia/lib/redfish/topology.h"
+
+namespace ecclesia {
+namespace {
+
+constexpr size_t kNumLookups = 50000;
+
+struct LookupSet {
+  NodeTopology topology;
+  std::unique_ptr<DevpathIndex> index;
+  std::vector<std::string> uris;
+  std::vector<std::string> devpaths;
+  // Sensors under each Chassis, whose devpath comes from the Chassis.
+  std::vector<std::unique_ptr<RedfishInterface>> sensor_intfs;
+  std::vector<std::unique_ptr<RedfishObject>> sensors;
+};
+
+const LookupSet &GetLookupSet() {
+  static const LookupSet *const lookup_set = [] {
+    auto *set = new LookupSet;
+    FakeRedfishServer server("indus_hmb_cn/mockup.shar");
+    std::unique_ptr<RedfishInterface> intf = server.RedfishClientInterface();
+    set->topology = CreateTopologyFromRedfish(intf.get());
+    set->index = std::make_unique<DevpathIndex>(set->topology);
+    for (const auto &[uri, unused] : set->topology.uri_to_associated_node_map) {
+      set->uris.push_back(uri);
+      if (!absl::StartsWith(uri, "/redfish/v1/Chassis/")) continue;
+      set->sensor_intfs.push_back(NewJsonMockupInterface(
+          absl::StrCat(R"json({"@odata.id": ")json", uri,
+                       R"json(/Sensors/sensor"})json")));
+      set->sensors.push_back(set->sensor_intfs.back()->GetRoot().AsObject());
+    }
+    for (const auto &[devpath, unused] : set->topology.devpath_to_node_map) {
+      set->devpaths.push_back(devpath);
+    }
+    return set;
+  }();
+  return *lookup_set;
+}
+
+template <typename TopologyT>
+void BM_GetDevpathForUri(benchmark::State &state, const TopologyT &topology) {
+  const LookupSet &set = GetLookupSet();
+  for (auto s : state) {
+    for (size_t i = 0; i < kNumLookups; ++i) {
+      benchmark::DoNotOptimize(
+          GetDevpathForUri(topology, set.uris[i % set.uris.size()]));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kNumLookups);
+}
+
+template <typename TopologyT>
+void BM_GetSensorDevpath(benchmark::State &state, const TopologyT &topology) {
+  const LookupSet &set = GetLookupSet();
+  for (auto s : state) {
+    for (size_t i = 0; i < kNumLookups; ++i) {
+      benchmark::DoNotOptimize(GetSensorDevpathFromNodeTopology(
+          *set.sensors[i % set.sensors.size()], topology));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kNumLookups);
+}
+
+template <typename TopologyT>
+void BM_GetReplaceableDevpath(benchmark::State &state,
+                              const TopologyT &topology) {
+  const LookupSet &set = GetLookupSet();
+  for (auto s : state) {
+    for (size_t i = 0; i < kNumLookups; ++i) {
+      benchmark::DoNotOptimize(GetReplaceableDevpathForDevpathAndNodeTopology(
+          set.devpaths[i % set.devpaths.size()], topology));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kNumLookups);
+}
+
+void BM_GetDevpathForUriTopology(benchmark::State &state) {
+  BM_GetDevpathForUri(state, GetLookupSet().topology);
+}
+void BM_GetDevpathForUriIndexed(benchmark::State &state) {
+  BM_GetDevpathForUri(state, *GetLookupSet().index);
+}
+void BM_GetSensorDevpathTopology(benchmark::State &state) {
+  BM_GetSensorDevpath(state, GetLookupSet().topology);
+}
+void BM_GetSensorDevpathIndexed(benchmark::State &state) {
+  BM_GetSensorDevpath(state, *GetLookupSet().index);
+}
+void BM_GetReplaceableDevpathTopology(benchmark::State &state) {
+  BM_GetReplaceableDevpath(state, GetLookupSet().topology);
+}
+void BM_GetReplaceableDevpathIndexed(benchmark::State &state) {
+  BM_GetReplaceableDevpath(state, *GetLookupSet().index);
+}
+
+BENCHMARK(BM_GetDevpathForUriTopology)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GetDevpathForUriIndexed)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GetSensorDevpathTopology)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GetSensorDevpathIndexed)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GetReplaceableDevpathTopology)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GetReplaceableDevpathIndexed)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace ecclesia
@@ -35,6 +35,7 @@ namespace ecclesia {
 namespace {
 
 using ::testing::NotNull;
+using ::testing::Optional;
 using ::testing::StrEq;
 
 TEST(GetDevpathForUri, DevpathAvailable) {
@@ -518,5 +519,104 @@ TEST(GetDevpathFromSlotDevpath, DevpathSuccess) {
   EXPECT_EQ(*result, expect_devpath);
 }
 
+TEST(DevpathIndex, FindsDevpathForUri) {
+  NodeTopology topology;
+  absl::string_view uri = "/redfish/v1/Chassis/chassis";
+  absl::string_view test_devpath = "/phys/test";
+  {
+    auto node = std::make_unique<Node>();
+    node->local_devpath = test_devpath;
+    topology.uri_to_associated_node_map[uri].push_back(node.get());
+    topology.nodes.push_back(std::move(node));
+  }
+
+  DevpathIndex index(topology);
+  EXPECT_THAT(GetDevpathForUri(index, uri), Optional(StrEq(test_devpath)));
+  EXPECT_EQ(GetDevpathForUri(index, "/redfish/v1/Chassis/not_here"),
+            std::nullopt);
+}
+
+TEST(DevpathIndex, FindsLongestUriPrefix) {
+  NodeTopology topology;
+  for (auto [uri, devpath] :
+       {std::pair<absl::string_view, absl::string_view>{
+            "/redfish/v1/Chassis/chassis", "/phys"},
+        {"/redfish/v1/Chassis/chassis/Drives/0", "/phys/SATA0"}}) {
+    auto node = std::make_unique<Node>();
+    node->local_devpath = devpath;
+    topology.uri_to_associated_node_map[uri].push_back(node.get());
+    topology.nodes.push_back(std::move(node));
+  }
+
+  DevpathIndex index(topology);
+  EXPECT_THAT(
+      index.FindDevpathForUriPrefix("/redfish/v1/Chassis/chassis/Drives/0/x"),
+      Optional(StrEq("/phys/SATA0")));
+  EXPECT_THAT(
+      index.FindDevpathForUriPrefix("/redfish/v1/Chassis/chassis/Sensors/s"),
+      Optional(StrEq("/phys")));
+  EXPECT_EQ(index.FindDevpathForUriPrefix("/redfish/v1/Chassis/other"),
+            std::nullopt);
+  // Prefixes shorter than 'min_segments' are not considered.
+  EXPECT_EQ(index.FindDevpathForUriPrefix(
+                "/redfish/v1/Chassis/chassis/Sensors/s", /*min_segments=*/5),
+            std::nullopt);
+}
+
+TEST(DevpathIndex, SensorUsingChassisDevpath) {
+  auto intf = NewJsonMockupInterface(R"json(
+    {
+      "@odata.id": "/redfish/v1/Chassis/chassis/Sensors/sensor"
+    }
+  )json");
+  auto json = intf->GetRoot().AsObject();
+  ASSERT_NE(json, nullptr);
+
+  NodeTopology topology;
+  absl::string_view uri = "/redfish/v1/Chassis/chassis",
+                    test_devpath = "/phys/test";
+  {
+    auto node = std::make_unique<Node>();
+    node->local_devpath = test_devpath;
+    topology.uri_to_associated_node_map[uri].push_back(node.get());
+    topology.nodes.push_back(std::move(node));
+  }
+
+  DevpathIndex index(topology);
+  EXPECT_THAT(GetSensorDevpathFromNodeTopology(*json, index),
+              Optional(StrEq(test_devpath)));
+}
+
+TEST(DevpathIndex, FindsReplaceableDevpath) {
+  NodeTopology topology;
+  auto add_node = [&](absl::string_view devpath, bool replaceable) {
+    auto node = std::make_unique<Node>();
+    node->local_devpath = devpath;
+    node->replaceable = replaceable;
+    Node *node_ptr = node.get();
+    topology.devpath_to_node_map[devpath] = node_ptr;
+    topology.nodes.push_back(std::move(node));
+    return node_ptr;
+  };
+  Node *board = add_node("/phys", true);
+  Node *connector = add_node("/phys/CPU0", false);
+  Node *orphan = add_node("/phys/orphan", false);
+  topology.node_to_parents[connector].push_back(board);
+  topology.node_to_parents[orphan];
+
+  DevpathIndex index(topology);
+  EXPECT_THAT(GetReplaceableDevpathForDevpathAndNodeTopology("/phys/CPU0",
+                                                             index),
+              IsOkAndHolds("/phys"));
+  EXPECT_THAT(GetReplaceableDevpathForDevpathAndNodeTopology("/phys", index),
+              IsOkAndHolds("/phys"));
+  EXPECT_THAT(GetReplaceableDevpathForDevpathAndNodeTopology("/phys/orphan",
+                                                             index),
+              IsStatusNotFound());
+  EXPECT_THAT(GetReplaceableDevpathForDevpathAndNodeTopology("/phys/none",
+                                                             index),
+              IsStatusNotFound());
+}
+
 }  // namespace
 }  // namespace ecclesia
@@ -16,7 +16,14 @@
 
 #include "ecclesia/lib/redfish/interface.h"
 
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
 #include "absl/types/optional.h"
 
 namespace ecclesia {
@@ -70,6 +77,77 @@ absl::Status RedfishQueryParamExpand::ValidateRedfishSupport(
   }
   return absl::OkStatus();
 }
+RedfishQueryParamFilter::RedfishQueryParamFilter(std::string filter_expression)
+    : filter_expression_(std::move(filter_expression)) {}
+
+std::string RedfishQueryParamFilter::ToString() const {
+  std::string filter = "$filter=";
+  for (char c : filter_expression_) {
+    switch (c) {
+      case ' ':
+      case '\'':
+      case '"':
+      case '#':
+      case '%':
+      case '&':
+      case '+':
+        absl::StrAppendFormat(&filter, "%%%02X", c);
+        break;
+      default:
+        filter.push_back(c);
+    }
+  }
+  return filter;
+}
+
+absl::Status RedfishQueryParamFilter::ValidateRedfishSupport(
+    const absl::optional<RedfishSupportedFeatures> &features) const {
+  if (!features.has_value() || !features->filter) {
+    return absl::InternalError("Filters are not supported.");
+  }
+  return absl::OkStatus();
+}
+
+RedfishQueryParamSelect::RedfishQueryParamSelect(
+    std::vector<std::string> properties)
+    : properties_(std::move(properties)) {}
+
+std::string RedfishQueryParamSelect::ToString() const {
+  return absl::StrCat("$select=", absl::StrJoin(properties_, ","));
+}
+
+absl::Status RedfishQueryParamSelect::ValidateRedfishSupport(
+    const absl::optional<RedfishSupportedFeatures> &features) const {
+  if (!features.has_value() || !features->select) {
+    return absl::InternalError("Selects are not supported.");
+  }
+  return absl::OkStatus();
+}
+
+std::string RedfishQueryParamTop::ToString() const {
+  return absl::StrCat("$top=", top_);
+}
+
+absl::Status RedfishQueryParamTop::ValidateRedfishSupport(
+    const absl::optional<RedfishSupportedFeatures> &features) const {
+  if (!features.has_value() || !features->top_skip) {
+    return absl::InternalError("Top is not supported.");
+  }
+  return absl::OkStatus();
+}
+
+std::string RedfishQueryParamSkip::ToString() const {
+  return absl::StrCat("$skip=", skip_);
+}
+
+absl::Status RedfishQueryParamSkip::ValidateRedfishSupport(
+    const absl::optional<RedfishSupportedFeatures> &features) const {
+  if (!features.has_value() || !features->top_skip) {
+    return absl::InternalError("Skip is not supported.");
+  }
+  return absl::OkStatus();
+}
+
 std::unique_ptr<RedfishObject> RedfishVariant::AsFreshObject() const {
   if (!ptr_) return nullptr;
   std::unique_ptr<RedfishObject> obj = ptr_->AsObject();
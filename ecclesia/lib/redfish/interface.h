@@ -90,6 +90,15 @@ struct RedfishSupportedFeatures {
     int max_levels = 0;
   };
   Expand expand;
+  // This property shall indicate whether this service supports the $filter
+  // query parameter.
+  bool filter = false;
+  // This property shall indicate whether this service supports the $select
+  // query parameter.
+  bool select = false;
+  // This property shall indicate whether this service supports the $top and
+  // $skip query parameters.
+  bool top_skip = false;
 };
 
 // Classes below provide an interface to supply query parameters to mmanager
@@ -133,6 +142,95 @@ class RedfishQueryParamExpand : public GetParamQueryInterface {
   size_t levels_;
 };
 
+// Defines Filter parameter
+// See RedFish spec 7.3.4. Use of the $filter query parameter
+// Services that honor the filter return only the collection members matching
+// the filter expression, eg. "ReadingType eq 'Temperature'".
+class RedfishQueryParamFilter : public GetParamQueryInterface {
+ public:
+  explicit RedfishQueryParamFilter(std::string filter_expression);
+
+  // Validates if redfish agent supports the Filter query parameter.
+  // Redfish agent is supposed to return ProtocolFeaturesSupported as part of
+  // the /redfish/v1 object
+  absl::Status ValidateRedfishSupport(
+      const absl::optional<RedfishSupportedFeatures> &features) const;
+
+  // Returns the filter with the expression percent-encoded for use in a URI.
+  std::string ToString() const override;
+
+  absl::string_view filter_expression() const { return filter_expression_; }
+
+ private:
+  std::string filter_expression_;
+};
+
+// Defines Select parameter
+// See RedFish spec 7.3.5. Use of the $select query parameter
+// Services that honor the parameter return only the listed properties of the
+// resource, along with the properties the specification always requires.
+class RedfishQueryParamSelect : public GetParamQueryInterface {
+ public:
+  explicit RedfishQueryParamSelect(std::vector<std::string> properties);
+
+  // Validates if redfish agent supports the Select query parameter.
+  // Redfish agent is supposed to return ProtocolFeaturesSupported as part of
+  // the /redfish/v1 object
+  absl::Status ValidateRedfishSupport(
+      const absl::optional<RedfishSupportedFeatures> &features) const;
+
+  std::string ToString() const override;
+
+  const std::vector<std::string> &properties() const { return properties_; }
+
+ private:
+  std::vector<std::string> properties_;
+};
+
+// Defines Top parameter
+// See RedFish spec 7.3.6. Use of the $top query parameter
+// Services that honor the parameter return at most the given number of
+// collection members.
+class RedfishQueryParamTop : public GetParamQueryInterface {
+ public:
+  explicit RedfishQueryParamTop(size_t top) : top_(top) {}
+
+  // Validates if redfish agent supports the Top query parameter.
+  // Redfish agent is supposed to return ProtocolFeaturesSupported as part of
+  // the /redfish/v1 object
+  absl::Status ValidateRedfishSupport(
+      const absl::optional<RedfishSupportedFeatures> &features) const;
+
+  std::string ToString() const override;
+
+  size_t top() const { return top_; }
+
+ private:
+  size_t top_;
+};
+
+// Defines Skip parameter
+// See RedFish spec 7.3.6. Use of the $skip query parameter
+// Services that honor the parameter omit the given number of collection
+// members from the start of the collection.
+class RedfishQueryParamSkip : public GetParamQueryInterface {
+ public:
+  explicit RedfishQueryParamSkip(size_t skip) : skip_(skip) {}
+
+  // Validates if redfish agent supports the Skip query parameter.
+  // Redfish agent is supposed to return ProtocolFeaturesSupported as part of
+  // the /redfish/v1 object
+  absl::Status ValidateRedfishSupport(
+      const absl::optional<RedfishSupportedFeatures> &features) const;
+
+  std::string ToString() const override;
+
+  size_t skip() const { return skip_; }
+
+ private:
+  size_t skip_;
+};
+
 // Struct to be used as a parameter to RedfishInterface implementations
 struct GetParams {
   enum class Freshness { kOptional, kRequired };
@@ -142,12 +240,28 @@ struct GetParams {
     if (expand.has_value()) {
       query_params.push_back(&expand.value());
     }
+    if (filter.has_value()) {
+      query_params.push_back(&filter.value());
+    }
+    if (select.has_value()) {
+      query_params.push_back(&select.value());
+    }
+    if (top.has_value()) {
+      query_params.push_back(&top.value());
+    }
+    if (skip.has_value()) {
+      query_params.push_back(&skip.value());
+    }
     return query_params;
   }
 
   Freshness freshness = Freshness::kOptional;
   bool auto_adjust_levels = false;
   std::optional<RedfishQueryParamExpand> expand;
+  std::optional<RedfishQueryParamFilter> filter;
+  std::optional<RedfishQueryParamSelect> select;
+  std::optional<RedfishQueryParamTop> top;
+  std::optional<RedfishQueryParamSkip> skip;
 };
 
 // RedfishVariant is the standard return type for all Redfish interfaces.
@@ -195,7 +309,15 @@ class RedfishVariant final {
   // object with expand query parameters, if available
   // kDisableAutoResolve is the most restrictive iterable mode in which the
   // navigation properties are left unresolved.
-  enum class IterableMode { kAllowExpand, kDisableExpand, kDisableAutoResolve };
+  // kPrefetchMembers behaves as kAllowExpand and additionally resolves the
+  // members ahead of their access, a bounded number at a time, on background
+  // threads. The RedfishInterface must then be safe to use concurrently.
+  enum class IterableMode {
+    kAllowExpand,
+    kDisableExpand,
+    kDisableAutoResolve,
+    kPrefetchMembers
+  };
   // ImplIntf is provided as the interface for subclasses to be implemented with
   // the PImpl idiom.
 
@@ -205,6 +327,13 @@ class RedfishVariant final {
     virtual std::unique_ptr<RedfishObject> AsObject() const = 0;
     virtual std::unique_ptr<RedfishIterable> AsIterable(
         IterableMode mode, GetParams::Freshness freshness) const = 0;
+    // Returns an iterable whose members are fetched with 'member_params'.
+    // Implementations that cannot pass query parameters to member fetches
+    // only honor the freshness requirement.
+    virtual std::unique_ptr<RedfishIterable> AsIterableWithParams(
+        IterableMode mode, const GetParams &member_params) const {
+      return AsIterable(mode, member_params.freshness);
+    }
     virtual std::optional<RedfishTransport::bytes> AsRaw() const = 0;
     virtual bool GetValue(std::string *val) const = 0;
     virtual bool GetValue(int32_t *val) const = 0;
@@ -327,6 +456,14 @@ class RedfishVariant final {
     }
     return ptr_->AsIterable(mode, freshness);
   }
+  std::unique_ptr<RedfishIterable> AsIterable(
+      IterableMode mode, const GetParams &member_params) const {
+    if (!ptr_) {
+      DLOG(INFO) << "RedfishVariant unable to create an Iterable: " << status();
+      return nullptr;
+    }
+    return ptr_->AsIterableWithParams(mode, member_params);
+  }
   std::optional<RedfishTransport::bytes> AsRaw() const {
     if (!ptr_) {
       DLOG(INFO) << "RedfishVariant unable to create Raw: " << status();
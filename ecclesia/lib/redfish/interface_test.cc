@@ -238,5 +238,49 @@ TEST(RedfishVariant, ValidateRedfishSupportFailures) {
       ecclesia::IsStatusInternal());
 }
 
+TEST(RedfishVariant, RedfishQueryParamFilter) {
+  EXPECT_EQ(RedfishQueryParamFilter("Reading gt 40").ToString(),
+            "$filter=Reading%20gt%2040");
+  EXPECT_EQ(RedfishQueryParamFilter("Name eq 'CPU#0'").ToString(),
+            "$filter=Name%20eq%20%27CPU%230%27");
+  EXPECT_THAT(RedfishQueryParamFilter("Reading gt 40")
+                  .ValidateRedfishSupport(std::nullopt),
+              ecclesia::IsStatusInternal());
+  EXPECT_THAT(RedfishQueryParamFilter("Reading gt 40")
+                  .ValidateRedfishSupport(RedfishSupportedFeatures{}),
+              ecclesia::IsStatusInternal());
+  EXPECT_THAT(RedfishQueryParamFilter("Reading gt 40")
+                  .ValidateRedfishSupport(
+                      RedfishSupportedFeatures{.filter = true}),
+              ecclesia::IsOk());
+}
+
+TEST(RedfishVariant, RedfishQueryParamSelect) {
+  EXPECT_EQ(RedfishQueryParamSelect({"Id", "Name"}).ToString(),
+            "$select=Id,Name");
+  EXPECT_THAT(
+      RedfishQueryParamSelect({"Id"}).ValidateRedfishSupport(std::nullopt),
+      ecclesia::IsStatusInternal());
+  EXPECT_THAT(RedfishQueryParamSelect({"Id"}).ValidateRedfishSupport(
+                  RedfishSupportedFeatures{}),
+              ecclesia::IsStatusInternal());
+  EXPECT_THAT(RedfishQueryParamSelect({"Id"}).ValidateRedfishSupport(
+                  RedfishSupportedFeatures{.select = true}),
+              ecclesia::IsOk());
+}
+
+TEST(RedfishVariant, RedfishQueryParamTopSkip) {
+  EXPECT_EQ(RedfishQueryParamTop(10).ToString(), "$top=10");
+  EXPECT_EQ(RedfishQueryParamSkip(20).ToString(), "$skip=20");
+  EXPECT_THAT(RedfishQueryParamTop(10).ValidateRedfishSupport(
+                  RedfishSupportedFeatures{}),
+              ecclesia::IsStatusInternal());
+  EXPECT_THAT(RedfishQueryParamSkip(20).ValidateRedfishSupport(std::nullopt),
+              ecclesia::IsStatusInternal());
+  EXPECT_THAT(RedfishQueryParamSkip(20).ValidateRedfishSupport(
+                  RedfishSupportedFeatures{.top_skip = true}),
+              ecclesia::IsOk());
+}
+
 }  // namespace
 }  // namespace ecclesia
@@ -17,15 +17,23 @@
 #ifndef ECCLESIA_LIB_REDFISH_NODE_TOPOLOGY_H_
 #define ECCLESIA_LIB_REDFISH_NODE_TOPOLOGY_H_
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "ecclesia/lib/redfish/topology_config.pb.h"
 #include "ecclesia/lib/redfish/types.h"
 
 namespace ecclesia {
 
+// The default maximum number of Redfish resources fetched concurrently while
+// creating a NodeTopology. Pass 1 to fetch resources one at a time.
+inline constexpr size_t kDefaultMaxConcurrentTopologyFetches = 8;
+
 // Node represents a single devpath from the Redfish backend and its associated
 // system data. There is a one-to-one mapping between Redfish Assembly
 // Components and Nodes.
@@ -42,6 +50,46 @@ struct Node {
   std::vector<std::string> associated_uris;
   // Whether the Node represents a part can be replaced.
   bool replaceable;
+  // Merkle hash of the name, local_devpath and type of this Node and of the
+  // Nodes attached to it, set by ComputeStructuralHashes(). Zero if not
+  // computed.
+  uint64_t structural_hash = 0;
+};
+
+// RedfishAssemblyRecord holds the data of a Redfish Assembly resource that
+// Nodes are created from.
+struct RedfishAssemblyRecord {
+  // A Component of the Assembly. Each Component is represented by a Node.
+  struct Component {
+    // Redfish @odata.id property value of the Component.
+    std::string odata_id;
+    // Name property value of the Component.
+    std::string name;
+    // Model property value of the Component.
+    std::string model;
+    // Node type derived from the Component.
+    NodeType type;
+    // URIs associated with the Component.
+    std::vector<std::string> associated_uris;
+  };
+
+  // Name property value of the Assembly.
+  std::string name;
+  // Model property value of the Assembly.
+  std::string model;
+  // The constituent Components of the Assembly.
+  std::vector<Component> components;
+  // Redfish @odata.id of the Components the Assembly is attached to.
+  std::vector<std::string> upstream_odata_ids;
+};
+
+// RedfishAssemblyOwner records a Redfish resource searched for Assembly
+// resources along with the Assemblies found there.
+struct RedfishAssemblyOwner {
+  // URI of the resource, e.g. "/redfish/v1/Systems/system/Memory/0".
+  std::string uri;
+  // Enabled Assemblies of the resource.
+  std::vector<RedfishAssemblyRecord> assemblies;
 };
 
 // NodeTopology represents the collection of Nodes comprising a Redfish backend.
@@ -62,6 +110,25 @@ struct NodeTopology {
   absl::flat_hash_map<Node *, std::vector<Node *>> node_to_parents;
   // Map of a Node to its child nodes. This is just the inverse of the above.
   absl::flat_hash_map<Node *, std::vector<Node *>> node_to_children;
+
+  // Resources searched for the Assemblies the Nodes were created from, in the
+  // order they were searched. Allows updating the topology without fetching
+  // every Assembly again. Empty if the topology was not created from
+  // Assemblies.
+  std::vector<RedfishAssemblyOwner> assembly_owners;
+
+  // The default representation and the topology config name the topology was
+  // created with, so that it can be created again the same way.
+  RedfishNodeTopologyRepresentation default_representation =
+      REDFISH_TOPOLOGY_UNSPECIFIED;
+  std::optional<std::string> topology_config_name;
+
+  // Nodes not attached to any other Node, and the hash of their structural
+  // hashes. Topologies with equal structural hashes have the same Nodes
+  // attached in the same way. Set by ComputeStructuralHashes(); the hash is
+  // zero if not computed.
+  std::vector<Node *> root_nodes;
+  uint64_t structural_hash = 0;
 };
 
 }  // namespace ecclesia
@@ -266,9 +266,12 @@ DEFINE_REDFISH_RESOURCE(OemResourceRootOfTrust, "RootOfTrust");
 
 DEFINE_REDFISH_PROPERTY(PropertyOdataId, std::string, "@odata.id");
 DEFINE_REDFISH_PROPERTY(PropertyOdataType, std::string, "@odata.type");
+DEFINE_REDFISH_PROPERTY(PropertyOdataEtag, std::string, "@odata.etag");
 DEFINE_REDFISH_PROPERTY(PropertyUuid, std::string, "UUID");
 DEFINE_REDFISH_PROPERTY(PropertyMembers, std::string, "Members");
 DEFINE_REDFISH_PROPERTY(PropertyMembersCount, int, "Members@odata.count");
+DEFINE_REDFISH_PROPERTY(PropertyMembersNextLink, std::string,
+                        "Members@odata.nextLink");
 DEFINE_REDFISH_PROPERTY(PropertyCapacityMiB, int, "CapacityMiB");
 DEFINE_REDFISH_PROPERTY(PropertyLogicalSizeMiB, int, "LogicalSizeMiB");
 DEFINE_REDFISH_PROPERTY(PropertyManufacturer, std::string, "Manufacturer");
@@ -500,6 +503,11 @@ DEFINE_REDFISH_PROPERTY(ExpandQuerykLinks, bool, "Links");
 DEFINE_REDFISH_PROPERTY(ExpandQuerykMaxLevels, int, "MaxLevels");
 DEFINE_REDFISH_PROPERTY(ExpandQuerykNoLinks, bool, "NoLinks");
 
+// Redfish agent filter, select and paging support capabilities
+DEFINE_REDFISH_PROPERTY(FilterQuery, bool, "FilterQuery");
+DEFINE_REDFISH_PROPERTY(SelectQuery, bool, "SelectQuery");
+DEFINE_REDFISH_PROPERTY(TopSkipQuery, bool, "TopSkipQuery");
+
 }  // namespace ecclesia
 
 #endif  // ECCLESIA_LIB_REDFISH_PROPERTY_DEFINITIONS_H_
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ecclesia/lib/redfish/redfish_override/compiled_override_policy.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/log/log.h"
+#include "absl/strings/string_view.h"
+#include "ecclesia/lib/redfish/redfish_override/override_edit.h"
+#include "ecclesia/lib/redfish/redfish_override/rf_override.pb.h"
+#include "re2/re2.h"
+#include "re2/set.h"
+
+namespace ecclesia {
+
+namespace {
+
+// Invalid patterns are reported once by the policy rather than by RE2.
+RE2::Options GetPatternOptions() {
+  RE2::Options options;
+  options.set_log_errors(false);
+  return options;
+}
+
+}  // namespace
+
+CompiledOverridePolicy::CompiledOverridePolicy(OverridePolicy policy)
+    : policy_(std::move(policy)),
+      regex_set_(GetPatternOptions(), RE2::ANCHOR_BOTH) {
+  for (const auto *content_map : {&policy_.override_content_map_uri(),
+                                  &policy_.override_content_map_regex()}) {
+    for (const auto &[unused, content] : *content_map) {
+      std::vector<OverrideEdit> &edits = edits_[&content];
+      edits.reserve(content.override_field_size());
+      for (const OverrideField &field : content.override_field()) {
+        edits.emplace_back(field);
+      }
+    }
+  }
+
+  // Patterns are added in order so that overrides apply in a fixed order.
+  std::vector<const std::string *> patterns;
+  patterns.reserve(policy_.override_content_map_regex_size());
+  for (const auto &[pattern, unused] : policy_.override_content_map_regex()) {
+    patterns.push_back(&pattern);
+  }
+  std::sort(patterns.begin(), patterns.end(),
+            [](const std::string *a, const std::string *b) { return *a < *b; });
+
+  regex_contents_.reserve(patterns.size());
+  for (const std::string *pattern : patterns) {
+    std::string error;
+    if (regex_set_.Add(*pattern, &error) < 0) {
+      LOG(WARNING) << "Ignoring invalid override URI pattern " << *pattern
+                   << ": " << error;
+      continue;
+    }
+    regex_contents_.push_back(
+        &policy_.override_content_map_regex().at(*pattern));
+  }
+  if (!regex_contents_.empty()) {
+    has_regex_set_ = regex_set_.Compile();
+    if (!has_regex_set_) {
+      LOG(WARNING) << "Unable to compile the override URI patterns; only "
+                      "exact URIs are overridden.";
+    }
+  }
+}
+
+std::vector<const OverridePolicy::OverrideContent *>
+CompiledOverridePolicy::Match(absl::string_view uri) const {
+  std::vector<const OverridePolicy::OverrideContent *> contents;
+  if (auto iter = policy_.override_content_map_uri().find(std::string(uri));
+      iter != policy_.override_content_map_uri().end()) {
+    contents.push_back(&iter->second);
+  }
+  if (!has_regex_set_) return contents;
+
+  std::vector<int> matches;
+  if (regex_set_.Match(uri, &matches)) {
+    std::sort(matches.begin(), matches.end());
+    for (int index : matches) {
+      contents.push_back(regex_contents_[index]);
+    }
+  }
+  return contents;
+}
+
+std::vector<const OverrideEdit *> CompiledOverridePolicy::MatchEdits(
+    absl::string_view uri) const {
+  std::vector<const OverrideEdit *> edits;
+  for (const OverridePolicy::OverrideContent *content : Match(uri)) {
+    for (const OverrideEdit &edit : edits_.at(content)) {
+      edits.push_back(&edit);
+    }
+  }
+  return edits;
+}
+
+}  // namespace ecclesia
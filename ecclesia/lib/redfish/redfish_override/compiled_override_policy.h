@@ -0,0 +1,72 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ECCLESIA_LIB_REDFISH_REDFISH_OVERRIDE_COMPILED_OVERRIDE_POLICY_H_
+#define ECCLESIA_LIB_REDFISH_REDFISH_OVERRIDE_COMPILED_OVERRIDE_POLICY_H_
+
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "ecclesia/lib/redfish/redfish_override/override_edit.h"
+#include "ecclesia/lib/redfish/redfish_override/rf_override.pb.h"
+#include "re2/set.h"
+
+namespace ecclesia {
+
+// An OverridePolicy prepared for matching request URIs.
+//
+// The URI patterns of the policy are compiled once into an RE2::Set, so that a
+// URI is matched against all of them in a single pass rather than with one
+// regular expression evaluation per pattern. Exact URIs are looked up in the
+// hash map of the policy. The override fields of each content are compiled
+// into OverrideEdits.
+//
+// This class is immutable and thread-safe.
+class CompiledOverridePolicy {
+ public:
+  explicit CompiledOverridePolicy(OverridePolicy policy);
+  CompiledOverridePolicy(const CompiledOverridePolicy &) = delete;
+  CompiledOverridePolicy &operator=(const CompiledOverridePolicy &) = delete;
+
+  const OverridePolicy &policy() const { return policy_; }
+
+  // Returns the override contents applicable to 'uri': the content for the
+  // exact URI first, followed by the contents of the matching patterns in the
+  // lexicographic order of the patterns. Patterns must match the whole URI.
+  std::vector<const OverridePolicy::OverrideContent *> Match(
+      absl::string_view uri) const;
+
+  // Returns the edits of the override contents applicable to 'uri', in the
+  // order of Match and of the fields within each content.
+  std::vector<const OverrideEdit *> MatchEdits(absl::string_view uri) const;
+
+ private:
+  const OverridePolicy policy_;
+  RE2::Set regex_set_;
+  // Whether regex_set_ holds any pattern and was compiled.
+  bool has_regex_set_ = false;
+  // Maps the index of each pattern in regex_set_ to its override content.
+  std::vector<const OverridePolicy::OverrideContent *> regex_contents_;
+  // Maps each override content of the policy to the edits of its fields.
+  absl::flat_hash_map<const OverridePolicy::OverrideContent *,
+                      std::vector<OverrideEdit>>
+      edits_;
+};
+
+}  // namespace ecclesia
+
+#endif  // ECCLESIA_LIB_REDFISH_REDFISH_OVERRIDE_COMPILED_OVERRIDE_POLICY_H_
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares matching a URI against the patterns of an override policy one
+// regular expression at a time, as RedfishTransportWithOverride used to, with
+// a single CompiledOverridePolicy match.
+
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/strings/str_cat.h"
+#include "ecclesia/lib/redfish/redfish_override/compiled_override_policy.h"
+#include "ecclesia/lib/redfish/redfish_override/rf_override.pb.h"
+#include "re2/re2.h"
+
+namespace ecclesia {
+namespace {
+
+constexpr int kPatterns = 500;
+
+// Returns a policy of kPatterns sensor patterns, one per chassis.
+const OverridePolicy &GetPolicy() {
+  static const OverridePolicy *policy = [] {
+    auto *policy = new OverridePolicy();
+    for (int i = 0; i < kPatterns; ++i) {
+      (*policy->mutable_override_content_map_regex())[absl::StrCat(
+          "/redfish/v1/Chassis/chassis", i, "/Sensors/(.*)_temp")];
+    }
+    return policy;
+  }();
+  return *policy;
+}
+
+// URIs matching one pattern and matching none.
+const std::vector<std::string> &GetUris() {
+  static const std::vector<std::string> *uris = new std::vector<std::string>{
+      absl::StrCat("/redfish/v1/Chassis/chassis", kPatterns / 2,
+                   "/Sensors/cpu0_temp"),
+      "/redfish/v1/Systems/system/Memory/dimm0",
+  };
+  return *uris;
+}
+
+void BM_FullMatchEachPattern(benchmark::State &state) {
+  const OverridePolicy &policy = GetPolicy();
+  const std::string &uri = GetUris()[state.range(0)];
+  for (auto s : state) {
+    int matches = 0;
+    for (const auto &[uri_regex, unused] :
+         policy.override_content_map_regex()) {
+      if (RE2::FullMatch(uri, uri_regex)) ++matches;
+    }
+    benchmark::DoNotOptimize(matches);
+  }
+}
+
+void BM_CompiledPolicyMatch(benchmark::State &state) {
+  CompiledOverridePolicy policy(GetPolicy());
+  const std::string &uri = GetUris()[state.range(0)];
+  for (auto s : state) {
+    benchmark::DoNotOptimize(policy.Match(uri));
+  }
+}
+
+BENCHMARK(BM_FullMatchEachPattern)->DenseRange(0, 1);
+BENCHMARK(BM_CompiledPolicyMatch)->DenseRange(0, 1);
+
+}  // namespace
+}  // namespace ecclesia
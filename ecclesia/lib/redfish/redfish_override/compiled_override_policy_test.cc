@@ -0,0 +1,152 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ecclesia/lib/redfish/redfish_override/compiled_override_policy.h"
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/string_view.h"
+#include "ecclesia/lib/protobuf/parse.h"
+#include "ecclesia/lib/redfish/redfish_override/override_edit.h"
+#include "ecclesia/lib/redfish/redfish_override/rf_override.pb.h"
+#include "ecclesia/lib/testing/status.h"
+#include "single_include/nlohmann/json.hpp"
+
+namespace ecclesia {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::IsEmpty;
+using ::testing::SizeIs;
+
+// Each override content of the policy replaces "Name" by its key.
+constexpr absl::string_view kPolicy = R"pb(
+  override_content_map_uri: {
+    key: "/redfish/v1/Chassis/chassis"
+    value: {
+      override_field:
+      [ {
+        action_replace: {
+          object_identifier: {
+            individual_object_identifier:
+            [ { field_name: "Name" }]
+          }
+          override_value: {
+            value: { string_value: "/redfish/v1/Chassis/chassis" }
+          }
+        }
+      }]
+    }
+  }
+  override_content_map_regex: {
+    key: "/redfish/v1/Chassis/.*"
+    value: {
+      override_field:
+      [ {
+        action_replace: {
+          object_identifier: {
+            individual_object_identifier:
+            [ { field_name: "Name" }]
+          }
+          override_value: { value: { string_value: "/redfish/v1/Chassis/.*" } }
+        }
+      }]
+    }
+  }
+  override_content_map_regex: {
+    key: "/redfish/v1/(.*)/chassis"
+    value: {
+      override_field:
+      [ {
+        action_replace: {
+          object_identifier: {
+            individual_object_identifier:
+            [ { field_name: "Name" }]
+          }
+          override_value: {
+            value: { string_value: "/redfish/v1/(.*)/chassis" }
+          }
+        }
+      }]
+    }
+  }
+  override_content_map_regex: {
+    key: "/redfish/v1/(unterminated"
+    value: {}
+  }
+)pb";
+
+// Returns the keys of 'contents', as stored in their replaced values.
+std::vector<std::string> GetKeys(
+    const std::vector<const OverridePolicy::OverrideContent *> &contents) {
+  std::vector<std::string> keys;
+  for (const OverridePolicy::OverrideContent *content : contents) {
+    keys.push_back(content->override_field(0)
+                       .action_replace()
+                       .override_value()
+                       .value()
+                       .string_value());
+  }
+  return keys;
+}
+
+TEST(CompiledOverridePolicyTest, MatchesExactUriThenPatternsInOrder) {
+  OverridePolicy override_policy = ParseTextProtoOrDie(kPolicy);
+  CompiledOverridePolicy policy(override_policy);
+  EXPECT_THAT(GetKeys(policy.Match("/redfish/v1/Chassis/chassis")),
+              ElementsAre("/redfish/v1/Chassis/chassis",
+                          "/redfish/v1/(.*)/chassis",
+                          "/redfish/v1/Chassis/.*"));
+  EXPECT_THAT(GetKeys(policy.Match("/redfish/v1/Systems/chassis")),
+              ElementsAre("/redfish/v1/(.*)/chassis"));
+  EXPECT_THAT(GetKeys(policy.Match("/redfish/v1/Chassis/other")),
+              ElementsAre("/redfish/v1/Chassis/.*"));
+}
+
+TEST(CompiledOverridePolicyTest, MatchesEditsInOrderOfContents) {
+  OverridePolicy override_policy = ParseTextProtoOrDie(kPolicy);
+  CompiledOverridePolicy policy(override_policy);
+  std::vector<const OverrideEdit *> edits =
+      policy.MatchEdits("/redfish/v1/Chassis/chassis");
+  ASSERT_THAT(edits, SizeIs(3));
+
+  nlohmann::json json = {{"Name", "chassis"}};
+  OverrideEditor editor(json);
+  for (const OverrideEdit *edit : edits) {
+    EXPECT_THAT(editor.Apply(*edit), IsOk());
+  }
+  EXPECT_THAT(json["Name"], Eq("/redfish/v1/Chassis/.*"));
+  EXPECT_THAT(policy.MatchEdits("/redfish/v1"), IsEmpty());
+}
+
+TEST(CompiledOverridePolicyTest, PatternsMatchWholeUri) {
+  OverridePolicy override_policy = ParseTextProtoOrDie(kPolicy);
+  CompiledOverridePolicy policy(override_policy);
+  EXPECT_THAT(policy.Match("/redfish/v1/Systems/chassis/Sensors"), IsEmpty());
+  EXPECT_THAT(policy.Match("/prefix/redfish/v1/Systems/chassis"), IsEmpty());
+}
+
+TEST(CompiledOverridePolicyTest, EmptyPolicyMatchesNothing) {
+  CompiledOverridePolicy policy(OverridePolicy::default_instance());
+  EXPECT_THAT(policy.Match("/redfish/v1"), IsEmpty());
+}
+
+}  // namespace
+}  // namespace ecclesia
@@ -0,0 +1,327 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ecclesia/lib/redfish/redfish_override/override_edit.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "absl/hash/hash.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "ecclesia/lib/redfish/redfish_override/rf_override.pb.h"
+#include "ecclesia/lib/redfish/transport/struct_proto_conversion.h"
+#include "single_include/nlohmann/json.hpp"
+
+namespace ecclesia {
+
+namespace {
+
+using OverrideValue = OverrideField::OverrideValue;
+
+const ObjectIdentifier &GetObjectIdentifier(const OverrideField &field) {
+  switch (field.Action_case()) {
+    case OverrideField::kActionReplace:
+      return field.action_replace().object_identifier();
+    case OverrideField::kActionAdd:
+      return field.action_add().object_identifier();
+    case OverrideField::kActionClear:
+      return field.action_clear().object_identifier();
+    default:
+      return ObjectIdentifier::default_instance();
+  }
+}
+
+absl::StatusOr<nlohmann::json> GetValue(const OverrideField &field) {
+  const OverrideValue *override_value = nullptr;
+  absl::string_view not_found;
+  switch (field.Action_case()) {
+    case OverrideField::kActionReplace:
+      override_value = &field.action_replace().override_value();
+      not_found = "Replace Json not found.";
+      break;
+    case OverrideField::kActionAdd:
+      override_value = &field.action_add().override_value();
+      not_found = "Added Json not found.";
+      break;
+    default:
+      return nlohmann::json();
+  }
+  if (override_value->has_value()) {
+    return ValueToJson(override_value->value());
+  }
+  if (override_value->has_override_by_reading()) {
+    return absl::UnimplementedError("To be implemented");
+  }
+  return absl::InvalidArgumentError(not_found);
+}
+
+// Returns 'index' if it is in the range of 'array', or an error otherwise.
+absl::StatusOr<size_t> CheckArrayIndex(const nlohmann::json &array,
+                                       int64_t index) {
+  if (!array.is_array()) {
+    return absl::InvalidArgumentError("Json is not an array type");
+  }
+  if (index < 0 || static_cast<size_t>(index) >= array.size()) {
+    return absl::InvalidArgumentError("index is out of array range");
+  }
+  return static_cast<size_t>(index);
+}
+
+}  // namespace
+
+OverrideEdit::OverrideEdit(const OverrideField &field)
+    : action_(field.Action_case()),
+      value_(GetValue(field)),
+      expand_only_(field.apply_condition().is_expand()) {
+  const ObjectIdentifier &object_identifier = GetObjectIdentifier(field);
+  steps_.reserve(object_identifier.individual_object_identifier_size());
+  for (const ObjectIdentifier::IndividualObjectIdentifier &identifier :
+       object_identifier.individual_object_identifier()) {
+    Step &step = steps_.emplace_back();
+    if (identifier.has_field_name()) {
+      step.kind = Step::Kind::kFieldName;
+      step.field_name = identifier.field_name();
+    } else if (identifier.has_array_field()) {
+      step.kind = Step::Kind::kArrayField;
+      step.field_name = identifier.array_field().field_name();
+      step.value = ValueToJson(identifier.array_field().value());
+    } else if (identifier.has_array_idx()) {
+      step.kind = Step::Kind::kArrayIndex;
+      step.index = identifier.array_idx();
+    }
+  }
+}
+
+size_t OverrideEditor::ValueHash::operator()(
+    const nlohmann::json *value) const {
+  switch (value->type()) {
+    case nlohmann::json::value_t::boolean:
+      return absl::HashOf(value->get<bool>());
+    case nlohmann::json::value_t::number_integer:
+    case nlohmann::json::value_t::number_unsigned:
+    case nlohmann::json::value_t::number_float: {
+      // Integers compare equal to their floating point values, and 0.0 to
+      // -0.0.
+      double number = value->get<double>();
+      return absl::HashOf(number == 0 ? 0.0 : number);
+    }
+    case nlohmann::json::value_t::string:
+      return absl::HashOf(value->get_ref<const std::string &>());
+    default:
+      // Members identifying array elements are not expected to hold objects
+      // or arrays; these are only told apart by comparison.
+      return absl::HashOf(static_cast<int>(value->type()));
+  }
+}
+
+absl::StatusOr<size_t> OverrideEditor::FindArrayElement(
+    const nlohmann::json &array, const std::string &field_name,
+    const nlohmann::json &value) {
+  if (!array.is_array()) {
+    return absl::InvalidArgumentError("Json is not an array type");
+  }
+  auto [iter, inserted] = indexes_[field_name].try_emplace(&array);
+  ArrayIndex &index = iter->second;
+  if (inserted) {
+    for (size_t i = 0; i < array.size(); ++i) {
+      const nlohmann::json &element = array[i];
+      if (!element.is_object()) continue;
+      auto member = element.find(field_name);
+      if (member != element.end()) index.try_emplace(&*member, i);
+    }
+  }
+  auto element = index.find(&value);
+  if (element == index.end()) {
+    return absl::NotFoundError("Required Json not found.");
+  }
+  return element->second;
+}
+
+absl::StatusOr<nlohmann::json *> OverrideEditor::Find(
+    absl::Span<const Step> steps) {
+  nlohmann::json *json = &json_;
+  for (const Step &step : steps) {
+    switch (step.kind) {
+      case Step::Kind::kFieldName: {
+        if (!json->is_object()) {
+          return absl::NotFoundError("Required Json not found.");
+        }
+        auto member = json->find(step.field_name);
+        if (member == json->end()) {
+          return absl::NotFoundError("Required Json not found.");
+        }
+        json = &*member;
+        break;
+      }
+      case Step::Kind::kArrayField: {
+        absl::StatusOr<size_t> index =
+            FindArrayElement(*json, step.field_name, step.value);
+        if (!index.ok()) return index.status();
+        json = &(*json)[*index];
+        break;
+      }
+      case Step::Kind::kArrayIndex: {
+        absl::StatusOr<size_t> index = CheckArrayIndex(*json, step.index);
+        if (!index.ok()) return index.status();
+        json = &(*json)[*index];
+        break;
+      }
+      default:
+        return absl::NotFoundError("Required Json not found.");
+    }
+  }
+  return json;
+}
+
+absl::Status OverrideEditor::Apply(const OverrideEdit &edit) {
+  switch (edit.action_) {
+    case OverrideField::kActionReplace:
+      return Replace(edit);
+    case OverrideField::kActionAdd:
+      return Add(edit);
+    case OverrideField::kActionClear:
+      return Clear(edit);
+    default:
+      return absl::InvalidArgumentError("No action specified");
+  }
+}
+
+absl::Status OverrideEditor::Replace(const OverrideEdit &edit) {
+  absl::StatusOr<nlohmann::json *> json = Find(edit.steps_);
+  if (!json.ok()) return json.status();
+  if (!edit.value_.ok()) return edit.value_.status();
+  if ((*json)->type() != edit.value_->type()) {
+    return absl::InvalidArgumentError(
+        "Value type is different from original type");
+  }
+  if ((*json)->is_structured()) {
+    // The indexed arrays may be replaced along with the value.
+    indexes_.clear();
+  } else if (!edit.steps_.empty() &&
+             edit.steps_.back().kind == Step::Kind::kFieldName) {
+    // The value may identify an element of an indexed array.
+    indexes_.erase(edit.steps_.back().field_name);
+  }
+  **json = *edit.value_;
+  return absl::OkStatus();
+}
+
+absl::Status OverrideEditor::Add(const OverrideEdit &edit) {
+  if (edit.steps_.empty()) {
+    return absl::InvalidArgumentError("Added Json not found.");
+  }
+  absl::Span<const Step> steps = edit.steps_;
+  absl::StatusOr<nlohmann::json *> json_or =
+      Find(steps.subspan(0, steps.size() - 1));
+  if (!json_or.ok()) return json_or.status();
+  if (!edit.value_.ok()) return edit.value_.status();
+  nlohmann::json &json = **json_or;
+
+  const Step &step = steps.back();
+  switch (step.kind) {
+    case Step::Kind::kFieldName: {
+      if (json.is_object()) {
+        if (auto member = json.find(step.field_name); member != json.end()) {
+          if (!member->is_array()) {
+            return absl::InvalidArgumentError("Json field already exist.");
+          }
+          member->push_back(*edit.value_);
+          break;
+        }
+      } else if (!json.is_null()) {
+        return absl::InvalidArgumentError("Json is not an object type");
+      }
+      json[step.field_name] = *edit.value_;
+      break;
+    }
+    case Step::Kind::kArrayField:
+      return absl::InvalidArgumentError(
+          "Please specify a field before adding inside an array type "
+          "json");
+    case Step::Kind::kArrayIndex: {
+      absl::StatusOr<size_t> index = CheckArrayIndex(json, step.index);
+      if (!index.ok()) return index.status();
+      if (!json[*index].is_array()) {
+        return absl::InvalidArgumentError(
+            "Please specify a field before adding inside an array type "
+            "json");
+      }
+      json[*index].push_back(*edit.value_);
+      break;
+    }
+    default:
+      return absl::InvalidArgumentError("Added Json not found.");
+  }
+  // Growing an array moves its elements, and the arrays they hold.
+  indexes_.clear();
+  return absl::OkStatus();
+}
+
+absl::Status OverrideEditor::Clear(const OverrideEdit &edit) {
+  if (edit.steps_.empty()) {
+    return absl::InvalidArgumentError("Cleared Json not found.");
+  }
+  absl::Span<const Step> steps = edit.steps_;
+  absl::StatusOr<nlohmann::json *> json_or =
+      Find(steps.subspan(0, steps.size() - 1));
+  if (!json_or.ok()) return json_or.status();
+  nlohmann::json &json = **json_or;
+
+  const Step &step = steps.back();
+  switch (step.kind) {
+    case Step::Kind::kFieldName: {
+      if (!json.is_object()) {
+        return absl::InvalidArgumentError("Cleared Json not found.");
+      }
+      auto member = json.find(step.field_name);
+      if (member == json.end()) {
+        return absl::InvalidArgumentError("Cleared Json not found.");
+      }
+      json.erase(member);
+      break;
+    }
+    case Step::Kind::kArrayField: {
+      absl::StatusOr<size_t> index =
+          FindArrayElement(json, step.field_name, step.value);
+      if (!index.ok()) {
+        if (absl::IsNotFound(index.status())) {
+          return absl::InvalidArgumentError("Cleared Json not found.");
+        }
+        return index.status();
+      }
+      json.erase(*index);
+      break;
+    }
+    case Step::Kind::kArrayIndex: {
+      absl::StatusOr<size_t> index = CheckArrayIndex(json, step.index);
+      if (!index.ok()) return index.status();
+      json.erase(*index);
+      break;
+    }
+    default:
+      return absl::InvalidArgumentError("Cleared Json not found.");
+  }
+  // Removing a value destroys the arrays it holds and moves the following
+  // array elements.
+  indexes_.clear();
+  return absl::OkStatus();
+}
+
+}  // namespace ecclesia
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ECCLESIA_LIB_REDFISH_REDFISH_OVERRIDE_OVERRIDE_EDIT_H_
+#define ECCLESIA_LIB_REDFISH_REDFISH_OVERRIDE_OVERRIDE_EDIT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "ecclesia/lib/redfish/redfish_override/rf_override.pb.h"
+#include "single_include/nlohmann/json.hpp"
+
+namespace ecclesia {
+
+// An OverrideField compiled into an edit of a JSON document.
+//
+// The object identifier of the field is compiled into a path of steps, each
+// selecting an object member by name, an array element by index, or an array
+// element by the value of one of its members. The values of the identifier and
+// of the action are converted to JSON once, rather than on every response.
+class OverrideEdit {
+ public:
+  explicit OverrideEdit(const OverrideField &field);
+
+  // Whether the edit applies only to responses of $expand requests.
+  bool expand_only() const { return expand_only_; }
+
+ private:
+  friend class OverrideEditor;
+
+  struct Step {
+    enum class Kind { kNone, kFieldName, kArrayField, kArrayIndex };
+
+    Kind kind = Kind::kNone;
+    // The member name for kFieldName and kArrayField.
+    std::string field_name;
+    // The member value identifying the array element for kArrayField.
+    nlohmann::json value;
+    // The array index for kArrayIndex.
+    int64_t index = 0;
+  };
+
+  OverrideField::ActionCase action_;
+  std::vector<Step> steps_;
+  // The value replaced or added by the edit, or the error to report when the
+  // edit is applied.
+  absl::StatusOr<nlohmann::json> value_;
+  bool expand_only_;
+};
+
+// Applies OverrideEdits to a JSON document in place.
+//
+// An array whose elements are selected by the value of a member is indexed by
+// that member on first use, so that each following edit of the array finds
+// its element without scanning the array. Indexes are kept across the edits
+// of the document until an edit adds or removes values from it.
+//
+// This class is not thread-safe.
+class OverrideEditor {
+ public:
+  explicit OverrideEditor(nlohmann::json &json) : json_(json) {}
+  OverrideEditor(const OverrideEditor &) = delete;
+  OverrideEditor &operator=(const OverrideEditor &) = delete;
+
+  // Applies 'edit' to the document. On error, the document is unchanged.
+  absl::Status Apply(const OverrideEdit &edit);
+
+ private:
+  using Step = OverrideEdit::Step;
+
+  // Hashes and compares JSON values by pointer, with numbers of different
+  // types equal when their values are, as for nlohmann::json comparisons.
+  struct ValueHash {
+    size_t operator()(const nlohmann::json *value) const;
+  };
+  struct ValueEq {
+    bool operator()(const nlohmann::json *a, const nlohmann::json *b) const {
+      return *a == *b;
+    }
+  };
+  // Maps each value of a member to the index of the first array element
+  // holding it.
+  using ArrayIndex =
+      absl::flat_hash_map<const nlohmann::json *, size_t, ValueHash, ValueEq>;
+
+  // Returns the value selected by 'steps' from the root of the document.
+  absl::StatusOr<nlohmann::json *> Find(absl::Span<const Step> steps);
+  // Returns the index of the first element of 'array' whose member
+  // 'field_name' equals 'value', or an error if there is none.
+  absl::StatusOr<size_t> FindArrayElement(const nlohmann::json &array,
+                                          const std::string &field_name,
+                                          const nlohmann::json &value);
+
+  absl::Status Replace(const OverrideEdit &edit);
+  absl::Status Add(const OverrideEdit &edit);
+  absl::Status Clear(const OverrideEdit &edit);
+
+  nlohmann::json &json_;
+  // Maps each member name to the indexes of arrays by that member.
+  absl::flat_hash_map<std::string,
+                      absl::flat_hash_map<const nlohmann::json *, ArrayIndex>>
+      indexes_;
+};
+
+}  // namespace ecclesia
+
+#endif  // ECCLESIA_LIB_REDFISH_REDFISH_OVERRIDE_OVERRIDE_EDIT_H_
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures applying an override of the reading of every sensor of an expanded
+// Sensor collection, with sensors selected by their "Id".
+
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/strings/str_cat.h"
+#include "ecclesia/lib/redfish/redfish_override/override_edit.h"
+#include "ecclesia/lib/redfish/redfish_override/rf_override.pb.h"
+#include "single_include/nlohmann/json.hpp"
+
+namespace ecclesia {
+namespace {
+
+void BM_ApplySensorReadingOverrides(benchmark::State &state) {
+  nlohmann::json sensors = {{"Members", nlohmann::json::array()}};
+  std::vector<OverrideEdit> edits;
+  for (int i = 0; i < state.range(0); ++i) {
+    std::string id = absl::StrCat("sensor", i);
+    sensors["Members"].push_back({{"Id", id}, {"Reading", 40.0}});
+
+    OverrideField field;
+    ObjectIdentifier *identifier =
+        field.mutable_action_replace()->mutable_object_identifier();
+    identifier->add_individual_object_identifier()->set_field_name("Members");
+    auto *array_field =
+        identifier->add_individual_object_identifier()->mutable_array_field();
+    array_field->set_field_name("Id");
+    array_field->mutable_value()->set_string_value(id);
+    identifier->add_individual_object_identifier()->set_field_name("Reading");
+    field.mutable_action_replace()
+        ->mutable_override_value()
+        ->mutable_value()
+        ->set_number_value(50.0);
+    edits.emplace_back(field);
+  }
+
+  for (auto s : state) {
+    state.PauseTiming();
+    nlohmann::json json = sensors;
+    state.ResumeTiming();
+    OverrideEditor editor(json);
+    for (const OverrideEdit &edit : edits) {
+      benchmark::DoNotOptimize(editor.Apply(edit));
+    }
+  }
+}
+
+BENCHMARK(BM_ApplySensorReadingOverrides)->Range(8, 1024);
+
+}  // namespace
+}  // namespace ecclesia
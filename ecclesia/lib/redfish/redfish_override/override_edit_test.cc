@@ -0,0 +1,282 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ecclesia/lib/redfish/redfish_override/override_edit.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "ecclesia/lib/protobuf/parse.h"
+#include "ecclesia/lib/redfish/redfish_override/rf_override.pb.h"
+#include "ecclesia/lib/testing/status.h"
+#include "single_include/nlohmann/json.hpp"
+
+namespace ecclesia {
+namespace {
+
+using ::testing::Eq;
+
+nlohmann::json GetSensors() {
+  return nlohmann::json::parse(R"json({
+    "Members": [
+      {"Id": "cpu0_temp", "Reading": 40.0},
+      {"Id": "cpu1_temp", "Reading": 41.0},
+      {"Id": 2, "Reading": 42.0},
+      {"Id": "cpu1_temp", "Reading": 43.0},
+      "NotAnObject"
+    ]
+  })json");
+}
+
+TEST(OverrideEditTest, ReplacesFirstElementMatchingMemberValue) {
+  OverrideField cpu1 = ParseTextProtoOrDie(R"pb(
+    action_replace: {
+      object_identifier: {
+        individual_object_identifier:
+        [ { field_name: "Members" }
+          , {
+            array_field: {
+              field_name: "Id"
+              value: { string_value: "cpu1_temp" }
+            }
+          }
+          , { field_name: "Reading" }]
+      }
+      override_value: { value: { number_value: 51.0 } }
+    }
+  )pb");
+  // Integers match the numbers of the policy.
+  OverrideField cpu2 = ParseTextProtoOrDie(R"pb(
+    action_replace: {
+      object_identifier: {
+        individual_object_identifier:
+        [ { field_name: "Members" }
+          , {
+            array_field: {
+              field_name: "Id"
+              value: { number_value: 2 }
+            }
+          }
+          , { field_name: "Reading" }]
+      }
+      override_value: { value: { number_value: 52.0 } }
+    }
+  )pb");
+  nlohmann::json json = GetSensors();
+  OverrideEditor editor(json);
+  EXPECT_THAT(editor.Apply(OverrideEdit(cpu1)), IsOk());
+  EXPECT_THAT(editor.Apply(OverrideEdit(cpu2)), IsOk());
+
+  nlohmann::json expected = GetSensors();
+  expected["Members"][1]["Reading"] = 51.0;
+  expected["Members"][2]["Reading"] = 52.0;
+  EXPECT_THAT(json, Eq(expected));
+}
+
+TEST(OverrideEditTest, FindsElementsAfterIdentifyingValueIsReplaced) {
+  OverrideField rename = ParseTextProtoOrDie(R"pb(
+    action_replace: {
+      object_identifier: {
+        individual_object_identifier:
+        [ { field_name: "Members" }
+          , {
+            array_field: {
+              field_name: "Id"
+              value: { string_value: "cpu0_temp" }
+            }
+          }
+          , { field_name: "Id" }]
+      }
+      override_value: { value: { string_value: "cpu9_temp" } }
+    }
+  )pb");
+  OverrideField replace_renamed = ParseTextProtoOrDie(R"pb(
+    action_replace: {
+      object_identifier: {
+        individual_object_identifier:
+        [ { field_name: "Members" }
+          , {
+            array_field: {
+              field_name: "Id"
+              value: { string_value: "cpu9_temp" }
+            }
+          }
+          , { field_name: "Reading" }]
+      }
+      override_value: { value: { number_value: 59.0 } }
+    }
+  )pb");
+  nlohmann::json json = GetSensors();
+  OverrideEditor editor(json);
+  OverrideEdit replace_edit(replace_renamed);
+  EXPECT_THAT(editor.Apply(replace_edit), IsStatusNotFound());
+  EXPECT_THAT(editor.Apply(OverrideEdit(rename)), IsOk());
+  EXPECT_THAT(editor.Apply(replace_edit), IsOk());
+  // The renamed element no longer matches.
+  EXPECT_THAT(editor.Apply(OverrideEdit(rename)), IsStatusNotFound());
+
+  nlohmann::json expected = GetSensors();
+  expected["Members"][0]["Id"] = "cpu9_temp";
+  expected["Members"][0]["Reading"] = 59.0;
+  EXPECT_THAT(json, Eq(expected));
+}
+
+TEST(OverrideEditTest, FindsElementsAfterArrayChanges) {
+  OverrideField clear = ParseTextProtoOrDie(R"pb(
+    action_clear: {
+      object_identifier: {
+        individual_object_identifier:
+        [ { field_name: "Members" }
+          , {
+            array_field: {
+              field_name: "Id"
+              value: { string_value: "cpu0_temp" }
+            }
+          }]
+      }
+    }
+  )pb");
+  OverrideField add = ParseTextProtoOrDie(R"pb(
+    action_add: {
+      object_identifier: {
+        individual_object_identifier:
+        [ { field_name: "Members" }]
+      }
+      override_value: {
+        value: {
+          struct_value: {
+            fields {
+              key: "Id"
+              value: { string_value: "dimm0_temp" }
+            }
+          }
+        }
+      }
+    }
+  )pb");
+  OverrideField replace = ParseTextProtoOrDie(R"pb(
+    action_replace: {
+      object_identifier: {
+        individual_object_identifier:
+        [ { field_name: "Members" }
+          , {
+            array_field: {
+              field_name: "Id"
+              value: { string_value: "cpu1_temp" }
+            }
+          }
+          , { field_name: "Reading" }]
+      }
+      override_value: { value: { number_value: 51.0 } }
+    }
+  )pb");
+  OverrideField add_to_added = ParseTextProtoOrDie(R"pb(
+    action_add: {
+      object_identifier: {
+        individual_object_identifier:
+        [ { field_name: "Members" }
+          , {
+            array_field: {
+              field_name: "Id"
+              value: { string_value: "dimm0_temp" }
+            }
+          }
+          , { field_name: "Reading" }]
+      }
+      override_value: { value: { number_value: 30.0 } }
+    }
+  )pb");
+  nlohmann::json json = GetSensors();
+  OverrideEditor editor(json);
+  EXPECT_THAT(editor.Apply(OverrideEdit(replace)), IsOk());
+  EXPECT_THAT(editor.Apply(OverrideEdit(clear)), IsOk());
+  EXPECT_THAT(editor.Apply(OverrideEdit(add)), IsOk());
+  EXPECT_THAT(editor.Apply(OverrideEdit(add_to_added)), IsOk());
+  EXPECT_THAT(editor.Apply(OverrideEdit(clear)), IsStatusInvalidArgument());
+
+  nlohmann::json expected = nlohmann::json::parse(R"json({
+    "Members": [
+      {"Id": "cpu1_temp", "Reading": 51.0},
+      {"Id": 2, "Reading": 42.0},
+      {"Id": "cpu1_temp", "Reading": 43.0},
+      "NotAnObject",
+      {"Id": "dimm0_temp", "Reading": 30.0}
+    ]
+  })json");
+  EXPECT_THAT(json, Eq(expected));
+}
+
+TEST(OverrideEditTest, FailedEditsLeaveDocumentUnchanged) {
+  // Replaces a number by a string.
+  OverrideField replace_type = ParseTextProtoOrDie(R"pb(
+    action_replace: {
+      object_identifier: {
+        individual_object_identifier:
+        [ { field_name: "Members" }
+          , { array_idx: 0 }
+          , { field_name: "Reading" }]
+      }
+      override_value: { value: { string_value: "High" } }
+    }
+  )pb");
+  // Adds a member that exists.
+  OverrideField add_existing = ParseTextProtoOrDie(R"pb(
+    action_add: {
+      object_identifier: {
+        individual_object_identifier:
+        [ { field_name: "Members" }
+          , { array_idx: 0 }
+          , { field_name: "Reading" }]
+      }
+      override_value: { value: { number_value: 1.0 } }
+    }
+  )pb");
+  // Clears an element out of range.
+  OverrideField clear_range = ParseTextProtoOrDie(R"pb(
+    action_clear: {
+      object_identifier: {
+        individual_object_identifier:
+        [ { field_name: "Members" }
+          , { array_idx: 5 }]
+      }
+    }
+  )pb");
+  // Reads the value from another resource.
+  OverrideField replace_by_reading = ParseTextProtoOrDie(R"pb(
+    action_replace: {
+      object_identifier: {
+        individual_object_identifier:
+        [ { field_name: "Members" }]
+      }
+      override_value: { override_by_reading: { uri: "/redfish/v1" } }
+    }
+  )pb");
+  nlohmann::json json = GetSensors();
+  OverrideEditor editor(json);
+  EXPECT_THAT(editor.Apply(OverrideEdit(replace_type)),
+              IsStatusInvalidArgument());
+  EXPECT_THAT(editor.Apply(OverrideEdit(add_existing)),
+              IsStatusInvalidArgument());
+  EXPECT_THAT(editor.Apply(OverrideEdit(clear_range)),
+              IsStatusInvalidArgument());
+  EXPECT_THAT(editor.Apply(OverrideEdit(replace_by_reading)),
+              IsStatusUnimplemented());
+  EXPECT_THAT(editor.Apply(OverrideEdit(OverrideField())),
+              IsStatusInvalidArgument());
+  EXPECT_THAT(json, Eq(GetSensors()));
+}
+
+}  // namespace
+}  // namespace ecclesia
@@ -19,8 +19,10 @@
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
+#include <variant>
 
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -28,25 +30,25 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "ecclesia/lib/redfish/proto/redfish_v1.grpc.pb.h"
 #include "ecclesia/lib/redfish/proto/redfish_v1.pb.h"
 #include "ecclesia/lib/redfish/proto/redfish_v1_grpc_include.h"
+#include "ecclesia/lib/redfish/redfish_override/compiled_override_policy.h"
+#include "ecclesia/lib/redfish/redfish_override/override_edit.h"
 #include "ecclesia/lib/redfish/redfish_override/rf_override.pb.h"
 #include "ecclesia/lib/redfish/transport/grpc.h"
 #include "ecclesia/lib/redfish/transport/interface.h"
-#include "ecclesia/lib/redfish/transport/struct_proto_conversion.h"
+#include "ecclesia/lib/redfish/transport/lazy_json.h"
 #include "grpc/grpc_security_constants.h"
 #include "grpcpp/client_context.h"
 #include "grpcpp/create_channel.h"
+#include "single_include/nlohmann/json.hpp"
 #include "google/protobuf/message.h"
 #include "google/protobuf/text_format.h"
-#include "re2/re2.h"
 
 namespace ecclesia {
 namespace {
-using OverrideValue = OverrideField::OverrideValue;
-using IndividualObjectIdentifier = ObjectIdentifier::IndividualObjectIdentifier;
-
 constexpr absl::string_view kTargetKey = "target";
 constexpr absl::string_view kResourceKey = "redfish-resource";
 
@@ -82,221 +84,6 @@ absl::Status GetBinaryProto(absl::string_view path, google::protobuf::Message *m
   return absl::OkStatus();
 }
 
-absl::Status JsonReplace(nlohmann::json &json,
-                         const OverrideValue &override_value,
-                         RedfishTransport *transport) {
-  if (override_value.has_value()) {
-    nlohmann::json replace_json = ValueToJson(override_value.value());
-    if (json.type() != replace_json.type()) {
-      return absl::InvalidArgumentError(
-          "Value type is different from original type");
-    }
-    json = replace_json;
-    return absl::OkStatus();
-  }
-  if (override_value.has_override_by_reading()) {
-    return absl::UnimplementedError("To be implemented");
-  }
-  return absl::InvalidArgumentError("Replace Json not found.");
-}
-
-absl::Status JsonAdd(nlohmann::json &json,
-                     const IndividualObjectIdentifier &object_identifier,
-                     const OverrideValue &override_value,
-                     RedfishTransport *transport) {
-  nlohmann::json add_json;
-  if (override_value.has_value()) {
-    add_json = ValueToJson(override_value.value());
-  } else if (override_value.has_override_by_reading()) {
-    return absl::UnimplementedError("To be implemented");
-  } else {
-    return absl::InvalidArgumentError("Added Json not found.");
-  }
-  if (object_identifier.has_field_name()) {
-    if (json.find(object_identifier.field_name()) != json.end()) {
-      if (json[object_identifier.field_name()].is_array()) {
-        json[object_identifier.field_name()].push_back(add_json);
-        return absl::OkStatus();
-      }
-      return absl::InvalidArgumentError("Json field already exist.");
-    }
-    json[object_identifier.field_name()] = add_json;
-    return absl::OkStatus();
-  }
-  if (object_identifier.has_array_field()) {
-    return absl::InvalidArgumentError(
-        "Please specify a field before adding inside an array type "
-        "json");
-  }
-  if (object_identifier.has_array_idx()) {
-    if (!json.is_array()) {
-      return absl::InvalidArgumentError("Json is not an array type");
-    }
-    if (object_identifier.array_idx() >= json.size()) {
-      return absl::InvalidArgumentError("index is out of array range");
-    }
-    if (!json[object_identifier.array_idx()].is_array()) {
-      return absl::InvalidArgumentError(
-          "Please specify a field before adding inside an array type "
-          "json");
-    }
-    json[object_identifier.array_idx()].push_back(add_json);
-    return absl::OkStatus();
-  }
-  return absl::InvalidArgumentError("Added Json not found.");
-}
-
-absl::Status JsonClear(nlohmann::json &json,
-                       const IndividualObjectIdentifier &object_identifier) {
-  if (object_identifier.has_field_name()) {
-    json.erase(json.find(object_identifier.field_name()));
-    return absl::OkStatus();
-  }
-  if (object_identifier.has_array_field()) {
-    if (!json.is_array()) {
-      return absl::InvalidArgumentError("Json is not an array type");
-    }
-    for (int i = 0; i < json.size(); i++) {
-      if (json[i].contains(object_identifier.array_field().field_name()) &&
-          json[i][object_identifier.array_field().field_name()] ==
-              ValueToJson(object_identifier.array_field().value())) {
-        json.erase(i);
-        return absl::OkStatus();
-      }
-    }
-  } else if (object_identifier.has_array_idx()) {
-    if (!json.is_array()) {
-      return absl::InvalidArgumentError("Json is not an array type");
-    }
-    if (object_identifier.array_idx() >= json.size()) {
-      return absl::InvalidArgumentError("index is out of array range");
-    }
-    json.erase(object_identifier.array_idx());
-    return absl::OkStatus();
-  }
-  return absl::InvalidArgumentError("Cleared Json not found.");
-}
-
-// Recursively find the target sub-JSON object in a JSON object till, then call
-// the action functions (JsonReplace, JsonAdd, JsonClear). The idx is the index
-// to do recursive find with object_identifier
-absl::Status FindObjectAndAct(nlohmann::json &json,
-                              const ObjectIdentifier &object_identifier,
-                              int idx, const OverrideValue &override_value,
-                              ecclesia::RedfishTransport *transport,
-                              OverrideField::ActionCase action) {
-  if (action == OverrideField::ActionCase::kActionReplace &&
-      idx == object_identifier.individual_object_identifier_size()) {
-    return JsonReplace(json, override_value, transport);
-  }
-  if (action == OverrideField::ActionCase::kActionAdd &&
-      idx == object_identifier.individual_object_identifier_size() - 1) {
-    return JsonAdd(json,
-                   object_identifier.individual_object_identifier().Get(idx),
-                   override_value, transport);
-  }
-  if (action == OverrideField::ActionCase::kActionClear &&
-      idx == object_identifier.individual_object_identifier_size() - 1) {
-    return JsonClear(json,
-                     object_identifier.individual_object_identifier().Get(idx));
-  }
-  if (object_identifier.individual_object_identifier()
-          .Get(idx)
-          .has_field_name()) {
-    if (json.find(object_identifier.individual_object_identifier()
-                      .Get(idx)
-                      .field_name()) != json.end()) {
-      return FindObjectAndAct(
-          json[object_identifier.individual_object_identifier()
-                   .Get(idx)
-                   .field_name()],
-          object_identifier, idx + 1, override_value, transport, action);
-    }
-  } else if (object_identifier.individual_object_identifier()
-                 .Get(idx)
-                 .has_array_field()) {
-    if (!json.is_array()) {
-      return absl::InvalidArgumentError("Json is not an array type");
-    }
-    for (auto &iter : json) {
-      if (iter.contains(object_identifier.individual_object_identifier()
-                            .Get(idx)
-                            .array_field()
-                            .field_name()) &&
-          iter[object_identifier.individual_object_identifier()
-                   .Get(idx)
-                   .array_field()
-                   .field_name()] ==
-              ValueToJson(object_identifier.individual_object_identifier()
-                              .Get(idx)
-                              .array_field()
-                              .value())) {
-        return FindObjectAndAct(iter, object_identifier, idx + 1,
-                                override_value, transport, action);
-      }
-    }
-  } else if (object_identifier.individual_object_identifier()
-                 .Get(idx)
-                 .has_array_idx()) {
-    if (!json.is_array()) {
-      return absl::InvalidArgumentError("Json is not an array type");
-    }
-    if (object_identifier.individual_object_identifier().Get(idx).array_idx() >=
-        json.size()) {
-      return absl::InvalidArgumentError("index is out of array range");
-    }
-    return FindObjectAndAct(
-        json[object_identifier.individual_object_identifier()
-                 .Get(idx)
-                 .array_idx()],
-        object_identifier, idx + 1, override_value, transport, action);
-  }
-  return absl::InvalidArgumentError("Required Json not found.");
-}
-// Updating the result by the specific OverrideField
-absl::Status ResultUpdateHelper(const OverrideField &field,
-                                RedfishTransport::Result &result,
-                                RedfishTransport *transport) {
-  if (!std::holds_alternative<nlohmann::json>(result.body)) {
-    return absl::InternalError("Result body is not storing JSON");
-  }
-  auto &json = std::get<nlohmann::json>(result.body);
-  switch (field.Action_case()) {
-    case OverrideField::kActionReplace: {
-      auto result_check =
-          FindObjectAndAct(json, field.action_replace().object_identifier(), 0,
-                           field.action_replace().override_value(), transport,
-                           OverrideField::ActionCase::kActionReplace);
-      if (!result_check.ok()) {
-        return result_check;
-      }
-      break;
-    }
-    case OverrideField::kActionAdd: {
-      auto result_check =
-          FindObjectAndAct(json, field.action_add().object_identifier(), 0,
-                           field.action_add().override_value(), transport,
-                           OverrideField::ActionCase::kActionAdd);
-      if (!result_check.ok()) {
-        return result_check;
-      }
-      break;
-    }
-    case OverrideField::kActionClear: {
-      auto result_check =
-          FindObjectAndAct(json, field.action_clear().object_identifier(), 0,
-                           field.action_add().override_value(), transport,
-                           OverrideField::ActionCase::kActionClear);
-      if (!result_check.ok()) {
-        return result_check;
-      }
-      break;
-    }
-    default:
-      return absl::InvalidArgumentError("No action specified");
-  }
-  return absl::OkStatus();
-}
 }  // namespace
 
 absl::StatusOr<OverridePolicy> TryGetOverridePolicy(
@@ -375,17 +162,12 @@ absl::StatusOr<RedfishTransport::Result>
 RedfishTransportWithOverride::TryApplyingOverride(
     absl::string_view path, RedfishTransport::Result get_result) {
   // Try to fetch the override policy.
-  if (!has_override_policy_) {
-    auto override_policy = override_policy_cb_();
-    if (!override_policy.ok()) {
-      LOG(ERROR) << "Unexpectedly unable to retrieve Redfish Override. "
-                    "Returning unedited Redfish response.";
-      return get_result;
-    }
-    has_override_policy_ = true;
-    override_policy_ = *std::move(override_policy);
-    LOG(INFO) << "Applying Redfish override: "
-              << override_policy_.DebugString();
+  std::shared_ptr<const CompiledOverridePolicy> override_policy =
+      GetCompiledOverridePolicy();
+  if (override_policy == nullptr) {
+    LOG(ERROR) << "Unexpectedly unable to retrieve Redfish Override. "
+                  "Returning unedited Redfish response.";
+    return get_result;
   }
 
   std::string checked_path = std::string(path);
@@ -397,44 +179,69 @@ RedfishTransportWithOverride::TryApplyingOverride(
   if (extend_pos != std::string::npos) {
     checked_path = path.substr(0, extend_pos);
   }
-  auto iter = override_policy_.override_content_map_uri().find(checked_path);
-  if (iter != override_policy_.override_content_map_uri().end()) {
-    for (const auto &field : iter->second.override_field()) {
-      if (field.has_apply_condition() && field.apply_condition().is_expand() &&
-          !absl::StrContains(path, "$expand=")) {
-        continue;
+  bool is_expand = absl::StrContains(path, "$expand=");
+  // All edits of the response are applied to the same document, so that the
+  // array indexes built by the editor are shared between them.
+  std::optional<OverrideEditor> editor;
+  for (const OverrideEdit *edit : override_policy->MatchEdits(checked_path)) {
+    if (edit->expand_only() && !is_expand) continue;
+    if (!editor.has_value()) {
+      // Overrides edit the document, so a lazily parsed body is parsed in
+      // full.
+      if (const auto *lazy = std::get_if<LazyJson>(&get_result.body)) {
+        get_result.body = lazy->Parse();
       }
-      auto update_status =
-          ResultUpdateHelper(field, get_result, redfish_transport_.get());
-      if (!update_status.ok()) {
+      if (!std::holds_alternative<nlohmann::json>(get_result.body)) {
         LOG(WARNING) << absl::StrFormat(
             "Failed to perform override to uri: %s, failure: %s.", path,
-            update_status.message());
+            "Result body is not storing JSON");
+        return get_result;
       }
+      editor.emplace(std::get<nlohmann::json>(get_result.body));
     }
-  }
-  for (const auto &[uri_regex, override_content] :
-       override_policy_.override_content_map_regex()) {
-    if (!RE2::FullMatch(checked_path, uri_regex)) {
-      continue;
-    }
-    for (const auto &field : override_content.override_field()) {
-      if (field.has_apply_condition() && field.apply_condition().is_expand() &&
-          !absl::StrContains(path, "$expand=")) {
-        continue;
-      }
-      auto update_status =
-          ResultUpdateHelper(field, get_result, redfish_transport_.get());
-      if (!update_status.ok()) {
-        LOG(WARNING) << absl::StrFormat(
-            "Failed to perform override to uri: %s, failure: %s.", path,
-            update_status.message());
-      }
+    absl::Status update_status = editor->Apply(*edit);
+    if (!update_status.ok()) {
+      LOG(WARNING) << absl::StrFormat(
+          "Failed to perform override to uri: %s, failure: %s.", path,
+          update_status.message());
     }
   }
   return get_result;
 }
 
+std::shared_ptr<const CompiledOverridePolicy>
+RedfishTransportWithOverride::GetCompiledOverridePolicy() {
+  {
+    absl::MutexLock lock(&policy_mutex_);
+    if (override_policy_ != nullptr) return override_policy_;
+  }
+  absl::MutexLock cb_lock(&policy_cb_mutex_);
+  {
+    // Another request may have fetched the policy in the meantime.
+    absl::MutexLock lock(&policy_mutex_);
+    if (override_policy_ != nullptr) return override_policy_;
+  }
+  if (!LoadOverridePolicy().ok()) return nullptr;
+  absl::MutexLock lock(&policy_mutex_);
+  return override_policy_;
+}
+
+absl::Status RedfishTransportWithOverride::LoadOverridePolicy() {
+  absl::StatusOr<OverridePolicy> policy = override_policy_cb_();
+  if (!policy.ok()) return policy.status();
+  LOG(INFO) << "Applying Redfish override: " << policy->DebugString();
+  auto compiled_policy =
+      std::make_shared<const CompiledOverridePolicy>(*std::move(policy));
+  absl::MutexLock lock(&policy_mutex_);
+  override_policy_ = std::move(compiled_policy);
+  return absl::OkStatus();
+}
+
+absl::Status RedfishTransportWithOverride::ReloadOverridePolicy() {
+  absl::MutexLock cb_lock(&policy_cb_mutex_);
+  return LoadOverridePolicy();
+}
+
 absl::StatusOr<RedfishTransport::Result> RedfishTransportWithOverride::Get(
     absl::string_view path) {
   auto get_result = redfish_transport_->Get(path);
@@ -17,13 +17,18 @@
 #ifndef ECCLESIA_LIB_REDFISH_REDFISH_OVERRIDE_TRANSPORT_WITH_OVERRIDE_H_
 #define ECCLESIA_LIB_REDFISH_REDFISH_OVERRIDE_TRANSPORT_WITH_OVERRIDE_H_
 
+#include <functional>
 #include <memory>
 #include <optional>
 #include <utility>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/functional/any_invocable.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "ecclesia/lib/redfish/redfish_override/compiled_override_policy.h"
 #include "ecclesia/lib/redfish/redfish_override/rf_override.pb.h"
 #include "ecclesia/lib/redfish/transport/interface.h"
 #include "grpcpp/security/credentials.h"
@@ -98,15 +103,40 @@ class RedfishTransportWithOverride : public RedfishTransport {
     return redfish_transport_->Delete(path, data);
   }
 
+  std::function<void()> BindToCallingThread(
+      std::function<void()> task) override {
+    return redfish_transport_->BindToCallingThread(std::move(task));
+  }
+
+  // Fetches the override policy anew from the policy callback. The compiled
+  // policy is swapped in atomically: requests in flight complete with the
+  // previous policy and subsequent requests use the new one. On failure, the
+  // previous policy stays in use.
+  absl::Status ReloadOverridePolicy();
+
  private:
   // If we do not have an override, try to fetch it fresh before calling Get.
   absl::StatusOr<RedfishTransport::Result> TryApplyingOverride(
       absl::string_view path, RedfishTransport::Result result);
 
+  // Returns the compiled override policy, fetching it on first use. Returns
+  // null if no policy could be retrieved.
+  std::shared_ptr<const CompiledOverridePolicy> GetCompiledOverridePolicy()
+      ABSL_LOCKS_EXCLUDED(policy_cb_mutex_, policy_mutex_);
+
+  // Fetches and compiles the override policy, and swaps it in.
+  absl::Status LoadOverridePolicy()
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(policy_cb_mutex_)
+          ABSL_LOCKS_EXCLUDED(policy_mutex_);
+
   std::unique_ptr<RedfishTransport> redfish_transport_;
-  bool has_override_policy_ = false;
-  OverridePolicy override_policy_;  // Use a default empty override policy.
-  absl::AnyInvocable<absl::StatusOr<OverridePolicy>()> override_policy_cb_;
+  // Serializes the fetches of the policy.
+  absl::Mutex policy_cb_mutex_;
+  absl::AnyInvocable<absl::StatusOr<OverridePolicy>()> override_policy_cb_
+      ABSL_GUARDED_BY(policy_cb_mutex_);
+  absl::Mutex policy_mutex_;
+  std::shared_ptr<const CompiledOverridePolicy> override_policy_
+      ABSL_GUARDED_BY(policy_mutex_);
 };
 }  // namespace ecclesia
 #endif  // ECCLESIA_LIB_REDFISH_REDFISH_OVERRIDE_TRANSPORT_WITH_OVERRIDE_H_
@@ -959,5 +959,53 @@ TEST_F(RedfishOverrideTest, GetReplaceValueFailedOverrideTryAgain) {
   EXPECT_THAT(res_get2->code, Eq(200));
 }
 
+TEST_F(RedfishOverrideTest, ReloadOverridePolicy) {
+  std::string replaced_value = "FirstPolicy";
+  auto rf_override = std::make_unique<RedfishTransportWithOverride>(
+      std::move(transport_),
+      [&replaced_value]() -> absl::StatusOr<OverridePolicy> {
+        OverridePolicy policy = ParseTextProtoOrDie(R"pb(
+          override_content_map_regex: {
+            key: "/expected/result/.*"
+            value: {
+              override_field:
+              [ {
+                action_replace: {
+                  object_identifier: {
+                    individual_object_identifier:
+                    [ { field_name: "TestString" }]
+                  }
+                  override_value: { value: { string_value: "" } }
+                }
+              }]
+            }
+          }
+        )pb");
+        (*policy.mutable_override_content_map_regex())["/expected/result/.*"]
+            .mutable_override_field(0)
+            ->mutable_action_replace()
+            ->mutable_override_value()
+            ->mutable_value()
+            ->set_string_value(replaced_value);
+        return policy;
+      });
+
+  absl::StatusOr<RedfishTransport::Result> res_get1 =
+      rf_override->Get("/expected/result/1");
+  ASSERT_THAT(res_get1, IsOk());
+  ASSERT_TRUE(std::holds_alternative<nlohmann::json>(res_get1->body));
+  EXPECT_THAT(std::get<nlohmann::json>(res_get1->body)["TestString"],
+              Eq("FirstPolicy"));
+
+  replaced_value = "SecondPolicy";
+  ASSERT_THAT(rf_override->ReloadOverridePolicy(), IsOk());
+  absl::StatusOr<RedfishTransport::Result> res_get2 =
+      rf_override->Get("/expected/result/1");
+  ASSERT_THAT(res_get2, IsOk());
+  ASSERT_TRUE(std::holds_alternative<nlohmann::json>(res_get2->body));
+  EXPECT_THAT(std::get<nlohmann::json>(res_get2->body)["TestString"],
+              Eq("SecondPolicy"));
+}
+
 }  // namespace
 }  // namespace ecclesia
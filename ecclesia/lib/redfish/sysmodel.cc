@@ -16,13 +16,26 @@
 
 #include "ecclesia/lib/redfish/sysmodel.h"
 
+#include <cstddef>
+#include <deque>
 #include <functional>
 #include <memory>
+#include <optional>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
 #include "ecclesia/lib/redfish/interface.h"
 #include "ecclesia/lib/redfish/property_definitions.h"
+#include "ecclesia/lib/thread/thread_pool.h"
+#include "single_include/nlohmann/json.hpp"
 
 namespace ecclesia {
 
@@ -537,4 +550,500 @@ void Sysmodel::QueryAllResourceInternal(
       });
 }
 
+namespace {
+
+// Passes on a parent resource of a bulk query, which the tasks of the query
+// share, without fetching it again.
+class SharedRedfishObject : public RedfishObject {
+ public:
+  explicit SharedRedfishObject(std::shared_ptr<RedfishObject> obj)
+      : obj_(std::move(obj)) {}
+
+  RedfishVariant operator[](const std::string &node_name) const override {
+    return (*obj_)[node_name];
+  }
+  RedfishVariant Get(const std::string &node_name,
+                     GetParams params) const override {
+    return obj_->Get(node_name, std::move(params));
+  }
+  std::optional<std::string> GetUriString() const override {
+    return obj_->GetUriString();
+  }
+  absl::StatusOr<std::unique_ptr<RedfishObject>> EnsureFreshPayload(
+      GetParams params) override {
+    return obj_->EnsureFreshPayload(std::move(params));
+  }
+  nlohmann::json GetContentAsJson() const override {
+    return obj_->GetContentAsJson();
+  }
+  std::string DebugString() const override { return obj_->DebugString(); }
+  void PrintDebugString() const override { obj_->PrintDebugString(); }
+  void ForEachProperty(
+      absl::FunctionRef<RedfishIterReturnValue(absl::string_view key,
+                                               RedfishVariant value)>
+          itr_func) override {
+    obj_->ForEachProperty(itr_func);
+  }
+
+ private:
+  const std::shared_ptr<RedfishObject> obj_;
+};
+
+}  // namespace
+
+// State of one resource type of a bulk query.
+class Sysmodel::BulkRequest {
+ public:
+  explicit BulkRequest(BulkResultCallback result_callback)
+      : result_callback_(std::move(result_callback)) {}
+
+  // Requests that the callback is run at most once per resource URI.
+  void SetOncePerUri() { once_per_uri_ = true; }
+
+  bool stopped() const ABSL_LOCKS_EXCLUDED(mutex_) {
+    absl::MutexLock lock(&mutex_);
+    return stopped_;
+  }
+
+  // Passes 'obj' to the callback unless the callback has stopped the query.
+  RedfishIterReturnValue Emit(std::unique_ptr<RedfishObject> obj)
+      ABSL_LOCKS_EXCLUDED(mutex_) {
+    absl::MutexLock lock(&mutex_);
+    if (stopped_) return RedfishIterReturnValue::kStop;
+    if (once_per_uri_) {
+      // As for non-bulk queries, objects without URIs are always passed on.
+      std::optional<std::string> uri = obj->GetUriString();
+      if (uri.has_value() && !visited_uris_.insert(*std::move(uri)).second) {
+        return RedfishIterReturnValue::kContinue;
+      }
+    }
+    if (result_callback_(std::move(obj)) == RedfishIterReturnValue::kStop) {
+      stopped_ = true;
+      return RedfishIterReturnValue::kStop;
+    }
+    return RedfishIterReturnValue::kContinue;
+  }
+
+ private:
+  const BulkResultCallback result_callback_;
+  bool once_per_uri_ = false;
+  mutable absl::Mutex mutex_;
+  bool stopped_ ABSL_GUARDED_BY(mutex_) = false;
+  absl::flat_hash_set<std::string> visited_uris_ ABSL_GUARDED_BY(mutex_);
+};
+
+// State of a bulk query: the parent resources shared between its resource
+// types, fetched on first use while planning, and the tasks to be run.
+class Sysmodel::BulkPlan {
+ public:
+  using Parents = std::vector<std::shared_ptr<RedfishObject>>;
+  // Walks the resources of a type below 'parent', passing each to 'emit'.
+  using ParentWalk =
+      std::function<void(const RedfishObject &parent,
+                         const QueryParams &query_params, ResultCallback emit)>;
+
+  BulkPlan(RedfishInterface *redfish_intf, const QueryParams &query_params)
+      : redfish_intf_(redfish_intf), query_params_(query_params) {}
+
+  const QueryParams &query_params() const { return query_params_; }
+
+  // "/redfish/v1/Systems/{id}"
+  const Parents &Systems() {
+    if (!systems_.has_value()) {
+      systems_ = FetchMembers(redfish_intf_->GetRoot().AsIndexHelper().Get(
+          kRfPropertySystems,
+          {.freshness = query_params_.freshness,
+           .expand = RedfishQueryParamExpand({.levels = 1})}));
+    }
+    return *systems_;
+  }
+
+  // "/redfish/v1/Chassis/{id}"
+  const Parents &Chassis() {
+    if (!chassis_.has_value()) {
+      chassis_ = FetchMembers(redfish_intf_->GetRoot().AsIndexHelper().Get(
+          kRfPropertyChassis,
+          {.freshness = query_params_.freshness,
+           .expand = RedfishQueryParamExpand({.levels = 1})}));
+    }
+    return *chassis_;
+  }
+
+  // "/redfish/v1/Systems/{id}/Storage/{id}"
+  const Parents &Storage() {
+    if (!storage_.has_value()) {
+      storage_.emplace();
+      for (const std::shared_ptr<RedfishObject> &system : Systems()) {
+        system
+            ->Get(kRfPropertyStorage,
+                  {.freshness = query_params_.freshness,
+                   .expand = RedfishQueryParamExpand({.levels = 0})})
+            .Each()
+            .Do([&](std::unique_ptr<RedfishObject> &storage_obj) {
+              storage_->push_back(std::move(storage_obj));
+              return RedfishIterReturnValue::kContinue;
+            });
+      }
+    }
+    return *storage_;
+  }
+
+  // Adds a task walking 'walk' from each of 'parents'.
+  void WalkFromEach(const Parents &parents, BulkRequest &request,
+                    ParentWalk walk) {
+    for (const std::shared_ptr<RedfishObject> &parent : parents) {
+      tasks_.push_back([this, parent = parent.get(), &request, walk]() {
+        if (request.stopped()) return;
+        walk(*parent, query_params_, [&](std::unique_ptr<RedfishObject> obj) {
+          return request.Emit(std::move(obj));
+        });
+      });
+    }
+  }
+
+  // Adds tasks passing each of 'parents' to 'request'. The parents are passed
+  // on as they were fetched while planning, as they are shared between tasks.
+  void EmitEach(const Parents &parents, BulkRequest &request) {
+    for (const std::shared_ptr<RedfishObject> &parent : parents) {
+      tasks_.push_back([parent, &request]() {
+        request.Emit(std::make_unique<SharedRedfishObject>(parent));
+      });
+    }
+  }
+
+  void AddTask(std::function<void()> task) {
+    tasks_.push_back(std::move(task));
+  }
+
+  // Runs the tasks on 'executor' and waits for them, or runs them in order on
+  // the calling thread if 'executor' is null.
+  void Run(ThreadPool *executor) {
+    if (executor == nullptr) {
+      for (const std::function<void()> &task : tasks_) task();
+      return;
+    }
+    absl::BlockingCounter pending(static_cast<int>(tasks_.size()));
+    for (const std::function<void()> &task : tasks_) {
+      executor->Schedule([&task, &pending]() {
+        task();
+        pending.DecrementCount();
+      });
+    }
+    pending.Wait();
+  }
+
+ private:
+  static Parents FetchMembers(RedfishVariant::IndexHelper collection) {
+    Parents members;
+    collection.Each().Do([&](std::unique_ptr<RedfishObject> &member) {
+      members.push_back(std::move(member));
+      return RedfishIterReturnValue::kContinue;
+    });
+    return members;
+  }
+
+  RedfishInterface *const redfish_intf_;
+  const QueryParams query_params_;
+  std::optional<Parents> systems_;
+  std::optional<Parents> chassis_;
+  std::optional<Parents> storage_;
+  std::vector<std::function<void()>> tasks_;
+};
+
+void Sysmodel::QueryAllResourcesInBulk(const BulkQuery &query,
+                                       const QueryParams &query_params,
+                                       ThreadPool *executor) {
+  BulkPlan plan(redfish_intf_, query_params);
+  std::deque<BulkRequest> requests;
+  for (const auto &[planner, result_callback] : query.requests_) {
+    planner(*this, plan, requests.emplace_back(result_callback));
+  }
+  plan.Run(executor);
+}
+
+void Sysmodel::PlanStandaloneQuery(
+    std::function<void(ResultCallback, const QueryParams &)> query,
+    BulkPlan &plan, BulkRequest &request) {
+  plan.AddTask([query = std::move(query), &plan, &request]() {
+    query(
+        [&](std::unique_ptr<RedfishObject> obj) {
+          return request.Emit(std::move(obj));
+        },
+        plan.query_params());
+  });
+}
+
+// The following functions plan the resources of the non-bulk queries above
+// as walks from the parents shared in a bulk query.
+
+void Sysmodel::PlanBulkQuery(Token<ResourceChassis> /*unused*/, BulkPlan &plan,
+                             BulkRequest &request) {
+  plan.EmitEach(plan.Chassis(), request);
+}
+
+void Sysmodel::PlanBulkQuery(Token<ResourceSystem> /*unused*/, BulkPlan &plan,
+                             BulkRequest &request) {
+  plan.EmitEach(plan.Systems(), request);
+}
+
+void Sysmodel::PlanBulkQuery(Token<ResourceComputerSystem> /*unused*/,
+                             BulkPlan &plan, BulkRequest &request) {
+  plan.EmitEach(plan.Systems(), request);
+}
+
+void Sysmodel::PlanBulkQuery(Token<ResourceEthernetInterface> /*unused*/,
+                             BulkPlan &plan, BulkRequest &request) {
+  plan.WalkFromEach(plan.Systems(), request,
+                    [](const RedfishObject &system, const QueryParams &,
+                       ResultCallback emit) {
+                      system[kRfPropertyEthernetInterfaces].Each().Do(
+                          [&](std::unique_ptr<RedfishObject> &eth_obj) {
+                            return emit(std::move(eth_obj));
+                          });
+                    });
+}
+
+void Sysmodel::PlanBulkQuery(Token<ResourceMemory> /*unused*/, BulkPlan &plan,
+                             BulkRequest &request) {
+  plan.WalkFromEach(
+      plan.Systems(), request,
+      [](const RedfishObject &system, const QueryParams &query_params,
+         ResultCallback emit) {
+        system
+            .Get(kRfPropertyMemory,
+                 {.freshness = query_params.freshness,
+                  .expand = RedfishQueryParamExpand(
+                      {.levels = query_params.expand_levels})})
+            .Each()
+            .Do([&](std::unique_ptr<RedfishObject> &memory_obj) {
+              return emit(std::move(memory_obj));
+            });
+      });
+}
+
+void Sysmodel::PlanBulkQuery(Token<ResourceProcessor> /*unused*/,
+                             BulkPlan &plan, BulkRequest &request) {
+  plan.WalkFromEach(
+      plan.Systems(), request,
+      [](const RedfishObject &system, const QueryParams &query_params,
+         ResultCallback emit) {
+        // One more level covers the members, as auto_adjust_levels does.
+        system
+            .Get(kRfPropertyProcessors,
+                 {.freshness = query_params.freshness,
+                  .expand = RedfishQueryParamExpand(
+                      {.levels = query_params.expand_levels + 1})})
+            .Each()
+            .Do([&](std::unique_ptr<RedfishObject> &processor_obj) {
+              return emit(std::move(processor_obj));
+            });
+      });
+}
+
+void Sysmodel::PlanBulkQuery(Token<AbstractionPhysicalLpu> /*unused*/,
+                             BulkPlan &plan, BulkRequest &request) {
+  plan.WalkFromEach(
+      plan.Systems(), request,
+      [](const RedfishObject &system, const QueryParams &query_params,
+         ResultCallback emit) {
+        // Three more levels cover the processors, cores and threads.
+        system
+            .Get(kRfPropertyProcessors,
+                 {.freshness = query_params.freshness,
+                  .expand = RedfishQueryParamExpand(
+                      {.levels = query_params.expand_levels + 3})})
+            .Each()[kRfPropertySubProcessors]
+            .Each()[kRfPropertySubProcessors]
+            .Each()
+            .Do([&](std::unique_ptr<RedfishObject> &phs_lpu_obj) {
+              return emit(std::move(phs_lpu_obj));
+            });
+      });
+}
+
+void Sysmodel::PlanBulkQuery(Token<ResourcePcieFunction> /*unused*/,
+                             BulkPlan &plan, BulkRequest &request) {
+  plan.WalkFromEach(
+      plan.Systems(), request,
+      [](const RedfishObject &system, const QueryParams &query_params,
+         ResultCallback emit) {
+        // Two more levels cover the devices and their functions.
+        system
+            .Get(kRfPropertyPcieDevices,
+                 {.freshness = query_params.freshness,
+                  .expand = RedfishQueryParamExpand(
+                      {.levels = query_params.expand_levels + 2})})
+            .Each()[kRfPropertyLinks][kRfPropertyPcieFunctions]
+            .Each()
+            .Do([&](std::unique_ptr<RedfishObject> &pcie_function_obj) {
+              return emit(std::move(pcie_function_obj));
+            });
+      });
+}
+
+void Sysmodel::PlanBulkQuery(Token<ResourceStorage> /*unused*/, BulkPlan &plan,
+                             BulkRequest &request) {
+  plan.EmitEach(plan.Storage(), request);
+}
+
+void Sysmodel::PlanBulkQuery(Token<ResourceLegacyStorageController> /*unused*/,
+                             BulkPlan &plan, BulkRequest &request) {
+  plan.WalkFromEach(plan.Storage(), request,
+                    [](const RedfishObject &storage, const QueryParams &,
+                       ResultCallback emit) {
+                      storage[kRfPropertyStorageControllers].Each().Do(
+                          [&](std::unique_ptr<RedfishObject> &ctrl_obj) {
+                            return emit(std::move(ctrl_obj));
+                          });
+                    });
+}
+
+void Sysmodel::PlanBulkQuery(Token<ResourceStorageController> /*unused*/,
+                             BulkPlan &plan, BulkRequest &request) {
+  plan.WalkFromEach(plan.Storage(), request,
+                    [](const RedfishObject &storage, const QueryParams &,
+                       ResultCallback emit) {
+                      storage[kRfPropertyControllers].Each().Do(
+                          [&](std::unique_ptr<RedfishObject> &ctrl_obj) {
+                            return emit(std::move(ctrl_obj));
+                          });
+                    });
+}
+
+void Sysmodel::PlanBulkQuery(Token<ResourceDrive> /*unused*/, BulkPlan &plan,
+                             BulkRequest &request) {
+  // A Drive may be referenced under both Storage and Chassis resources.
+  request.SetOncePerUri();
+  plan.WalkFromEach(plan.Storage(), request,
+                    [](const RedfishObject &storage, const QueryParams &,
+                       ResultCallback emit) {
+                      storage[kRfPropertyDrives].Each().Do(
+                          [&](std::unique_ptr<RedfishObject> &drive_obj) {
+                            return emit(std::move(drive_obj));
+                          });
+                    });
+  plan.WalkFromEach(
+      plan.Chassis(), request,
+      [](const RedfishObject &chassis, const QueryParams &query_params,
+         ResultCallback emit) {
+        chassis
+            .Get(kRfPropertyDrives,
+                 {.freshness = query_params.freshness,
+                  .expand = RedfishQueryParamExpand({.levels = 0})})
+            .Each()
+            .Do([&](std::unique_ptr<RedfishObject> &drive_obj) {
+              return emit(std::move(drive_obj));
+            });
+      });
+}
+
+void Sysmodel::PlanBulkQuery(Token<ResourceThermal> /*unused*/, BulkPlan &plan,
+                             BulkRequest &request) {
+  plan.WalkFromEach(plan.Chassis(), request,
+                    [](const RedfishObject &chassis, const QueryParams &,
+                       ResultCallback emit) {
+                      if (std::unique_ptr<RedfishObject> thermal_obj =
+                              chassis[kRfPropertyThermal].AsObject()) {
+                        emit(std::move(thermal_obj));
+                      }
+                    });
+}
+
+void Sysmodel::PlanBulkQuery(Token<ResourceTemperature> /*unused*/,
+                             BulkPlan &plan, BulkRequest &request) {
+  plan.WalkFromEach(
+      plan.Chassis(), request,
+      [](const RedfishObject &chassis, const QueryParams &,
+         ResultCallback emit) {
+        chassis[kRfPropertyThermal][kRfPropertyTemperatures].Each().Do(
+            [&](std::unique_ptr<RedfishObject> &temp_obj) {
+              return emit(std::move(temp_obj));
+            });
+      });
+}
+
+void Sysmodel::PlanBulkQuery(Token<ResourceVoltage> /*unused*/, BulkPlan &plan,
+                             BulkRequest &request) {
+  plan.WalkFromEach(plan.Chassis(), request,
+                    [](const RedfishObject &chassis, const QueryParams &,
+                       ResultCallback emit) {
+                      chassis[kRfPropertyPower][kRfPropertyVoltages].Each().Do(
+                          [&](std::unique_ptr<RedfishObject> &volt_obj) {
+                            return emit(std::move(volt_obj));
+                          });
+                    });
+}
+
+void Sysmodel::PlanBulkQuery(Token<ResourceFan> /*unused*/, BulkPlan &plan,
+                             BulkRequest &request) {
+  plan.WalkFromEach(plan.Chassis(), request,
+                    [](const RedfishObject &chassis, const QueryParams &,
+                       ResultCallback emit) {
+                      chassis[kRfPropertyThermal][kRfPropertyFans].Each().Do(
+                          [&](std::unique_ptr<RedfishObject> &fan_obj) {
+                            return emit(std::move(fan_obj));
+                          });
+                    });
+}
+
+void Sysmodel::PlanBulkQuery(Token<ResourceSensor> /*unused*/, BulkPlan &plan,
+                             BulkRequest &request) {
+  plan.WalkFromEach(
+      plan.Chassis(), request,
+      [](const RedfishObject &chassis, const QueryParams &query_params,
+         ResultCallback emit) {
+        chassis
+            .Get(kRfPropertySensors,
+                 {.freshness = query_params.freshness,
+                  .expand = RedfishQueryParamExpand({.levels = 1})})
+            .Each()
+            .Do([&](std::unique_ptr<RedfishObject> &sensor_obj) {
+              return emit(std::move(sensor_obj));
+            });
+      });
+}
+
+void Sysmodel::PlanBulkQuery(Token<ResourceSensorCollection> /*unused*/,
+                             BulkPlan &plan, BulkRequest &request) {
+  plan.WalkFromEach(
+      plan.Chassis(), request,
+      [](const RedfishObject &chassis, const QueryParams &query_params,
+         ResultCallback emit) {
+        if (std::unique_ptr<RedfishObject> sensors_obj =
+                chassis
+                    .Get(kRfPropertySensors,
+                         {.freshness = query_params.freshness,
+                          .expand = RedfishQueryParamExpand({.levels = 1})})
+                    .AsObject()) {
+          emit(std::move(sensors_obj));
+        }
+      });
+}
+
+void Sysmodel::PlanBulkQuery(Token<ResourceLogEntry> /*unused*/,
+                             BulkPlan &plan, BulkRequest &request) {
+  plan.WalkFromEach(plan.Chassis(), request,
+                    [](const RedfishObject &chassis, const QueryParams &,
+                       ResultCallback emit) {
+                      chassis[kRfPropertyLogServices]
+                          .Each()[kRfPropertyEntries]
+                          .Each()
+                          .Do([&](std::unique_ptr<RedfishObject> &entry) {
+                            return emit(std::move(entry));
+                          });
+                    });
+}
+
+void Sysmodel::PlanBulkQuery(Token<ResourcePcieSlots> /*unused*/,
+                             BulkPlan &plan, BulkRequest &request) {
+  plan.WalkFromEach(plan.Chassis(), request,
+                    [](const RedfishObject &chassis, const QueryParams &,
+                       ResultCallback emit) {
+                      if (std::unique_ptr<RedfishObject> slots_obj =
+                              chassis[kRfPropertyPcieSlots].AsObject()) {
+                        emit(std::move(slots_obj));
+                      }
+                    });
+}
+
 }  // namespace ecclesia
@@ -17,11 +17,15 @@
 #ifndef ECCLESIA_LIB_REDFISH_SYSMODEL_H_
 #define ECCLESIA_LIB_REDFISH_SYSMODEL_H_
 
+#include <functional>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "absl/functional/function_ref.h"
 #include "ecclesia/lib/redfish/interface.h"
 #include "ecclesia/lib/redfish/property_definitions.h"
+#include "ecclesia/lib/thread/thread_pool.h"
 
 namespace ecclesia {
 
@@ -78,6 +82,112 @@ class Sysmodel {
   template <typename T>
   struct Token {};
 
+  // State of a bulk query shared between its resource types, and the state of
+  // one resource type of a bulk query. Defined in sysmodel.cc.
+  class BulkPlan;
+  class BulkRequest;
+
+ public:
+  // Callback of a bulk query. As it may be run on the executor of the query,
+  // the callback is stored rather than referenced.
+  using BulkResultCallback =
+      std::function<RedfishIterReturnValue(std::unique_ptr<RedfishObject>)>;
+
+  // A set of resource types to be queried together by QueryAllResourcesInBulk.
+  class BulkQuery {
+   public:
+    // Requests all resources of type ResourceT, which are passed to
+    // result_callback. Returning kStop from result_callback stops the query of
+    // ResourceT only.
+    template <typename ResourceT>
+    BulkQuery &Add(BulkResultCallback result_callback) {
+      requests_.push_back(
+          {[](Sysmodel &sysmodel, BulkPlan &plan, BulkRequest &request) {
+             sysmodel.PlanBulkQuery(Token<ResourceT>(), plan, request);
+           },
+           std::move(result_callback)});
+      return *this;
+    }
+
+   private:
+    friend class Sysmodel;
+
+    using Planner = void (*)(Sysmodel &, BulkPlan &, BulkRequest &);
+    std::vector<std::pair<Planner, BulkResultCallback>> requests_;
+  };
+
+  // QueryAllResourcesInBulk queries the resources of every type in 'query'.
+  // The parent resources common to several types, such as the Systems and
+  // Chassis collections and the Storage of each system, are fetched once and
+  // shared between the types. The query_params apply to every type.
+  //
+  // The resources below each parent are then walked, and passed to the
+  // callbacks, on 'executor' in parallel; the RedfishInterface must then be
+  // safe to use concurrently. The callback of one type is never run
+  // concurrently with itself. If 'executor' is null, everything runs on the
+  // calling thread in order. Returns once all of the callbacks have run.
+  void QueryAllResourcesInBulk(const BulkQuery &query,
+                               const QueryParams &query_params,
+                               ThreadPool *executor);
+
+ private:
+  // Plans the query of a resource type in a bulk query. Types found below the
+  // Systems, Chassis or Storage collections walk from the parents shared in
+  // 'plan'; other types are queried on their own.
+  template <typename ResourceT>
+  void PlanBulkQuery(Token<ResourceT>, BulkPlan &plan, BulkRequest &request) {
+    PlanStandaloneQuery(
+        [this](ResultCallback result_callback,
+               const QueryParams &query_params) {
+          QueryAllResourceInternal(Token<ResourceT>(), result_callback,
+                                   query_params);
+        },
+        plan, request);
+  }
+  void PlanBulkQuery(Token<ResourceChassis>, BulkPlan &plan,
+                     BulkRequest &request);
+  void PlanBulkQuery(Token<ResourceSystem>, BulkPlan &plan,
+                     BulkRequest &request);
+  void PlanBulkQuery(Token<ResourceEthernetInterface>, BulkPlan &plan,
+                     BulkRequest &request);
+  void PlanBulkQuery(Token<ResourceMemory>, BulkPlan &plan,
+                     BulkRequest &request);
+  void PlanBulkQuery(Token<ResourceStorage>, BulkPlan &plan,
+                     BulkRequest &request);
+  void PlanBulkQuery(Token<ResourceLegacyStorageController>, BulkPlan &plan,
+                     BulkRequest &request);
+  void PlanBulkQuery(Token<ResourceStorageController>, BulkPlan &plan,
+                     BulkRequest &request);
+  void PlanBulkQuery(Token<ResourceDrive>, BulkPlan &plan,
+                     BulkRequest &request);
+  void PlanBulkQuery(Token<ResourceProcessor>, BulkPlan &plan,
+                     BulkRequest &request);
+  void PlanBulkQuery(Token<AbstractionPhysicalLpu>, BulkPlan &plan,
+                     BulkRequest &request);
+  void PlanBulkQuery(Token<ResourceThermal>, BulkPlan &plan,
+                     BulkRequest &request);
+  void PlanBulkQuery(Token<ResourceTemperature>, BulkPlan &plan,
+                     BulkRequest &request);
+  void PlanBulkQuery(Token<ResourceVoltage>, BulkPlan &plan,
+                     BulkRequest &request);
+  void PlanBulkQuery(Token<ResourceFan>, BulkPlan &plan, BulkRequest &request);
+  void PlanBulkQuery(Token<ResourceSensor>, BulkPlan &plan,
+                     BulkRequest &request);
+  void PlanBulkQuery(Token<ResourceSensorCollection>, BulkPlan &plan,
+                     BulkRequest &request);
+  void PlanBulkQuery(Token<ResourcePcieFunction>, BulkPlan &plan,
+                     BulkRequest &request);
+  void PlanBulkQuery(Token<ResourceComputerSystem>, BulkPlan &plan,
+                     BulkRequest &request);
+  void PlanBulkQuery(Token<ResourceLogEntry>, BulkPlan &plan,
+                     BulkRequest &request);
+  void PlanBulkQuery(Token<ResourcePcieSlots>, BulkPlan &plan,
+                     BulkRequest &request);
+  // Plans 'query' as a single task of the bulk query.
+  void PlanStandaloneQuery(
+      std::function<void(ResultCallback, const QueryParams &)> query,
+      BulkPlan &plan, BulkRequest &request);
+
   // Internal implementations for each resource type to find all instances of
   // a Redfish resource type. These functions overload QueryAllResourceInternal
   // using a Token struct.
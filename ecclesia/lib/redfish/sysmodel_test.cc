@@ -25,9 +25,15 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "ecclesia/lib/redfish/interface.h"
 #include "ecclesia/lib/redfish/property_definitions.h"
 #include "ecclesia/lib/redfish/testing/fake_redfish_server.h"
+#include "ecclesia/lib/redfish/transport/cache.h"
+#include "ecclesia/lib/redfish/transport/http_redfish_intf.h"
+#include "ecclesia/lib/redfish/transport/interface.h"
+#include "ecclesia/lib/thread/thread_pool.h"
 #include "tensorflow_serving/util/net_http/server/public/server_request_interface.h"
 
 namespace ecclesia {
@@ -35,6 +41,8 @@ namespace {
 
 using ::tensorflow::serving::net_http::ServerRequestInterface;
 using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+using ::testing::UnorderedElementsAreArray;
 
 class SysmodelTest : public testing::Test {
  public:
@@ -153,5 +161,154 @@ TEST_F(SysmodelTest, GetResourcePhysicalLpuExpands) {
   EXPECT_EQ(expand_processor_count, 1);
 }
 
+// Returns the URIs of the resources found by a non-bulk query of ResourceT.
+template <typename ResourceT>
+std::vector<std::string> QueryUris(Sysmodel &sysmodel) {
+  std::vector<std::string> uris;
+  sysmodel.QueryAllResources<ResourceT>(
+      [&](std::unique_ptr<RedfishObject> obj) -> RedfishIterReturnValue {
+        uris.push_back(obj->GetUriString().value_or(""));
+        return RedfishIterReturnValue::kContinue;
+      });
+  return uris;
+}
+
+TEST_F(SysmodelTest, BulkQueryFindsSameResourcesInOrder) {
+  InitServer("topology_v2_testing/mockup.shar");
+  std::vector<std::string> memory_uris;
+  std::vector<std::string> drive_uris;
+  std::vector<std::string> system_uris;
+  std::vector<std::string> manager_uris;
+  auto append_uri = [](std::vector<std::string> &uris) {
+    return [&uris](std::unique_ptr<RedfishObject> obj) {
+      uris.push_back(obj->GetUriString().value_or(""));
+      return RedfishIterReturnValue::kContinue;
+    };
+  };
+  sysmodel_->QueryAllResourcesInBulk(
+      Sysmodel::BulkQuery()
+          .Add<ResourceMemory>(append_uri(memory_uris))
+          .Add<ResourceDrive>(append_uri(drive_uris))
+          .Add<ResourceSystem>(append_uri(system_uris))
+          .Add<ResourceManager>(append_uri(manager_uris)),
+      {}, /*executor=*/nullptr);
+
+  EXPECT_THAT(memory_uris,
+              ElementsAreArray(QueryUris<ResourceMemory>(*sysmodel_)));
+  EXPECT_THAT(drive_uris,
+              ElementsAreArray(QueryUris<ResourceDrive>(*sysmodel_)));
+  EXPECT_THAT(system_uris,
+              ElementsAreArray(QueryUris<ResourceSystem>(*sysmodel_)));
+  EXPECT_THAT(manager_uris,
+              ElementsAreArray(QueryUris<ResourceManager>(*sysmodel_)));
+  EXPECT_FALSE(memory_uris.empty());
+  EXPECT_FALSE(system_uris.empty());
+}
+
+TEST_F(SysmodelTest, BulkQueryOnExecutorFindsSameResources) {
+  InitServer("topology_v2_testing/mockup.shar");
+  absl::Mutex mutex;
+  std::vector<std::string> processor_uris;
+  std::vector<std::string> sensor_uris;
+  auto append_uri = [&mutex](std::vector<std::string> &uris) {
+    return [&mutex, &uris](std::unique_ptr<RedfishObject> obj) {
+      absl::MutexLock lock(&mutex);
+      uris.push_back(obj->GetUriString().value_or(""));
+      return RedfishIterReturnValue::kContinue;
+    };
+  };
+  ThreadPool executor(4);
+  sysmodel_->QueryAllResourcesInBulk(
+      Sysmodel::BulkQuery()
+          .Add<ResourceProcessor>(append_uri(processor_uris))
+          .Add<ResourceSensor>(append_uri(sensor_uris)),
+      {}, &executor);
+
+  EXPECT_THAT(processor_uris, UnorderedElementsAreArray(
+                                  QueryUris<ResourceProcessor>(*sysmodel_)));
+  EXPECT_THAT(sensor_uris,
+              UnorderedElementsAreArray(QueryUris<ResourceSensor>(*sysmodel_)));
+}
+
+TEST_F(SysmodelTest, BulkQueryStopsOnlyTheStoppedType) {
+  InitServer("topology_v2_testing/mockup.shar");
+  int stopped_calls = 0;
+  std::vector<std::string> memory_uris;
+  sysmodel_->QueryAllResourcesInBulk(
+      Sysmodel::BulkQuery()
+          .Add<ResourceChassis>([&](std::unique_ptr<RedfishObject>) {
+            ++stopped_calls;
+            return RedfishIterReturnValue::kStop;
+          })
+          .Add<ResourceMemory>([&](std::unique_ptr<RedfishObject> obj) {
+            memory_uris.push_back(obj->GetUriString().value_or(""));
+            return RedfishIterReturnValue::kContinue;
+          }),
+      {}, /*executor=*/nullptr);
+
+  EXPECT_EQ(stopped_calls, 1);
+  EXPECT_THAT(memory_uris,
+              ElementsAreArray(QueryUris<ResourceMemory>(*sysmodel_)));
+}
+
+TEST_F(SysmodelTest, BulkQueryFetchesSharedParentsOncePerQuery) {
+  InitServer("topology_v2_testing/mockup.shar");
+  // Serve Systems without embedding its members, so that the System and
+  // Storage parents shared by the bulk query are fetched by their own URIs.
+  auto systems_json =
+      intf_->CachedGetUri("/redfish/v1/Systems").AsObject()->DebugString();
+  auto system_json = intf_->CachedGetUri("/redfish/v1/Systems/system")
+                         .AsObject()
+                         ->DebugString();
+  auto storage1_json =
+      intf_->CachedGetUri("/redfish/v1/Systems/system/Storage/1")
+          .AsObject()
+          ->DebugString();
+  mockup_server_->AddHttpGetHandler(
+      "/redfish/v1/Systems?$expand=.($levels=1)",
+      [&](ServerRequestInterface *req) {
+        SendJsonHttpResponse(req, systems_json);
+      });
+  int system_count = 0;
+  mockup_server_->AddHttpGetHandler("/redfish/v1/Systems/system",
+                                    [&](ServerRequestInterface *req) {
+                                      system_count++;
+                                      SendJsonHttpResponse(req, system_json);
+                                    });
+  int storage1_count = 0;
+  mockup_server_->AddHttpGetHandler("/redfish/v1/Systems/system/Storage/1",
+                                    [&](ServerRequestInterface *req) {
+                                      storage1_count++;
+                                      SendJsonHttpResponse(req, storage1_json);
+                                    });
+
+  // Parents served from a cache must not be fetched again for each resource
+  // type walking from them.
+  std::unique_ptr<RedfishInterface> cached_intf = NewHttpInterface(
+      mockup_server_->RedfishClientTransport(),
+      [](RedfishTransport *transport) {
+        return TimeBasedCache::Create(transport, absl::InfiniteDuration());
+      },
+      RedfishInterface::kTrusted);
+  Sysmodel sysmodel(cached_intf.get());
+  auto ignore = [](std::unique_ptr<RedfishObject>) {
+    return RedfishIterReturnValue::kContinue;
+  };
+  auto query_in_bulk = [&]() {
+    sysmodel.QueryAllResourcesInBulk(Sysmodel::BulkQuery()
+                                         .Add<ResourceSystem>(ignore)
+                                         .Add<ResourceStorage>(ignore)
+                                         .Add<ResourceDrive>(ignore)
+                                         .Add<ResourceMemory>(ignore),
+                                     {}, /*executor=*/nullptr);
+  };
+  query_in_bulk();
+  EXPECT_EQ(system_count, 1);
+  EXPECT_EQ(storage1_count, 1);
+  query_in_bulk();
+  EXPECT_EQ(system_count, 1);
+  EXPECT_EQ(storage1_count, 1);
+}
+
 }  // namespace
 }  // namespace ecclesia
@@ -29,6 +29,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "ecclesia/lib/http/client.h"
@@ -112,8 +113,20 @@ void FakeRedfishServer::AddHttpGetHandlerWithOwnedData(
         });
   }
 
+void FakeRedfishServer::SetLatency(absl::Duration latency) {
+  absl::MutexLock mu(&patch_lock_);
+  latency_ = latency;
+}
+
 void FakeRedfishServer::HandleHttpGet(
     ::tensorflow::serving::net_http::ServerRequestInterface *req) {
+  absl::Duration latency;
+  {
+    absl::MutexLock mu(&patch_lock_);
+    latency = latency_;
+  }
+  // Sleep outside of the lock so that concurrent requests overlap.
+  if (latency > absl::ZeroDuration()) absl::SleepFor(latency);
   absl::MutexLock mu(&patch_lock_);
   auto itr = http_get_handlers_.find(req->uri_path());
   if (itr == http_get_handlers_.end()) {
@@ -26,6 +26,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "ecclesia/lib/file/test_filesystem.h"
 #include "ecclesia/lib/redfish/interface.h"
@@ -108,6 +109,11 @@ class FakeRedfishServer {
   void AddHttpGetHandlerWithOwnedData(std::string uri, std::string data)
       ABSL_LOCKS_EXCLUDED(patch_lock_);
 
+  // Delays each GET by 'latency' before it is handled. The proxy server
+  // delays concurrent requests independently, as a BMC serving several
+  // connections at once would.
+  void SetLatency(absl::Duration latency) ABSL_LOCKS_EXCLUDED(patch_lock_);
+
   struct Config {
     std::string hostname;
     int port;
@@ -136,6 +142,7 @@ class FakeRedfishServer {
       ABSL_GUARDED_BY(patch_lock_);
   absl::flat_hash_map<std::string, HandlerFunc> http_delete_handlers_
       ABSL_GUARDED_BY(patch_lock_);
+  absl::Duration latency_ ABSL_GUARDED_BY(patch_lock_) = absl::ZeroDuration();
   // Helper for fetching any registered patches for a given URI.
   void HandleHttpGet(
       ::tensorflow::serving::net_http::ServerRequestInterface *req)
@@ -0,0 +1,184 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ecclesia/lib/redfish/testing/fake_redfish_transport.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ecclesia/lib/redfish/transport/interface.h"
+#include "single_include/nlohmann/json.hpp"
+
+namespace ecclesia {
+
+FakeRedfishTransport::FakeRedfishTransport(std::string root_uri)
+    : root_uri_(std::move(root_uri)) {}
+
+FakeRedfishTransport::FakeRedfishTransport(
+    std::unique_ptr<RedfishTransport> base)
+    : base_(std::move(base)) {}
+
+void FakeRedfishTransport::SetResource(std::string path, nlohmann::json json) {
+  absl::MutexLock lock(&mutex_);
+  resources_[std::move(path)] = std::move(json);
+}
+
+std::optional<nlohmann::json> FakeRedfishTransport::GetResource(
+    absl::string_view path) const {
+  absl::MutexLock lock(&mutex_);
+  auto iter = resources_.find(path);
+  if (iter == resources_.end()) return std::nullopt;
+  return iter->second;
+}
+
+void FakeRedfishTransport::SetDefaultGetHandler(GetHandler handler) {
+  absl::MutexLock lock(&mutex_);
+  default_get_handler_ = std::move(handler);
+}
+
+void FakeRedfishTransport::SetLatency(absl::Duration latency) {
+  absl::MutexLock lock(&mutex_);
+  latency_ = latency;
+}
+
+void FakeRedfishTransport::SetGetHooks(GetHook before, GetHook after) {
+  absl::MutexLock lock(&mutex_);
+  before_get_ = std::move(before);
+  after_get_ = std::move(after);
+}
+
+std::vector<std::string> FakeRedfishTransport::GetRequestedPaths() const {
+  absl::MutexLock lock(&mutex_);
+  return requested_paths_;
+}
+
+size_t FakeRedfishTransport::GetRequestCount() const {
+  absl::MutexLock lock(&mutex_);
+  return requested_paths_.size();
+}
+
+size_t FakeRedfishTransport::GetServedBytes() const {
+  absl::MutexLock lock(&mutex_);
+  return served_bytes_;
+}
+
+size_t FakeRedfishTransport::GetMaxConcurrentRequests() const {
+  absl::MutexLock lock(&mutex_);
+  return max_concurrent_requests_;
+}
+
+absl::Duration FakeRedfishTransport::BeginRequest() {
+  absl::MutexLock lock(&mutex_);
+  ++concurrent_requests_;
+  max_concurrent_requests_ =
+      std::max(max_concurrent_requests_, concurrent_requests_);
+  return latency_;
+}
+
+void FakeRedfishTransport::EndRequest() {
+  absl::MutexLock lock(&mutex_);
+  --concurrent_requests_;
+}
+
+absl::string_view FakeRedfishTransport::GetRootUri() {
+  if (base_ != nullptr) return base_->GetRootUri();
+  return root_uri_;
+}
+
+absl::StatusOr<RedfishTransport::Result> FakeRedfishTransport::Get(
+    absl::string_view path) {
+  GetHook before_get;
+  GetHook after_get;
+  GetHandler default_get_handler;
+  std::optional<nlohmann::json> resource;
+  {
+    absl::MutexLock lock(&mutex_);
+    requested_paths_.push_back(std::string(path));
+    before_get = before_get_;
+    after_get = after_get_;
+    default_get_handler = default_get_handler_;
+    if (auto iter = resources_.find(path); iter != resources_.end()) {
+      resource = iter->second;
+    }
+  }
+
+  if (before_get != nullptr) before_get(path);
+  absl::SleepFor(BeginRequest());
+  absl::StatusOr<Result> result;
+  if (resource.has_value()) {
+    result = Result{.code = 200, .body = *std::move(resource)};
+  } else if (default_get_handler != nullptr) {
+    result = default_get_handler(path);
+  } else if (base_ != nullptr) {
+    result = base_->Get(path);
+  } else {
+    result = absl::NotFoundError(path);
+  }
+  EndRequest();
+  if (after_get != nullptr) after_get(path);
+
+  if (result.ok()) {
+    if (const nlohmann::json *json = result->GetJsonBody(); json != nullptr) {
+      size_t bytes = json->dump().size();
+      absl::MutexLock lock(&mutex_);
+      served_bytes_ += bytes;
+    }
+  }
+  return result;
+}
+
+absl::StatusOr<RedfishTransport::Result> FakeRedfishTransport::Post(
+    absl::string_view path, absl::string_view data) {
+  absl::SleepFor(BeginRequest());
+  absl::StatusOr<Result> result =
+      base_ != nullptr ? base_->Post(path, data)
+                       : absl::UnimplementedError("POST is not supported");
+  EndRequest();
+  return result;
+}
+
+absl::StatusOr<RedfishTransport::Result> FakeRedfishTransport::Patch(
+    absl::string_view path, absl::string_view data) {
+  absl::SleepFor(BeginRequest());
+  absl::StatusOr<Result> result =
+      base_ != nullptr ? base_->Patch(path, data)
+                       : absl::UnimplementedError("PATCH is not supported");
+  EndRequest();
+  return result;
+}
+
+absl::StatusOr<RedfishTransport::Result> FakeRedfishTransport::Delete(
+    absl::string_view path, absl::string_view data) {
+  absl::SleepFor(BeginRequest());
+  absl::StatusOr<Result> result =
+      base_ != nullptr ? base_->Delete(path, data)
+                       : absl::UnimplementedError("DELETE is not supported");
+  EndRequest();
+  return result;
+}
+
+}  // namespace ecclesia
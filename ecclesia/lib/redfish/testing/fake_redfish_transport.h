@@ -0,0 +1,115 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ECCLESIA_LIB_REDFISH_TESTING_FAKE_REDFISH_TRANSPORT_H_
+#define ECCLESIA_LIB_REDFISH_TESTING_FAKE_REDFISH_TRANSPORT_H_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ecclesia/lib/redfish/transport/interface.h"
+#include "single_include/nlohmann/json.hpp"
+
+namespace ecclesia {
+
+// FakeRedfishTransport serves GET requests from an in-memory map of Redfish
+// resources, keyed by the requested path including any query parameters.
+// Requests for other paths are passed to a default handler, to a base
+// transport, or fail with NotFoundError, in that order.
+//
+// Each GET request is recorded, and can be delayed or observed through hooks
+// run before and after it is served. This lets tests count requests, add
+// latency, advance a fake clock or track the concurrency of requests.
+//
+// This class is thread-safe.
+class FakeRedfishTransport : public RedfishTransport {
+ public:
+  // Serves a GET request for a path without a resource.
+  using GetHandler =
+      std::function<absl::StatusOr<Result>(absl::string_view path)>;
+  // Observes a GET request for 'path'.
+  using GetHook = std::function<void(absl::string_view path)>;
+
+  // Serves only the resources added with SetResource.
+  explicit FakeRedfishTransport(std::string root_uri = "/redfish/v1");
+  // Passes requests for paths without a resource to 'base'.
+  explicit FakeRedfishTransport(std::unique_ptr<RedfishTransport> base);
+
+  // Serves 'json' for GET requests of 'path'.
+  void SetResource(std::string path, nlohmann::json json);
+  // Returns the resource of 'path', or nullopt if it has none.
+  std::optional<nlohmann::json> GetResource(absl::string_view path) const;
+  // Serves GET requests for paths without a resource with 'handler'.
+  void SetDefaultGetHandler(GetHandler handler);
+
+  // Delays every request by 'latency'.
+  void SetLatency(absl::Duration latency);
+  // Runs 'before' and 'after' around every GET request. Either may be null.
+  void SetGetHooks(GetHook before, GetHook after);
+
+  // Returns the paths of all GET requests, in the order they were received.
+  std::vector<std::string> GetRequestedPaths() const;
+  size_t GetRequestCount() const;
+  // Returns the total size of the JSON bodies served.
+  size_t GetServedBytes() const;
+  // Returns the largest number of requests served at the same time.
+  size_t GetMaxConcurrentRequests() const;
+
+  // RedfishTransport overrides. Only GET requests are served from the
+  // resources; other requests are passed to the base transport, if any.
+  absl::string_view GetRootUri() override;
+  absl::StatusOr<Result> Get(absl::string_view path) override;
+  absl::StatusOr<Result> Post(absl::string_view path,
+                              absl::string_view data) override;
+  absl::StatusOr<Result> Patch(absl::string_view path,
+                               absl::string_view data) override;
+  absl::StatusOr<Result> Delete(absl::string_view path,
+                                absl::string_view data) override;
+
+ private:
+  // Returns the latency and marks the start of a request.
+  absl::Duration BeginRequest() ABSL_LOCKS_EXCLUDED(mutex_);
+  void EndRequest() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  const std::string root_uri_;
+  const std::unique_ptr<RedfishTransport> base_;
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, nlohmann::json> resources_
+      ABSL_GUARDED_BY(mutex_);
+  GetHandler default_get_handler_ ABSL_GUARDED_BY(mutex_);
+  absl::Duration latency_ ABSL_GUARDED_BY(mutex_) = absl::ZeroDuration();
+  GetHook before_get_ ABSL_GUARDED_BY(mutex_);
+  GetHook after_get_ ABSL_GUARDED_BY(mutex_);
+  std::vector<std::string> requested_paths_ ABSL_GUARDED_BY(mutex_);
+  size_t served_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+  size_t concurrent_requests_ ABSL_GUARDED_BY(mutex_) = 0;
+  size_t max_concurrent_requests_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace ecclesia
+
+#endif  // ECCLESIA_LIB_REDFISH_TESTING_FAKE_REDFISH_TRANSPORT_H_
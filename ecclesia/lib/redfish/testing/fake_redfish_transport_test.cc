@@ -0,0 +1,100 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ecclesia/lib/redfish/testing/fake_redfish_transport.h"
+
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "ecclesia/lib/redfish/transport/interface.h"
+#include "ecclesia/lib/testing/status.h"
+#include "single_include/nlohmann/json.hpp"
+
+namespace ecclesia {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::Gt;
+
+TEST(FakeRedfishTransportTest, ServesResourcesAndRecordsRequests) {
+  FakeRedfishTransport transport;
+  transport.SetResource("/redfish/v1", {{"@odata.id", "/redfish/v1"}});
+  EXPECT_THAT(transport.GetRootUri(), Eq("/redfish/v1"));
+
+  absl::StatusOr<RedfishTransport::Result> result =
+      transport.Get("/redfish/v1");
+  ASSERT_THAT(result, IsOk());
+  EXPECT_THAT(result->code, Eq(200));
+  ASSERT_TRUE(result->GetJsonBody() != nullptr);
+  EXPECT_THAT((*result->GetJsonBody())["@odata.id"], Eq("/redfish/v1"));
+
+  EXPECT_THAT(transport.Get("/redfish/v1/Chassis"), IsStatusNotFound());
+  EXPECT_THAT(transport.Post("/redfish/v1", "{}"), IsStatusUnimplemented());
+  EXPECT_THAT(transport.GetRequestedPaths(),
+              ElementsAre("/redfish/v1", "/redfish/v1/Chassis"));
+  EXPECT_THAT(transport.GetRequestCount(), Eq(2));
+  EXPECT_THAT(transport.GetServedBytes(), Gt(0));
+  EXPECT_THAT(transport.GetMaxConcurrentRequests(), Eq(1));
+}
+
+TEST(FakeRedfishTransportTest, PassesOtherPathsToDefaultHandlerAndBase) {
+  auto base = std::make_unique<FakeRedfishTransport>();
+  base->SetResource("/redfish/v1/Systems", {{"Name", "base"}});
+  FakeRedfishTransport transport(std::move(base));
+  transport.SetResource("/redfish/v1", {{"Name", "root"}});
+
+  absl::StatusOr<RedfishTransport::Result> result =
+      transport.Get("/redfish/v1/Systems");
+  ASSERT_THAT(result, IsOk());
+  EXPECT_THAT((*result->GetJsonBody())["Name"], Eq("base"));
+
+  transport.SetDefaultGetHandler(
+      [](absl::string_view path) -> absl::StatusOr<RedfishTransport::Result> {
+        return RedfishTransport::Result{
+            .code = 200, .body = nlohmann::json{{"Name", std::string(path)}}};
+      });
+  result = transport.Get("/redfish/v1/Systems");
+  ASSERT_THAT(result, IsOk());
+  EXPECT_THAT((*result->GetJsonBody())["Name"], Eq("/redfish/v1/Systems"));
+  result = transport.Get("/redfish/v1");
+  ASSERT_THAT(result, IsOk());
+  EXPECT_THAT((*result->GetJsonBody())["Name"], Eq("root"));
+}
+
+TEST(FakeRedfishTransportTest, RunsHooksAroundRequests) {
+  FakeRedfishTransport transport;
+  transport.SetResource("/redfish/v1", nlohmann::json::object());
+  std::string before;
+  std::string after;
+  transport.SetGetHooks(
+      [&](absl::string_view path) {
+        EXPECT_THAT(after, Eq(""));
+        before = std::string(path);
+      },
+      [&](absl::string_view path) { after = std::string(path); });
+
+  EXPECT_THAT(transport.Get("/redfish/v1"), IsOk());
+  EXPECT_THAT(before, Eq("/redfish/v1"));
+  EXPECT_THAT(after, Eq("/redfish/v1"));
+}
+
+}  // namespace
+}  // namespace ecclesia
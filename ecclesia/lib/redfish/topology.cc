@@ -16,7 +16,9 @@
 
 #include "ecclesia/lib/redfish/topology.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <initializer_list>
 #include <memory>
 #include <optional>
@@ -25,20 +27,29 @@
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/meta/type_traits.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "ecclesia/lib/redfish/interface.h"
 #include "ecclesia/lib/redfish/node_topology.h"
 #include "ecclesia/lib/redfish/property_definitions.h"
 #include "ecclesia/lib/redfish/property_values.h"
 #include "ecclesia/lib/redfish/topology_config.pb.h"
+#include "ecclesia/lib/redfish/topology_diff.h"
 #include "ecclesia/lib/redfish/topology_v2.h"
 #include "ecclesia/lib/redfish/types.h"
 #include "ecclesia/lib/redfish/utils.h"
+#include "ecclesia/lib/thread/thread_pool.h"
 
 namespace ecclesia {
 namespace {
@@ -92,115 +103,6 @@ struct Assembly {
   std::vector<std::string> upstream_odata_ids;
 };
 
-// If this Redfish object has a "Assembly" property, retrieve it and append it
-// to assembly_out.
-void ExtractAssemblyProperties(const RedfishObject &obj,
-                               std::vector<RedfishVariant> *assembly_out) {
-  auto assembly_node = obj[kRfPropertyAssembly].AsObject();
-  if (!assembly_node) return;
-
-  auto assembly_collection =
-      (*assembly_node)[kRfPropertyAssemblies].AsIterable();
-  if (!assembly_collection) return;
-
-  for (auto assembly : *assembly_collection) {
-    auto assembly_obj = assembly.AsObject();
-    if (!assembly_obj || !AssemblyIsEnabled(*assembly_obj)) {
-      continue;
-    }
-    assembly_out->push_back(std::move(assembly));
-  }
-}
-
-// Finds Assembly resources under the System URI by searching hardcoded URIs:
-// * /redfish/v1/Systems/{id}/Assembly
-// * /redfish/v1/Systems/{id}/Memory/{id}/Assembly
-// * /redfish/v1/Systems/{id}/Processors/{id}/Assembly
-// * /redfish/v1/Systems/{id}/EthernetInterfaces/{id}/Assembly
-// * /redfish/v1/Systems/{id}/Storage/{id}Drives/{id}/Assembly
-void ExtractAssemblyFromSystemUri(const RedfishObject &root_obj,
-                                  std::vector<RedfishVariant> *assembly_out) {
-  auto system_collection = root_obj[kRfPropertySystems].AsIterable();
-  if (!system_collection) return;
-
-  for (auto system : *system_collection) {
-    auto system_obj = system.AsObject();
-    if (!system_obj) continue;
-    ExtractAssemblyProperties(*system_obj, assembly_out);
-
-    auto memory_collection = (*system_obj)[kRfPropertyMemory].AsIterable();
-    if (memory_collection) {
-      for (auto memory : *memory_collection) {
-        auto memory_obj = memory.AsObject();
-        if (!memory_obj) continue;
-        ExtractAssemblyProperties(*memory_obj, assembly_out);
-      }
-    }
-
-    auto processors_collection =
-        (*system_obj)[kRfPropertyProcessors].AsIterable();
-    if (processors_collection) {
-      for (auto processor : *processors_collection) {
-        auto processor_obj = processor.AsObject();
-        if (!processor_obj) continue;
-        ExtractAssemblyProperties(*processor_obj, assembly_out);
-      }
-    }
-
-    auto ethernet_interfaces_collection =
-        (*system_obj)[kRfPropertyEthernetInterfaces].AsIterable();
-    if (ethernet_interfaces_collection) {
-      for (auto ethernet_interface : *ethernet_interfaces_collection) {
-        auto ethernet_interface_obj = ethernet_interface.AsObject();
-        if (!ethernet_interface_obj) continue;
-        ExtractAssemblyProperties(*ethernet_interface_obj, assembly_out);
-      }
-    }
-
-    auto storage_collection = (*system_obj)[kRfPropertyStorage].AsIterable();
-    if (storage_collection) {
-      for (auto storage : *storage_collection) {
-        auto storage_obj = storage.AsObject();
-        if (!storage_obj) continue;
-        auto drives_collection = (*storage_obj)[kRfPropertyDrives].AsIterable();
-        if (drives_collection) {
-          for (auto drive : *drives_collection) {
-            auto drive_obj = drive.AsObject();
-            if (!drive_obj) continue;
-            ExtractAssemblyProperties(*drive_obj, assembly_out);
-          }
-        }
-      }
-    }
-  }
-}
-
-// Finds Assembly resources under the Chassis URI by searching hardcoded URIs:
-// * /redfish/v1/chassis/{chassis_id}/Assembly
-void ExtractAssemblyFromChassisUri(const RedfishObject &root_obj,
-                                   std::vector<RedfishVariant> *assembly_out) {
-  auto chassis_collection = root_obj[kRfPropertyChassis].AsIterable();
-  if (!chassis_collection) return;
-
-  for (auto chassis : *chassis_collection) {
-    auto chassis_obj = chassis.AsObject();
-    if (!chassis_obj) continue;
-    ExtractAssemblyProperties(*chassis_obj, assembly_out);
-  }
-}
-
-std::vector<RedfishVariant> FindAssemblyPayloads(
-    RedfishInterface *redfish_intf) {
-  std::vector<RedfishVariant> assemblies;
-  auto root = redfish_intf->GetRoot().AsObject();
-  if (!root) return assemblies;
-
-  ExtractAssemblyFromChassisUri(*root, &assemblies);
-  ExtractAssemblyFromSystemUri(*root, &assemblies);
-
-  return assemblies;
-}
-
 // Modifies the provided vector of Components by adding devpath information.
 // Devpaths are generated from the provided upstream_connector_sequence and
 // appending a suffix depending on the Component type.
@@ -370,19 +272,333 @@ std::optional<Assembly> ProcessAssembly(RedfishObject *assembly_payload) {
   return assembly;
 }
 
+// If this Redfish object has a "Assembly" property, retrieve it and append it
+// to assembly_out.
+void ExtractAssemblyProperties(const RedfishObject &obj,
+                               GetParams::Freshness freshness,
+                               std::vector<RedfishVariant> *assembly_out) {
+  auto assembly_node =
+      obj.Get(kRfPropertyAssembly, {.freshness = freshness}).AsObject();
+  if (!assembly_node) return;
+
+  auto assembly_collection =
+      (*assembly_node)[kRfPropertyAssemblies].AsIterable();
+  if (!assembly_collection) return;
+
+  for (auto assembly : *assembly_collection) {
+    auto assembly_obj = assembly.AsObject();
+    if (!assembly_obj || !AssemblyIsEnabled(*assembly_obj)) {
+      continue;
+    }
+    assembly_out->push_back(std::move(assembly));
+  }
+}
+
+// Returns the fingerprint of the Assembly resource of 'obj', or an empty
+// string if it has none: the URI of the resource followed by its ETag, or by a
+// hash of its content if it has no ETag.
+std::string GetAssemblyResourceFingerprint(const RedfishObject &obj) {
+  auto assembly_node = obj[kRfPropertyAssembly].AsObject();
+  if (!assembly_node) return "";
+  std::string fingerprint = assembly_node->GetUriString().value_or("");
+  if (auto etag = assembly_node->GetNodeValue<PropertyOdataEtag>();
+      etag.has_value()) {
+    absl::StrAppend(&fingerprint, " ", *etag);
+    return fingerprint;
+  }
+  // FNV-1a, which unlike absl::Hash is stable across processes.
+  uint64_t hash = 0xcbf29ce484222325;
+  for (char c : assembly_node->GetContentAsJson().dump()) {
+    hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3;
+  }
+  absl::StrAppend(&fingerprint, " #", absl::Hex(hash, absl::kZeroPad16));
+  return fingerprint;
+}
+
+RedfishAssemblyRecord ToAssemblyRecord(const Assembly &assembly) {
+  RedfishAssemblyRecord record{.name = assembly.name,
+                               .model = assembly.model,
+                               .upstream_odata_ids =
+                                   assembly.upstream_odata_ids};
+  record.components.reserve(assembly.components.size());
+  for (const auto &component : assembly.components) {
+    record.components.push_back(
+        {.odata_id = component->odata_id,
+         .name = component->name,
+         .model = component->model,
+         .type = component->type,
+         .associated_uris = component->associated_uris});
+  }
+  return record;
+}
+
+Assembly FromAssemblyRecord(const RedfishAssemblyRecord &record) {
+  Assembly assembly{.name = record.name,
+                    .model = record.model,
+                    .upstream_odata_ids = record.upstream_odata_ids};
+  assembly.components.reserve(record.components.size());
+  for (const auto &component : record.components) {
+    assembly.components.push_back(absl::WrapUnique(
+        new Component{.name = component.name,
+                      .model = component.model,
+                      .odata_id = component.odata_id,
+                      .type = component.type,
+                      .associated_uris = component.associated_uris}));
+  }
+  return assembly;
+}
+
+// Assemblies of a previous search to reuse rather than fetch again.
+struct AssemblyReuse {
+  // Returns true if 'uri' is one of the changed URIs or lies under or above
+  // one of them. Trailing slashes are ignored.
+  bool IsChanged(absl::string_view uri) const {
+    uri = absl::StripSuffix(uri, "/");
+    for (absl::string_view changed_uri : changed_uris) {
+      changed_uri = absl::StripSuffix(changed_uri, "/");
+      if (uri == changed_uri ||
+          (absl::StartsWith(uri, changed_uri) &&
+           uri[changed_uri.size()] == '/') ||
+          (absl::StartsWith(changed_uri, uri) &&
+           changed_uri[uri.size()] == '/')) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // URIs of the resources that changed since the previous search.
+  absl::Span<const std::string> changed_uris;
+  // Previously searched resources which did not change, by URI.
+  absl::flat_hash_map<absl::string_view, const RedfishAssemblyOwner *> owners;
+};
+
+// Kinds of Redfish resources searched for Assembly resources.
+enum class AssemblyOwner {
+  kChassis,
+  kSystem,
+  kMemory,
+  kProcessor,
+  kEthernetInterface,
+  kStorage,
+  kDrive,
+};
+
+// The Assemblies found under a Redfish resource. Results are kept in a tree
+// mirroring the searched resources so that they are collected in the same
+// order no matter the order in which concurrent fetches complete.
+struct AssemblySearchResult {
+  // Moves the Assemblies of the subordinate resources, depth-first, to
+  // 'assemblies' and records the resources in 'owners'.
+  void Collect(std::vector<Assembly> *assemblies,
+               std::vector<RedfishAssemblyOwner> *owners) {
+    for (auto &subordinate : subordinates) {
+      RedfishAssemblyOwner &owner = owners->emplace_back();
+      owner.uri = std::move(subordinate->uri);
+      for (auto &assembly : subordinate->assemblies) {
+        owner.assemblies.push_back(ToAssemblyRecord(assembly));
+        assemblies->push_back(std::move(assembly));
+      }
+      subordinate->Collect(assemblies, owners);
+    }
+  }
+
+  // Appends the fingerprints of the subordinate resources, depth-first, to
+  // 'fingerprint'.
+  void CollectFingerprint(std::string *fingerprint) const {
+    for (const auto &subordinate : subordinates) {
+      if (!subordinate->fingerprint.empty()) {
+        absl::StrAppend(fingerprint, subordinate->fingerprint, "\n");
+      }
+      subordinate->CollectFingerprint(fingerprint);
+    }
+  }
+
+  std::string uri;
+  std::vector<Assembly> assemblies;
+  // Fingerprint of the Assembly resource, when only fingerprints are searched.
+  std::string fingerprint;
+  std::vector<std::unique_ptr<AssemblySearchResult>> subordinates;
+};
+
+// What an AssemblySearch collects from the Assembly resources.
+enum class AssemblySearchMode {
+  kAssemblies,
+  kFingerprints,
+};
+
+// Searches Redfish resources for Assembly resources, fetching at most
+// max_concurrent_fetches resources at once. If 'reuse' is provided, the
+// Assemblies of resources which did not change are taken from it.
+class AssemblySearch {
+ public:
+  AssemblySearch(RedfishInterface *redfish_intf, size_t max_concurrent_fetches,
+                 const AssemblyReuse *reuse,
+                 AssemblySearchMode mode = AssemblySearchMode::kAssemblies)
+      : redfish_intf_(redfish_intf),
+        reuse_(reuse),
+        mode_(mode),
+        pool_(static_cast<int>(std::max<size_t>(max_concurrent_fetches, 1))) {}
+
+  // Searches every member of the collection 'collection' of 'parent' as an
+  // 'owner' resource. Results of the members are added to 'result' in the
+  // order of the collection.
+  void SearchMembers(const RedfishObject &parent, absl::string_view collection,
+                     AssemblyOwner owner, AssemblySearchResult &result) {
+    RedfishVariant collection_variant = parent[std::string(collection)];
+    GetParams::Freshness freshness = GetParams::Freshness::kOptional;
+    if (reuse_ != nullptr) {
+      // Members may have been added to or removed from a changed collection.
+      auto collection_obj = collection_variant.AsObject();
+      std::optional<std::string> uri =
+          collection_obj ? collection_obj->GetUriString() : std::nullopt;
+      if (uri.has_value() && reuse_->IsChanged(*uri)) {
+        freshness = GetParams::Freshness::kRequired;
+        collection_variant = redfish_intf_->UncachedGetUri(*uri);
+      }
+    }
+    // Only the member references are read here; the members are fetched by
+    // the pool.
+    auto members = collection_variant.AsIterable(
+        RedfishVariant::IterableMode::kDisableAutoResolve, freshness);
+    if (!members) return;
+    for (auto member : *members) {
+      auto member_obj = member.AsObject();
+      if (!member_obj) continue;
+      std::optional<std::string> uri = member_obj->GetUriString();
+      if (!uri.has_value()) continue;
+      auto &member_result = result.subordinates.emplace_back(
+          std::make_unique<AssemblySearchResult>());
+      member_result->uri = *std::move(uri);
+      {
+        absl::MutexLock lock(&mutex_);
+        ++pending_searches_;
+      }
+      pool_.Schedule(
+          [this, owner, member_result = member_result.get()]() {
+            Search(owner, *member_result);
+            absl::MutexLock lock(&mutex_);
+            --pending_searches_;
+          });
+    }
+  }
+
+  // Blocks until every search has completed.
+  void Wait() {
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(absl::Condition(
+        +[](size_t *pending) { return *pending == 0; }, &pending_searches_));
+  }
+
+ private:
+  // Searches the 'owner' resource at result.uri, then the members of its
+  // subordinate collections, for Assembly resources.
+  void Search(AssemblyOwner owner, AssemblySearchResult &result) {
+    const RedfishAssemblyOwner *previous = nullptr;
+    if (reuse_ != nullptr) {
+      if (auto iter = reuse_->owners.find(result.uri);
+          iter != reuse_->owners.end()) {
+        previous = iter->second;
+      }
+    }
+    bool has_subordinates =
+        owner == AssemblyOwner::kSystem || owner == AssemblyOwner::kStorage;
+    if (previous != nullptr) {
+      for (const auto &record : previous->assemblies) {
+        result.assemblies.push_back(FromAssemblyRecord(record));
+      }
+      if (!has_subordinates) return;
+    }
+
+    GetParams::Freshness freshness =
+        reuse_ != nullptr && reuse_->IsChanged(result.uri)
+            ? GetParams::Freshness::kRequired
+            : GetParams::Freshness::kOptional;
+    auto obj = freshness == GetParams::Freshness::kRequired
+                   ? redfish_intf_->UncachedGetUri(result.uri).AsObject()
+                   : redfish_intf_->CachedGetUri(result.uri).AsObject();
+    if (!obj) return;
+    if (mode_ == AssemblySearchMode::kFingerprints) {
+      if (owner != AssemblyOwner::kStorage) {
+        result.fingerprint = GetAssemblyResourceFingerprint(*obj);
+      }
+    } else if (previous == nullptr && owner != AssemblyOwner::kStorage) {
+      std::vector<RedfishVariant> payloads;
+      ExtractAssemblyProperties(*obj, freshness, &payloads);
+      for (auto &payload : payloads) {
+        auto view = payload.AsObject();
+        if (!view) continue;
+        auto assembly = ProcessAssembly(view.get());
+        if (assembly.has_value()) {
+          result.assemblies.push_back(*std::move(assembly));
+        }
+      }
+    }
+    if (owner == AssemblyOwner::kSystem) {
+      SearchMembers(*obj, kRfPropertyMemory, AssemblyOwner::kMemory, result);
+      SearchMembers(*obj, kRfPropertyProcessors, AssemblyOwner::kProcessor,
+                    result);
+      SearchMembers(*obj, kRfPropertyEthernetInterfaces,
+                    AssemblyOwner::kEthernetInterface, result);
+      SearchMembers(*obj, kRfPropertyStorage, AssemblyOwner::kStorage, result);
+    } else if (owner == AssemblyOwner::kStorage) {
+      SearchMembers(*obj, kRfPropertyDrives, AssemblyOwner::kDrive, result);
+    }
+  }
+
+  RedfishInterface *redfish_intf_;
+  const AssemblyReuse *reuse_;
+  const AssemblySearchMode mode_;
+  absl::Mutex mutex_;
+  size_t pending_searches_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Declared last so that it is joined before the members above are destroyed.
+  ThreadPool pool_;
+};
+
+// Finds Assembly resources under the System URI by searching hardcoded URIs:
+// * /redfish/v1/Systems/{id}/Assembly
+// * /redfish/v1/Systems/{id}/Memory/{id}/Assembly
+// * /redfish/v1/Systems/{id}/Processors/{id}/Assembly
+// * /redfish/v1/Systems/{id}/EthernetInterfaces/{id}/Assembly
+// * /redfish/v1/Systems/{id}/Storage/{id}Drives/{id}/Assembly
+void ExtractAssemblyFromSystemUri(const RedfishObject &root_obj,
+                                  AssemblySearch &search,
+                                  AssemblySearchResult &result) {
+  search.SearchMembers(root_obj, kRfPropertySystems, AssemblyOwner::kSystem,
+                       result);
+}
+
+// Finds Assembly resources under the Chassis URI by searching hardcoded URIs:
+// * /redfish/v1/chassis/{chassis_id}/Assembly
+void ExtractAssemblyFromChassisUri(const RedfishObject &root_obj,
+                                   AssemblySearch &search,
+                                   AssemblySearchResult &result) {
+  search.SearchMembers(root_obj, kRfPropertyChassis, AssemblyOwner::kChassis,
+                       result);
+}
+
 // Run during initialization. Fetches all Assemblies from a Redfish server
-// and parses them into data structs.
+// and parses them into data structs. The resources of Chassis and then of
+// Systems are fetched concurrently but the Assemblies are returned in the
+// order of a sequential search, which keeps the generated devpaths
+// deterministic. The searched resources are recorded in 'owners'.
 std::vector<Assembly> CreateAssembliesFromRedfish(
-    RedfishInterface *redfish_intf) {
+    RedfishInterface *redfish_intf, size_t max_concurrent_fetches,
+    const AssemblyReuse *reuse, std::vector<RedfishAssemblyOwner> *owners) {
   std::vector<Assembly> assemblies;
-  for (auto &assembly : FindAssemblyPayloads(redfish_intf)) {
-    auto view = assembly.AsObject();
-    if (!view) continue;
-    auto processed_info = ProcessAssembly(view.get());
-    if (processed_info.has_value()) {
-      assemblies.push_back(std::move(processed_info.value()));
-    }
+  auto root = redfish_intf->GetRoot().AsObject();
+  if (!root) return assemblies;
+
+  AssemblySearchResult chassis_result;
+  AssemblySearchResult system_result;
+  {
+    AssemblySearch search(redfish_intf, max_concurrent_fetches, reuse);
+    ExtractAssemblyFromChassisUri(*root, search, chassis_result);
+    ExtractAssemblyFromSystemUri(*root, search, system_result);
+    search.Wait();
   }
+  chassis_result.Collect(&assemblies, owners);
+  system_result.Collect(&assemblies, owners);
 
   GenerateDevpaths(&assemblies);
   return assemblies;
@@ -521,6 +737,100 @@ class NodeId {
   NodeType type_;
 };
 
+// Creates a NodeTopology from the Assemblies of a Redfish server, reusing the
+// Assemblies of unchanged resources in 'reuse' if provided.
+NodeTopology CreateNodeTopologyFromRedfishAssemblies(
+    RedfishInterface *redfish_intf, size_t max_concurrent_fetches,
+    const AssemblyReuse *reuse) {
+  std::vector<RedfishAssemblyOwner> owners;
+  std::vector<Assembly> assemblies = CreateAssembliesFromRedfish(
+      redfish_intf, max_concurrent_fetches, reuse, &owners);
+  NodeTopology node_topology = CreateNodeTopologyFromAssemblies(assemblies);
+  node_topology.assembly_owners = std::move(owners);
+  return node_topology;
+}
+
+// Replaces the contents of 'topology' with 'updated'. Nodes present in both
+// keep their address in 'topology' and take the remaining properties of their
+// counterpart in 'updated'. Returns the devpaths of the added and removed
+// Nodes.
+NodeTopologyUpdate PatchNodeTopology(NodeTopology updated,
+                                     NodeTopology *topology) {
+  NodeTopologyUpdate update;
+  absl::flat_hash_map<NodeId, std::vector<std::unique_ptr<Node>>>
+      previous_nodes;
+  for (auto &node : topology->nodes) {
+    NodeId id(*node);
+    previous_nodes[std::move(id)].push_back(std::move(node));
+  }
+
+  // Maps each Node of 'updated' to the Node taking its place.
+  absl::flat_hash_map<const Node *, Node *> kept_nodes;
+  std::vector<std::unique_ptr<Node>> nodes;
+  nodes.reserve(updated.nodes.size());
+  for (auto &node : updated.nodes) {
+    const Node *updated_node = node.get();
+    auto previous = previous_nodes.find(NodeId(*node));
+    if (previous != previous_nodes.end() && !previous->second.empty()) {
+      std::unique_ptr<Node> kept = std::move(previous->second.back());
+      previous->second.pop_back();
+      kept->model = std::move(node->model);
+      kept->associated_uris = std::move(node->associated_uris);
+      kept->replaceable = node->replaceable;
+      node = std::move(kept);
+    } else {
+      update.added_devpaths.push_back(node->local_devpath);
+    }
+    kept_nodes[updated_node] = node.get();
+    nodes.push_back(std::move(node));
+  }
+  for (const auto &[id, removed_nodes] : previous_nodes) {
+    for (const auto &node : removed_nodes) {
+      update.removed_devpaths.push_back(node->local_devpath);
+    }
+  }
+  std::sort(update.added_devpaths.begin(), update.added_devpaths.end());
+  std::sort(update.removed_devpaths.begin(), update.removed_devpaths.end());
+
+  // Rebuild the lookup maps in terms of the kept Nodes.
+  auto translate = [&kept_nodes](const std::vector<Node *> &updated_nodes) {
+    std::vector<Node *> translated;
+    translated.reserve(updated_nodes.size());
+    for (const Node *node : updated_nodes) {
+      if (auto iter = kept_nodes.find(node); iter != kept_nodes.end()) {
+        translated.push_back(iter->second);
+      }
+    }
+    return translated;
+  };
+  topology->nodes = std::move(nodes);
+  topology->uri_to_associated_node_map.clear();
+  for (const auto &[uri, associated_nodes] :
+       updated.uri_to_associated_node_map) {
+    topology->uri_to_associated_node_map[uri] = translate(associated_nodes);
+  }
+  topology->devpath_to_node_map.clear();
+  for (const auto &[devpath, node] : updated.devpath_to_node_map) {
+    if (auto iter = kept_nodes.find(node); iter != kept_nodes.end()) {
+      topology->devpath_to_node_map[devpath] = iter->second;
+    }
+  }
+  topology->node_to_parents.clear();
+  for (const auto &[node, parents] : updated.node_to_parents) {
+    if (auto iter = kept_nodes.find(node); iter != kept_nodes.end()) {
+      topology->node_to_parents[iter->second] = translate(parents);
+    }
+  }
+  topology->node_to_children.clear();
+  for (const auto &[node, children] : updated.node_to_children) {
+    if (auto iter = kept_nodes.find(node); iter != kept_nodes.end()) {
+      topology->node_to_children[iter->second] = translate(children);
+    }
+  }
+  topology->assembly_owners = std::move(updated.assembly_owners);
+  return update;
+}
+
 RedfishNodeTopologyRepresentation GetNodeTopologyReprensentation(
     RedfishInterface *redfish_intf) {
   auto service_root = redfish_intf->GetRoot().AsObject();
@@ -546,47 +856,119 @@ RedfishNodeTopologyRepresentation GetNodeTopologyReprensentation(
 NodeTopology CreateTopologyFromRedfishHelper(
     RedfishInterface *redfish_intf,
     RedfishNodeTopologyRepresentation &default_redfish_topology_reprensentation,
-    std::optional<absl::string_view> topology_config_name) {
+    std::optional<absl::string_view> topology_config_name,
+    size_t max_concurrent_fetches) {
   auto redfish_topology_version = GetNodeTopologyReprensentation(redfish_intf);
   // If the Redfish Agent specifies it's using REDFISH_TOPOLOGY_V1, or if it's
   // unspecified in the Redfish Agent but the default topology is
   // REDFISH_TOPOLOGY_V1, use REDFISH_TOPOLOGY_V1 to create the assemblies and
   // node topology.
+  NodeTopology topology;
   if (redfish_topology_version == REDFISH_TOPOLOGY_V1 ||
       (redfish_topology_version == REDFISH_TOPOLOGY_UNSPECIFIED &&
        default_redfish_topology_reprensentation == REDFISH_TOPOLOGY_V1)) {
-    std::vector<Assembly> assemblies =
-        CreateAssembliesFromRedfish(redfish_intf);
-    return CreateNodeTopologyFromAssemblies(assemblies);
+    topology = CreateNodeTopologyFromRedfishAssemblies(
+        redfish_intf, max_concurrent_fetches, /*reuse=*/nullptr);
+  } else {
+    topology = CreateTopologyFromRedfishV2(
+        redfish_intf,
+        topology_config_name.value_or(kDefaultTopologyV2ConfigName),
+        max_concurrent_fetches);
   }
+  topology.default_representation = default_redfish_topology_reprensentation;
   if (topology_config_name.has_value()) {
-    return CreateTopologyFromRedfishV2(redfish_intf, *topology_config_name);
+    topology.topology_config_name = std::string(*topology_config_name);
   }
-  return CreateTopologyFromRedfishV2(redfish_intf);
+  ComputeStructuralHashes(&topology);
+  return topology;
 }
 }  // namespace
 
 NodeTopology CreateTopologyFromRedfish(
     RedfishInterface *redfish_intf,
-    RedfishNodeTopologyRepresentation
-        default_redfish_topology_reprensentation) {
+    RedfishNodeTopologyRepresentation default_redfish_topology_reprensentation,
+    size_t max_concurrent_fetches) {
   return CreateTopologyFromRedfishHelper(
-      redfish_intf, default_redfish_topology_reprensentation, std::nullopt);
+      redfish_intf, default_redfish_topology_reprensentation, std::nullopt,
+      max_concurrent_fetches);
 }
 
 NodeTopology CreateTopologyFromRedfish(
     RedfishInterface *redfish_intf, absl::string_view topology_config_name,
-    RedfishNodeTopologyRepresentation
-        default_redfish_topology_reprensentation) {
+    RedfishNodeTopologyRepresentation default_redfish_topology_reprensentation,
+    size_t max_concurrent_fetches) {
   return CreateTopologyFromRedfishHelper(
       redfish_intf, default_redfish_topology_reprensentation,
-      topology_config_name);
+      topology_config_name, max_concurrent_fetches);
+}
+
+NodeTopologyUpdate UpdateTopologyFromRedfish(
+    RedfishInterface *redfish_intf, absl::Span<const std::string> changed_uris,
+    NodeTopology *topology, size_t max_concurrent_fetches) {
+  NodeTopologyUpdate update;
+  if (topology->assembly_owners.empty()) {
+    RedfishNodeTopologyRepresentation representation =
+        topology->default_representation;
+    std::optional<absl::string_view> topology_config_name;
+    if (topology->topology_config_name.has_value()) {
+      topology_config_name = *topology->topology_config_name;
+    }
+    update = PatchNodeTopology(
+        CreateTopologyFromRedfishHelper(redfish_intf, representation,
+                                        topology_config_name,
+                                        max_concurrent_fetches),
+        topology);
+  } else {
+    AssemblyReuse reuse{.changed_uris = changed_uris};
+    for (const RedfishAssemblyOwner &owner : topology->assembly_owners) {
+      if (!reuse.IsChanged(owner.uri)) reuse.owners[owner.uri] = &owner;
+    }
+    update = PatchNodeTopology(
+        CreateNodeTopologyFromRedfishAssemblies(redfish_intf,
+                                                max_concurrent_fetches, &reuse),
+        topology);
+  }
+  ComputeStructuralHashes(topology);
+  return update;
+}
+
+absl::StatusOr<std::string> GetAssemblyFingerprint(
+    RedfishInterface *redfish_intf,
+    RedfishNodeTopologyRepresentation default_redfish_topology_reprensentation,
+    size_t max_concurrent_fetches) {
+  auto redfish_topology_version = GetNodeTopologyReprensentation(redfish_intf);
+  if (redfish_topology_version != REDFISH_TOPOLOGY_V1 &&
+      (redfish_topology_version != REDFISH_TOPOLOGY_UNSPECIFIED ||
+       default_redfish_topology_reprensentation != REDFISH_TOPOLOGY_V1)) {
+    return absl::FailedPreconditionError(
+        "The topology is not created from Assembly resources");
+  }
+  auto root = redfish_intf->GetRoot().AsObject();
+  if (!root) return absl::UnavailableError("Unable to fetch the service root");
+
+  AssemblySearchResult chassis_result;
+  AssemblySearchResult system_result;
+  {
+    AssemblySearch search(redfish_intf, max_concurrent_fetches,
+                          /*reuse=*/nullptr, AssemblySearchMode::kFingerprints);
+    ExtractAssemblyFromChassisUri(*root, search, chassis_result);
+    ExtractAssemblyFromSystemUri(*root, search, system_result);
+    search.Wait();
+  }
+  std::string fingerprint;
+  chassis_result.CollectFingerprint(&fingerprint);
+  system_result.CollectFingerprint(&fingerprint);
+  return fingerprint;
 }
 
 bool NodeTopologiesHaveTheSameNodes(const NodeTopology &n1,
                                     const NodeTopology &n2) {
   // Short circuit: if the container sizes are mismatched then infer a delta.
   if (n1.nodes.size() != n2.nodes.size()) return false;
+  // Topologies with the same structure have the same nodes.
+  if (n1.structural_hash != 0 && n1.structural_hash == n2.structural_hash) {
+    return true;
+  }
 
   // Check that all nodes exist in both topologies. This assumes that there are
   // no duplicates of (name, devpath, type) that exist in either set of nodes.
@@ -17,25 +17,79 @@
 #ifndef ECCLESIA_LIB_REDFISH_TOPOLOGY_H_
 #define ECCLESIA_LIB_REDFISH_TOPOLOGY_H_
 
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "ecclesia/lib/redfish/interface.h"
 #include "ecclesia/lib/redfish/node_topology.h"
 #include "ecclesia/lib/redfish/topology_config.pb.h"
 
 namespace ecclesia {
 
+// Creates the NodeTopology of a Redfish service. Up to max_concurrent_fetches
+// resources are fetched concurrently, whether the topology is built from
+// Assembly resources (REDFISH_TOPOLOGY_V1) or from Redfish links; the
+// resulting devpaths do not depend on the concurrency. The structural hashes
+// of the topology are computed.
 NodeTopology CreateTopologyFromRedfish(
     RedfishInterface *redfish_intf,
     RedfishNodeTopologyRepresentation default_redfish_topology_reprensentation =
-        REDFISH_TOPOLOGY_UNSPECIFIED);
+        REDFISH_TOPOLOGY_UNSPECIFIED,
+    size_t max_concurrent_fetches = kDefaultMaxConcurrentTopologyFetches);
 
 NodeTopology CreateTopologyFromRedfish(
     RedfishInterface *redfish_intf, absl::string_view topology_config_name,
     RedfishNodeTopologyRepresentation default_redfish_topology_reprensentation =
-        REDFISH_TOPOLOGY_UNSPECIFIED);
+        REDFISH_TOPOLOGY_UNSPECIFIED,
+    size_t max_concurrent_fetches = kDefaultMaxConcurrentTopologyFetches);
+
+// The devpaths of the Nodes added to and removed from a NodeTopology by an
+// update, in lexicographic order.
+struct NodeTopologyUpdate {
+  std::vector<std::string> added_devpaths;
+  std::vector<std::string> removed_devpaths;
+};
+
+// Updates 'topology', created by CreateTopologyFromRedfish, after the Redfish
+// resources at 'changed_uris' were added, removed or modified, e.g. when a
+// drive or NIC is hot-plugged. Only resources at, under or above a changed URI
+// are fetched again, along with the collections listing them; the Assemblies
+// of the other resources are reused from 'topology'. Topologies which were not
+// created from Assemblies are created again in full, with the representation
+// and topology config they were created with.
+//
+// Nodes which remain in the topology keep their address and the structural
+// hashes are computed again. Returns the devpaths which were added and removed.
+NodeTopologyUpdate UpdateTopologyFromRedfish(
+    RedfishInterface *redfish_intf, absl::Span<const std::string> changed_uris,
+    NodeTopology *topology,
+    size_t max_concurrent_fetches = kDefaultMaxConcurrentTopologyFetches);
+
+// Returns a fingerprint of the Assembly resources CreateTopologyFromRedfish
+// creates the NodeTopology of a Redfish service from: the URI and ETag of each
+// Assembly resource, in the order they are searched. Assembly resources
+// without an ETag are represented by a hash of their content. The Assembly
+// resources are fetched but not processed.
+//
+// Services with equal fingerprints have the same topology, so a topology can
+// be saved along with its fingerprint and reused while the fingerprint holds.
+// Returns FailedPreconditionError if the topology of the service is not
+// created from Assembly resources.
+absl::StatusOr<std::string> GetAssemblyFingerprint(
+    RedfishInterface *redfish_intf,
+    RedfishNodeTopologyRepresentation default_redfish_topology_reprensentation =
+        REDFISH_TOPOLOGY_UNSPECIFIED,
+    size_t max_concurrent_fetches = kDefaultMaxConcurrentTopologyFetches);
+
 // Returns true if both provided NodeTopologies have the same nodes. Nodes are
 // matched by their name, local_devpath, and type fields only. This does not
-// detect changes in the internal maps to nodes.
+// detect changes in the internal maps to nodes. Topologies with equal
+// structural hashes are reported as equal without comparing their nodes; use
+// DiffNodeTopologies to find which nodes changed.
 bool NodeTopologiesHaveTheSameNodes(const NodeTopology &n1,
                                     const NodeTopology &n2);
 
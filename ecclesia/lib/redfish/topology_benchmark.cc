@@ -0,0 +1,70 @@
+/*
+ * Copyright 2020 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures building the NodeTopology of the indus mockup for different bounds
+// on concurrent fetches. The mockup server delays each request to model the
+// latency of a BMC, which dominates topology creation on real systems. Requests
+// go over HTTP and the server delays up to five of them at once, so the speedup
+// levels off beyond five concurrent fetches.
+
+#include <cstddef>
+#include <memory>
+
+#include "benchmark/benchmark.h"
+#include "absl/time/time.h"
+#include "ecclesia/lib/redfish/interface.h"
+#include "ecclesia/lib/redfish/node_topology.h"
+#include "ecclesia/lib/redfish/testing/fake_redfish_server.h"
+#include "ecclesia/lib/redfish/topology.h"
+#include "ecclesia/lib/redfish/topology_config.pb.h"
+#include "ecclesia/lib/redfish/transport/cache.h"
+#include "ecclesia/lib/redfish/transport/http_redfish_intf.h"
+#include "ecclesia/lib/redfish/transport/interface.h"
+
+namespace ecclesia {
+namespace {
+
+constexpr absl::Duration kRequestLatency = absl::Milliseconds(2);
+
+void BM_CreateTopologyFromRedfish(benchmark::State &state) {
+  FakeRedfishServer server("indus_hmb_cn/mockup.shar");
+  server.SetLatency(kRequestLatency);
+  // Responses are not cached so that every iteration fetches the resources.
+  std::unique_ptr<RedfishInterface> intf = NewHttpInterface(
+      server.RedfishClientTransport(),
+      [](RedfishTransport *transport) {
+        return std::make_unique<NullCache>(transport);
+      },
+      RedfishInterface::kTrusted);
+  size_t nodes = 0;
+  for (auto s : state) {
+    NodeTopology topology = CreateTopologyFromRedfish(
+        intf.get(), REDFISH_TOPOLOGY_V1,
+        /*max_concurrent_fetches=*/state.range(0));
+    nodes = topology.nodes.size();
+    benchmark::DoNotOptimize(topology);
+  }
+  state.counters["nodes"] = static_cast<double>(nodes);
+}
+
+BENCHMARK(BM_CreateTopologyFromRedfish)
+    ->RangeMultiplier(2)
+    ->Range(1, 16)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace ecclesia
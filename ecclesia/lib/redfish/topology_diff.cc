@@ -0,0 +1,170 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ecclesia/lib/redfish/topology_diff.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/functional/function_ref.h"
+#include "absl/hash/hash.h"
+#include "absl/strings/string_view.h"
+#include "ecclesia/lib/redfish/node_topology.h"
+
+namespace ecclesia {
+
+namespace {
+
+using NodeMap = absl::flat_hash_map<Node *, std::vector<Node *>>;
+
+// Returns the Nodes 'node' maps to in 'map', which may be empty.
+const std::vector<Node *> &GetMappedNodes(const NodeMap &map,
+                                          const Node *node) {
+  static const std::vector<Node *> *const kNoNodes = new std::vector<Node *>;
+  auto iter = map.find(const_cast<Node *>(node));
+  return iter == map.end() ? *kNoNodes : iter->second;
+}
+
+// Zero marks hashes which were not computed.
+uint64_t NonZeroHash(uint64_t hash) { return hash == 0 ? 1 : hash; }
+
+uint64_t HashNodeFields(const Node &node) {
+  return absl::HashOf(node.name, node.local_devpath, node.type);
+}
+
+uint64_t ComputeNodeHash(const NodeTopology &topology, Node *node,
+                         absl::flat_hash_set<const Node *> &in_progress) {
+  if (node->structural_hash != 0) return node->structural_hash;
+  // Attachments should not form a cycle; if they do, the Node closing the
+  // cycle contributes its own fields only.
+  if (!in_progress.insert(node).second) {
+    return NonZeroHash(HashNodeFields(*node));
+  }
+  std::vector<uint64_t> child_hashes;
+  for (Node *child : GetMappedNodes(topology.node_to_children, node)) {
+    child_hashes.push_back(ComputeNodeHash(topology, child, in_progress));
+  }
+  std::sort(child_hashes.begin(), child_hashes.end());
+  in_progress.erase(node);
+  node->structural_hash =
+      NonZeroHash(absl::HashOf(HashNodeFields(*node), child_hashes));
+  return node->structural_hash;
+}
+
+bool HaveSameFields(const Node &n1, const Node &n2) {
+  return n1.name == n2.name && n1.local_devpath == n2.local_devpath &&
+         n1.type == n2.type;
+}
+
+std::vector<absl::string_view> GetParentDevpaths(const NodeTopology &topology,
+                                                 const Node &node) {
+  std::vector<absl::string_view> devpaths;
+  for (const Node *parent : GetMappedNodes(topology.node_to_parents, &node)) {
+    devpaths.push_back(parent->local_devpath);
+  }
+  std::sort(devpaths.begin(), devpaths.end());
+  return devpaths;
+}
+
+// Calls 'visit' with each Node of 'topology' reachable from its roots along
+// with the Node with the same devpath in 'other', if any. Nodes below a Node
+// whose structural hash equals that of its counterpart are not visited when
+// 'use_hashes' is true.
+void VisitChangedNodes(
+    const NodeTopology &topology, const NodeTopology &other, bool use_hashes,
+    absl::FunctionRef<void(const Node &node, const Node *counterpart)> visit) {
+  std::vector<const Node *> pending;
+  if (use_hashes) {
+    pending.assign(topology.root_nodes.begin(), topology.root_nodes.end());
+  } else {
+    for (const auto &node : topology.nodes) {
+      if (GetMappedNodes(topology.node_to_parents, node.get()).empty()) {
+        pending.push_back(node.get());
+      }
+    }
+  }
+  absl::flat_hash_set<const Node *> visited;
+  while (!pending.empty()) {
+    const Node *node = pending.back();
+    pending.pop_back();
+    if (!visited.insert(node).second) continue;
+    const Node *counterpart = nullptr;
+    if (auto iter = other.devpath_to_node_map.find(node->local_devpath);
+        iter != other.devpath_to_node_map.end()) {
+      counterpart = iter->second;
+    }
+    visit(*node, counterpart);
+    if (use_hashes && counterpart != nullptr &&
+        counterpart->structural_hash == node->structural_hash) {
+      continue;
+    }
+    for (const Node *child : GetMappedNodes(topology.node_to_children, node)) {
+      pending.push_back(child);
+    }
+  }
+}
+
+}  // namespace
+
+void ComputeStructuralHashes(NodeTopology *topology) {
+  for (const auto &node : topology->nodes) node->structural_hash = 0;
+  topology->root_nodes.clear();
+  absl::flat_hash_set<const Node *> in_progress;
+  std::vector<uint64_t> root_hashes;
+  for (const auto &node : topology->nodes) {
+    uint64_t hash = ComputeNodeHash(*topology, node.get(), in_progress);
+    if (GetMappedNodes(topology->node_to_parents, node.get()).empty()) {
+      topology->root_nodes.push_back(node.get());
+      root_hashes.push_back(hash);
+    }
+  }
+  std::sort(root_hashes.begin(), root_hashes.end());
+  topology->structural_hash = NonZeroHash(absl::HashOf(root_hashes));
+}
+
+NodeTopologyDiff DiffNodeTopologies(const NodeTopology &from,
+                                    const NodeTopology &to) {
+  NodeTopologyDiff diff;
+  bool use_hashes = from.structural_hash != 0 && to.structural_hash != 0;
+  if (use_hashes && from.structural_hash == to.structural_hash) return diff;
+
+  VisitChangedNodes(
+      to, from, use_hashes, [&](const Node &node, const Node *counterpart) {
+        if (counterpart == nullptr || !HaveSameFields(node, *counterpart)) {
+          diff.added_devpaths.push_back(node.local_devpath);
+        } else if (GetParentDevpaths(to, node) !=
+                   GetParentDevpaths(from, *counterpart)) {
+          diff.moved_devpaths.push_back(node.local_devpath);
+        }
+      });
+  VisitChangedNodes(
+      from, to, use_hashes, [&](const Node &node, const Node *counterpart) {
+        if (counterpart == nullptr || !HaveSameFields(node, *counterpart)) {
+          diff.removed_devpaths.push_back(node.local_devpath);
+        }
+      });
+
+  std::sort(diff.added_devpaths.begin(), diff.added_devpaths.end());
+  std::sort(diff.removed_devpaths.begin(), diff.removed_devpaths.end());
+  std::sort(diff.moved_devpaths.begin(), diff.moved_devpaths.end());
+  return diff;
+}
+
+}  // namespace ecclesia
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ECCLESIA_LIB_REDFISH_TOPOLOGY_DIFF_H_
+#define ECCLESIA_LIB_REDFISH_TOPOLOGY_DIFF_H_
+
+#include <string>
+#include <vector>
+
+#include "ecclesia/lib/redfish/node_topology.h"
+
+namespace ecclesia {
+
+// Sets the structural hash of every Node of 'topology', its root Nodes and the
+// structural hash of the topology. The structural hash of a Node covers its
+// name, local_devpath and type and the structural hashes of the Nodes attached
+// to it, so it changes when a Node below it is added, removed or moved.
+//
+// Hashes are only comparable within a process. They must be computed again
+// after the Nodes or their attachments are modified.
+void ComputeStructuralHashes(NodeTopology *topology);
+
+// The devpaths which differ between two NodeTopologies, in lexicographic
+// order. A devpath whose Node changed name or type is both removed and added.
+struct NodeTopologyDiff {
+  // Devpaths only found in the new topology.
+  std::vector<std::string> added_devpaths;
+  // Devpaths only found in the old topology.
+  std::vector<std::string> removed_devpaths;
+  // Devpaths found in both topologies, attached to different Nodes.
+  std::vector<std::string> moved_devpaths;
+
+  bool empty() const {
+    return added_devpaths.empty() && removed_devpaths.empty() &&
+           moved_devpaths.empty();
+  }
+};
+
+// Returns the differences from the 'from' topology to the 'to' topology.
+//
+// If both topologies have structural hashes, equal topologies are detected
+// from their hashes alone and subtrees with equal hashes are not visited, so
+// the cost scales with the number of changed Nodes. Otherwise every Node of
+// both topologies is compared.
+NodeTopologyDiff DiffNodeTopologies(const NodeTopology &from,
+                                    const NodeTopology &to);
+
+}  // namespace ecclesia
+
+#endif  // ECCLESIA_LIB_REDFISH_TOPOLOGY_DIFF_H_
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ecclesia/lib/redfish/topology_diff.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/string_view.h"
+#include "ecclesia/lib/redfish/node_topology.h"
+#include "ecclesia/lib/redfish/types.h"
+
+namespace ecclesia {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Ne;
+
+// Adds a Node named after its devpath and attached to the Node at
+// 'parent_devpath', unless it is empty.
+void AddNode(NodeTopology &topology, absl::string_view devpath,
+             absl::string_view parent_devpath = "", NodeType type = kBoard) {
+  auto node = std::make_unique<Node>();
+  node->name = std::string(devpath);
+  node->local_devpath = std::string(devpath);
+  node->type = type;
+  Node *node_ptr = node.get();
+  topology.devpath_to_node_map[devpath] = node_ptr;
+  topology.nodes.push_back(std::move(node));
+  if (!parent_devpath.empty()) {
+    Node *parent = topology.devpath_to_node_map.at(parent_devpath);
+    topology.node_to_parents[node_ptr].push_back(parent);
+    topology.node_to_children[parent].push_back(node_ptr);
+  }
+}
+
+NodeTopology CreateTopology() {
+  NodeTopology topology;
+  AddNode(topology, "/phys");
+  AddNode(topology, "/phys/CPU0", "/phys");
+  AddNode(topology, "/phys/CPU1", "/phys");
+  AddNode(topology, "/phys/PE0", "/phys");
+  AddNode(topology, "/phys/PE0/SSD", "/phys/PE0");
+  return topology;
+}
+
+TEST(ComputeStructuralHashes, EqualForEqualTopologies) {
+  NodeTopology t1 = CreateTopology();
+  NodeTopology t2;
+  // The order of the Nodes does not matter.
+  AddNode(t2, "/phys");
+  AddNode(t2, "/phys/PE0", "/phys");
+  AddNode(t2, "/phys/PE0/SSD", "/phys/PE0");
+  AddNode(t2, "/phys/CPU1", "/phys");
+  AddNode(t2, "/phys/CPU0", "/phys");
+  ComputeStructuralHashes(&t1);
+  ComputeStructuralHashes(&t2);
+
+  EXPECT_THAT(t1.structural_hash, Ne(0));
+  EXPECT_EQ(t1.structural_hash, t2.structural_hash);
+  ASSERT_EQ(t1.root_nodes.size(), 1);
+  EXPECT_EQ(t1.root_nodes[0]->local_devpath, "/phys");
+  EXPECT_TRUE(DiffNodeTopologies(t1, t2).empty());
+}
+
+TEST(ComputeStructuralHashes, ChangesWithNodeBelow) {
+  NodeTopology t1 = CreateTopology();
+  NodeTopology t2 = CreateTopology();
+  t2.devpath_to_node_map.at("/phys/PE0/SSD")->type = kConnector;
+  ComputeStructuralHashes(&t1);
+  ComputeStructuralHashes(&t2);
+
+  EXPECT_NE(t1.structural_hash, t2.structural_hash);
+  EXPECT_NE(t1.devpath_to_node_map.at("/phys/PE0")->structural_hash,
+            t2.devpath_to_node_map.at("/phys/PE0")->structural_hash);
+  // Nodes outside the changed subtree keep their hash.
+  EXPECT_EQ(t1.devpath_to_node_map.at("/phys/CPU0")->structural_hash,
+            t2.devpath_to_node_map.at("/phys/CPU0")->structural_hash);
+}
+
+TEST(DiffNodeTopologies, AddedAndRemoved) {
+  NodeTopology from = CreateTopology();
+  NodeTopology to = CreateTopology();
+  AddNode(to, "/phys/PE1", "/phys");
+  AddNode(to, "/phys/PE1/NIC", "/phys/PE1");
+  ComputeStructuralHashes(&from);
+  ComputeStructuralHashes(&to);
+
+  NodeTopologyDiff diff = DiffNodeTopologies(from, to);
+  EXPECT_THAT(diff.added_devpaths, ElementsAre("/phys/PE1", "/phys/PE1/NIC"));
+  EXPECT_THAT(diff.removed_devpaths, IsEmpty());
+  EXPECT_THAT(diff.moved_devpaths, IsEmpty());
+
+  diff = DiffNodeTopologies(to, from);
+  EXPECT_THAT(diff.added_devpaths, IsEmpty());
+  EXPECT_THAT(diff.removed_devpaths,
+              ElementsAre("/phys/PE1", "/phys/PE1/NIC"));
+  EXPECT_THAT(diff.moved_devpaths, IsEmpty());
+}
+
+TEST(DiffNodeTopologies, Moved) {
+  NodeTopology from = CreateTopology();
+  NodeTopology to;
+  AddNode(to, "/phys");
+  AddNode(to, "/phys/CPU0", "/phys");
+  AddNode(to, "/phys/CPU1", "/phys");
+  AddNode(to, "/phys/PE0", "/phys");
+  AddNode(to, "/phys/PE0/SSD", "/phys/CPU1");
+  ComputeStructuralHashes(&from);
+  ComputeStructuralHashes(&to);
+
+  NodeTopologyDiff diff = DiffNodeTopologies(from, to);
+  EXPECT_THAT(diff.added_devpaths, IsEmpty());
+  EXPECT_THAT(diff.removed_devpaths, IsEmpty());
+  EXPECT_THAT(diff.moved_devpaths, ElementsAre("/phys/PE0/SSD"));
+}
+
+TEST(DiffNodeTopologies, ChangedTypeIsRemovedAndAdded) {
+  NodeTopology from = CreateTopology();
+  NodeTopology to = CreateTopology();
+  to.devpath_to_node_map.at("/phys/CPU1")->type = kConnector;
+  ComputeStructuralHashes(&from);
+  ComputeStructuralHashes(&to);
+
+  NodeTopologyDiff diff = DiffNodeTopologies(from, to);
+  EXPECT_THAT(diff.added_devpaths, ElementsAre("/phys/CPU1"));
+  EXPECT_THAT(diff.removed_devpaths, ElementsAre("/phys/CPU1"));
+  EXPECT_THAT(diff.moved_devpaths, IsEmpty());
+}
+
+TEST(DiffNodeTopologies, WithoutHashes) {
+  NodeTopology from = CreateTopology();
+  NodeTopology to = CreateTopology();
+  AddNode(to, "/phys/CPU0/DIMM0", "/phys/CPU0");
+
+  NodeTopologyDiff diff = DiffNodeTopologies(from, to);
+  EXPECT_THAT(diff.added_devpaths, ElementsAre("/phys/CPU0/DIMM0"));
+  EXPECT_THAT(diff.removed_devpaths, IsEmpty());
+  EXPECT_THAT(diff.moved_devpaths, IsEmpty());
+}
+
+}  // namespace
+}  // namespace ecclesia
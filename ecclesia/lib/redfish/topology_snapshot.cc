@@ -0,0 +1,188 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ecclesia/lib/redfish/topology_snapshot.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/cleanup/cleanup.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "ecclesia/lib/codec/endian.h"
+#include "ecclesia/lib/file/mmap.h"
+#include "ecclesia/lib/redfish/compact_node_topology.h"
+#include "ecclesia/lib/redfish/interface.h"
+#include "ecclesia/lib/redfish/node_topology.h"
+#include "ecclesia/lib/redfish/topology.h"
+#include "ecclesia/lib/redfish/topology_config.pb.h"
+#include "ecclesia/lib/status/posix.h"
+
+namespace ecclesia {
+
+namespace {
+
+// A snapshot starts with the magic, the version and the size of the
+// fingerprint, followed by the fingerprint and the topology.
+constexpr uint32_t kSnapshotMagic = 0x53544345;  // "ECTS"
+constexpr uint32_t kSnapshotVersion = 1;
+constexpr size_t kSnapshotHeaderSize = 3 * sizeof(uint32_t);
+
+absl::Status WriteAll(int fd, absl::string_view data,
+                      const std::string &path) {
+  while (!data.empty()) {
+    ssize_t write_size = write(fd, data.data(), data.size());
+    if (write_size < 0) {
+      if (errno == EINTR) continue;
+      return PosixErrorToStatus(absl::StrCat("failed to write to ", path));
+    }
+    data.remove_prefix(write_size);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::Status WriteTopologySnapshot(const NodeTopology &topology,
+                                   absl::string_view fingerprint,
+                                   const std::string &path) {
+  std::string header(kSnapshotHeaderSize, '\0');
+  LittleEndian::Store32(kSnapshotMagic, header.data());
+  LittleEndian::Store32(kSnapshotVersion, header.data() + sizeof(uint32_t));
+  LittleEndian::Store32(fingerprint.size(),
+                        header.data() + 2 * sizeof(uint32_t));
+  CompactNodeTopology compact = CompactNodeTopology::Create(topology);
+
+  // Write to a temporary file which is then renamed over the snapshot, so
+  // readers never see a partial snapshot. The name is unique so that
+  // concurrent writers do not interleave their snapshots.
+  std::string temp_path = absl::StrCat(path, ".XXXXXX");
+  int fd = mkstemp(temp_path.data());
+  if (fd < 0) {
+    return PosixErrorToStatus(absl::StrCat("unable to create ", temp_path));
+  }
+  absl::Status status;
+  {
+    absl::Cleanup fd_closer = [fd]() { close(fd); };
+    // mkstemp creates the file readable by its owner only.
+    if (fchmod(fd, 0644) != 0) {
+      status = PosixErrorToStatus(absl::StrCat("unable to chmod ", temp_path));
+    }
+    for (absl::string_view data :
+         {absl::string_view(header), fingerprint, compact.serialized()}) {
+      if (!status.ok()) break;
+      status = WriteAll(fd, data, temp_path);
+    }
+  }
+  if (status.ok() && rename(temp_path.c_str(), path.c_str()) != 0) {
+    status = PosixErrorToStatus(absl::StrCat("unable to rename ", temp_path));
+  }
+  if (!status.ok()) unlink(temp_path.c_str());
+  return status;
+}
+
+absl::StatusOr<CompactNodeTopology> ReadTopologySnapshot(
+    const std::string &path, absl::string_view fingerprint) {
+  // The snapshot is opened and mapped once, so that the header, the
+  // fingerprint and the topology all come from the same file even if a new
+  // snapshot is renamed over it meanwhile.
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return PosixErrorToStatus(absl::StrCat("unable to open ", path));
+  }
+  absl::Cleanup fd_closer = [fd]() { close(fd); };
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    return PosixErrorToStatus(absl::StrCat("unable to stat ", path));
+  }
+  size_t snapshot_size = static_cast<size_t>(st.st_size);
+  if (snapshot_size < kSnapshotHeaderSize) {
+    return absl::DataLossError(
+        absl::StrCat("snapshot ", path, " is truncated"));
+  }
+  absl::StatusOr<MappedMemory> mapping = MappedMemory::CreateFromFd(
+      fd, 0, snapshot_size, MappedMemory::Type::kReadOnly);
+  if (!mapping.ok()) return mapping.status();
+  auto storage = std::make_shared<const MappedMemory>(*std::move(mapping));
+  absl::string_view snapshot = storage->MemoryAsStringView();
+
+  if (LittleEndian::Load32(snapshot.data()) != kSnapshotMagic ||
+      LittleEndian::Load32(snapshot.data() + sizeof(uint32_t)) !=
+          kSnapshotVersion) {
+    return absl::FailedPreconditionError(
+        absl::StrCat(path, " is not a topology snapshot of this version"));
+  }
+  uint32_t fingerprint_size =
+      LittleEndian::Load32(snapshot.data() + 2 * sizeof(uint32_t));
+  snapshot.remove_prefix(kSnapshotHeaderSize);
+  if (fingerprint_size > snapshot.size()) {
+    return absl::DataLossError(
+        absl::StrCat("snapshot ", path, " is truncated"));
+  }
+  if (snapshot.substr(0, fingerprint_size) != fingerprint) {
+    return absl::FailedPreconditionError(
+        absl::StrCat("snapshot ", path, " has a different fingerprint"));
+  }
+  snapshot.remove_prefix(fingerprint_size);
+  return CompactNodeTopology::ParseShared(snapshot, std::move(storage));
+}
+
+NodeTopology CreateTopologyFromRedfishWithSnapshot(
+    RedfishInterface *redfish_intf, const std::string &snapshot_path,
+    RedfishNodeTopologyRepresentation default_redfish_topology_reprensentation,
+    size_t max_concurrent_fetches) {
+  absl::StatusOr<std::string> fingerprint =
+      GetAssemblyFingerprint(redfish_intf,
+                             default_redfish_topology_reprensentation,
+                             max_concurrent_fetches);
+  if (fingerprint.ok()) {
+    absl::StatusOr<CompactNodeTopology> snapshot =
+        ReadTopologySnapshot(snapshot_path, *fingerprint);
+    if (snapshot.ok()) {
+      NodeTopology topology = snapshot->ToNodeTopology();
+      topology.default_representation =
+          default_redfish_topology_reprensentation;
+      return topology;
+    }
+    LOG(INFO) << "Creating the topology in full: " << snapshot.status();
+  }
+  NodeTopology topology = CreateTopologyFromRedfish(
+      redfish_intf, default_redfish_topology_reprensentation,
+      max_concurrent_fetches);
+  if (fingerprint.ok()) {
+    if (absl::Status status =
+            WriteTopologySnapshot(topology, *fingerprint, snapshot_path);
+        !status.ok()) {
+      LOG(WARNING) << "Unable to write a topology snapshot: " << status;
+    }
+  }
+  return topology;
+}
+
+}  // namespace ecclesia
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ECCLESIA_LIB_REDFISH_TOPOLOGY_SNAPSHOT_H_
+#define ECCLESIA_LIB_REDFISH_TOPOLOGY_SNAPSHOT_H_
+
+#include <cstddef>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "ecclesia/lib/redfish/compact_node_topology.h"
+#include "ecclesia/lib/redfish/interface.h"
+#include "ecclesia/lib/redfish/node_topology.h"
+#include "ecclesia/lib/redfish/topology.h"
+#include "ecclesia/lib/redfish/topology_config.pb.h"
+
+namespace ecclesia {
+
+// A topology snapshot is a file holding a NodeTopology, in the serialized form
+// of CompactNodeTopology, along with the fingerprint of the Assembly resources
+// it was created from as returned by GetAssemblyFingerprint. A snapshot lets a
+// process reuse the topology created by a previous process for as long as the
+// Assembly resources of the Redfish service are unchanged.
+
+// Writes 'topology' and 'fingerprint' to a snapshot at 'path', replacing any
+// previous snapshot atomically.
+absl::Status WriteTopologySnapshot(const NodeTopology &topology,
+                                   absl::string_view fingerprint,
+                                   const std::string &path);
+
+// Memory maps the snapshot at 'path'. Returns FailedPreconditionError if the
+// snapshot was taken with a fingerprint other than 'fingerprint'.
+absl::StatusOr<CompactNodeTopology> ReadTopologySnapshot(
+    const std::string &path, absl::string_view fingerprint);
+
+// Creates the NodeTopology of a Redfish service like CreateTopologyFromRedfish,
+// but reuses the snapshot at 'snapshot_path' if it matches the fingerprint of
+// the Assembly resources of the service. Otherwise the topology is created in
+// full and a new snapshot is written. Topologies which are not created from
+// Assembly resources are always created in full.
+//
+// Topologies read from a snapshot do not record the resources searched for
+// Assemblies, so UpdateTopologyFromRedfish creates them again in full.
+NodeTopology CreateTopologyFromRedfishWithSnapshot(
+    RedfishInterface *redfish_intf, const std::string &snapshot_path,
+    RedfishNodeTopologyRepresentation default_redfish_topology_reprensentation =
+        REDFISH_TOPOLOGY_UNSPECIFIED,
+    size_t max_concurrent_fetches = kDefaultMaxConcurrentTopologyFetches);
+
+}  // namespace ecclesia
+
+#endif  // ECCLESIA_LIB_REDFISH_TOPOLOGY_SNAPSHOT_H_
@@ -0,0 +1,182 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ecclesia/lib/redfish/topology_snapshot.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "ecclesia/lib/file/test_filesystem.h"
+#include "ecclesia/lib/redfish/compact_node_topology.h"
+#include "ecclesia/lib/redfish/node_topology.h"
+#include "ecclesia/lib/redfish/testing/fake_redfish_server.h"
+#include "ecclesia/lib/redfish/testing/json_mockup.h"
+#include "ecclesia/lib/redfish/topology.h"
+#include "ecclesia/lib/redfish/types.h"
+#include "ecclesia/lib/testing/status.h"
+
+namespace ecclesia {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+constexpr absl::string_view kDimmAssemblyUri =
+    "/redfish/v1/Systems/system/Memory/0/Assembly";
+
+class TopologySnapshotTest : public ::testing::Test {
+ protected:
+  TopologySnapshotTest()
+      : fs_(GetTestTempdirPath()),
+        snapshot_path_(fs_.GetTruePath("/topology")),
+        mockup_("indus_hmb_cn/mockup.shar"),
+        intf_(mockup_.RedfishClientInterface()) {}
+
+  TestFilesystem fs_;
+  std::string snapshot_path_;
+  FakeRedfishServer mockup_;
+  std::unique_ptr<RedfishInterface> intf_;
+};
+
+TEST_F(TopologySnapshotTest, FingerprintFollowsAssemblies) {
+  absl::StatusOr<std::string> fingerprint = GetAssemblyFingerprint(intf_.get());
+  ASSERT_THAT(fingerprint, IsOk());
+  EXPECT_THAT(*fingerprint, HasSubstr(kDimmAssemblyUri));
+  EXPECT_THAT(GetAssemblyFingerprint(intf_.get(), REDFISH_TOPOLOGY_UNSPECIFIED,
+                                     /*max_concurrent_fetches=*/1),
+              IsOkAndHolds(*fingerprint));
+
+  mockup_.AddHttpGetHandlerWithData(std::string(kDimmAssemblyUri), R"json({
+        "@odata.id": "/redfish/v1/Systems/system/Memory/0/Assembly",
+        "@odata.etag": "W/\"2\"",
+        "Assemblies": []
+      })json");
+  absl::StatusOr<std::string> changed = GetAssemblyFingerprint(intf_.get());
+  ASSERT_THAT(changed, IsOk());
+  EXPECT_NE(*changed, *fingerprint);
+  EXPECT_THAT(*changed, HasSubstr(absl::StrCat(kDimmAssemblyUri, " W/\"2\"")));
+}
+
+TEST_F(TopologySnapshotTest, FingerprintRequiresAssemblyTopology) {
+  auto json_intf = NewJsonMockupInterface(R"json(
+    {}
+  )json");
+  EXPECT_THAT(GetAssemblyFingerprint(json_intf.get()),
+              IsStatusFailedPrecondition());
+}
+
+TEST_F(TopologySnapshotTest, ReadsSnapshotWithMatchingFingerprint) {
+  NodeTopology topology = CreateTopologyFromRedfish(intf_.get());
+  ASSERT_THAT(WriteTopologySnapshot(topology, "fingerprint", snapshot_path_),
+              IsOk());
+
+  absl::StatusOr<CompactNodeTopology> snapshot =
+      ReadTopologySnapshot(snapshot_path_, "fingerprint");
+  ASSERT_THAT(snapshot, IsOk());
+  EXPECT_TRUE(
+      NodeTopologiesHaveTheSameNodes(snapshot->ToNodeTopology(), topology));
+  EXPECT_TRUE(snapshot->FindNodeByDevpath("/phys/DIMM0").has_value());
+
+  EXPECT_THAT(ReadTopologySnapshot(snapshot_path_, "other"),
+              IsStatusFailedPrecondition());
+  EXPECT_THAT(ReadTopologySnapshot(snapshot_path_, "fingerprinT"),
+              IsStatusFailedPrecondition());
+  EXPECT_THAT(ReadTopologySnapshot(fs_.GetTruePath("/missing"), "fingerprint"),
+              Not(IsOk()));
+}
+
+TEST_F(TopologySnapshotTest, RejectsTruncatedSnapshot) {
+  fs_.CreateFile("/short", "ECTS");
+  EXPECT_THAT(ReadTopologySnapshot(fs_.GetTruePath("/short"), "fingerprint"),
+              IsStatusDataLoss());
+
+  // The header claims a fingerprint of 100 bytes.
+  fs_.CreateFile("/no_fingerprint",
+                 std::string("ECTS\x01\0\0\0\x64\0\0\0fin", 15));
+  EXPECT_THAT(
+      ReadTopologySnapshot(fs_.GetTruePath("/no_fingerprint"), "fingerprint"),
+      IsStatusDataLoss());
+}
+
+TEST_F(TopologySnapshotTest, ReadSnapshotOutlivesItsReplacement) {
+  NodeTopology topology = CreateTopologyFromRedfish(intf_.get());
+  ASSERT_THAT(WriteTopologySnapshot(topology, "fingerprint", snapshot_path_),
+              IsOk());
+  absl::StatusOr<CompactNodeTopology> snapshot =
+      ReadTopologySnapshot(snapshot_path_, "fingerprint");
+  ASSERT_THAT(snapshot, IsOk());
+
+  // Replacing the snapshot does not change the one already read.
+  ASSERT_THAT(WriteTopologySnapshot(NodeTopology(), "other", snapshot_path_),
+              IsOk());
+  EXPECT_TRUE(
+      NodeTopologiesHaveTheSameNodes(snapshot->ToNodeTopology(), topology));
+  EXPECT_THAT(ReadTopologySnapshot(snapshot_path_, "other"), IsOk());
+}
+
+TEST_F(TopologySnapshotTest, ReusesSnapshotWhileAssembliesAreUnchanged) {
+  absl::StatusOr<std::string> fingerprint = GetAssemblyFingerprint(intf_.get());
+  ASSERT_THAT(fingerprint, IsOk());
+  // A snapshot unlike the topology of the service shows that it was reused.
+  NodeTopology snapshot_topology;
+  {
+    auto node = std::make_unique<Node>();
+    node->local_devpath = "/phys/snapshot";
+    node->type = NodeType::kBoard;
+    snapshot_topology.devpath_to_node_map[node->local_devpath] = node.get();
+    snapshot_topology.nodes.push_back(std::move(node));
+  }
+  ASSERT_THAT(
+      WriteTopologySnapshot(snapshot_topology, *fingerprint, snapshot_path_),
+      IsOk());
+
+  NodeTopology topology =
+      CreateTopologyFromRedfishWithSnapshot(intf_.get(), snapshot_path_);
+  EXPECT_TRUE(NodeTopologiesHaveTheSameNodes(topology, snapshot_topology));
+}
+
+TEST_F(TopologySnapshotTest, CreatesTopologyWhenAssembliesChange) {
+  NodeTopology topology =
+      CreateTopologyFromRedfishWithSnapshot(intf_.get(), snapshot_path_);
+  EXPECT_TRUE(topology.devpath_to_node_map.contains("/phys/DIMM0"));
+
+  // Remove the DIMM.
+  mockup_.AddHttpGetHandlerWithData(std::string(kDimmAssemblyUri), R"json({
+        "@odata.id": "/redfish/v1/Systems/system/Memory/0/Assembly",
+        "Assemblies": []
+      })json");
+  topology = CreateTopologyFromRedfishWithSnapshot(intf_.get(), snapshot_path_);
+  EXPECT_FALSE(topology.devpath_to_node_map.contains("/phys/DIMM0"));
+  EXPECT_TRUE(NodeTopologiesHaveTheSameNodes(
+      topology, CreateTopologyFromRedfish(intf_.get())));
+
+  // The snapshot was replaced.
+  absl::StatusOr<std::string> fingerprint = GetAssemblyFingerprint(intf_.get());
+  ASSERT_THAT(fingerprint, IsOk());
+  absl::StatusOr<CompactNodeTopology> snapshot =
+      ReadTopologySnapshot(snapshot_path_, *fingerprint);
+  ASSERT_THAT(snapshot, IsOk());
+  EXPECT_FALSE(snapshot->FindNodeByDevpath("/phys/DIMM0").has_value());
+}
+
+}  // namespace
+}  // namespace ecclesia
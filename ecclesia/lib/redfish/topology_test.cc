@@ -16,6 +16,7 @@
 
 #include "ecclesia/lib/redfish/topology.h"
 
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <utility>
@@ -25,12 +26,20 @@
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/match.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "ecclesia/lib/redfish/interface.h"
 #include "ecclesia/lib/redfish/node_topology.h"
 #include "ecclesia/lib/redfish/test_mockup.h"
 #include "ecclesia/lib/redfish/testing/fake_redfish_server.h"
+#include "ecclesia/lib/redfish/testing/fake_redfish_transport.h"
 #include "ecclesia/lib/redfish/testing/json_mockup.h"
 #include "ecclesia/lib/redfish/testing/node_topology_testing.h"
+#include "ecclesia/lib/redfish/topology_v2.h"
+#include "ecclesia/lib/redfish/transport/cache.h"
+#include "ecclesia/lib/redfish/transport/http_redfish_intf.h"
+#include "ecclesia/lib/redfish/transport/interface.h"
 #include "ecclesia/lib/redfish/types.h"
 
 namespace ecclesia {
@@ -38,11 +47,17 @@ namespace ecclesia {
 namespace {
 
 using ::testing::Contains;
+using ::testing::Each;
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
 using ::testing::Eq;
+using ::testing::Gt;
+using ::testing::IsEmpty;
 using ::testing::IsNull;
 using ::testing::Not;
 using ::testing::Pointee;
 using ::testing::Pointwise;
+using ::testing::StartsWith;
 using ::testing::UnorderedElementsAre;
 
 TEST(Topology, Empty) {
@@ -231,12 +246,9 @@ TEST(NodeTopologiesHaveTheSameNodes, NewTypeDetected) {
   EXPECT_FALSE(NodeTopologiesHaveTheSameNodes(n1, n2));
 }
 
-TEST(RawInterfaceTestWithMockup, IndusHmbCnMockupNodesArePopulated) {
-  TestingMockupServer mockup("indus_hmb_cn/mockup.shar");
-  auto raw_intf = mockup.RedfishClientInterface();
-  NodeTopology topology = CreateTopologyFromRedfish(raw_intf.get());
-
-  const std::vector<Node> expected_nodes = {
+// Returns the nodes of the indus_hmb_cn mockup topology, in order.
+std::vector<Node> IndusHmbCnExpectedNodes() {
+  return {
       Node{"indus", "indus", "/phys", NodeType::kBoard},
       Node{"CPU0", "CPU0", "/phys:connector:CPU0", NodeType::kConnector},
       Node{"CPU1", "CPU1", "/phys:connector:CPU1", NodeType::kConnector},
@@ -366,6 +378,12 @@ TEST(RawInterfaceTestWithMockup, IndusHmbCnMockupNodesArePopulated) {
       Node{"cascadelake", "cascadelake", "/phys/CPU0", NodeType::kBoard},
       Node{"cascadelake", "cascadelake", "/phys/CPU1", NodeType::kBoard},
   };
+}
+
+TEST(RawInterfaceTestWithMockup, IndusHmbCnMockupNodesArePopulated) {
+  TestingMockupServer mockup("indus_hmb_cn/mockup.shar");
+  auto raw_intf = mockup.RedfishClientInterface();
+  NodeTopology topology = CreateTopologyFromRedfish(raw_intf.get());
 
   std::vector<Node> actual_nodes;
   actual_nodes.reserve(topology.nodes.size());
@@ -373,7 +391,8 @@ TEST(RawInterfaceTestWithMockup, IndusHmbCnMockupNodesArePopulated) {
     actual_nodes.push_back(*node);
   }
 
-  EXPECT_THAT(actual_nodes, Pointwise(RedfishNodeEqId(), expected_nodes));
+  EXPECT_THAT(actual_nodes,
+              Pointwise(RedfishNodeEqId(), IndusHmbCnExpectedNodes()));
 }
 
 TEST(RawInterfaceTestWithMockup, IndusHmbCnMockupDevpathToNodeMapMatches) {
@@ -595,6 +614,149 @@ TEST(RawInterfaceTestWithMockup, NodesMatch) {
   NodeTopologiesHaveTheSameNodes(topology1, topology2);
 }
 
+TEST(RawInterfaceTestWithMockup, ConcurrentFetchesKeepNodeOrder) {
+  TestingMockupServer mockup("indus_hmb_cn/mockup.shar");
+  auto raw_intf = mockup.RedfishClientInterface();
+
+  // Nodes come in the order of the sequential Assembly search whatever the
+  // order in which concurrent fetches complete.
+  for (int i = 0; i < 5; ++i) {
+    NodeTopology topology = CreateTopologyFromRedfish(
+        raw_intf.get(), REDFISH_TOPOLOGY_UNSPECIFIED,
+        /*max_concurrent_fetches=*/16);
+    std::vector<Node> actual_nodes;
+    actual_nodes.reserve(topology.nodes.size());
+    for (const auto &node : topology.nodes) {
+      actual_nodes.push_back(*node);
+    }
+    EXPECT_THAT(actual_nodes,
+                Pointwise(RedfishNodeEqId(), IndusHmbCnExpectedNodes()));
+  }
+}
+
+TEST(RawInterfaceTestWithMockup, UpdatesTopologyIncrementally) {
+  FakeRedfishServer mockup("indus_hmb_cn/mockup.shar");
+  auto raw_intf = mockup.RedfishClientInterface();
+  NodeTopology topology = CreateTopologyFromRedfish(raw_intf.get());
+  ASSERT_TRUE(topology.devpath_to_node_map.contains("/phys/DIMM0"));
+  ASSERT_TRUE(topology.devpath_to_node_map.contains("/phys"));
+  const Node *root = topology.devpath_to_node_map.at("/phys");
+  const std::vector<std::string> changed_uris = {
+      "/redfish/v1/Systems/system/Memory/0"};
+
+  // Remove the DIMM.
+  mockup.AddHttpGetHandlerWithData(
+      "/redfish/v1/Systems/system/Memory/0/Assembly", R"json({
+        "@odata.id": "/redfish/v1/Systems/system/Memory/0/Assembly",
+        "Assemblies": []
+      })json");
+  NodeTopologyUpdate update =
+      UpdateTopologyFromRedfish(raw_intf.get(), changed_uris, &topology);
+  EXPECT_THAT(update.added_devpaths, IsEmpty());
+  EXPECT_THAT(update.removed_devpaths, Contains("/phys/DIMM0"));
+  EXPECT_FALSE(topology.devpath_to_node_map.contains("/phys/DIMM0"));
+  EXPECT_FALSE(topology.uri_to_associated_node_map.contains(
+      "/redfish/v1/Systems/system/Memory/0"));
+  // Nodes which remain keep their address.
+  EXPECT_EQ(topology.devpath_to_node_map.at("/phys"), root);
+  EXPECT_TRUE(NodeTopologiesHaveTheSameNodes(
+      topology, CreateTopologyFromRedfish(raw_intf.get())));
+
+  // Plug the DIMM back in.
+  mockup.ClearHandlers();
+  update = UpdateTopologyFromRedfish(raw_intf.get(), changed_uris, &topology);
+  EXPECT_THAT(update.added_devpaths, Contains("/phys/DIMM0"));
+  EXPECT_THAT(update.removed_devpaths, IsEmpty());
+  ASSERT_TRUE(topology.devpath_to_node_map.contains("/phys/DIMM0"));
+  EXPECT_THAT(topology.node_to_parents.at(
+                  topology.devpath_to_node_map.at("/phys/DIMM0")),
+              Contains(topology.devpath_to_node_map.at(
+                  "/phys:connector:DIMM0")));
+  EXPECT_EQ(topology.devpath_to_node_map.at("/phys"), root);
+  EXPECT_TRUE(NodeTopologiesHaveTheSameNodes(
+      topology, CreateTopologyFromRedfish(raw_intf.get())));
+}
+
+TEST(RawInterfaceTestWithMockup, UpdateWithoutChangesKeepsTopology) {
+  TestingMockupServer mockup("indus_hmb_cn/mockup.shar");
+  auto raw_intf = mockup.RedfishClientInterface();
+  NodeTopology topology = CreateTopologyFromRedfish(raw_intf.get());
+  size_t num_nodes = topology.nodes.size();
+
+  NodeTopologyUpdate update =
+      UpdateTopologyFromRedfish(raw_intf.get(), {}, &topology);
+  EXPECT_THAT(update.added_devpaths, IsEmpty());
+  EXPECT_THAT(update.removed_devpaths, IsEmpty());
+  EXPECT_EQ(topology.nodes.size(), num_nodes);
+}
+
+TEST(RawInterfaceTestWithMockup, UpdateFetchesOnlyChangedAssemblies) {
+  FakeRedfishServer mockup("indus_hmb_cn/mockup.shar");
+  auto transport =
+      std::make_unique<FakeRedfishTransport>(mockup.RedfishClientTransport());
+  FakeRedfishTransport *fake_transport = transport.get();
+  // Responses are not cached so that every fetch reaches the transport.
+  std::unique_ptr<RedfishInterface> intf = NewHttpInterface(
+      std::move(transport),
+      [](RedfishTransport *transport) {
+        return std::make_unique<NullCache>(transport);
+      },
+      RedfishInterface::kTrusted);
+  NodeTopology topology = CreateTopologyFromRedfish(intf.get());
+  size_t num_nodes = topology.nodes.size();
+  size_t create_requests = fake_transport->GetRequestCount();
+
+  // Returns the Assembly resources fetched since the first 'num_requests'.
+  auto assemblies_fetched_since = [&](size_t num_requests) {
+    std::vector<std::string> paths = fake_transport->GetRequestedPaths();
+    std::vector<std::string> assembly_paths;
+    for (size_t i = num_requests; i < paths.size(); ++i) {
+      if (absl::EndsWith(paths[i], "/Assembly")) {
+        assembly_paths.push_back(paths[i]);
+      }
+    }
+    return assembly_paths;
+  };
+
+  NodeTopologyUpdate update = UpdateTopologyFromRedfish(
+      intf.get(), {"/redfish/v1/Systems/system/Memory/0"}, &topology);
+  EXPECT_THAT(update.added_devpaths, IsEmpty());
+  EXPECT_THAT(update.removed_devpaths, IsEmpty());
+  EXPECT_EQ(topology.nodes.size(), num_nodes);
+  EXPECT_LT(fake_transport->GetRequestCount() - create_requests,
+            create_requests);
+  EXPECT_THAT(assemblies_fetched_since(create_requests),
+              ElementsAre("/redfish/v1/Systems/system/Memory/0/Assembly"));
+
+  // Changed URIs match with or without a trailing slash, so the members of a
+  // changed collection are fetched again.
+  size_t requests = fake_transport->GetRequestCount();
+  update = UpdateTopologyFromRedfish(
+      intf.get(), {"/redfish/v1/Systems/system/Memory/"}, &topology);
+  EXPECT_THAT(update.added_devpaths, IsEmpty());
+  EXPECT_THAT(update.removed_devpaths, IsEmpty());
+  std::vector<std::string> assembly_paths = assemblies_fetched_since(requests);
+  EXPECT_THAT(assembly_paths, Not(IsEmpty()));
+  EXPECT_THAT(assembly_paths,
+              Each(StartsWith("/redfish/v1/Systems/system/Memory/")));
+}
+
+TEST(TopologyTestRunner, UpdateKeepsTopologyConfig) {
+  TestingMockupServer mockup("topology_v2_testing/mockup.shar");
+  auto raw_intf = mockup.RedfishClientInterface();
+  NodeTopology topology = CreateTopologyFromRedfish(
+      raw_intf.get(), "redfish_test.textpb", REDFISH_TOPOLOGY_V2);
+  ASSERT_THAT(topology.assembly_owners, IsEmpty());
+  size_t num_nodes = topology.nodes.size();
+
+  // The topology is created again with the same config.
+  NodeTopologyUpdate update =
+      UpdateTopologyFromRedfish(raw_intf.get(), {}, &topology);
+  EXPECT_THAT(update.added_devpaths, IsEmpty());
+  EXPECT_THAT(update.removed_devpaths, IsEmpty());
+  EXPECT_EQ(topology.nodes.size(), num_nodes);
+}
+
 TEST(RawInterfaceTestWithMockup, HandleAssemblyStateCorrectlly) {
   TestingMockupServer mockup("indus_hmb_cn_playground/mockup.shar");
   auto raw_intf = mockup.RedfishClientInterface();
@@ -684,5 +846,48 @@ TEST(TopologyTestRunner, TestingConfigsOptionV2) {
   EXPECT_THAT(actual_nodes, Pointwise(RedfishNodeEqId(), expected_nodes));
 }
 
+TEST(TopologyTestRunner, TestingV2ResolvesLinksConcurrently) {
+  FakeRedfishServer mockup("topology_v2_testing/mockup.shar");
+  auto transport =
+      std::make_unique<FakeRedfishTransport>(mockup.RedfishClientTransport());
+  // Requests take long enough for concurrent fetches to overlap.
+  transport->SetLatency(absl::Milliseconds(1));
+  FakeRedfishTransport *fake_transport = transport.get();
+  std::unique_ptr<RedfishInterface> intf = NewHttpInterface(
+      std::move(transport),
+      [](RedfishTransport *transport) {
+        return std::make_unique<NullCache>(transport);
+      },
+      RedfishInterface::kTrusted);
+  auto devpaths = [](const NodeTopology &topology) {
+    std::vector<std::string> devpaths;
+    for (const auto &node : topology.nodes) {
+      devpaths.push_back(node->local_devpath);
+    }
+    return devpaths;
+  };
+
+  NodeTopology sequential = CreateTopologyFromRedfish(
+      intf.get(), REDFISH_TOPOLOGY_V2, /*max_concurrent_fetches=*/1);
+  ASSERT_THAT(sequential.nodes, Not(IsEmpty()));
+  EXPECT_THAT(fake_transport->GetMaxConcurrentRequests(), Eq(1));
+
+  // Links are resolved concurrently by default, into the same topology.
+  NodeTopology concurrent =
+      CreateTopologyFromRedfish(intf.get(), REDFISH_TOPOLOGY_V2);
+  EXPECT_THAT(fake_transport->GetMaxConcurrentRequests(), Gt(1));
+  EXPECT_THAT(devpaths(concurrent), ElementsAreArray(devpaths(sequential)));
+
+  TopologyV2Metrics metrics;
+  NodeTopology measured = CreateTopologyFromRedfishV2(
+      intf.get(), kDefaultTopologyV2ConfigName,
+      kDefaultMaxConcurrentTopologyFetches, &metrics);
+  EXPECT_THAT(devpaths(measured), ElementsAreArray(devpaths(sequential)));
+  EXPECT_THAT(metrics.nodes, Eq(measured.nodes.size()));
+  EXPECT_THAT(metrics.cables, Gt(0));
+  EXPECT_THAT(metrics.traversal_levels, Gt(0));
+  EXPECT_THAT(metrics.traversal_time, Gt(absl::ZeroDuration()));
+}
+
 }  // namespace
 }  // namespace ecclesia
@@ -16,6 +16,8 @@
 
 #include "ecclesia/lib/redfish/topology_v2.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <memory>
 #include <optional>
 #include <queue>
@@ -28,8 +30,13 @@
 #include "absl/functional/function_ref.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "ecclesia/lib/file/cc_embed_interface.h"
 #include "ecclesia/lib/redfish/interface.h"
 #include "ecclesia/lib/redfish/node_topology.h"
@@ -39,14 +46,14 @@
 #include "ecclesia/lib/redfish/topology_configs.h"
 #include "ecclesia/lib/redfish/types.h"
 #include "ecclesia/lib/redfish/utils.h"
+#include "ecclesia/lib/thread/thread_pool.h"
 #include "google/protobuf/text_format.h"
+#include "single_include/nlohmann/json.hpp"
 
 namespace ecclesia {
 namespace {
 
 constexpr absl::string_view kTopologyConfigPrefix = "topology_configs/";
-constexpr absl::string_view kDefaultTopologyConfigName =
-    "redfish_2021_1.textpb";
 
 std::optional<TopologyConfig> LoadTopologyConfigFromConfigName(
     absl::string_view config_name) {
@@ -61,57 +68,90 @@ std::optional<TopologyConfig> LoadTopologyConfigFromConfigName(
   return std::nullopt;
 }
 
+// Fetches the members of the Cables collection. The members are expanded into
+// the collection if the service supports it; otherwise they are fetched a few
+// at a time ahead of their access if 'prefetch' is true.
+std::vector<std::unique_ptr<RedfishObject>> FetchCables(
+    RedfishInterface *redfish_intf, bool prefetch) {
+  std::vector<std::unique_ptr<RedfishObject>> cables;
+  GetParams params;
+  RedfishQueryParamExpand expand({.type = RedfishQueryParamExpand::kNotLinks,
+                                  .levels = 1});
+  if (expand.ValidateRedfishSupport(redfish_intf->SupportedFeatures()).ok()) {
+    params.expand = std::move(expand);
+  }
+  RedfishVariant collection =
+      redfish_intf->GetRoot()[RedfishVariant::IndexGetWithArgs{
+          kRfPropertyCables, std::move(params)}];
+  std::unique_ptr<RedfishIterable> members = collection.AsIterable(
+      prefetch ? RedfishVariant::IterableMode::kPrefetchMembers
+               : RedfishVariant::IterableMode::kAllowExpand);
+  if (members == nullptr) return cables;
+  for (auto member : *members) {
+    if (std::unique_ptr<RedfishObject> cable = member.AsObject()) {
+      cables.push_back(std::move(cable));
+    }
+  }
+  return cables;
+}
+
 // Function to iterate through all cables with valid Location tags and call
 // callback_function on each
-void FindAllCablesHelper(RedfishInterface *redfish_intf,
-                         const TopologyConfig::CableLinkages &cable_linkages,
-                         absl::FunctionRef<RedfishIterReturnValue(
-                             std::unique_ptr<RedfishObject> cable_json,
-                             const std::string &upstream_uri)>
-                             callback_function) {
-  redfish_intf->GetRoot()[kRfPropertyCables].Each().Do(
-      [&](std::unique_ptr<RedfishObject> &cable_json) {
-        DLOG(INFO) << "Handling cable "
-                   << cable_json->GetUriString().value_or("<unknown URI>");
-        const auto cable_links = (*cable_json)[kRfPropertyLinks].AsObject();
-        if (!cable_links) return RedfishIterReturnValue::kContinue;
-
-        DLOG(INFO) << "Looking for upstream connections";
-        std::optional<std::string> upstream_uri;
-        for (const auto &upstream_link : cable_linkages.upstream_links()) {
-          // Assuming there is only one upstream resource
-          if (auto upstream_obj = (*cable_links)[upstream_link][0].AsObject()) {
-            // Collection of Resources
-            DLOG(INFO) << "Found a collection of resources at upstream link: "
-                       << upstream_link;
-            upstream_uri = upstream_obj->GetUriString();
-          } else if (auto upstream_obj =
-                         (*cable_links)[upstream_link].AsObject()) {
-            // Single Resource link
-            DLOG(INFO) << "Found an upstream resources at upstream link: "
-                       << upstream_link;
-            upstream_uri = upstream_obj->GetUriString();
-          }
-        }
-        if (!upstream_uri.has_value()) {
-          DLOG(INFO) << "No upstream connection from cable found";
-          return RedfishIterReturnValue::kContinue;
-        }
+void FindAllCablesHelper(
+    absl::Span<const std::unique_ptr<RedfishObject>> cables,
+    const TopologyConfig::CableLinkages &cable_linkages,
+    absl::FunctionRef<RedfishIterReturnValue(const RedfishObject &cable_json,
+                                             const std::string &upstream_uri)>
+        callback_function) {
+  for (const std::unique_ptr<RedfishObject> &cable_json : cables) {
+    DLOG(INFO) << "Handling cable "
+               << cable_json->GetUriString().value_or("<unknown URI>");
+    const nlohmann::json cable_content = cable_json->GetContentAsJson();
+    const auto cable_links = cable_content.find(kRfPropertyLinks);
+    if (cable_links == cable_content.end() || !cable_links->is_object()) {
+      continue;
+    }
 
-        // In order to attach cable, we will require a PartLocation to be
-        // present
-        const auto cable_location =
-            (*cable_json)[kRfPropertyLocation][kRfPropertyPartLocation]
-                .AsObject();
-        if (!cable_location) {
-          DLOG(INFO) << "Cable has no location information";
-          return RedfishIterReturnValue::kContinue;
-        }
+    // The upstream URIs are read from the links so that the upstream resources
+    // are not fetched here.
+    DLOG(INFO) << "Looking for upstream connections";
+    std::optional<std::string> upstream_uri;
+    for (const auto &upstream_link : cable_linkages.upstream_links()) {
+      const auto link = cable_links->find(upstream_link);
+      if (link == cable_links->end()) continue;
+      // Assuming there is only one upstream resource
+      const nlohmann::json *reference = &*link;
+      if (link->is_array()) {
+        // Collection of Resources
+        if (link->empty()) continue;
+        reference = &link->front();
+      }
+      if (absl::StatusOr<std::string> uri = GetObjectUri(*reference);
+          uri.ok()) {
+        DLOG(INFO) << "Found an upstream resource at upstream link: "
+                   << upstream_link;
+        upstream_uri = *std::move(uri);
+      }
+    }
+    if (!upstream_uri.has_value()) {
+      DLOG(INFO) << "No upstream connection from cable found";
+      continue;
+    }
 
-        RedfishIterReturnValue retval =
-            callback_function(std::move(cable_json), *upstream_uri);
-        return retval;
-      });
+    // In order to attach cable, we will require a PartLocation to be
+    // present
+    const auto cable_location =
+        (*cable_json)[kRfPropertyLocation][kRfPropertyPartLocation].AsObject();
+    if (!cable_location) {
+      DLOG(INFO) << "Cable has no location information";
+      continue;
+    }
+
+    if (callback_function(*cable_json, *upstream_uri) ==
+        RedfishIterReturnValue::kStop) {
+      return;
+    }
+  }
 }
 
 ResourceConfig GetResourceConfigFromResourceTypeAndVersion(
@@ -126,10 +166,13 @@ ResourceConfig GetResourceConfigFromResourceTypeAndVersion(
 }
 
 // Helper function for finding downstream URIs via Links or first class
-// attributes for a given RedfishObject
+// attributes for a given RedfishObject. Skipped links are followed unless
+// their URI is in 'visited_uri' or 'skipped_uri'; the URIs followed are added
+// to 'skipped_uri'.
 std::vector<std::unique_ptr<RedfishObject>> FindAllDownstreamsUris(
     const RedfishObject &obj, const TopologyConfig &config,
-    absl::flat_hash_set<std::string> &visited_uri) {
+    const absl::flat_hash_set<std::string> &visited_uri,
+    absl::flat_hash_set<std::string> &skipped_uri) {
   std::vector<std::unique_ptr<RedfishObject>> downstream_objs;
 
   ResourceConfig resource_config;
@@ -197,12 +240,12 @@ std::vector<std::unique_ptr<RedfishObject>> FindAllDownstreamsUris(
           DLOG(INFO) << "Found skipped downstream obj at Links."
                      << array_link_skip;
           std::optional<std::string> skip_uri = json->GetUriString();
-          if (!skip_uri.has_value() || visited_uri.contains(*skip_uri)) {
+          if (!skip_uri.has_value() || visited_uri.contains(*skip_uri) ||
+              !skipped_uri.insert(*skip_uri).second) {
             return RedfishIterReturnValue::kContinue;
           }
-          visited_uri.insert(*skip_uri);
           std::vector<std::unique_ptr<RedfishObject>> tmp_next_level_obj =
-              FindAllDownstreamsUris(*json, config, visited_uri);
+              FindAllDownstreamsUris(*json, config, visited_uri, skipped_uri);
           for (std::unique_ptr<RedfishObject> &next_obj : tmp_next_level_obj) {
             downstream_objs.push_back(std::move(next_obj));
           }
@@ -212,9 +255,29 @@ std::vector<std::unique_ptr<RedfishObject>> FindAllDownstreamsUris(
   return downstream_objs;
 }
 
+// Calls 'func' with each index in [0, count), on the threads of 'pool' if it
+// is not null, and returns once every call has returned.
+void ForEachIndex(ThreadPool *pool, size_t count,
+                  absl::FunctionRef<void(size_t)> func) {
+  if (pool == nullptr || count <= 1) {
+    for (size_t i = 0; i < count; ++i) func(i);
+    return;
+  }
+  absl::BlockingCounter pending(static_cast<int>(count));
+  for (size_t i = 0; i < count; ++i) {
+    pool->Schedule([&func, &pending, i]() {
+      func(i);
+      pending.DecrementCount();
+    });
+  }
+  pending.Wait();
+}
+
 // Helper function to find root chassis from service root
 absl::StatusOr<std::unique_ptr<RedfishObject>> FindRootChassisUri(
-    RedfishInterface *redfish_intf, const TopologyConfig &config) {
+    RedfishInterface *redfish_intf, const TopologyConfig &config,
+    absl::Span<const std::unique_ptr<RedfishObject>> cables,
+    ThreadPool *pool) {
   auto chassis = redfish_intf->GetRoot()[kRfPropertyChassis];
   if (!chassis.status().ok()) {
     return chassis.status();
@@ -243,27 +306,39 @@ absl::StatusOr<std::unique_ptr<RedfishObject>> FindRootChassisUri(
   const std::string chassis_link = config.find_root_node().chassis_link();
   DLOG(INFO) << "Using chassis link value: Links." << chassis_link;
 
-  // Iterate through cables to find upstream connections
+  // Iterate through cables to find upstream connections. The downstream
+  // resources of the cables are found concurrently.
+  std::vector<std::pair<const RedfishObject *, std::string>> linked_cables;
+  FindAllCablesHelper(cables, config.cable_linkages(),
+                      [&](const RedfishObject &cable_json,
+                          const std::string &upstream_uri) {
+                        linked_cables.push_back({&cable_json, upstream_uri});
+                        return RedfishIterReturnValue::kContinue;
+                      });
+  std::vector<std::vector<std::unique_ptr<RedfishObject>>> cable_downstreams(
+      linked_cables.size());
+  ForEachIndex(pool, linked_cables.size(), [&](size_t i) {
+    absl::flat_hash_set<std::string> skipped_uri;
+    cable_downstreams[i] =
+        FindAllDownstreamsUris(*linked_cables[i].first, config,
+                               /*visited_uri=*/{}, skipped_uri);
+  });
   absl::flat_hash_map<std::string, std::string>
       cable_downstream_to_upstream_map;
-  FindAllCablesHelper(
-      redfish_intf, config.cable_linkages(),
-      [&](std::unique_ptr<RedfishObject> cable_json,
-          const std::string &upstream_uri) {
-        absl::flat_hash_set<std::string> visited_uri;
-        for (std::unique_ptr<RedfishObject> &downstream_obj :
-             FindAllDownstreamsUris(*cable_json, config, visited_uri)) {
-          if (!downstream_obj) continue;
-          if (std::optional<std::string> downstream_uri =
-                  downstream_obj->GetUriString();
-              downstream_uri.has_value()) {
-            DLOG(INFO) << "Cable between " << *downstream_uri << " and "
-                       << upstream_uri;
-            cable_downstream_to_upstream_map[*downstream_uri] = upstream_uri;
-          }
-        }
-        return RedfishIterReturnValue::kContinue;
-      });
+  for (size_t i = 0; i < linked_cables.size(); ++i) {
+    const std::string &upstream_uri = linked_cables[i].second;
+    for (std::unique_ptr<RedfishObject> &downstream_obj :
+         cable_downstreams[i]) {
+      if (!downstream_obj) continue;
+      if (std::optional<std::string> downstream_uri =
+              downstream_obj->GetUriString();
+          downstream_uri.has_value()) {
+        DLOG(INFO) << "Cable between " << *downstream_uri << " and "
+                   << upstream_uri;
+        cable_downstream_to_upstream_map[*downstream_uri] = upstream_uri;
+      }
+    }
+  }
 
   DLOG(INFO) << "Checking for upstream Chassis obj for " << *chassis_uri;
   std::unique_ptr<RedfishObject> upstream_chassis_obj =
@@ -306,33 +381,39 @@ absl::StatusOr<std::unique_ptr<RedfishObject>> FindRootChassisUri(
 }
 
 absl::StatusOr<std::unique_ptr<RedfishObject>> FindRootNode(
-    RedfishInterface *redfish_intf, const TopologyConfig &config) {
+    RedfishInterface *redfish_intf, const TopologyConfig &config,
+    absl::Span<const std::unique_ptr<RedfishObject>> cables,
+    ThreadPool *pool) {
   const auto &finding_root = config.find_root_node();
   if (finding_root.has_chassis_link()) {
     DLOG(INFO) << "Finding root chassis";
-    return FindRootChassisUri(redfish_intf, config);
+    return FindRootChassisUri(redfish_intf, config, cables, pool);
   }
   return absl::InternalError("finding_root.has_chassis_link was false.");
 }
 
-using UriToAttachedCableUris =
-    absl::flat_hash_map<std::string, std::vector<std::string>>;
+// Maps the URI of a resource to the index of each cable attached to it in the
+// fetched cables.
+using UriToAttachedCables =
+    absl::flat_hash_map<std::string, std::vector<size_t>>;
 
-UriToAttachedCableUris GetUpstreamUriToAttachedCableMap(
-    RedfishInterface *redfish_intf,
+UriToAttachedCables GetUpstreamUriToAttachedCableMap(
+    absl::Span<const std::unique_ptr<RedfishObject>> cables,
     const TopologyConfig::CableLinkages &cable_linkages) {
-  UriToAttachedCableUris uri_to_cable_uri;
+  absl::flat_hash_map<const RedfishObject *, size_t> cable_indices;
+  for (size_t i = 0; i < cables.size(); ++i) {
+    cable_indices[cables[i].get()] = i;
+  }
+  UriToAttachedCables uri_to_cables;
   FindAllCablesHelper(
-      redfish_intf, cable_linkages,
-      [&](std::unique_ptr<RedfishObject> cable_json,
-          const std::string &upstream_uri) {
-        if (auto uri = cable_json->GetUriString(); uri.has_value()) {
-          DLOG(INFO) << "Mapping " << upstream_uri << " to cable " << *uri;
-          uri_to_cable_uri[upstream_uri].push_back(*std::move(uri));
-        }
+      cables, cable_linkages,
+      [&](const RedfishObject &cable_json, const std::string &upstream_uri) {
+        DLOG(INFO) << "Mapping " << upstream_uri << " to cable "
+                   << cable_json.GetUriString().value_or("<unknown URI>");
+        uri_to_cables[upstream_uri].push_back(cable_indices.at(&cable_json));
         return RedfishIterReturnValue::kContinue;
       });
-  return uri_to_cable_uri;
+  return uri_to_cables;
 }
 
 struct AttachingNodes {
@@ -340,6 +421,76 @@ struct AttachingNodes {
   std::unique_ptr<RedfishObject> obj;
 };
 
+// A resource attached to the topology whose downstream resources are to be
+// found.
+struct AttachedNode {
+  Node *node;
+  std::unique_ptr<RedfishObject> obj;
+  std::string uri;
+  // Downstream resources of 'obj' and the URIs of the skipped resources
+  // searched for them.
+  std::vector<std::unique_ptr<RedfishObject>> downstream_objs;
+  absl::flat_hash_set<std::string> skipped_uris;
+};
+
+// Queues the downstream resources and cables of 'attached_nodes', the
+// resources of one level of the traversal, in order. The links of the
+// resources are resolved concurrently on 'pool' if it is not null.
+void QueueDownstreams(const TopologyConfig &config, ThreadPool *pool,
+                      std::vector<AttachedNode> &attached_nodes,
+                      const UriToAttachedCables &cable_map,
+                      std::vector<std::unique_ptr<RedfishObject>> &cables,
+                      absl::flat_hash_set<std::string> &visited_uris,
+                      std::queue<AttachingNodes> &queue) {
+  DLOG(INFO) << "Finding Downstream Nodes";
+  ForEachIndex(pool, attached_nodes.size(), [&](size_t i) {
+    AttachedNode &attached = attached_nodes[i];
+    attached.downstream_objs = FindAllDownstreamsUris(
+        *attached.obj, config, visited_uris, attached.skipped_uris);
+  });
+
+  for (AttachedNode &attached : attached_nodes) {
+    // A skipped resource searched concurrently may since have been visited by
+    // a preceding resource of the level; search again in order then.
+    for (const std::string &skipped_uri : attached.skipped_uris) {
+      if (!visited_uris.contains(skipped_uri)) continue;
+      attached.skipped_uris.clear();
+      attached.downstream_objs = FindAllDownstreamsUris(
+          *attached.obj, config, visited_uris, attached.skipped_uris);
+      break;
+    }
+    visited_uris.insert(attached.skipped_uris.begin(),
+                        attached.skipped_uris.end());
+
+    // For every downstream uri from Resource add it to the queue
+    for (std::unique_ptr<RedfishObject> &downstream_obj :
+         attached.downstream_objs) {
+      if (downstream_obj == nullptr) continue;
+      std::optional<std::string> uri = downstream_obj->GetUriString();
+      if (!uri.has_value() || visited_uris.contains(*uri)) continue;
+      visited_uris.insert(*uri);
+      queue.push({.parent = attached.node, .obj = std::move(downstream_obj)});
+    }
+
+    // Adding any downstream cables
+    if (const auto it = cable_map.find(attached.uri); it != cable_map.end()) {
+      DLOG(INFO) << "Found downstream cables";
+      for (size_t cable_index : it->second) {
+        std::unique_ptr<RedfishObject> &cable_obj = cables[cable_index];
+        if (cable_obj == nullptr) continue;
+        std::optional<std::string> cable_uri = cable_obj->GetUriString();
+        DLOG(INFO) << "Cable URI: " << cable_uri.value_or("<unknown URI>");
+        if (!cable_uri.has_value() || cable_uri->empty() ||
+            visited_uris.contains(*cable_uri)) {
+          continue;
+        }
+        visited_uris.insert(*cable_uri);
+        queue.push({.parent = attached.node, .obj = std::move(cable_obj)});
+      }
+    }
+  }
+}
+
 constexpr absl::string_view kRootDevpath = "/phys";
 constexpr absl::string_view kLocationTypeEmbedded = "Embedded";
 constexpr absl::string_view kLocationTypeSlot = "Slot";
@@ -350,11 +501,28 @@ constexpr absl::string_view kLocationTypeSocket = "Socket";
 
 }  // namespace
 NodeTopology CreateTopologyFromRedfishV2(RedfishInterface *redfish_intf) {
-  return CreateTopologyFromRedfishV2(redfish_intf, kDefaultTopologyConfigName);
+  return CreateTopologyFromRedfishV2(redfish_intf,
+                                     kDefaultTopologyV2ConfigName);
 }
 NodeTopology CreateTopologyFromRedfishV2(RedfishInterface *redfish_intf,
                                          absl::string_view config_name) {
+  return CreateTopologyFromRedfishV2(redfish_intf, config_name,
+                                     kDefaultMaxConcurrentTopologyFetches);
+}
+NodeTopology CreateTopologyFromRedfishV2(RedfishInterface *redfish_intf,
+                                         absl::string_view config_name,
+                                         size_t max_concurrent_fetches,
+                                         TopologyV2Metrics *metrics) {
   NodeTopology topology;
+  TopologyV2Metrics local_metrics;
+  if (metrics == nullptr) metrics = &local_metrics;
+  *metrics = TopologyV2Metrics();
+  // Resolves links concurrently; sequential if only one fetch is allowed.
+  std::unique_ptr<ThreadPool> pool;
+  if (max_concurrent_fetches > 1) {
+    pool = std::make_unique<ThreadPool>(
+        static_cast<int>(max_concurrent_fetches));
+  }
 
   DLOG(INFO) << "Loading topology config: " << config_name;
   std::optional<TopologyConfig> config = LoadTopologyConfigFromConfigName(
@@ -363,9 +531,19 @@ NodeTopology CreateTopologyFromRedfishV2(RedfishInterface *redfish_intf,
     LOG(FATAL) << "No valid config found with name: " << config_name;
   }
 
+  // Cables are fetched once for both the root node search and the cable map.
+  absl::Time phase_start = absl::Now();
+  std::vector<std::unique_ptr<RedfishObject>> cables =
+      FetchCables(redfish_intf, /*prefetch=*/pool != nullptr);
+  metrics->cables = cables.size();
+  metrics->cable_fetch_time = absl::Now() - phase_start;
+
   // Find root chassis to build from using config find root chassis
   DLOG(INFO) << "Starting root node search";
-  auto maybe_root_node_uri = FindRootNode(redfish_intf, *config);
+  phase_start = absl::Now();
+  auto maybe_root_node_uri =
+      FindRootNode(redfish_intf, *config, cables, pool.get());
+  metrics->root_search_time = absl::Now() - phase_start;
   if (!maybe_root_node_uri.ok()) {
     LOG(ERROR) << "No root node found for devpath generation, status: "
                << maybe_root_node_uri.status();
@@ -379,14 +557,27 @@ NodeTopology CreateTopologyFromRedfishV2(RedfishInterface *redfish_intf,
   }
   // Iterate through all Cables if available
   DLOG(INFO) << "Creating cable map for upstream and downstream links";
-  UriToAttachedCableUris cable_map =
-      GetUpstreamUriToAttachedCableMap(redfish_intf, config->cable_linkages());
+  UriToAttachedCables cable_map =
+      GetUpstreamUriToAttachedCableMap(cables, config->cable_linkages());
   DLOG(INFO) << "Cable map completed";
-  // Create queue of one item with no parent
+
+  // Traverse the resources breadth-first. Nodes are created in order; once
+  // the resources of a level are attached, their links are resolved together
+  // and the downstream resources queued in order for the next level.
+  phase_start = absl::Now();
   std::queue<AttachingNodes> queue;
   queue.push({.parent = nullptr, .obj = std::move(*maybe_root_node_uri)});
   absl::flat_hash_set<std::string> visited_uris;
-  while (!queue.empty()) {
+  // Resources of the current level attached to the topology.
+  std::vector<AttachedNode> attached_nodes;
+  while (!queue.empty() || !attached_nodes.empty()) {
+    if (queue.empty()) {
+      ++metrics->traversal_levels;
+      QueueDownstreams(*config, pool.get(), attached_nodes, cable_map, cables,
+                       visited_uris, queue);
+      attached_nodes.clear();
+      continue;
+    }
     AttachingNodes node_to_attach = std::move(queue.front());
     queue.pop();
 
@@ -571,33 +762,12 @@ NodeTopology CreateTopologyFromRedfishV2(RedfishInterface *redfish_intf,
       topology.nodes.push_back(std::move(node));
     }
 
-    DLOG(INFO) << "Finding Downstream Nodes";
-    // For every downstream uri from Resource add it to the queue
-    std::vector<std::unique_ptr<RedfishObject>> downstream_objs =
-        FindAllDownstreamsUris(*node_to_attach.obj, *config, visited_uris);
-    for (int i = 0; i < downstream_objs.size(); ++i) {
-      if (downstream_objs[i] == nullptr) continue;
-      std::optional<std::string> uri = downstream_objs[i]->GetUriString();
-      if (!uri.has_value() || visited_uris.contains(*uri)) continue;
-      visited_uris.insert(*uri);
-      queue.push(
-          {.parent = current_node_ptr, .obj = std::move(downstream_objs[i])});
-    }
-
-    // Adding any downstream cables
-    if (const auto it = cable_map.find(*current_uri); it != cable_map.end()) {
-      DLOG(INFO) << "Found downstream cables";
-      for (const auto &cable_uri : it->second) {
-        DLOG(INFO) << "Cable URI: " << cable_uri;
-        std::unique_ptr<RedfishObject> cable_obj =
-            redfish_intf->CachedGetUri(cable_uri).AsObject();
-        if (!cable_obj || cable_uri.empty() || visited_uris.contains(cable_uri))
-          continue;
-        visited_uris.insert(cable_uri);
-        queue.push({.parent = current_node_ptr, .obj = std::move(cable_obj)});
-      }
-    }
+    attached_nodes.push_back({.node = current_node_ptr,
+                              .obj = std::move(node_to_attach.obj),
+                              .uri = *std::move(current_uri)});
   }
+  metrics->traversal_time = absl::Now() - phase_start;
+  metrics->nodes = topology.nodes.size();
 
   return topology;
 }
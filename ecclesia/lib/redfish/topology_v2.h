@@ -17,18 +17,52 @@
 #ifndef ECCLESIA_LIB_REDFISH_TOPOLOGY_V2_H_
 #define ECCLESIA_LIB_REDFISH_TOPOLOGY_V2_H_
 
+#include <cstddef>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "ecclesia/lib/redfish/interface.h"
 #include "ecclesia/lib/redfish/node_topology.h"
 
 namespace ecclesia {
 
+// Name of the topology config used when none is given.
+inline constexpr absl::string_view kDefaultTopologyV2ConfigName =
+    "redfish_2021_1.textpb";
+
+// Statistics on the phases of creating a NodeTopology with
+// CreateTopologyFromRedfishV2.
+struct TopologyV2Metrics {
+  // Time spent fetching the Cables collection and its members.
+  absl::Duration cable_fetch_time;
+  // Time spent finding the root node.
+  absl::Duration root_search_time;
+  // Time spent traversing the resources linked from the root node.
+  absl::Duration traversal_time;
+  // Number of cables fetched.
+  size_t cables = 0;
+  // Number of levels of resources traversed breadth-first.
+  size_t traversal_levels = 0;
+  // Number of nodes in the created topology.
+  size_t nodes = 0;
+};
+
 // Function to create NodeTopology based on go/redfish-devpath2 design
 //
 // This function will find a root node and uses the redfish linkages to find
-// nodes and assign devpaths based on the Location.PartLocation attribute
+// nodes and assign devpaths based on the Location.PartLocation attribute. The
+// links of up to kDefaultMaxConcurrentTopologyFetches resources are resolved at
+// once.
 NodeTopology CreateTopologyFromRedfishV2(RedfishInterface *redfish_intf);
 NodeTopology CreateTopologyFromRedfishV2(RedfishInterface *redfish_intf,
                                          absl::string_view config_name);
+// As above, resolving the links of up to max_concurrent_fetches resources at
+// once. The resulting topology does not depend on the concurrency. If
+// 'metrics' is provided, it is populated with statistics on the phases.
+NodeTopology CreateTopologyFromRedfishV2(RedfishInterface *redfish_intf,
+                                         absl::string_view config_name,
+                                         size_t max_concurrent_fetches,
+                                         TopologyV2Metrics *metrics = nullptr);
 
 // Function to create NodeTopology based on go/redfish-devpath2 design
 //
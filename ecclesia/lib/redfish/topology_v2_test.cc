@@ -92,6 +92,19 @@ TEST(TopologyTestRunner, TestingMockupNodesArePopulated) {
       CreateTopologyFromRedfishV2(raw_intf.get()));
 }
 
+TEST(TopologyTestRunner, TestingMockupNodesArePopulatedConcurrently) {
+  TestingMockupServer mockup("topology_v2_testing/mockup.shar");
+  auto raw_intf = mockup.RedfishClientInterface();
+  TopologyV2Metrics metrics;
+  NodeTopology topology = CreateTopologyFromRedfishV2(
+      raw_intf.get(), kDefaultTopologyV2ConfigName,
+      /*max_concurrent_fetches=*/4, &metrics);
+  CheckAgainstTestingMockupFullDevpaths(topology);
+  EXPECT_EQ(metrics.nodes, topology.nodes.size());
+  EXPECT_GT(metrics.cables, 0);
+  EXPECT_GT(metrics.traversal_levels, 0);
+}
+
 TEST(TopologyTestRunner, TestingMockupFindingRootChassis) {
   FakeRedfishServer mockup("topology_v2_testing/mockup.shar");
   auto raw_intf = mockup.RedfishClientInterface();
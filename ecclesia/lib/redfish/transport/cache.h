@@ -243,7 +243,7 @@ class TimeBasedCache : public RedfishCachedGetterInterface {
       absl::Time update_time = absl::InfinitePast();
       if (result.ok() &&
           (post_payload_.has_value() ||
-           std::holds_alternative<nlohmann::json>(result->body))) {
+           result->HasJsonBody())) {
         update_time = clock_->Now();
       }
 
@@ -36,6 +36,7 @@
 #include "ecclesia/lib/redfish/interface.h"
 #include "ecclesia/lib/redfish/property_definitions.h"
 #include "ecclesia/lib/redfish/transport/interface.h"
+#include "ecclesia/lib/redfish/transport/lazy_json.h"
 #include "ecclesia/lib/redfish/utils.h"
 #include "ecclesia/lib/status/macros.h"
 #include "single_include/nlohmann/json.hpp"
@@ -56,7 +57,8 @@ constexpr absl::string_view kLocation = "Location";
 template <typename RestOp>
 absl::StatusOr<RedfishTransport::Result> RestHelper(
     std::unique_ptr<HttpClient::HttpRequest> request, RestOp rest_func,
-    const HttpHeaderCondition &header_for_json) {
+    const HttpHeaderCondition &header_for_json,
+    JsonBodyParsing json_body_parsing) {
   ECCLESIA_ASSIGN_OR_RETURN(HttpClient::HttpResponse resp,
                             rest_func(std::move(request)));
   RedfishTransport::Result result;
@@ -68,7 +70,11 @@ absl::StatusOr<RedfishTransport::Result> RestHelper(
   auto header_iter = result.headers.find(header_for_json.header_key);
   if (header_iter != result.headers.end() &&
       header_for_json.matched_values.contains(header_iter->second)) {
-    result.body = resp.GetBodyJson();
+    if (json_body_parsing == JsonBodyParsing::kLazy) {
+      result.body = LazyJson(std::move(resp.body));
+    } else {
+      result.body = resp.GetBodyJson();
+    }
   } else {
     result.body = GetBytesFromString(resp.body);
   }
@@ -135,12 +141,12 @@ absl::Status HttpRedfishTransport::LockedDoSessionAuth() {
     return absl::OkStatus();
   }
   ECCLESIA_ASSIGN_OR_RETURN(Result root, LockedGet(GetRootUri()));
-  if (!std::holds_alternative<nlohmann::json>(root.body)) {
+  const nlohmann::json *root_json = root.GetJsonBody();
+  if (root_json == nullptr) {
     return absl::InternalError("Result from the root URI is not JSON");
   }
-  ECCLESIA_ASSIGN_OR_RETURN(
-      std::string post_uri,
-      GetSessionServicePostTarget(std::get<nlohmann::json>(root.body)));
+  ECCLESIA_ASSIGN_OR_RETURN(std::string post_uri,
+                            GetSessionServicePostTarget(*root_json));
 
   nlohmann::json session_post_payload;
   session_post_payload[PropertyUserName::Name] = session_username_;
@@ -191,25 +197,26 @@ std::unique_ptr<HttpClient::HttpRequest> HttpRedfishTransport::MakeRequest(
 HttpRedfishTransport::HttpRedfishTransport(
     std::unique_ptr<HttpClient> client,
     std::variant<TcpTarget, UdsTarget> target,
-    HttpHeaderCondition header_for_json)
+    HttpHeaderCondition header_for_json, JsonBodyParsing json_body_parsing)
     : client_(std::move(client)),
       target_(std::move(target)),
-      header_for_json_payload_(std::move(header_for_json)) {}
+      header_for_json_payload_(std::move(header_for_json)),
+      json_body_parsing_(json_body_parsing) {}
 
 std::unique_ptr<HttpRedfishTransport> HttpRedfishTransport::MakeNetwork(
     std::unique_ptr<HttpClient> client, std::string endpoint,
-    HttpHeaderCondition header_for_json) {
+    HttpHeaderCondition header_for_json, JsonBodyParsing json_body_parsing) {
   return absl::WrapUnique(new HttpRedfishTransport(
       std::move(client), TcpTarget{std::move(endpoint)},
-      std::move(header_for_json)));
+      std::move(header_for_json), json_body_parsing));
 }
 
 std::unique_ptr<HttpRedfishTransport> HttpRedfishTransport::MakeUds(
     std::unique_ptr<HttpClient> client, std::string unix_domain_socket,
-    HttpHeaderCondition header_for_json) {
+    HttpHeaderCondition header_for_json, JsonBodyParsing json_body_parsing) {
   return absl::WrapUnique(new HttpRedfishTransport(
       std::move(client), UdsTarget{std::string(std::move(unix_domain_socket))},
-      std::move(header_for_json)));
+      std::move(header_for_json), json_body_parsing));
 }
 
 absl::string_view HttpRedfishTransport::GetRootUri() {
@@ -218,7 +225,9 @@ absl::string_view HttpRedfishTransport::GetRootUri() {
 
 absl::StatusOr<RedfishTransport::Result> HttpRedfishTransport::Get(
     absl::string_view path) {
-  absl::MutexLock mu(&mutex_);
+  // GETs only read the transport state and the HTTP client issues each
+  // request on its own handle, so they may be issued concurrently.
+  absl::ReaderMutexLock mu(&mutex_);
   return LockedGet(path);
 }
 
@@ -228,7 +237,7 @@ absl::StatusOr<RedfishTransport::Result> HttpRedfishTransport::LockedGet(
                                    mutex_) { return MakeRequest(t, path, ""); },
                                target_),
                     absl::bind_front(&HttpClient::Get, client_.get()),
-                    header_for_json_payload_);
+                    header_for_json_payload_, json_body_parsing_);
 }
 
 absl::StatusOr<RedfishTransport::Result> HttpRedfishTransport::Post(
@@ -244,7 +253,7 @@ absl::StatusOr<RedfishTransport::Result> HttpRedfishTransport::LockedPost(
                      mutex_) { return MakeRequest(t, path, data); },
                  target_),
       absl::bind_front(&HttpClient::Post, client_.get()),
-      header_for_json_payload_);
+      header_for_json_payload_, json_body_parsing_);
 }
 
 absl::StatusOr<RedfishTransport::Result> HttpRedfishTransport::Patch(
@@ -260,7 +269,7 @@ absl::StatusOr<RedfishTransport::Result> HttpRedfishTransport::LockedPatch(
                      mutex_) { return MakeRequest(t, path, data); },
                  target_),
       absl::bind_front(&HttpClient::Patch, client_.get()),
-      header_for_json_payload_);
+      header_for_json_payload_, json_body_parsing_);
 }
 
 absl::StatusOr<RedfishTransport::Result> HttpRedfishTransport::Delete(
@@ -276,7 +285,7 @@ absl::StatusOr<RedfishTransport::Result> HttpRedfishTransport::LockedDelete(
                      mutex_) { return MakeRequest(t, path, data); },
                  target_),
       absl::bind_front(&HttpClient::Delete, client_.get()),
-      header_for_json_payload_);
+      header_for_json_payload_, json_body_parsing_);
 }
 
 }  // namespace ecclesia
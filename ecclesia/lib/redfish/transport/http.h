@@ -48,6 +48,15 @@ inline HttpHeaderCondition DefaultHttpHeaderConditionForJson() {
   return HttpHeaderCondition{"Content-Type", {"application/json"}};
 }
 
+// How JSON payloads are represented in the body of a result.
+enum class JsonBodyParsing {
+  // The payload is parsed into an nlohmann::json.
+  kEager,
+  // The payload is held as a LazyJson, which parses only the properties that
+  // are read.
+  kLazy,
+};
+
 // HttpRedfishTransport implements RedfishTransport with an HttpClient.
 class HttpRedfishTransport : public RedfishTransport {
  public:
@@ -57,16 +66,16 @@ class HttpRedfishTransport : public RedfishTransport {
   //   tcp_endpoint: e.g. "localhost:80", "https://10.0.0.1", "[::1]:8000"
   static std::unique_ptr<HttpRedfishTransport> MakeNetwork(
       std::unique_ptr<HttpClient> client, std::string tcp_endpoint,
-      HttpHeaderCondition header_for_json =
-          DefaultHttpHeaderConditionForJson());
+      HttpHeaderCondition header_for_json = DefaultHttpHeaderConditionForJson(),
+      JsonBodyParsing json_body_parsing = JsonBodyParsing::kEager);
   // Creates an HttpRedfishTransport using a unix domain socket endpoint.
   // Params:
   //   client: HttpClient instance
   //   unix_domain_socket: e.g. "/var/run/my.socket"
   static std::unique_ptr<HttpRedfishTransport> MakeUds(
       std::unique_ptr<HttpClient> client, std::string unix_domain_socket,
-      HttpHeaderCondition header_for_json =
-          DefaultHttpHeaderConditionForJson());
+      HttpHeaderCondition header_for_json = DefaultHttpHeaderConditionForJson(),
+      JsonBodyParsing json_body_parsing = JsonBodyParsing::kEager);
   // Performs the Redfish Session Login Authorization procedure, as documented
   // in the Redfish Spec (DSP0266 Redfish Specification v1.14.0 Section 13.3.4:
   // Redfish session login authentication).
@@ -124,7 +133,8 @@ class HttpRedfishTransport : public RedfishTransport {
   // internal target structs in the public interface.
   HttpRedfishTransport(std::unique_ptr<HttpClient> client,
                        std::variant<TcpTarget, UdsTarget> target,
-                       HttpHeaderCondition header_for_json);
+                       HttpHeaderCondition header_for_json,
+                       JsonBodyParsing json_body_parsing);
 
   // Helper function for creating a HTTP request, overloaded on the target type.
   std::unique_ptr<HttpClient::HttpRequest> MakeRequest(TcpTarget target,
@@ -153,6 +163,7 @@ class HttpRedfishTransport : public RedfishTransport {
   // i.e., If there's such header and the header value matches any of the values
   // in the condition, the payload is set to JSON.
   const HttpHeaderCondition header_for_json_payload_;
+  const JsonBodyParsing json_body_parsing_;
 };
 
 }  // namespace ecclesia
@@ -16,6 +16,7 @@
 
 #include "ecclesia/lib/redfish/transport/http_redfish_intf.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
@@ -29,6 +30,7 @@
 #include <vector>
 
 #include "absl/base/thread_annotations.h"
+#include "absl/container/btree_map.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/functional/function_ref.h"
 #include "absl/log/log.h"
@@ -39,6 +41,7 @@
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "ecclesia/lib/http/codes.h"
@@ -47,7 +50,9 @@
 #include "ecclesia/lib/redfish/property_definitions.h"
 #include "ecclesia/lib/redfish/transport/cache.h"
 #include "ecclesia/lib/redfish/transport/interface.h"
+#include "ecclesia/lib/redfish/transport/lazy_json.h"
 #include "ecclesia/lib/redfish/utils.h"
+#include "ecclesia/lib/thread/thread_pool.h"
 #include "single_include/nlohmann/json.hpp"
 
 namespace ecclesia {
@@ -127,35 +132,57 @@ nlohmann::json KvSpanToJson(
   return json;
 }
 
+// Maximum number of collection members resolved concurrently ahead of their
+// access in the kPrefetchMembers iterable mode.
+constexpr size_t kMaxMemberPrefetches = 8;
+
+// Collection members requested with the $skip and $top query parameters.
+struct MemberWindow {
+  size_t skip = 0;
+  std::optional<size_t> top;
+};
+
+// Returns 'task' wrapped by the transport of 'intf' to issue its requests as
+// if from the calling thread. The variants, objects and iterables below are
+// only created by HttpRedfishInterface.
+std::function<void()> BindToCallingThread(RedfishInterface *intf,
+                                          std::function<void()> task);
+
 class HttpIntfVariantImpl : public RedfishVariant::ImplIntf {
  public:
   HttpIntfVariantImpl(RedfishInterface *intf, RedfishExtendedPath path,
                       ecclesia::RedfishTransport::Result result,
-                      CacheState cache_state)
+                      CacheState cache_state, MemberWindow member_window = {})
       : intf_(intf),
         path_(std::move(path)),
         result_(std::move(result)),
-        cache_state_(cache_state) {}
+        cache_state_(cache_state),
+        member_window_(member_window) {}
   std::unique_ptr<RedfishObject> AsObject() const override;
   std::unique_ptr<RedfishIterable> AsIterable(
       RedfishVariant::IterableMode mode,
       GetParams::Freshness freshness) const override;
+  std::unique_ptr<RedfishIterable> AsIterableWithParams(
+      RedfishVariant::IterableMode mode,
+      const GetParams &member_params) const override;
   std::optional<RedfishTransport::bytes> AsRaw() const override;
 
   bool GetValue(std::string *val) const override {
-    if (!std::holds_alternative<nlohmann::json>(result_.body)) {
+    const nlohmann::json *json_body = result_.GetJsonBody();
+    if (json_body == nullptr) {
       return false;
     }
-    const auto &json = std::get<nlohmann::json>(result_.body);
+    const auto &json = *json_body;
     if (!json.is_string()) return false;
     *val = json.get<std::string>();
     return true;
   }
   bool GetValue(int32_t *val) const override {
-    if (!std::holds_alternative<nlohmann::json>(result_.body)) {
+    const nlohmann::json *json_body = result_.GetJsonBody();
+    if (json_body == nullptr) {
       return false;
     }
-    const auto &json = std::get<nlohmann::json>(result_.body);
+    const auto &json = *json_body;
     if (json.is_number_integer()) {
       *val = json.get<int32_t>();
       return true;
@@ -174,10 +201,11 @@ class HttpIntfVariantImpl : public RedfishVariant::ImplIntf {
     return false;
   }
   bool GetValue(int64_t *val) const override {
-    if (!std::holds_alternative<nlohmann::json>(result_.body)) {
+    const nlohmann::json *json_body = result_.GetJsonBody();
+    if (json_body == nullptr) {
       return false;
     }
-    const auto &json = std::get<nlohmann::json>(result_.body);
+    const auto &json = *json_body;
     if (json.is_number_integer()) {
       *val = json.get<int64_t>();
       return true;
@@ -196,19 +224,21 @@ class HttpIntfVariantImpl : public RedfishVariant::ImplIntf {
     return false;
   }
   bool GetValue(double *val) const override {
-    if (!std::holds_alternative<nlohmann::json>(result_.body)) {
+    const nlohmann::json *json_body = result_.GetJsonBody();
+    if (json_body == nullptr) {
       return false;
     }
-    const auto &json = std::get<nlohmann::json>(result_.body);
+    const auto &json = *json_body;
     if (!json.is_number()) return false;
     *val = json.get<double>();
     return true;
   }
   bool GetValue(bool *val) const override {
-    if (!std::holds_alternative<nlohmann::json>(result_.body)) {
+    const nlohmann::json *json_body = result_.GetJsonBody();
+    if (json_body == nullptr) {
       return false;
     }
-    const auto &json = std::get<nlohmann::json>(result_.body);
+    const auto &json = *json_body;
     if (!json.is_boolean()) return false;
     *val = json.get<bool>();
     return true;
@@ -221,8 +251,8 @@ class HttpIntfVariantImpl : public RedfishVariant::ImplIntf {
     return absl::ParseTime("%Y-%m-%dT%H:%M:%S%Z", dt_string, val, nullptr);
   }
   std::string DebugString() const override {
-    if (std::holds_alternative<nlohmann::json>(result_.body)) {
-      return std::get<nlohmann::json>(result_.body).dump(1);
+    if (const nlohmann::json *json = result_.GetJsonBody(); json != nullptr) {
+      return json->dump(1);
     }
     return RedfishTransportBytesToString(
         std::get<RedfishTransport::bytes>(result_.body));
@@ -237,6 +267,7 @@ class HttpIntfVariantImpl : public RedfishVariant::ImplIntf {
   RedfishExtendedPath path_;
   ecclesia::RedfishTransport::Result result_;
   CacheState cache_state_;
+  MemberWindow member_window_;
 };
 
 // Helper function for automatically fetching an @odata.id reference using
@@ -303,17 +334,16 @@ class HttpIntfObjectImpl : public RedfishObject {
 
   RedfishVariant Get(const std::string &node_name,
                      GetParams params) const override {
-    if (!std::holds_alternative<nlohmann::json>(result_.body)) {
+    if (!result_.HasJsonBody()) {
       return RedfishVariant(
           absl::InternalError("Result body is not holding JSON"));
     }
-    const auto &json = std::get<nlohmann::json>(result_.body);
     // Update path with a new node name
     RedfishExtendedPath new_path = path_;
     new_path.properties.push_back(node_name);
 
-    auto itr = json.find(node_name);
-    if (itr == json.end()) {
+    std::optional<nlohmann::json> node = FindProperty(node_name);
+    if (!node.has_value()) {
       return RedfishVariant(std::make_unique<HttpIntfVariantImpl>(
                                 intf_, std::move(new_path),
                                 ecclesia::RedfishTransport::Result{
@@ -332,31 +362,54 @@ class HttpIntfObjectImpl : public RedfishObject {
              .ok()) {
       params.expand.reset();
     }
-    return ResolveReference(result_.code, itr.value(), result_.headers, intf_,
-                            std::move(new_path), cache_state_,
+    // Reset filters if requested but not available
+    if (params.filter.has_value() &&
+        !params.filter.value()
+             .ValidateRedfishSupport(intf_->SupportedFeatures())
+             .ok()) {
+      params.filter.reset();
+    }
+    // Reset selects if requested but not available
+    if (params.select.has_value() &&
+        !params.select.value()
+             .ValidateRedfishSupport(intf_->SupportedFeatures())
+             .ok()) {
+      params.select.reset();
+    }
+    // Reset paging if requested but not available
+    if (params.top.has_value() &&
+        !params.top.value()
+             .ValidateRedfishSupport(intf_->SupportedFeatures())
+             .ok()) {
+      params.top.reset();
+    }
+    if (params.skip.has_value() &&
+        !params.skip.value()
+             .ValidateRedfishSupport(intf_->SupportedFeatures())
+             .ok()) {
+      params.skip.reset();
+    }
+    return ResolveReference(result_.code, *std::move(node), result_.headers,
+                            intf_, std::move(new_path), cache_state_,
                             std::move(params));
   }
 
   std::optional<std::string> GetUriString() const override {
-    if (!std::holds_alternative<nlohmann::json>(result_.body)) {
-      return std::nullopt;
-    }
-    const auto &json = std::get<nlohmann::json>(result_.body);
-    auto itr = json.find(PropertyOdataId::Name);
-    if (itr == json.end()) return std::nullopt;
-    return std::string(itr.value());
+    std::optional<nlohmann::json> odata_id =
+        FindProperty(PropertyOdataId::Name);
+    if (!odata_id.has_value()) return std::nullopt;
+    return std::string(*odata_id);
   }
 
   nlohmann::json GetContentAsJson() const override {
-    if (!std::holds_alternative<nlohmann::json>(result_.body)) {
-      return nlohmann::json::value_t::discarded;
-    }
-    return std::get<nlohmann::json>(result_.body);
+    const nlohmann::json *json = result_.GetJsonBody();
+    if (json == nullptr) return nlohmann::json::value_t::discarded;
+    return *json;
   }
 
   std::string DebugString() const override {
-    if (std::holds_alternative<nlohmann::json>(result_.body)) {
-      return std::get<nlohmann::json>(result_.body).dump(1);
+    if (const nlohmann::json *json = result_.GetJsonBody(); json != nullptr) {
+      return json->dump(1);
     }
     return RedfishTransportBytesToString(
         std::get<RedfishTransport::bytes>(result_.body));
@@ -385,10 +438,11 @@ class HttpIntfObjectImpl : public RedfishObject {
   void ForEachProperty(absl::FunctionRef<RedfishIterReturnValue(
                            absl::string_view, RedfishVariant value)>
                            itr_func) {
-    if (!std::holds_alternative<nlohmann::json>(result_.body)) {
+    const nlohmann::json *json_body = result_.GetJsonBody();
+    if (json_body == nullptr) {
       return;
     }
-    const auto &json = std::get<nlohmann::json>(result_.body);
+    const auto &json = *json_body;
     for (const auto &items : json.items()) {
       RedfishExtendedPath path = path_;
       path.properties.push_back(items.key());
@@ -410,6 +464,19 @@ class HttpIntfObjectImpl : public RedfishObject {
   }
 
  private:
+  // Returns the value of the property 'name'. A lazily parsed body only has
+  // the value of the property parsed.
+  std::optional<nlohmann::json> FindProperty(absl::string_view name) const {
+    if (const auto *lazy = std::get_if<LazyJson>(&result_.body)) {
+      return lazy->Get(name);
+    }
+    const auto *json = std::get_if<nlohmann::json>(&result_.body);
+    if (json == nullptr) return std::nullopt;
+    auto itr = json->find(name);
+    if (itr == json->end()) return std::nullopt;
+    return *itr;
+  }
+
   RedfishInterface *intf_;
   RedfishExtendedPath path_;
   ecclesia::RedfishTransport::Result result_;
@@ -426,13 +493,13 @@ class HttpIntfArrayIterableImpl : public RedfishIterable {
                                      ecclesia::RedfishTransport::Result result,
                                      CacheState cache_state,
                                      RedfishVariant::IterableMode mode,
-                                     GetParams::Freshness freshness)
+                                     GetParams member_params)
       : intf_(intf),
         path_(std::move(path)),
         result_(std::move(result)),
         cache_state_(cache_state),
         mode_(mode),
-        freshness_(freshness) {}
+        member_params_(std::move(member_params)) {}
 
   HttpIntfArrayIterableImpl(const HttpIntfArrayIterableImpl &) = delete;
   HttpIntfObjectImpl &operator=(const HttpIntfArrayIterableImpl &) = delete;
@@ -469,7 +536,7 @@ class HttpIntfArrayIterableImpl : public RedfishIterable {
     }
     return ResolveReference(result_.code, json[index], result_.headers, intf_,
                             std::move(new_path), cache_state_,
-                            GetParams{.freshness = freshness_});
+                            member_params_);
   }
 
  private:
@@ -478,113 +545,442 @@ class HttpIntfArrayIterableImpl : public RedfishIterable {
   ecclesia::RedfishTransport::Result result_;
   CacheState cache_state_;
   RedfishVariant::IterableMode mode_;
-  GetParams::Freshness freshness_;
+  // Parameters of the requests fetching members.
+  GetParams member_params_;
 };
 
 // HttpIntfCollectionIterableImpl implements the RedfishIterable interface
 // with a JSON object representing a Redfish Collection. The Collection object
 // must be verified before constructing this class. Redfish Collection objects
 // must have "Members" field which must be an array.
+//
+// Collections split into pages by the service are followed through their
+// "Members@odata.nextLink" as members are accessed. Besides the first page,
+// only the page being accessed and the page after it are held, the latter
+// being fetched in the background. The second page is fetched in the
+// background once members of the first page are accessed.
+//
+// This class is thread-safe.
 class HttpIntfCollectionIterableImpl : public RedfishIterable {
  public:
   explicit HttpIntfCollectionIterableImpl(
       RedfishInterface *intf, RedfishExtendedPath path,
       ecclesia::RedfishTransport::Result result, CacheState cache_state,
-      RedfishVariant::IterableMode mode, GetParams::Freshness freshness)
+      RedfishVariant::IterableMode mode, GetParams member_params,
+      MemberWindow member_window)
       : intf_(intf),
         path_(std::move(path)),
-        result_(std::move(result)),
         cache_state_(cache_state),
         mode_(mode),
-        freshness_(freshness) {}
+        member_params_(std::move(member_params)),
+        member_window_(member_window),
+        first_page_(MakePage(std::get<nlohmann::json>(std::move(result.body)),
+                             result.code, std::move(result.headers))) {
+    if (first_page_.next_link.has_value()) {
+      page_links_.push_back(
+          {.start = first_page_.members.size(), .uri = *first_page_.next_link});
+    }
+  }
   HttpIntfCollectionIterableImpl(const HttpIntfCollectionIterableImpl &) =
       delete;
   HttpIntfObjectImpl &operator=(const HttpIntfCollectionIterableImpl &) =
       delete;
 
   size_t Size() override {
-    const auto &json = std::get<nlohmann::json>(result_.body);
-    // Return size based on the number of elements in Members array.
-    auto itr = json.find(PropertyMembers::Name);
-    if (itr == json.end() || !itr.value().is_array()) return 0;
-    return itr.value().size();
+    absl::MutexLock lock(&mutex_);
+    return GetSize();
   }
 
+  // Answered from the first page where possible, which unlike Size() does not
+  // walk through the pages of collections without a member count.
   bool Empty() override {
-    const auto &json = std::get<nlohmann::json>(result_.body);
-    // Determine emptiness by checking if Members array is empty.
-    auto itr = json.find(PropertyMembers::Name);
-    if (itr == json.end() || !itr.value().is_array()) return true;
-    return itr.value().empty();
+    if (member_window_.top.has_value() && *member_window_.top == 0) {
+      return true;
+    }
+    if (!first_page_.members.empty()) return false;
+    if (!first_page_.next_link.has_value()) return true;
+    return Size() == 0;
   }
 
   RedfishVariant operator[](int index) const override {
-    const auto &json = std::get<nlohmann::json>(result_.body);
-    // Check the bounds based on the array in the Members property and access
-    // the Members array directly.
-    auto itr = json.find(PropertyMembers::Name);
-    if (itr == json.end() || !itr.value().is_array() ||
-        itr.value().size() <= index) {
-      return RedfishVariant(absl::NotFoundError(
-          absl::StrFormat("Index %d not found for json collection", index)));
+    nlohmann::json member;
+    int code;
+    absl::flat_hash_map<std::string, std::string> headers;
+    {
+      absl::MutexLock lock(&mutex_);
+      if (index >= 0 &&
+          mode_ == RedfishVariant::IterableMode::kPrefetchMembers) {
+        PrefetchMembers(index);
+        if (auto itr = member_fetches_.find(index);
+            itr != member_fetches_.end()) {
+          itr->second->done.WaitForNotification();
+          RedfishVariant fetched = *std::move(itr->second->member);
+          member_fetches_.erase(itr);
+          return fetched;
+        }
+      }
+      const Page *page = nullptr;
+      if (index >= 0 && static_cast<size_t>(index) < GetSize()) {
+        page = FindPage(index);
+      }
+      if (page == nullptr) {
+        if (!page_status_.ok()) return RedfishVariant(page_status_);
+        return RedfishVariant(absl::NotFoundError(
+            absl::StrFormat("Index %d not found for json collection", index)));
+      }
+      member = page->members[index - page->start];
+      code = page->code;
+      headers = page->headers;
     }
     RedfishExtendedPath new_path = path_;
-    auto retval = itr.value()[index];
     new_path.properties.push_back(index);
     if (mode_ == RedfishVariant::IterableMode::kDisableAutoResolve) {
       // Return json object without resolving reference property.
       return RedfishVariant(std::make_unique<HttpIntfVariantImpl>(
                                 intf_, std::move(new_path),
                                 ecclesia::RedfishTransport::Result{
-                                    .code = result_.code,
-                                    .body = retval,
-                                    .headers = result_.headers,
+                                    .code = code,
+                                    .body = std::move(member),
+                                    .headers = headers,
                                 },
                                 cache_state_),
-                            ecclesia::HttpResponseCodeFromInt(result_.code),
-                            result_.headers);
+                            ecclesia::HttpResponseCodeFromInt(code), headers);
     }
-    return ResolveReference(result_.code, itr.value()[index], result_.headers,
-                            intf_, std::move(new_path), cache_state_,
-                            GetParams{.freshness = freshness_});
+    return ResolveReference(code, std::move(member), headers, intf_,
+                            std::move(new_path), cache_state_, member_params_);
   }
 
  private:
+  // Members of one page of the collection.
+  struct Page {
+    // Index of the first member of the page within the collection.
+    size_t start = 0;
+    nlohmann::json members;
+    int code = 0;
+    absl::flat_hash_map<std::string, std::string> headers;
+    // URI of the following page, if any.
+    std::optional<std::string> next_link;
+    // Total number of members reported by the service, if any.
+    std::optional<size_t> members_count;
+  };
+  // Location of a page following the first one.
+  struct PageLink {
+    size_t start;
+    std::string uri;
+  };
+  // Page being fetched in the background.
+  struct Prefetch {
+    size_t link_index;
+    absl::Notification done;
+    absl::StatusOr<Page> page;
+  };
+  // Member being resolved in the background.
+  struct MemberFetch {
+    absl::Notification done;
+    std::optional<RedfishVariant> member;
+  };
+
+  static Page MakePage(nlohmann::json json, int code,
+                       absl::flat_hash_map<std::string, std::string> headers) {
+    Page page{.code = code, .headers = std::move(headers)};
+    if (auto itr = json.find(PropertyMembers::Name);
+        itr != json.end() && itr->is_array()) {
+      page.members = std::move(*itr);
+    } else {
+      page.members = nlohmann::json::array();
+    }
+    if (auto itr = json.find(PropertyMembersNextLink::Name);
+        itr != json.end() && itr->is_string()) {
+      page.next_link = itr->get<std::string>();
+    }
+    if (auto itr = json.find(PropertyMembersCount::Name);
+        itr != json.end() && itr->is_number_unsigned()) {
+      page.members_count = itr->get<size_t>();
+    }
+    return page;
+  }
+
+  size_t GetSize() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    if (!size_.has_value()) size_ = CountMembers();
+    return *size_;
+  }
+
+  // Returns the number of members reachable from the first page, bounded by
+  // the $top requested for the collection.
+  size_t CountMembers() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    size_t count = first_page_.members.size();
+    if (first_page_.next_link.has_value()) {
+      if (first_page_.members_count.has_value() &&
+          *first_page_.members_count >= member_window_.skip) {
+        // The count covers the whole collection, including skipped members.
+        count = std::max(count,
+                         *first_page_.members_count - member_window_.skip);
+      } else {
+        // Without a count, the pages are walked through to count members.
+        size_t end = count;
+        for (size_t link_index = 0; link_index < page_links_.size() &&
+                                    (!member_window_.top.has_value() ||
+                                     end < *member_window_.top);
+             ++link_index) {
+          const Page *page = LoadPage(link_index);
+          if (page == nullptr) break;
+          end = page->start + page->members.size();
+        }
+        count = end;
+      }
+    }
+    if (member_window_.top.has_value()) {
+      count = std::min(count, *member_window_.top);
+    }
+    return count;
+  }
+
+  // Returns the page holding the member at 'index', fetching the pages leading
+  // to it as needed. Returns nullptr if there is no such member or a page
+  // could not be fetched, in which case 'page_status_' holds the error.
+  const Page *FindPage(size_t index) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    if (index < first_page_.members.size()) {
+      if (!current_page_.has_value() && prefetch_ == nullptr) {
+        SchedulePageFetch(0);
+      }
+      return &first_page_;
+    }
+    auto contains = [index](const Page &page) {
+      return index >= page.start && index < page.start + page.members.size();
+    };
+    if (current_page_.has_value() && contains(*current_page_)) {
+      return &*current_page_;
+    }
+    // Resume from the last known page starting at or before 'index'.
+    auto itr = std::upper_bound(
+        page_links_.begin(), page_links_.end(), index,
+        [](size_t index, const PageLink &link) { return index < link.start; });
+    if (itr == page_links_.begin()) return nullptr;
+    for (size_t link_index = itr - page_links_.begin() - 1;
+         link_index < page_links_.size(); ++link_index) {
+      const Page *page = LoadPage(link_index);
+      if (page == nullptr) return nullptr;
+      if (contains(*page)) return page;
+    }
+    return nullptr;
+  }
+
+  // Makes the page at 'link_index' the current page and schedules a fetch of
+  // the page following it.
+  const Page *LoadPage(size_t link_index) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    const PageLink &link = page_links_[link_index];
+    if (current_page_.has_value() && current_link_index_ == link_index) {
+      return &*current_page_;
+    }
+    absl::StatusOr<Page> page;
+    if (prefetch_ != nullptr && prefetch_->link_index == link_index) {
+      prefetch_->done.WaitForNotification();
+      page = std::move(prefetch_->page);
+      prefetch_ = nullptr;
+    } else {
+      page = FetchPage(link.uri);
+    }
+    if (!page.ok()) {
+      page_status_ = page.status();
+      return nullptr;
+    }
+    page->start = link.start;
+    current_page_ = *std::move(page);
+    current_link_index_ = link_index;
+
+    // Stop at pages without members or linking to themselves, which would
+    // otherwise be followed forever.
+    if (link_index + 1 == page_links_.size() &&
+        current_page_->next_link.has_value() &&
+        !current_page_->members.empty() &&
+        *current_page_->next_link != link.uri) {
+      page_links_.push_back(
+          {.start = link.start + current_page_->members.size(),
+           .uri = *current_page_->next_link});
+    }
+    SchedulePageFetch(link_index + 1);
+    return &*current_page_;
+  }
+
+  // Schedules a background fetch of the page at 'link_index', unless there is
+  // no such page within the collection or it is already being fetched.
+  void SchedulePageFetch(size_t link_index) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    if (link_index >= page_links_.size() ||
+        (size_.has_value() && page_links_[link_index].start >= *size_) ||
+        (prefetch_ != nullptr && prefetch_->link_index == link_index)) {
+      return;
+    }
+    if (prefetch_ != nullptr) prefetch_->done.WaitForNotification();
+    prefetch_ = std::make_unique<Prefetch>();
+    prefetch_->link_index = link_index;
+    if (page_fetch_pool_ == nullptr) {
+      page_fetch_pool_ = std::make_unique<ThreadPool>(1);
+    }
+    page_fetch_pool_->Schedule(
+        BindToCallingThread(intf_, [this, prefetch = prefetch_.get(),
+                                    uri = page_links_[link_index].uri]() {
+          prefetch->page = FetchPage(uri);
+          prefetch->done.Notify();
+        }));
+  }
+
+  // Schedules the resolution of the members following 'index', including
+  // it, keeping at most kMaxMemberPrefetches of them in flight.
+  void PrefetchMembers(size_t index) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    // Drop the members skipped over, waiting for their resolution to finish.
+    while (!member_fetches_.empty() && member_fetches_.begin()->first < index) {
+      member_fetches_.begin()->second->done.WaitForNotification();
+      member_fetches_.erase(member_fetches_.begin());
+    }
+    // Members accessed before are resolved again on demand.
+    if (index >= next_member_fetch_) next_member_fetch_ = index;
+    else if (!member_fetches_.contains(index)) return;
+
+    size_t size = GetSize();
+    while (next_member_fetch_ < size &&
+           member_fetches_.size() < kMaxMemberPrefetches) {
+      const Page *page = FindPage(next_member_fetch_);
+      if (page == nullptr) return;
+      if (member_fetch_pool_ == nullptr) {
+        member_fetch_pool_ = std::make_unique<ThreadPool>(static_cast<int>(
+            std::min(size - next_member_fetch_, kMaxMemberPrefetches)));
+      }
+      RedfishExtendedPath new_path = path_;
+      new_path.properties.push_back(static_cast<int>(next_member_fetch_));
+      auto [itr, inserted] = member_fetches_.emplace(
+          next_member_fetch_, std::make_unique<MemberFetch>());
+      member_fetch_pool_->Schedule(BindToCallingThread(
+          intf_, [this, fetch = itr->second.get(),
+                  member = page->members[next_member_fetch_ - page->start],
+                  code = page->code, headers = page->headers,
+                  new_path = std::move(new_path)]() mutable {
+            fetch->member = ResolveReference(code, std::move(member), headers,
+                                             intf_, std::move(new_path),
+                                             cache_state_, member_params_);
+            fetch->done.Notify();
+          }));
+      ++next_member_fetch_;
+    }
+  }
+
+  // Called from the page fetching thread, so this only reads members that do
+  // not change after construction.
+  absl::StatusOr<Page> FetchPage(const std::string &uri) const {
+    GetParams params{.freshness = member_params_.freshness};
+    RedfishVariant variant =
+        params.freshness == GetParams::Freshness::kRequired
+            ? intf_->UncachedGetUri(uri, std::move(params))
+            : intf_->CachedGetUri(uri, std::move(params));
+    if (!variant.status().ok()) return variant.status();
+    std::unique_ptr<RedfishObject> object = variant.AsObject();
+    if (object == nullptr) {
+      return absl::InternalError(
+          absl::StrCat("Collection page ", uri, " is not an object"));
+    }
+    int code = variant.httpcode().has_value()
+                   ? static_cast<int>(*variant.httpcode())
+                   : first_page_.code;
+    return MakePage(object->GetContentAsJson(), code,
+                    variant.httpheaders().value_or(first_page_.headers));
+  }
+
   RedfishInterface *intf_;
   RedfishExtendedPath path_;
-  ecclesia::RedfishTransport::Result result_;
   CacheState cache_state_;
   RedfishVariant::IterableMode mode_;
-  GetParams::Freshness freshness_;
+  // Parameters of the requests fetching members.
+  GetParams member_params_;
+  MemberWindow member_window_;
+  const Page first_page_;
+  // Pages are fetched as members are accessed through the const operator[],
+  // which may be called from several threads.
+  mutable absl::Mutex mutex_;
+  mutable std::optional<size_t> size_ ABSL_GUARDED_BY(mutex_);
+  mutable std::vector<PageLink> page_links_ ABSL_GUARDED_BY(mutex_);
+  mutable std::optional<Page> current_page_ ABSL_GUARDED_BY(mutex_);
+  mutable size_t current_link_index_ ABSL_GUARDED_BY(mutex_) = 0;
+  mutable std::unique_ptr<Prefetch> prefetch_ ABSL_GUARDED_BY(mutex_);
+  mutable absl::Status page_status_ ABSL_GUARDED_BY(mutex_);
+  // Members being resolved ahead of their access, by index.
+  mutable absl::btree_map<size_t, std::unique_ptr<MemberFetch>>
+      member_fetches_ ABSL_GUARDED_BY(mutex_);
+  // Index of the next member to resolve ahead of its access.
+  mutable size_t next_member_fetch_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Declared last so that in-flight fetches finish before the pages and
+  // members they write to are destroyed.
+  mutable std::unique_ptr<ThreadPool> page_fetch_pool_ ABSL_GUARDED_BY(mutex_);
+  mutable std::unique_ptr<ThreadPool> member_fetch_pool_
+      ABSL_GUARDED_BY(mutex_);
 };
 
 std::unique_ptr<RedfishObject> HttpIntfVariantImpl::AsObject() const {
-  if (!std::holds_alternative<nlohmann::json>(result_.body)) {
-    return nullptr;
+  if (const auto *lazy = std::get_if<LazyJson>(&result_.body)) {
+    if (!lazy->IsObject()) return nullptr;
+  } else {
+    const auto *json = std::get_if<nlohmann::json>(&result_.body);
+    if (json == nullptr || !json->is_object()) return nullptr;
   }
-  const auto &json = std::get<nlohmann::json>(result_.body);
-  if (!json.is_object()) return nullptr;
   return std::make_unique<HttpIntfObjectImpl>(intf_, path_, result_,
                                               cache_state_);
 }
 
 std::unique_ptr<RedfishIterable> HttpIntfVariantImpl::AsIterable(
     RedfishVariant::IterableMode mode, GetParams::Freshness freshness) const {
-  if (!std::holds_alternative<nlohmann::json>(result_.body)) {
+  return AsIterableWithParams(mode, GetParams{.freshness = freshness});
+}
+
+std::unique_ptr<RedfishIterable> HttpIntfVariantImpl::AsIterableWithParams(
+    RedfishVariant::IterableMode mode, const GetParams &member_params) const {
+  ecclesia::RedfishTransport::Result result = result_;
+  if (const auto *lazy = std::get_if<LazyJson>(&result_.body)) {
+    if (lazy->IsObject()) {
+      // Only the properties describing the members of a collection are
+      // parsed.
+      nlohmann::json collection = nlohmann::json::object();
+      for (const char *name :
+           {PropertyMembers::Name, PropertyMembersNextLink::Name,
+            PropertyMembersCount::Name}) {
+        if (std::optional<nlohmann::json> value = lazy->Get(name)) {
+          collection[name] = *std::move(value);
+        }
+      }
+      result.body = std::move(collection);
+    } else {
+      result.body = lazy->Parse();
+    }
+  }
+  const auto *json_body = std::get_if<nlohmann::json>(&result.body);
+  if (json_body == nullptr) {
     return nullptr;
   }
-  const auto &json = std::get<nlohmann::json>(result_.body);
+  const auto &json = *json_body;
+  bool is_array = json.is_array();
   bool is_collection_iterable = json.is_object() &&
                                 json.contains(PropertyMembers::Name) &&
                                 json[PropertyMembers::Name].is_array();
-  if (json.is_array()) {
+  // Members are fetched with the freshness requirement and the properties to
+  // select, if supported.
+  GetParams params{.freshness = member_params.freshness,
+                   .select = member_params.select};
+  if (params.select.has_value() &&
+      !params.select->ValidateRedfishSupport(intf_->SupportedFeatures())
+           .ok()) {
+    params.select.reset();
+  }
+  if (is_array) {
     return std::make_unique<HttpIntfArrayIterableImpl>(
-        intf_, path_, result_, cache_state_, mode, freshness);
+        intf_, path_, std::move(result), cache_state_, mode,
+        std::move(params));
   }
   // Check if the object is a Redfish collection.
   if (is_collection_iterable) {
     return std::make_unique<HttpIntfCollectionIterableImpl>(
-        intf_, path_, result_, cache_state_, mode, freshness);
+        intf_, path_, std::move(result), cache_state_, mode,
+        std::move(params), member_window_);
   }
   return nullptr;
 }
@@ -620,6 +1016,11 @@ class HttpRedfishInterface : public RedfishInterface {
     return trusted_ == kTrusted;
   }
 
+  std::function<void()> BindToCallingThread(std::function<void()> task) const {
+    absl::ReaderMutexLock mu(&transport_mutex_);
+    return transport_->BindToCallingThread(std::move(task));
+  }
+
   void UpdateTransport(std::unique_ptr<RedfishTransport> new_transport,
                        TrustedEndpoint trusted) {
     absl::WriterMutexLock mu(&transport_mutex_);
@@ -739,6 +1140,11 @@ class HttpRedfishInterface : public RedfishInterface {
       ecclesia::RedfishCachedGetterInterface::OperationResult get_res) {
     if (!get_res.result.ok()) return RedfishVariant(get_res.result.status());
 
+    // Collection members are counted relative to the requested window.
+    MemberWindow member_window;
+    if (params.skip.has_value()) member_window.skip = params.skip->skip();
+    if (params.top.has_value()) member_window.top = params.top->top();
+
     // Handle JSON pointers if needed. Pointers follow a '#' character at the
     // end of a path.
     std::vector<absl::string_view> json_ptrs =
@@ -752,15 +1158,16 @@ class HttpRedfishInterface : public RedfishInterface {
           std::make_unique<HttpIntfVariantImpl>(
               this, RedfishExtendedPath{.uri = std::string(uri)},
               *std::move(get_res.result),
-              get_res.is_fresh ? kIsFresh : kIsCached),
+              get_res.is_fresh ? kIsFresh : kIsCached, member_window),
           ecclesia::HttpResponseCodeFromInt(code), headers);
     }
-    if (!std::holds_alternative<nlohmann::json>(get_res.result->body)) {
+    const nlohmann::json *json_body = get_res.result->GetJsonBody();
+    if (json_body == nullptr) {
       return RedfishVariant(
           absl::InternalError("Result body is not holding JSON"));
     }
-    nlohmann::json resolved_ptr = ecclesia::HandleJsonPtr(
-        std::get<nlohmann::json>(get_res.result->body), json_ptrs[1]);
+    nlohmann::json resolved_ptr =
+        ecclesia::HandleJsonPtr(*json_body, json_ptrs[1]);
     get_res.result->body = std::move(resolved_ptr);
     int code = get_res.result->code;
     absl::flat_hash_map<std::string, std::string> headers =
@@ -789,6 +1196,16 @@ class HttpRedfishInterface : public RedfishInterface {
     auto features_json =
         (*root_object)[kProtocolFeaturesSupported][kExpandQuery].AsObject();
     RedfishSupportedFeatures features;
+    if (auto protocol_features_json =
+            (*root_object)[kProtocolFeaturesSupported].AsObject();
+        protocol_features_json != nullptr) {
+      features.filter =
+          protocol_features_json->GetNodeValue<FilterQuery>().value_or(false);
+      features.select =
+          protocol_features_json->GetNodeValue<SelectQuery>().value_or(false);
+      features.top_skip =
+          protocol_features_json->GetNodeValue<TopSkipQuery>().value_or(false);
+    }
     if (features_json != nullptr) {
       if (auto val = features_json->GetNodeValue<ExpandQueryExpandAll>();
           val.has_value()) {
@@ -830,6 +1247,12 @@ class HttpRedfishInterface : public RedfishInterface {
       false;
 };
 
+std::function<void()> BindToCallingThread(RedfishInterface *intf,
+                                          std::function<void()> task) {
+  return static_cast<HttpRedfishInterface *>(intf)->BindToCallingThread(
+      std::move(task));
+}
+
 }  // namespace
 
 std::unique_ptr<RedfishInterface> NewHttpInterface(
@@ -26,9 +26,13 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "ecclesia/lib/http/client.h"
@@ -42,6 +46,7 @@
 #include "ecclesia/lib/redfish/transport/http.h"
 #include "ecclesia/lib/redfish/transport/interface.h"
 #include "ecclesia/lib/thread/thread.h"
+#include "ecclesia/lib/thread/thread_pool.h"
 #include "ecclesia/lib/time/clock_fake.h"
 #include "single_include/nlohmann/json.hpp"
 #include "tensorflow_serving/util/net_http/server/public/server_request_interface.h"
@@ -49,9 +54,11 @@
 namespace ecclesia {
 namespace {
 
+using ::testing::Each;
 using ::testing::ElementsAre;
 using ::testing::Eq;
 using ::testing::Gt;
+using ::testing::SizeIs;
 using ::testing::UnorderedElementsAre;
 
 using ::tensorflow::serving::net_http::ServerRequestInterface;
@@ -1417,5 +1424,215 @@ TEST_F(HttpRedfishInterfaceTest, GetUnresolvedNavigationProperty) {
   EXPECT_EQ("/redfish/v1/Chassis/chassis", odata_id.value());
 }
 
+// Serves a collection of 6 entries split in 3 pages linked through
+// Members@odata.nextLink. The number of GETs of each page is recorded.
+class PaginatedCollectionTest : public HttpRedfishInterfaceTest {
+ protected:
+  void ServeCollection(bool with_count, absl::string_view first_page_uri) {
+    for (int page = 0; page < 3; ++page) {
+      nlohmann::json json = {{"@odata.id", "/redfish/v1/Entries"}};
+      for (int entry = page * 2; entry < page * 2 + 2; ++entry) {
+        std::string uri = absl::StrCat("/redfish/v1/Entries/", entry);
+        json["Members"].push_back(
+            {{"@odata.id", uri}, {"Id", absl::StrCat(entry)}});
+      }
+      if (page < 2) {
+        json["Members@odata.nextLink"] =
+            absl::StrCat("/redfish/v1/Entries/Page", page + 1);
+      }
+      if (with_count) json["Members@odata.count"] = 6;
+      std::string uri = page == 0
+                            ? std::string(first_page_uri)
+                            : absl::StrCat("/redfish/v1/Entries/Page", page);
+      server_->AddHttpGetHandler(
+          uri, [this, page, body = json.dump()](ServerRequestInterface *req) {
+            {
+              absl::MutexLock lock(&mutex_);
+              ++page_get_count_[page];
+              if (page == 1 && !second_page_requested_.HasBeenNotified()) {
+                second_page_requested_.Notify();
+              }
+            }
+            SetContentType(req, "application/json");
+            req->OverwriteResponseHeader("OData-Version", "4.0");
+            req->WriteResponseString(body);
+            req->Reply();
+          });
+    }
+  }
+
+  std::vector<int> PageGetCounts() {
+    absl::MutexLock lock(&mutex_);
+    return {page_get_count_[0], page_get_count_[1], page_get_count_[2]};
+  }
+
+  absl::Mutex mutex_;
+  int page_get_count_[3] ABSL_GUARDED_BY(mutex_) = {0, 0, 0};
+  absl::Notification second_page_requested_;
+};
+
+TEST_F(PaginatedCollectionTest, IteratesThroughAllPages) {
+  ServeCollection(/*with_count=*/false, "/redfish/v1/Entries");
+  auto collection = intf_->CachedGetUri("/redfish/v1/Entries", GetParams{});
+  std::unique_ptr<RedfishIterable> iterable = collection.AsIterable();
+  ASSERT_NE(iterable, nullptr);
+  EXPECT_THAT(iterable->Size(), Eq(6));
+
+  std::vector<std::string> ids;
+  for (RedfishVariant member : *iterable) {
+    std::unique_ptr<RedfishObject> object = member.AsObject();
+    ASSERT_NE(object, nullptr);
+    ids.push_back(object->GetNodeValue<PropertyId>().value_or(""));
+  }
+  EXPECT_THAT(ids, ElementsAre("0", "1", "2", "3", "4", "5"));
+  EXPECT_THAT((*iterable)[6].status().code(),
+              Eq(absl::StatusCode::kNotFound));
+}
+
+TEST_F(PaginatedCollectionTest, FetchesPagesLazily) {
+  ServeCollection(/*with_count=*/true, "/redfish/v1/Entries");
+  auto collection = intf_->UncachedGetUri("/redfish/v1/Entries", GetParams{});
+  std::unique_ptr<RedfishIterable> iterable = collection.AsIterable(
+      RedfishVariant::IterableMode::kAllowExpand,
+      GetParams::Freshness::kRequired);
+  ASSERT_NE(iterable, nullptr);
+  // The size comes from the count, without fetching the following pages.
+  EXPECT_THAT(iterable->Size(), Eq(6));
+  EXPECT_TRUE((*iterable)[1].status().ok());
+  // Only the second page is fetched in the background.
+  ASSERT_TRUE(
+      second_page_requested_.WaitForNotificationWithTimeout(absl::Seconds(10)));
+  EXPECT_THAT(PageGetCounts(), ElementsAre(1, 1, 0));
+
+  std::unique_ptr<RedfishObject> object = (*iterable)[5].AsObject();
+  ASSERT_NE(object, nullptr);
+  EXPECT_THAT(object->GetNodeValue<PropertyId>(), Eq("5"));
+  EXPECT_THAT(PageGetCounts(), ElementsAre(1, 1, 1));
+}
+
+TEST_F(PaginatedCollectionTest, RequestsSecondPageWhileReadingFirst) {
+  ServeCollection(/*with_count=*/true, "/redfish/v1/Entries");
+  auto collection = intf_->UncachedGetUri("/redfish/v1/Entries", GetParams{});
+  std::unique_ptr<RedfishIterable> iterable = collection.AsIterable(
+      RedfishVariant::IterableMode::kAllowExpand,
+      GetParams::Freshness::kRequired);
+  ASSERT_NE(iterable, nullptr);
+
+  std::unique_ptr<RedfishObject> object = (*iterable)[0].AsObject();
+  ASSERT_NE(object, nullptr);
+  EXPECT_THAT(object->GetNodeValue<PropertyId>(), Eq("0"));
+  // The second page is requested before any of its members is accessed.
+  EXPECT_TRUE(
+      second_page_requested_.WaitForNotificationWithTimeout(absl::Seconds(10)));
+
+  object = (*iterable)[2].AsObject();
+  ASSERT_NE(object, nullptr);
+  EXPECT_THAT(object->GetNodeValue<PropertyId>(), Eq("2"));
+  EXPECT_THAT(PageGetCounts()[1], Eq(1));
+}
+
+TEST_F(PaginatedCollectionTest, EmptyReadsOnlyFirstPage) {
+  ServeCollection(/*with_count=*/false, "/redfish/v1/Entries");
+  auto collection = intf_->UncachedGetUri("/redfish/v1/Entries", GetParams{});
+  std::unique_ptr<RedfishIterable> iterable = collection.AsIterable(
+      RedfishVariant::IterableMode::kAllowExpand,
+      GetParams::Freshness::kRequired);
+  ASSERT_NE(iterable, nullptr);
+  EXPECT_FALSE(iterable->Empty());
+  EXPECT_THAT(PageGetCounts(), ElementsAre(1, 0, 0));
+}
+
+TEST_F(PaginatedCollectionTest, AccessesMembersFromManyThreads) {
+  ServeCollection(/*with_count=*/false, "/redfish/v1/Entries");
+  auto collection = intf_->UncachedGetUri("/redfish/v1/Entries", GetParams{});
+  std::unique_ptr<RedfishIterable> iterable = collection.AsIterable(
+      RedfishVariant::IterableMode::kAllowExpand,
+      GetParams::Freshness::kRequired);
+  ASSERT_NE(iterable, nullptr);
+
+  std::vector<std::string> ids(6);
+  {
+    ThreadPool pool(3);
+    for (int i = 0; i < 6; ++i) {
+      pool.Schedule([&iterable, &ids, i]() {
+        std::unique_ptr<RedfishObject> object = (*iterable)[i].AsObject();
+        if (object != nullptr) {
+          ids[i] = object->GetNodeValue<PropertyId>().value_or("");
+        }
+      });
+    }
+  }
+  EXPECT_THAT(ids, ElementsAre("0", "1", "2", "3", "4", "5"));
+}
+
+TEST_F(PaginatedCollectionTest, StopsAtTop) {
+  ServeCollection(/*with_count=*/true, "/redfish/v1/Entries?$top=3");
+  auto collection = intf_->UncachedGetUri(
+      "/redfish/v1/Entries", GetParams{.top = RedfishQueryParamTop(3)});
+  std::unique_ptr<RedfishIterable> iterable = collection.AsIterable(
+      RedfishVariant::IterableMode::kAllowExpand,
+      GetParams::Freshness::kRequired);
+  ASSERT_NE(iterable, nullptr);
+  EXPECT_THAT(iterable->Size(), Eq(3));
+
+  std::vector<std::string> ids;
+  for (RedfishVariant member : *iterable) {
+    std::unique_ptr<RedfishObject> object = member.AsObject();
+    ASSERT_NE(object, nullptr);
+    ids.push_back(object->GetNodeValue<PropertyId>().value_or(""));
+  }
+  EXPECT_THAT(ids, ElementsAre("0", "1", "2"));
+  // The last page is neither needed nor prefetched.
+  EXPECT_THAT(PageGetCounts(), ElementsAre(1, 1, 0));
+}
+
+TEST_F(HttpRedfishInterfaceTest, PrefetchesMembersInOrder) {
+  constexpr int kMembers = 20;
+  absl::Mutex mutex;
+  std::vector<int> member_get_counts(kMembers, 0);
+  nlohmann::json collection = {{"@odata.id", "/redfish/v1/Entries"},
+                               {"Members@odata.count", kMembers}};
+  for (int i = 0; i < kMembers; ++i) {
+    std::string uri = absl::StrCat("/redfish/v1/Entries/", i);
+    collection["Members"].push_back({{"@odata.id", uri}});
+    server_->AddHttpGetHandler(uri, [&, i](ServerRequestInterface *req) {
+      {
+        absl::MutexLock lock(&mutex);
+        ++member_get_counts[i];
+      }
+      SetContentType(req, "application/json");
+      req->OverwriteResponseHeader("OData-Version", "4.0");
+      req->WriteResponseString(
+          nlohmann::json({{"Id", absl::StrCat(i)}}).dump());
+      req->Reply();
+    });
+  }
+  server_->AddHttpGetHandler(
+      "/redfish/v1/Entries", [&](ServerRequestInterface *req) {
+        SetContentType(req, "application/json");
+        req->OverwriteResponseHeader("OData-Version", "4.0");
+        req->WriteResponseString(collection.dump());
+        req->Reply();
+      });
+
+  auto variant = intf_->CachedGetUri("/redfish/v1/Entries", GetParams{});
+  std::unique_ptr<RedfishIterable> iterable =
+      variant.AsIterable(RedfishVariant::IterableMode::kPrefetchMembers,
+                         GetParams::Freshness::kRequired);
+  ASSERT_NE(iterable, nullptr);
+  std::vector<std::string> ids;
+  for (RedfishVariant member : *iterable) {
+    std::unique_ptr<RedfishObject> object = member.AsObject();
+    ASSERT_NE(object, nullptr);
+    ids.push_back(object->GetNodeValue<PropertyId>().value_or(""));
+  }
+  ASSERT_THAT(ids, SizeIs(kMembers));
+  for (int i = 0; i < kMembers; ++i) {
+    EXPECT_THAT(ids[i], Eq(absl::StrCat(i)));
+  }
+  absl::MutexLock lock(&mutex);
+  EXPECT_THAT(member_get_counts, Each(1));
+}
+
 }  // namespace
 }  // namespace ecclesia
@@ -18,6 +18,7 @@
 #define ECCLESIA_LIB_REDFISH_TRANSPORT_INTERFACE_H_
 
 #include <cstdint>
+#include <functional>
 #include <string>
 #include <variant>
 #include <vector>
@@ -26,6 +27,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "ecclesia/lib/redfish/transport/lazy_json.h"
 #include "single_include/nlohmann/json.hpp"
 
 namespace ecclesia {
@@ -39,12 +41,26 @@ class RedfishTransport {
   struct Result {
     // HTTP code.
     int code = 0;
-    // If the result is in the Redfish tree, it will be parsed as JSON.
-    // Otherwise, it will be treated as bytes.
-    std::variant<nlohmann::json, bytes> body =
+    // If the result is in the Redfish tree, it will be parsed as JSON, either
+    // in full or lazily as its properties are accessed. Otherwise, it will be
+    // treated as bytes.
+    std::variant<nlohmann::json, bytes, LazyJson> body =
         nlohmann::json::value_t::discarded;
     // Headers returned in the response.
     absl::flat_hash_map<std::string, std::string> headers;
+
+    // Returns true if the body holds JSON, parsed or not.
+    bool HasJsonBody() const {
+      return !std::holds_alternative<bytes>(body);
+    }
+    // Returns the body as JSON, parsing a lazily parsed body in full, or
+    // nullptr if the body holds bytes.
+    const nlohmann::json *GetJsonBody() const {
+      if (const auto *lazy = std::get_if<LazyJson>(&body)) {
+        return &lazy->Parse();
+      }
+      return std::get_if<nlohmann::json>(&body);
+    }
   };
 
   virtual ~RedfishTransport() = default;
@@ -62,6 +78,14 @@ class RedfishTransport {
                                        absl::string_view data) = 0;
   virtual absl::StatusOr<Result> Delete(absl::string_view path,
                                         absl::string_view data) = 0;
+
+  // Returns 'task' wrapped to issue its requests as if from the calling
+  // thread, for work scheduled on other threads on its behalf. Decorators
+  // keeping per-thread state carry it over to 'task'.
+  virtual std::function<void()> BindToCallingThread(
+      std::function<void()> task) {
+    return task;
+  }
 };
 
 // NullTransport provides a placeholder implementation which gracefully fails
@@ -0,0 +1,199 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ecclesia/lib/redfish/transport/lazy_json.h"
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/base/call_once.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "single_include/nlohmann/json.hpp"
+
+namespace ecclesia {
+
+namespace {
+
+bool IsWhitespace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+size_t SkipWhitespace(absl::string_view text, size_t pos) {
+  while (pos < text.size() && IsWhitespace(text[pos])) ++pos;
+  return pos;
+}
+
+// Returns the position following the JSON string starting at 'pos', or npos
+// if the string is not terminated.
+size_t SkipString(absl::string_view text, size_t pos) {
+  for (size_t i = pos + 1; i < text.size(); ++i) {
+    if (text[i] == '\\') {
+      ++i;
+    } else if (text[i] == '"') {
+      return i + 1;
+    }
+  }
+  return absl::string_view::npos;
+}
+
+// Returns the position following the JSON value starting at 'pos', or npos if
+// the value is not terminated. Objects and arrays are skipped by matching
+// their brackets; their contents are validated along with the whole text.
+size_t SkipValue(absl::string_view text, size_t pos) {
+  if (pos >= text.size()) return absl::string_view::npos;
+  char first = text[pos];
+  if (first == '"') return SkipString(text, pos);
+  if (first == '{' || first == '[') {
+    int depth = 0;
+    for (size_t i = pos; i < text.size(); ++i) {
+      switch (text[i]) {
+        case '"':
+          i = SkipString(text, i);
+          if (i == absl::string_view::npos) return i;
+          --i;
+          break;
+        case '{':
+        case '[':
+          ++depth;
+          break;
+        case '}':
+        case ']':
+          if (--depth == 0) return i + 1;
+          break;
+        default:
+          break;
+      }
+    }
+    return absl::string_view::npos;
+  }
+  // Numbers and literals extend to the next delimiter.
+  size_t end = pos;
+  while (end < text.size() && text[end] != ',' && text[end] != '}' &&
+         text[end] != ']' && !IsWhitespace(text[end])) {
+    ++end;
+  }
+  return end == pos ? absl::string_view::npos : end;
+}
+
+// Indexes the top-level properties of the JSON object in 'text'. Returns
+// false if the text is not recognized as a JSON object.
+bool IndexObject(absl::string_view text,
+                 absl::flat_hash_map<std::string, absl::string_view> &index) {
+  size_t pos = SkipWhitespace(text, 0);
+  if (pos >= text.size() || text[pos] != '{') return false;
+  pos = SkipWhitespace(text, pos + 1);
+  if (pos < text.size() && text[pos] == '}') {
+    return SkipWhitespace(text, pos + 1) == text.size();
+  }
+  while (pos < text.size()) {
+    if (text[pos] != '"') return false;
+    size_t name_end = SkipString(text, pos);
+    if (name_end == absl::string_view::npos) return false;
+    // Names without escape sequences are used as-is.
+    absl::string_view raw_name = text.substr(pos + 1, name_end - pos - 2);
+    std::string name;
+    if (raw_name.find('\\') == absl::string_view::npos) {
+      name = std::string(raw_name);
+    } else {
+      nlohmann::json decoded =
+          nlohmann::json::parse(text.substr(pos, name_end - pos), nullptr,
+                                /*allow_exceptions=*/false);
+      if (!decoded.is_string()) return false;
+      name = decoded.get<std::string>();
+    }
+
+    pos = SkipWhitespace(text, name_end);
+    if (pos >= text.size() || text[pos] != ':') return false;
+    pos = SkipWhitespace(text, pos + 1);
+    size_t value_end = SkipValue(text, pos);
+    if (value_end == absl::string_view::npos) return false;
+    // As when parsing, the last of duplicate properties wins.
+    index.insert_or_assign(std::move(name),
+                           text.substr(pos, value_end - pos));
+
+    pos = SkipWhitespace(text, value_end);
+    if (pos >= text.size()) return false;
+    if (text[pos] == '}') return SkipWhitespace(text, pos + 1) == text.size();
+    if (text[pos] != ',') return false;
+    pos = SkipWhitespace(text, pos + 1);
+  }
+  return false;
+}
+
+}  // namespace
+
+LazyJson::LazyJson(std::string text)
+    : state_(std::make_shared<State>(std::move(text))) {}
+
+const LazyJson::State &LazyJson::GetIndexedState() const {
+  State *state = state_.get();
+  absl::call_once(state->index_once, [state]() {
+    // The text is validated without building any values, so that a malformed
+    // value makes the whole text invalid as it does when parsing it in full.
+    state->is_object = IndexObject(state->text, state->index) &&
+                       nlohmann::json::accept(state->text);
+    if (!state->is_object) state->index.clear();
+  });
+  return *state;
+}
+
+bool LazyJson::IsObject() const {
+  const State &state = GetIndexedState();
+  if (state.is_object) return true;
+  // Fall back to the parser for text the index does not recognize.
+  return Parse().is_object();
+}
+
+std::optional<nlohmann::json> LazyJson::Get(absl::string_view name) const {
+  const State &state = GetIndexedState();
+  if (!state.is_object) {
+    const nlohmann::json &json = Parse();
+    if (!json.is_object()) return std::nullopt;
+    auto itr = json.find(std::string(name));
+    if (itr == json.end()) return std::nullopt;
+    return *itr;
+  }
+  auto itr = state.index.find(name);
+  if (itr == state.index.end()) return std::nullopt;
+  nlohmann::json value = nlohmann::json::parse(itr->second, nullptr,
+                                               /*allow_exceptions=*/false);
+  if (value.is_discarded()) return std::nullopt;
+  return value;
+}
+
+bool LazyJson::Contains(absl::string_view name) const {
+  const State &state = GetIndexedState();
+  if (!state.is_object) {
+    const nlohmann::json &json = Parse();
+    return json.is_object() && json.contains(std::string(name));
+  }
+  return state.index.contains(name);
+}
+
+const nlohmann::json &LazyJson::Parse() const {
+  State *state = state_.get();
+  absl::call_once(state->parse_once, [state]() {
+    state->json = nlohmann::json::parse(state->text, nullptr,
+                                        /*allow_exceptions=*/false);
+  });
+  return state->json;
+}
+
+}  // namespace ecclesia
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ECCLESIA_LIB_REDFISH_TRANSPORT_LAZY_JSON_H_
+#define ECCLESIA_LIB_REDFISH_TRANSPORT_LAZY_JSON_H_
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/base/call_once.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "single_include/nlohmann/json.hpp"
+
+namespace ecclesia {
+
+// LazyJson holds JSON text which is parsed only as far as it is accessed.
+//
+// The text of a JSON object is validated and indexed by its top-level property
+// names on first access, without building the values. Each property is then
+// parsed individually when it is read, so reading a few properties of a large
+// resource costs scans of the text rather than the construction of the whole
+// document. The text is parsed in full only when the whole document is
+// requested. As when parsing in full, text which is not valid JSON throughout
+// does not hold an object.
+//
+// Copies share the text and the parsing state. This class is thread-safe.
+class LazyJson {
+ public:
+  explicit LazyJson(std::string text);
+
+  // Returns the JSON text.
+  absl::string_view text() const { return state_->text; }
+
+  // Returns true if the text holds a JSON object.
+  bool IsObject() const;
+
+  // Returns the top-level property 'name' of the JSON object, parsing only the
+  // value of the property. Returns nullopt if the text does not hold a valid
+  // JSON object or the object has no such property.
+  std::optional<nlohmann::json> Get(absl::string_view name) const;
+
+  // Returns true if the JSON object has the top-level property 'name'.
+  bool Contains(absl::string_view name) const;
+
+  // Returns the whole document, parsing the text in full on first use. If the
+  // text is not valid JSON, nlohmann::json::value_t::discarded is returned.
+  const nlohmann::json &Parse() const;
+
+ private:
+  struct State {
+    explicit State(std::string text) : text(std::move(text)) {}
+
+    const std::string text;
+    absl::once_flag index_once;
+    // Whether the text was recognized as a JSON object.
+    bool is_object = false;
+    // Maps each top-level property name to the text of its value.
+    absl::flat_hash_map<std::string, absl::string_view> index;
+    absl::once_flag parse_once;
+    nlohmann::json json;
+  };
+
+  const State &GetIndexedState() const;
+
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace ecclesia
+
+#endif  // ECCLESIA_LIB_REDFISH_TRANSPORT_LAZY_JSON_H_
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares parsing Redfish payloads in full against reading a few properties
+// of a LazyJson, over payloads of the indus mockup.
+
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "ecclesia/lib/redfish/testing/fake_redfish_server.h"
+#include "ecclesia/lib/redfish/transport/interface.h"
+#include "ecclesia/lib/redfish/transport/lazy_json.h"
+#include "single_include/nlohmann/json.hpp"
+
+namespace ecclesia {
+namespace {
+
+// Resources of the mockup, from the largest payload to a small one.
+constexpr const char *kUris[] = {
+    "/redfish/v1/Chassis/chassis/Assembly",
+    "/redfish/v1/Chassis/chassis/Sensors",
+    "/redfish/v1/Chassis/chassis",
+    "/redfish/v1/Chassis/chassis/Sensors/i_cpu0_t",
+};
+
+// Returns the payload of each resource in kUris.
+const std::vector<std::string> &GetPayloads() {
+  static const std::vector<std::string> *payloads = [] {
+    FakeRedfishServer server("indus_hmb_shim/mockup.shar");
+    auto transport = server.RedfishClientTransport();
+    auto *payloads = new std::vector<std::string>();
+    for (const char *uri : kUris) {
+      absl::StatusOr<RedfishTransport::Result> result = transport->Get(uri);
+      CHECK(result.ok()) << result.status();
+      const nlohmann::json *json = result->GetJsonBody();
+      CHECK(json != nullptr) << uri;
+      payloads->push_back(json->dump(1));
+    }
+    return payloads;
+  }();
+  return *payloads;
+}
+
+// Parses each payload in full, then reads the properties a query typically
+// reads of a resource.
+void BM_EagerParse(benchmark::State &state) {
+  const std::string &payload = GetPayloads()[state.range(0)];
+  for (auto s : state) {
+    nlohmann::json json = nlohmann::json::parse(payload);
+    benchmark::DoNotOptimize(json.find("@odata.id"));
+    benchmark::DoNotOptimize(json.find("Name"));
+  }
+  state.SetBytesProcessed(state.iterations() * payload.size());
+}
+
+// Reads the same properties of a LazyJson, parsing only their values.
+void BM_LazyParse(benchmark::State &state) {
+  const std::string &payload = GetPayloads()[state.range(0)];
+  for (auto s : state) {
+    LazyJson lazy(payload);
+    benchmark::DoNotOptimize(lazy.Get("@odata.id"));
+    benchmark::DoNotOptimize(lazy.Get("Name"));
+  }
+  state.SetBytesProcessed(state.iterations() * payload.size());
+}
+
+BENCHMARK(BM_EagerParse)->DenseRange(0, std::size(kUris) - 1);
+BENCHMARK(BM_LazyParse)->DenseRange(0, std::size(kUris) - 1);
+
+}  // namespace
+}  // namespace ecclesia
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ecclesia/lib/redfish/transport/lazy_json.h"
+
+#include <optional>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "single_include/nlohmann/json.hpp"
+
+namespace ecclesia {
+namespace {
+
+using ::testing::Eq;
+using ::testing::Optional;
+
+constexpr char kResource[] = R"json(
+{
+  "@odata.id": "/redfish/v1/Chassis/chassis",
+  "Name": "Indus Chassis",
+  "Status": {"State": "Enabled", "Health": "OK"},
+  "Sensors": {"@odata.id": "/redfish/v1/Chassis/chassis/Sensors"},
+  "Links": {"ComputerSystems": [{"@odata.id": "/redfish/v1/Systems/system"}]},
+  "Description": "Braces } and brackets ] in a \"string\"",
+  "Quoted\"Name": 1,
+  "PowerWatts": -12.5e1,
+  "Present": true,
+  "Location": null
+}
+)json";
+
+TEST(LazyJsonTest, GetsTopLevelProperties) {
+  LazyJson lazy{std::string(kResource)};
+  ASSERT_TRUE(lazy.IsObject());
+  EXPECT_THAT(lazy.Get("@odata.id"),
+              Optional(Eq(nlohmann::json("/redfish/v1/Chassis/chassis"))));
+  EXPECT_THAT(lazy.Get("Status"),
+              Optional(Eq(nlohmann::json::parse(
+                  R"json({"State": "Enabled", "Health": "OK"})json"))));
+  EXPECT_THAT(lazy.Get("Description"),
+              Optional(Eq(nlohmann::json(
+                  "Braces } and brackets ] in a \"string\""))));
+  EXPECT_THAT(lazy.Get("Quoted\"Name"), Optional(Eq(nlohmann::json(1))));
+  EXPECT_THAT(lazy.Get("PowerWatts"), Optional(Eq(nlohmann::json(-125.0))));
+  EXPECT_THAT(lazy.Get("Present"), Optional(Eq(nlohmann::json(true))));
+  EXPECT_THAT(lazy.Get("Location"), Optional(Eq(nlohmann::json(nullptr))));
+  EXPECT_EQ(lazy.Get("Missing"), std::nullopt);
+  EXPECT_TRUE(lazy.Contains("Links"));
+  EXPECT_FALSE(lazy.Contains("Missing"));
+}
+
+TEST(LazyJsonTest, ParseMatchesEagerParsing) {
+  LazyJson lazy{std::string(kResource)};
+  EXPECT_EQ(lazy.Parse(), nlohmann::json::parse(kResource));
+}
+
+TEST(LazyJsonTest, CopiesShareState) {
+  LazyJson lazy{std::string(kResource)};
+  LazyJson copy = lazy;
+  EXPECT_EQ(&lazy.Parse(), &copy.Parse());
+  EXPECT_EQ(lazy.text().data(), copy.text().data());
+}
+
+TEST(LazyJsonTest, LastDuplicatePropertyWins) {
+  LazyJson lazy{std::string(R"json({"Name": "first", "Name": "last"})json")};
+  EXPECT_THAT(lazy.Get("Name"), Optional(Eq(nlohmann::json("last"))));
+}
+
+TEST(LazyJsonTest, EmptyObject) {
+  LazyJson lazy{std::string(" { } ")};
+  EXPECT_TRUE(lazy.IsObject());
+  EXPECT_EQ(lazy.Get("Name"), std::nullopt);
+}
+
+TEST(LazyJsonTest, ArrayIsNotObject) {
+  LazyJson lazy{std::string("[1, 2, 3]")};
+  EXPECT_FALSE(lazy.IsObject());
+  EXPECT_EQ(lazy.Get("Name"), std::nullopt);
+  EXPECT_EQ(lazy.Parse(), nlohmann::json::parse("[1, 2, 3]"));
+}
+
+TEST(LazyJsonTest, InvalidJson) {
+  LazyJson lazy{std::string(R"json({"Name": "unterminated)json")};
+  EXPECT_FALSE(lazy.IsObject());
+  EXPECT_FALSE(lazy.Contains("Name"));
+  EXPECT_EQ(lazy.Get("Name"), std::nullopt);
+  EXPECT_TRUE(lazy.Parse().is_discarded());
+}
+
+TEST(LazyJsonTest, InvalidPropertyValue) {
+  LazyJson lazy{std::string(R"json({"Name": [1, }, "Id": "1"})json")};
+  EXPECT_EQ(lazy.Get("Name"), std::nullopt);
+}
+
+TEST(LazyJsonTest, MalformedNestedValueInvalidatesObject) {
+  // The brackets of the nested value match, but its contents are malformed.
+  constexpr char kMalformed[] =
+      R"json({"Id": "1", "Status": {"State": "Enabled",, "Health"}})json";
+  LazyJson lazy{std::string(kMalformed)};
+  EXPECT_FALSE(lazy.IsObject());
+  EXPECT_FALSE(lazy.Contains("Id"));
+  EXPECT_EQ(lazy.Get("Id"), std::nullopt);
+  EXPECT_TRUE(lazy.Parse().is_discarded());
+  EXPECT_TRUE(nlohmann::json::parse(kMalformed, nullptr,
+                                    /*allow_exceptions=*/false)
+                  .is_discarded());
+}
+
+}  // namespace
+}  // namespace ecclesia
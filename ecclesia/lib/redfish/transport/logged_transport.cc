@@ -29,6 +29,7 @@
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "ecclesia/lib/redfish/transport/interface.h"
+#include "ecclesia/lib/redfish/transport/lazy_json.h"
 #include "ecclesia/lib/redfish/utils.h"
 
 namespace ecclesia {
@@ -37,6 +38,9 @@ namespace {
 std::string PrintResult(const nlohmann::json &result) {
   return JsonToString(result, /*indent=*/1);
 }
+std::string PrintResult(const LazyJson &result) {
+  return std::string(result.text());
+}
 std::string PrintResult(const RedfishTransport::bytes &result) {
   return "<bytes output>";
 }
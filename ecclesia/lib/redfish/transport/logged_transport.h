@@ -17,6 +17,7 @@
 #ifndef ECCLESIA_LIB_REDFISH_TRANSPORT_LOGGED_TRANSPORT_H_
 #define ECCLESIA_LIB_REDFISH_TRANSPORT_LOGGED_TRANSPORT_H_
 
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
@@ -51,6 +52,10 @@ class RedfishLoggedTransport : public RedfishTransport {
                                absl::string_view data) override;
   absl::StatusOr<Result> Delete(absl::string_view path,
                                 absl::string_view data) override;
+  std::function<void()> BindToCallingThread(
+      std::function<void()> task) override {
+    return base_transport_->BindToCallingThread(std::move(task));
+  }
 
  private:
   std::unique_ptr<RedfishTransport> base_transport_;
@@ -17,6 +17,7 @@
 #ifndef ECCLESIA_LIB_REDFISH_TRANSPORT_METRICAL_TRANSPORT_H_
 #define ECCLESIA_LIB_REDFISH_TRANSPORT_METRICAL_TRANSPORT_H_
 
+#include <functional>
 #include <memory>
 #include <utility>
 
@@ -46,6 +47,10 @@ class MetricalRedfishTransport : public RedfishTransport {
                                absl::string_view data) override;
   absl::StatusOr<Result> Delete(absl::string_view path,
                                 absl::string_view data) override;
+  std::function<void()> BindToCallingThread(
+      std::function<void()> task) override {
+    return base_transport_->BindToCallingThread(std::move(task));
+  }
   // Overwrite the current metrics with a new metrics proto. This is used for
   // collecting metrics over certain intervals.
   void ResetTrackingMetricsProto(RedfishMetrics *transport_metrics) {